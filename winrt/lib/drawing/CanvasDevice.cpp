@@ -633,6 +633,134 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+    IFACEMETHODIMP CanvasDevice::get_TextLayoutCacheMaximumEntries(UINT32* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_textLayoutCache.GetMaximumEntries();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::put_TextLayoutCacheMaximumEntries(UINT32 value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+
+                m_textLayoutCache.SetMaximumEntries(value);
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_TextLayoutCacheMaximumBytes(UINT64* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_textLayoutCache.GetMaximumBytes();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::put_TextLayoutCacheMaximumBytes(UINT64 value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+
+                m_textLayoutCache.SetMaximumBytes(value);
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_TextLayoutCacheStatistics(CanvasTextLayoutCacheStatistics* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_textLayoutCache.GetStatistics();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_LayerPoolMaximumBytes(UINT64* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_layerPool.GetMaximumBytes();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::put_LayerPoolMaximumBytes(UINT64 value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+
+                m_layerPool.SetMaximumBytes(value);
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_LayerPoolStatistics(CanvasLayerPoolStatistics* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_layerPool.GetStatistics();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_GeometryRealizationCacheMaximumBytes(UINT64* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_geometryRealizationCache.GetMaximumBytes();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::put_GeometryRealizationCacheMaximumBytes(UINT64 value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+
+                m_geometryRealizationCache.SetMaximumBytes(value);
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_GeometryRealizationCacheStatistics(CanvasGeometryRealizationCacheStatistics* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckInPointer(value);
+
+                *value = m_geometryRealizationCache.GetStatistics();
+            });
+    }
+
     IFACEMETHODIMP CanvasDevice::add_DeviceLost(
         DeviceLostHandlerType* value, 
         EventRegistrationToken* token)
@@ -724,6 +852,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 m_primaryOutput.Reset();
                 m_sharedState.reset();
                 m_histogramEffect.Reset();
+                m_textLayoutCache.Clear();
+                m_layerPool.Clear();
+                m_geometryRealizationCache.Clear();
             });
     }
 
@@ -1020,6 +1151,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 d2dDevice->ClearResources();
 
                 dxgiDevice->Trim();
+
+                m_textLayoutCache.Clear();
+                m_layerPool.Clear();
+                m_geometryRealizationCache.Clear();
             });
     }
 
@@ -1403,6 +1538,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         InterlockedExchangeComPtr(m_histogramEffect, std::move(effect));
     }
 
+    Text::TextLayoutCache* CanvasDevice::GetTextLayoutCache()
+    {
+        return &m_textLayoutCache;
+    }
+
+    LayerPool* CanvasDevice::GetLayerPool()
+    {
+        return &m_layerPool;
+    }
+
+    Geometry::GeometryRealizationCache* CanvasDevice::GetGeometryRealizationCache()
+    {
+        return &m_geometryRealizationCache;
+    }
+
 #if WINVER > _WIN32_WINNT_WINBLUE
 
     ComPtr<ID2D1GradientMesh> CanvasDevice::CreateGradientMesh(
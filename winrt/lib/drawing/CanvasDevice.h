@@ -5,6 +5,9 @@
 #pragma once
 
 #include "DeviceContextPool.h"
+#include "LayerPool.h"
+#include "geometry/GeometryRealizationCache.h"
+#include "text/TextLayoutCache.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
@@ -166,6 +169,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         virtual ComPtr<ID2D1Effect> LeaseHistogramEffect(ID2D1DeviceContext* d2dContext) = 0;
         virtual void ReleaseHistogramEffect(ComPtr<ID2D1Effect>&& effect) = 0;
 
+        virtual Text::TextLayoutCache* GetTextLayoutCache() = 0;
+        virtual LayerPool* GetLayerPool() = 0;
+        virtual Geometry::GeometryRealizationCache* GetGeometryRealizationCache() = 0;
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         virtual ComPtr<ID2D1GradientMesh> CreateGradientMesh(D2D1_GRADIENT_MESH_PATCH const* patches, uint32_t patchCount) = 0;
 
@@ -209,6 +216,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         ComPtr<ID2D1Effect> m_histogramEffect;
 
+        Text::TextLayoutCache m_textLayoutCache;
+
+        LayerPool m_layerPool;
+
+        Geometry::GeometryRealizationCache m_geometryRealizationCache;
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         std::mutex m_quirkMutex;
         
@@ -249,6 +262,24 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHOD(get_LowPriority)(boolean* value) override;
         IFACEMETHOD(put_LowPriority)(boolean value) override;
 
+        IFACEMETHOD(get_TextLayoutCacheMaximumEntries)(UINT32* value) override;
+        IFACEMETHOD(put_TextLayoutCacheMaximumEntries)(UINT32 value) override;
+
+        IFACEMETHOD(get_TextLayoutCacheMaximumBytes)(UINT64* value) override;
+        IFACEMETHOD(put_TextLayoutCacheMaximumBytes)(UINT64 value) override;
+
+        IFACEMETHOD(get_TextLayoutCacheStatistics)(CanvasTextLayoutCacheStatistics* value) override;
+
+        IFACEMETHOD(get_LayerPoolMaximumBytes)(UINT64* value) override;
+        IFACEMETHOD(put_LayerPoolMaximumBytes)(UINT64 value) override;
+
+        IFACEMETHOD(get_LayerPoolStatistics)(CanvasLayerPoolStatistics* value) override;
+
+        IFACEMETHOD(get_GeometryRealizationCacheMaximumBytes)(UINT64* value) override;
+        IFACEMETHOD(put_GeometryRealizationCacheMaximumBytes)(UINT64 value) override;
+
+        IFACEMETHOD(get_GeometryRealizationCacheStatistics)(CanvasGeometryRealizationCacheStatistics* value) override;
+
         IFACEMETHOD(add_DeviceLost)(DeviceLostHandlerType* value, EventRegistrationToken* token) override;
 
         IFACEMETHOD(remove_DeviceLost)(EventRegistrationToken token) override;
@@ -369,6 +400,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         virtual ComPtr<ID2D1Effect> LeaseHistogramEffect(ID2D1DeviceContext* d2dContext) override;
         virtual void ReleaseHistogramEffect(ComPtr<ID2D1Effect>&& effect) override;
 
+        virtual Text::TextLayoutCache* GetTextLayoutCache() override;
+        virtual LayerPool* GetLayerPool() override;
+        virtual Geometry::GeometryRealizationCache* GetGeometryRealizationCache() override;
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         virtual ComPtr<ID2D1GradientMesh> CreateGradientMesh(D2D1_GRADIENT_MESH_PATCH const* patches, uint32_t patchCount) override;
 
@@ -6,9 +6,11 @@
 
 #include "CanvasActiveLayer.h"
 #include "CanvasSpriteBatch.h"
+#include "geometry/CanvasCachedGeometry.h"
 #include "text/CanvasTextFormat.h"
 #include "text/CanvasTextRenderingParameters.h"
 #include "text/CanvasFontFace.h"
+#include "utils/BroadcastArray.h"
 #include "utils/TemporaryTransform.h"
 #include "text/TextUtilities.h"
 #include "text/InternalDWriteTextRenderer.h"
@@ -51,6 +53,62 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             return D2D1_SIZE_F{};
         }
     }
+
+
+    //
+    // Conservative bounds used by CullInvisibleDraws.  Strokes are centered on
+    // the outline, and the corners of a rectangle can extend a little further
+    // than half the stroke width, so the full width is allowed either side.
+    //
+
+    static D2D1_RECT_F GetStrokeBounds(D2D1_RECT_F const& rect, float strokeWidth)
+    {
+        auto margin = fabs(strokeWidth);
+
+        return D2D1_RECT_F
+        {
+            std::min(rect.left, rect.right) - margin,
+            std::min(rect.top, rect.bottom) - margin,
+            std::max(rect.left, rect.right) + margin,
+            std::max(rect.top, rect.bottom) + margin
+        };
+    }
+
+    static D2D1_RECT_F GetEllipseBounds(D2D1_ELLIPSE const& ellipse)
+    {
+        auto radiusX = fabs(ellipse.radiusX);
+        auto radiusY = fabs(ellipse.radiusY);
+
+        return D2D1_RECT_F
+        {
+            ellipse.point.x - radiusX,
+            ellipse.point.y - radiusY,
+            ellipse.point.x + radiusX,
+            ellipse.point.y + radiusY
+        };
+    }
+
+    // Some composite modes also affect the destination outside the image, so
+    // draws that use them must never be culled.
+    static bool IsBoundedComposite(ID2D1DeviceContext1* deviceContext, CanvasComposite const* composite)
+    {
+        // Without an explicit composite, the Copy blend maps to an unbounded copy.
+        if (!composite)
+            return deviceContext->GetPrimitiveBlend() != D2D1_PRIMITIVE_BLEND_COPY;
+
+        switch (*composite)
+        {
+        case CanvasComposite::SourceIn:
+        case CanvasComposite::DestinationIn:
+        case CanvasComposite::SourceOut:
+        case CanvasComposite::DestinationAtop:
+        case CanvasComposite::Copy:
+            return false;
+
+        default:
+            return true;
+        }
+    }
     
 
     //
@@ -86,6 +144,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             offset);
         CheckMakeResult(drawingSession);
 
+        // Sessions created this way own their device context, so nothing else
+        // can change its state behind their back.
+        drawingSession->m_stateCache->Enable();
+
         return drawingSession;
     }
 
@@ -137,8 +199,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         , m_adapter(adapter ? adapter : std::make_shared<NoopCanvasDrawingSessionAdapter>())
         , m_targetHasActiveDrawingSession(std::move(targetHasActiveDrawingSession))
         , m_offset(offset)
+        , m_solidColorBrushColor{}
+        , m_coalesceColorFills(false)
+        , m_coalescedFillColor{}
+        , m_colorFillStatistics{}
+        , m_stateCache(std::make_shared<DeviceContextStateCache>())
         , m_nextLayerId(0)
         , m_owner(owner)
+#if WINVER > _WIN32_WINNT_WINBLUE
+        , m_coalesceBitmapDraws(false)
+        , m_coalescedBitmapInterpolation(CanvasImageInterpolation::Linear)
+#endif
     {
         if (m_targetHasActiveDrawingSession)
             *m_targetHasActiveDrawingSession = true;
@@ -158,9 +229,38 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             [&]
             {
                 auto deviceContext = MaybeGetResource();
+
+                // Coalesced fills and bitmaps must be drawn before EndDraw, but a
+                // failure to draw them should not prevent the session from closing.
+                HRESULT coalescedFillResult = ExceptionBoundary(
+                    [&]
+                    {
+                        FlushCoalescedColorFills();
+                    });
+
+                m_coalescedFills.clear();
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+                HRESULT coalescedDrawResult = S_OK;
+
+                if (m_coalescedBitmapDraws)
+                {
+                    auto coalescedBitmapDraws = As<IClosable>(m_coalescedBitmapDraws);
+                    m_coalescedBitmapDraws.Reset();
+
+                    coalescedDrawResult = coalescedBitmapDraws->Close();
+                }
+#endif
         
+                if (deviceContext && m_profiler.IsEnabled())
+                    m_profiler.WriteStatisticsEvent();
+
                 ReleaseResource();
 
+                // Sprite batches created by this session share its state
+                // cache, and may outlive it.
+                m_stateCache->Disable();
+
                 if (!m_activeLayerIds.empty())
                     ThrowHR(E_FAIL, Strings::DidNotPopLayer);
 
@@ -185,8 +285,50 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 #if WINVER > _WIN32_WINNT_WINBLUE
                 m_inkD2DRenderer.Reset();
                 m_inkStateBlock.Reset();
+
+                ThrowIfFailed(coalescedDrawResult);
+#endif
+
+                ThrowIfFailed(coalescedFillResult);
+            });
+    }
+
+
+    ComPtr<ID2D1DeviceContext1> const& CanvasDrawingSession::GetResource()
+    {
+        auto& deviceContext = ResourceWrapper::GetResource();
+
+        FlushCoalescedColorFills();
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+        FlushCoalescedBitmapDraws();
+#endif
+
+        return deviceContext;
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::GetNativeResource(ICanvasDevice* device, float dpi, REFIID iid, void** resource)
+    {
+        // Anything drawn through the native device context must appear after
+        // the fills and bitmaps that have already been drawn through this session.
+        HRESULT hr = ExceptionBoundary(
+            [&]
+            {
+                FlushCoalescedColorFills();
+#if WINVER > _WIN32_WINNT_WINBLUE
+                FlushCoalescedBitmapDraws();
 #endif
             });
+
+        if (FAILED(hr))
+            return hr;
+
+        // Whoever gets the device context may change its state, so we can no
+        // longer trust the state we remember.
+        m_stateCache->Disable();
+
+        return ResourceWrapper::GetNativeResource(device, dpi, iid, resource);
     }
 
 
@@ -217,6 +359,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::Flush);
+
                 ThrowIfFailed(GetResource()->Flush(nullptr, nullptr));
             });
     }
@@ -425,6 +569,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {
         ICanvasDevice* m_canvasDevice;
         ID2D1DeviceContext1* m_deviceContext;
+        DrawingSessionProfiler* m_profiler;
         Vector2* m_offset;
         Rect* m_destinationRect;
         Rect* m_sourceRect;
@@ -436,9 +581,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ComPtr<ID2D1Image> m_borderEffectOutput;
 
     public:
-        DrawImageWorker(ICanvasDevice* canvasDevice, ID2D1DeviceContext1* deviceContext, Vector2* offset, Rect* destinationRect, Rect* sourceRect, float opacity, CanvasImageInterpolation interpolation)
+        DrawImageWorker(ICanvasDevice* canvasDevice, ID2D1DeviceContext1* deviceContext, DrawingSessionProfiler* profiler, Vector2* offset, Rect* destinationRect, Rect* sourceRect, float opacity, CanvasImageInterpolation interpolation)
             : m_canvasDevice(canvasDevice)
             , m_deviceContext(deviceContext)
+            , m_profiler(profiler)
             , m_offset(offset)
             , m_destinationRect(destinationRect)
             , m_sourceRect(sourceRect)
@@ -472,7 +618,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 // If DrawBitmap cannot handle this request, we must use the DrawImage slow path.
 
                 auto internalImage = As<ICanvasImageInternal>(image);
-                auto d2dImage = internalImage->GetD2DImage(m_canvasDevice, m_deviceContext);
+
+                ComPtr<ID2D1Image> d2dImage;
+                {
+                    auto profile = m_profiler->Profile(DrawingSessionCallFamily::EffectRealization);
+                    d2dImage = internalImage->GetD2DImage(m_canvasDevice, m_deviceContext);
+                }
 
                 auto d2dInterpolationMode = static_cast<D2D1_INTERPOLATION_MODE>(m_interpolation);
                 auto d2dCompositeMode = composite ? static_cast<D2D1_COMPOSITE_MODE>(*composite)
@@ -731,10 +882,33 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {
         return ExceptionBoundary([&]
         {
-            auto& deviceContext = GetResource();
+            auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawImage);
+
+            auto& deviceContext = ResourceWrapper::GetResource();
             CheckInPointer(image);
 
-            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), offset, destinationRect, sourceRect, opacity, interpolation).DrawImage(image, composite);
+            if (m_culler.IsEnabled() &&
+                IsBoundedComposite(deviceContext.Get(), composite) &&
+                !IsImageVisible(deviceContext.Get(), image, offset, destinationRect, sourceRect))
+            {
+                return;
+            }
+
+            FlushCoalescedColorFills();
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+            if (m_coalesceBitmapDraws)
+            {
+                auto bitmap = MaybeAs<ICanvasBitmap>(image);
+
+                if (bitmap && TryCoalesceBitmapDraw(deviceContext.Get(), bitmap.Get(), offset, destinationRect, sourceRect, opacity, interpolation, composite))
+                    return;
+            }
+
+            FlushCoalescedBitmapDraws();
+#endif
+
+            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), &m_profiler, offset, destinationRect, sourceRect, opacity, interpolation).DrawImage(image, composite);
         });
 
     }
@@ -750,13 +924,65 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {        
         return ExceptionBoundary([&]
         {
-            auto& deviceContext = GetResource();
+            auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawImage);
+
+            auto& deviceContext = ResourceWrapper::GetResource();
             CheckInPointer(bitmap);
 
-            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), offset, destinationRect, sourceRect, opacity, interpolation).DrawBitmap(bitmap, perspective);
+            // Perspective transforms can move the bitmap anywhere.
+            if (m_culler.IsEnabled() &&
+                !perspective &&
+                !IsImageVisible(deviceContext.Get(), As<ICanvasImage>(bitmap).Get(), offset, destinationRect, sourceRect))
+            {
+                return;
+            }
+
+            FlushCoalescedColorFills();
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+            if (!perspective && TryCoalesceBitmapDraw(deviceContext.Get(), bitmap, offset, destinationRect, sourceRect, opacity, interpolation, nullptr))
+                return;
+
+            FlushCoalescedBitmapDraws();
+#endif
+
+            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), &m_profiler, offset, destinationRect, sourceRect, opacity, interpolation).DrawBitmap(bitmap, perspective);
         });
     }
 
+    bool CanvasDrawingSession::IsImageVisible(
+        ID2D1DeviceContext1* deviceContext,
+        ICanvasImage* image,
+        Vector2 const* offset,
+        Rect const* destinationRect,
+        Rect const* sourceRect)
+    {
+        D2D1_RECT_F bounds;
+
+        if (destinationRect)
+        {
+            bounds = ToD2DRect(*destinationRect);
+        }
+        else if (sourceRect)
+        {
+            bounds = D2D1_RECT_F{ offset->X, offset->Y, offset->X + sourceRect->Width, offset->Y + sourceRect->Height };
+        }
+        else if (auto internalBitmap = MaybeAs<ICanvasBitmapInternal>(image))
+        {
+            auto size = GetBitmapSize(deviceContext->GetUnitMode(), internalBitmap->GetD2DBitmap().Get());
+
+            bounds = D2D1_RECT_F{ offset->X, offset->Y, offset->X + size.width, offset->Y + size.height };
+        }
+        else
+        {
+            // Working out the bounds of an effect graph costs more than
+            // culling would save.
+            return true;
+        }
+
+        return m_culler.IsVisible(deviceContext, bounds);
+    }
+
     //
     // DrawLine
     //
@@ -968,6 +1194,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float strokeWidth,
         ICanvasStrokeStyle* strokeStyle)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
@@ -1172,11 +1400,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float strokeWidth,
         ICanvasStrokeStyle* strokeStyle)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
         auto d2dRect = ToD2DRect(rect);
 
+        if (!m_culler.IsVisible(deviceContext.Get(), GetStrokeBounds(d2dRect, strokeWidth)))
+            return;
+
         deviceContext->DrawRectangle(
             &d2dRect,
             brush,
@@ -1216,6 +1449,114 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    //
+    // When CoalesceColorFills is enabled, opaque fills of simple shapes are
+    // collected into a geometry group rather than drawn immediately.  A group
+    // using the winding fill mode fills the union of its members, which only
+    // matches what separate fills would have drawn if every member winds the
+    // same way.  D2D rectangles, rounded rectangles and ellipses all do, as
+    // long as their sizes are not negative, so those are the only shapes that
+    // are coalesced.  These helpers return null for anything else.
+    //
+
+    static bool IsNormalized(D2D1_RECT_F const& rect)
+    {
+        return rect.right >= rect.left &&
+               rect.bottom >= rect.top;
+    }
+
+    static bool IsNormalized(D2D1_ROUNDED_RECT const& roundedRect)
+    {
+        return IsNormalized(roundedRect.rect) &&
+               roundedRect.radiusX >= 0 &&
+               roundedRect.radiusY >= 0;
+    }
+
+    static bool IsNormalized(D2D1_ELLIPSE const& ellipse)
+    {
+        return ellipse.radiusX >= 0 &&
+               ellipse.radiusY >= 0;
+    }
+
+    static ComPtr<ID2D1Geometry> CreateCoalescedFillGeometry(ID2D1Factory* factory, D2D1_RECT_F const& rect)
+    {
+        if (!IsNormalized(rect))
+            return nullptr;
+
+        ComPtr<ID2D1RectangleGeometry> geometry;
+        ThrowIfFailed(factory->CreateRectangleGeometry(&rect, &geometry));
+        return geometry;
+    }
+
+    static ComPtr<ID2D1Geometry> CreateCoalescedFillGeometry(ID2D1Factory* factory, D2D1_ROUNDED_RECT const& roundedRect)
+    {
+        if (!IsNormalized(roundedRect))
+            return nullptr;
+
+        ComPtr<ID2D1RoundedRectangleGeometry> geometry;
+        ThrowIfFailed(factory->CreateRoundedRectangleGeometry(&roundedRect, &geometry));
+        return geometry;
+    }
+
+    static ComPtr<ID2D1Geometry> CreateCoalescedFillGeometry(ID2D1Factory* factory, D2D1_ELLIPSE const& ellipse)
+    {
+        if (!IsNormalized(ellipse))
+            return nullptr;
+
+        ComPtr<ID2D1EllipseGeometry> geometry;
+        ThrowIfFailed(factory->CreateEllipseGeometry(&ellipse, &geometry));
+        return geometry;
+    }
+
+    static bool IsSimpleShape(ID2D1Geometry* geometry)
+    {
+        if (auto rectangleGeometry = MaybeAs<ID2D1RectangleGeometry>(geometry))
+        {
+            D2D1_RECT_F rect;
+            rectangleGeometry->GetRect(&rect);
+            return IsNormalized(rect);
+        }
+
+        if (auto roundedRectangleGeometry = MaybeAs<ID2D1RoundedRectangleGeometry>(geometry))
+        {
+            D2D1_ROUNDED_RECT roundedRect;
+            roundedRectangleGeometry->GetRoundedRect(&roundedRect);
+            return IsNormalized(roundedRect);
+        }
+
+        if (auto ellipseGeometry = MaybeAs<ID2D1EllipseGeometry>(geometry))
+        {
+            D2D1_ELLIPSE ellipse;
+            ellipseGeometry->GetEllipse(&ellipse);
+            return IsNormalized(ellipse);
+        }
+
+        return false;
+    }
+
+    static ComPtr<ID2D1Geometry> CreateCoalescedFillGeometry(ID2D1Factory* factory, ID2D1Geometry* geometry, Vector2 const& offset)
+    {
+        if (!IsSimpleShape(geometry))
+            return nullptr;
+
+        // Geometry groups can only contain geometries from the same factory.
+        ComPtr<ID2D1Factory> geometryFactory;
+        geometry->GetFactory(&geometryFactory);
+
+        if (geometryFactory.Get() != factory)
+            return nullptr;
+
+        if (offset.X == 0 && offset.Y == 0)
+            return geometry;
+
+        auto transform = D2D1::Matrix3x2F::Translation(offset.X, offset.Y);
+
+        ComPtr<ID2D1TransformedGeometry> transformedGeometry;
+        ThrowIfFailed(factory->CreateTransformedGeometry(geometry, &transform, &transformedGeometry));
+        return transformedGeometry;
+    }
+
+
     IFACEMETHODIMP CanvasDrawingSession::FillRectangleWithColor(
         Rect rect,
         Color color)
@@ -1223,6 +1564,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
+                auto& deviceContext = ResourceWrapper::GetResource();
+
+                if (!m_culler.IsVisible(deviceContext.Get(), ToD2DRect(rect)))
+                    return;
+
+                auto coalesced = TryCoalesceColorFill(deviceContext.Get(), color,
+                    [&] (ID2D1Factory* factory)
+                    {
+                        return CreateCoalescedFillGeometry(factory, ToD2DRect(rect));
+                    });
+
+                if (coalesced)
+                    return;
+
                 FillRectangleImpl(
                     rect,
                     GetColorBrush(color));
@@ -1247,11 +1604,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         Rect const& rect,
         ID2D1Brush* brush)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
         auto d2dRect = ToD2DRect(rect);
 
+        if (!m_culler.IsVisible(deviceContext.Get(), d2dRect))
+            return;
+
         deviceContext->FillRectangle(
             &d2dRect,
             brush);
@@ -1633,6 +1995,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float strokeWidth,
         ICanvasStrokeStyle* strokeStyle)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
@@ -1694,6 +2058,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
+                auto& deviceContext = ResourceWrapper::GetResource();
+
+                auto coalesced = TryCoalesceColorFill(deviceContext.Get(), color,
+                    [&] (ID2D1Factory* factory)
+                    {
+                        return CreateCoalescedFillGeometry(factory, ToD2DRoundedRect(rect, radiusX, radiusY));
+                    });
+
+                if (coalesced)
+                    return;
+
                 FillRoundedRectangleImpl(
                     rect, 
                     radiusX, 
@@ -1726,6 +2103,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float radiusY,
         ID2D1Brush* brush)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
@@ -1967,11 +2346,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float strokeWidth,
         ICanvasStrokeStyle* strokeStyle)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
         auto d2dEllipse = ToD2DEllipse(centerPoint, radiusX, radiusY);
 
+        if (!m_culler.IsVisible(deviceContext.Get(), GetStrokeBounds(GetEllipseBounds(d2dEllipse), strokeWidth)))
+            return;
+
         deviceContext->DrawEllipse(
             &d2dEllipse,
             brush,
@@ -2026,6 +2410,23 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
+                auto& deviceContext = ResourceWrapper::GetResource();
+                auto d2dEllipse = ToD2DEllipse(centerPoint, radiusX, radiusY);
+
+                if (!m_culler.IsVisible(deviceContext.Get(), GetEllipseBounds(d2dEllipse)))
+                    return;
+
+                auto coalesced = TryCoalesceColorFill(deviceContext.Get(), color,
+                    [&] (ID2D1Factory* factory)
+                    {
+                        return CreateCoalescedFillGeometry(factory, d2dEllipse);
+                    });
+
+                if (coalesced)
+                    return;
+
                 FillEllipseImpl(
                     centerPoint, 
                     radiusX, 
@@ -2056,11 +2457,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float radiusY,
         ID2D1Brush* brush)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(brush);
 
         auto d2dEllipse = ToD2DEllipse(centerPoint, radiusX, radiusY);
 
+        if (!m_culler.IsVisible(deviceContext.Get(), GetEllipseBounds(d2dEllipse)))
+            return;
+
         deviceContext->FillEllipse(
             &d2dEllipse,
             brush);
@@ -2500,12 +2906,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ID2D1Brush* brush,
         ICanvasTextFormat* format)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawText);
+
         if (!format)
             format = GetDefaultTextFormat();
 
         auto formatInternal = As<ICanvasTextFormatInternal>(format);
-        auto realizedFormat = formatInternal->GetRealizedTextFormat();
         auto drawTextOptions = formatInternal->GetDrawTextOptions();
+
+        if (TryDrawCachedTextLayout(text, rect, brush, format, false, drawTextOptions))
+            return;
+
+        auto realizedFormat = formatInternal->GetSharedTextFormat();
         
         DrawTextImpl(text, rect, brush, realizedFormat.Get(), drawTextOptions);
     }
@@ -2517,6 +2929,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ID2D1Brush* brush,
         ICanvasTextFormat* format)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawText);
+
         if (!format)
         {
             format = GetDefaultTextFormat();
@@ -2529,14 +2943,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         auto formatInternal = As<ICanvasTextFormatInternal>(format);
         auto drawTextOptions = formatInternal->GetDrawTextOptions();
 
+        if (TryDrawCachedTextLayout(text, rect, brush, format, true, drawTextOptions))
+            return;
+
         ComPtr<IDWriteTextFormat> realizedTextFormat;
         
         //
         // Drawing at a point only works if word wrapping is turned off.  We
         // don't want to modify the original format passed in (since DrawText is
         // conceptually a read-only operation and we want the same format to be
-        // usable across multiple threads).  Instead we create a temporary clone
-        // of the original with a different word wrapping setting.
+        // usable across multiple threads).  Instead we use a copy of the
+        // original with a different word wrapping setting.
         //
         
         CanvasWordWrapping wordWrapping;
@@ -2544,11 +2961,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         if (wordWrapping == CanvasWordWrapping::NoWrap)
         {
-            realizedTextFormat = formatInternal->GetRealizedTextFormat();
+            realizedTextFormat = formatInternal->GetSharedTextFormat();
         }
         else
         {
-            realizedTextFormat = formatInternal->GetRealizedTextFormatClone(CanvasWordWrapping::NoWrap);
+            realizedTextFormat = formatInternal->GetSharedTextFormatWithWordWrapping(CanvasWordWrapping::NoWrap);
         }
 
         DrawTextImpl(text, rect, brush, realizedTextFormat.Get(), drawTextOptions);
@@ -2575,6 +2992,58 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    bool CanvasDrawingSession::TryDrawCachedTextLayout(
+        HSTRING text,
+        Rect const& rect,
+        ID2D1Brush* brush,
+        ICanvasTextFormat* format,
+        bool noWrap,
+        D2D1_DRAW_TEXT_OPTIONS drawTextOptions)
+    {
+        auto& deviceContext = GetResource();
+        CheckInPointer(brush);
+
+        // Negative and NaN sizes are left for Direct2D to deal with.
+        if (!(rect.Width >= 0 && rect.Height >= 0))
+            return false;
+
+        auto formatInternal = As<ICanvasTextFormatInternal>(format);
+        auto formatVersion = formatInternal->GetVersion();
+
+        // Formats that may have been modified through interop can't be cached.
+        if (formatVersion == UncacheableTextFormatVersion)
+            return false;
+
+        auto textLayoutCache = As<ICanvasDeviceInternal>(GetDevice())->GetTextLayoutCache();
+
+        //
+        // Direct2D implements DrawText by creating a text layout that is the
+        // size of the rectangle and drawing it at the top left corner, so a
+        // cached layout built the same way draws identically.
+        //
+        auto textLayout = textLayoutCache->GetOrCreate(
+            text,
+            formatVersion,
+            rect.Width,
+            rect.Height,
+            noWrap,
+            [&] () -> ComPtr<IDWriteTextFormat>
+            {
+                if (noWrap)
+                    return formatInternal->GetSharedTextFormatWithWordWrapping(CanvasWordWrapping::NoWrap);
+                else
+                    return formatInternal->GetSharedTextFormat();
+            });
+
+        if (!textLayout)
+            return false;
+
+        deviceContext->DrawTextLayout(D2D1_POINT_2F{ rect.X, rect.Y }, textLayout.Get(), brush, drawTextOptions);
+
+        return true;
+    }
+
+
     ICanvasTextFormat* CanvasDrawingSession::GetDefaultTextFormat()
     {
         if (!m_defaultTextFormat)
@@ -2613,10 +3082,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawText);
+
                 auto& deviceContext = GetResource();
                 CheckInPointer(textLayout);
                 CheckInPointer(brush);
 
+                if (!IsTextLayoutVisible(deviceContext.Get(), textLayout, x, y))
+                    return;
+
                 CanvasDrawTextOptions drawTextOptions;
                 ThrowIfFailed(textLayout->get_Options(&drawTextOptions));
 
@@ -2651,9 +3125,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawText);
+
                 auto& deviceContext = GetResource();
                 CheckInPointer(textLayout);
 
+                if (!IsTextLayoutVisible(deviceContext.Get(), textLayout, x, y))
+                    return;
+
                 CanvasDrawTextOptions drawTextOptions;
                 ThrowIfFailed(textLayout->get_Options(&drawTextOptions));
 
@@ -2665,6 +3144,34 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+
+    bool CanvasDrawingSession::IsTextLayoutVisible(
+        ID2D1DeviceContext1* deviceContext,
+        ICanvasTextLayout* textLayout,
+        float x,
+        float y)
+    {
+        if (!m_culler.IsEnabled())
+            return true;
+
+        auto dwriteTextLayout = GetWrappedResource<IDWriteTextLayout>(textLayout);
+
+        // Overhangs are measured outwards from the layout box, so this covers
+        // all of the ink however the text is aligned within the box.
+        DWRITE_OVERHANG_METRICS overhang;
+        ThrowIfFailed(dwriteTextLayout->GetOverhangMetrics(&overhang));
+
+        D2D1_RECT_F bounds
+        {
+            x - overhang.left,
+            y - overhang.top,
+            x + dwriteTextLayout->GetMaxWidth() + overhang.right,
+            y + dwriteTextLayout->GetMaxHeight() + overhang.bottom
+        };
+
+        return m_culler.IsVisible(deviceContext, bounds);
+    }
+
     
     //
     // DrawGeometry
@@ -2961,6 +3468,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float strokeWidth,
         ICanvasStrokeStyle* strokeStyle)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(geometry);
         CheckInPointer(brush);
@@ -3024,6 +3533,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
+                auto& deviceContext = ResourceWrapper::GetResource();
+                CheckInPointer(geometry);
+
+                auto coalesced = TryCoalesceColorFill(deviceContext.Get(), color,
+                    [&] (ID2D1Factory* factory)
+                    {
+                        return CreateCoalescedFillGeometry(factory, GetWrappedResource<ID2D1Geometry>(geometry).Get(), offset);
+                    });
+
+                if (coalesced)
+                    return;
+
                 TemporaryTransform<ID2D1DeviceContext1> transform(GetResource().Get(), offset);
 
                 FillGeometryImpl(
@@ -3133,6 +3656,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ID2D1Brush* brush,
         ID2D1Brush* opacityBrush)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(geometry);
         CheckInPointer(brush);
@@ -3266,16 +3791,31 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ICanvasCachedGeometry* cachedGeometry,
         ID2D1Brush* brush)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
         auto& deviceContext = GetResource();
         CheckInPointer(cachedGeometry);
         CheckInPointer(brush);
 
-        deviceContext->DrawGeometryRealization(
-            GetWrappedResource<ID2D1GeometryRealization>(cachedGeometry).Get(),
-            brush);
-    }
+        if (m_culler.IsEnabled())
+        {
+            auto cachedGeometryInternal = MaybeAs<ICanvasCachedGeometryInternal>(cachedGeometry);
+            D2D1_RECT_F bounds;
 
-#if WINVER > _WIN32_WINNT_WINBLUE
+            if (cachedGeometryInternal &&
+                cachedGeometryInternal->TryGetBounds(&bounds) &&
+                !m_culler.IsVisible(deviceContext.Get(), bounds))
+            {
+                return;
+            }
+        }
+
+        deviceContext->DrawGeometryRealization(
+            GetWrappedResource<ID2D1GeometryRealization>(cachedGeometry).Get(),
+            brush);
+    }
+
+#if WINVER > _WIN32_WINNT_WINBLUE
     IFACEMETHODIMP CanvasDrawingSession::DrawInk(IIterable<InkStroke*>* inkStrokeCollection)
     {
         return ExceptionBoundary(
@@ -3380,11 +3920,30 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
 #endif
 
+    static bool IsSameColor(Color const& a, Color const& b)
+    {
+        return a.A == b.A &&
+               a.R == b.R &&
+               a.G == b.G &&
+               a.B == b.B;
+    }
+
+
     ID2D1SolidColorBrush* CanvasDrawingSession::GetColorBrush(Color const& color)
     {
+        // Pending fills use the shared brush, so must be drawn before its color changes.
+        FlushCoalescedColorFills();
+
         if (m_solidColorBrush)
         {
-            m_solidColorBrush->SetColor(ToD2DColor(color));
+            if (IsSameColor(color, m_solidColorBrushColor))
+            {
+                m_colorFillStatistics.SetColorCallsAvoided++;
+            }
+            else
+            {
+                m_solidColorBrush->SetColor(ToD2DColor(color));
+            }
         }
         else
         {
@@ -3392,6 +3951,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowIfFailed(deviceContext->CreateSolidColorBrush(ToD2DColor(color), &m_solidColorBrush));
         }
 
+        m_solidColorBrushColor = color;
+
         return m_solidColorBrush.Get();
     }
 
@@ -3415,7 +3976,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& deviceContext = GetResource();
                 CheckInPointer(value);
 
-                *value = static_cast<CanvasAntialiasing>(deviceContext->GetAntialiasMode());
+                auto d2dValue = deviceContext->GetAntialiasMode();
+                m_stateCache->OnAntialiasModeRead(d2dValue);
+
+                *value = static_cast<CanvasAntialiasing>(d2dValue);
             });
     }
 
@@ -3426,7 +3990,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             {
                 auto& deviceContext = GetResource();
 
-                deviceContext->SetAntialiasMode(static_cast<D2D1_ANTIALIAS_MODE>(value));
+                m_stateCache->SetAntialiasMode(deviceContext.Get(), static_cast<D2D1_ANTIALIAS_MODE>(value));
             });
     }
 
@@ -3438,7 +4002,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& deviceContext = GetResource();
                 CheckInPointer(value);
 
-                *value = static_cast<CanvasBlend>(deviceContext->GetPrimitiveBlend());
+                auto d2dValue = deviceContext->GetPrimitiveBlend();
+                m_stateCache->OnPrimitiveBlendRead(d2dValue);
+
+                *value = static_cast<CanvasBlend>(d2dValue);
             });
     }
 
@@ -3449,7 +4016,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             {
                 auto& deviceContext = GetResource();
 
-                deviceContext->SetPrimitiveBlend(static_cast<D2D1_PRIMITIVE_BLEND>(value));
+                m_stateCache->SetPrimitiveBlend(deviceContext.Get(), static_cast<D2D1_PRIMITIVE_BLEND>(value));
             });
     }
 
@@ -3461,7 +4028,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& deviceContext = GetResource();
                 CheckInPointer(value);
 
-                *value = static_cast<CanvasTextAntialiasing>(deviceContext->GetTextAntialiasMode());
+                auto d2dValue = deviceContext->GetTextAntialiasMode();
+                m_stateCache->OnTextAntialiasModeRead(d2dValue);
+
+                *value = static_cast<CanvasTextAntialiasing>(d2dValue);
             });
     }
 
@@ -3472,7 +4042,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             {
                 auto& deviceContext = GetResource();
 
-                deviceContext->SetTextAntialiasMode(static_cast<D2D1_TEXT_ANTIALIAS_MODE>(value));
+                m_stateCache->SetTextAntialiasMode(deviceContext.Get(), static_cast<D2D1_TEXT_ANTIALIAS_MODE>(value));
             });
     }
 
@@ -3546,10 +4116,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     // Gets the current transform from the given device context, stripping out
     // the current offset
     //
-    static Matrix3x2 GetTransform(ID2D1DeviceContext1* deviceContext, D2D1_POINT_2F const& offset)
+    static Matrix3x2 GetTransform(ID2D1DeviceContext1* deviceContext, DeviceContextStateCache& stateCache, D2D1_POINT_2F const& offset)
     {
         D2D1_MATRIX_3X2_F transform;
         deviceContext->GetTransform(&transform);
+        stateCache.OnTransformRead(transform);
 
         // We assume that the currently set transform has the offset applied to
         // it, correctly set for the current unit mode.  We need to subtract
@@ -3564,7 +4135,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     //
     // Sets the transform on the given device context, applied the offset.
     //
-    static void SetTransform(ID2D1DeviceContext1* deviceContext, D2D1_POINT_2F const& offset, Matrix3x2 const& matrix)
+    static void SetTransform(ID2D1DeviceContext1* deviceContext, DeviceContextStateCache& stateCache, D2D1_POINT_2F const& offset, Matrix3x2 const& matrix)
     {
         auto adjustedOffset = GetOffsetInCorrectUnits(deviceContext, offset);
 
@@ -3572,7 +4143,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         transform._31 += adjustedOffset.x;
         transform._32 += adjustedOffset.y;
 
-        deviceContext->SetTransform(transform);
+        stateCache.SetTransform(deviceContext, transform);
     }
 
     IFACEMETHODIMP CanvasDrawingSession::get_Transform(ABI::Microsoft::Graphics::Canvas::Numerics::Matrix3x2* value)
@@ -3583,7 +4154,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& deviceContext = GetResource();
                 CheckInPointer(value);
 
-                *value = GetTransform(deviceContext.Get(), m_offset);
+                *value = GetTransform(deviceContext.Get(), *m_stateCache, m_offset);
             });
     }
 
@@ -3594,7 +4165,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             {
                 auto& deviceContext = GetResource();
 
-                SetTransform(deviceContext.Get(), m_offset, value);
+                SetTransform(deviceContext.Get(), *m_stateCache, m_offset, value);
             });
     }
 
@@ -3606,7 +4177,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& deviceContext = GetResource();
                 CheckInPointer(value);
 
-                *value = static_cast<CanvasUnits>(deviceContext->GetUnitMode());
+                auto unitMode = deviceContext->GetUnitMode();
+                m_stateCache->OnUnitModeRead(unitMode);
+
+                *value = static_cast<CanvasUnits>(unitMode);
             });
     }
 
@@ -3616,16 +4190,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             [&]
             {
                 auto& deviceContext = GetResource();
+                auto unitMode = static_cast<D2D1_UNIT_MODE>(value);
+
+                if (m_stateCache->IsUnitModeAlready(unitMode))
+                    return;
 
                 if (m_offset.x != 0 || m_offset.y != 0)
                 {
-                    auto transform = GetTransform(deviceContext.Get(), m_offset);
-                    deviceContext->SetUnitMode(static_cast<D2D1_UNIT_MODE>(value));
-                    SetTransform(deviceContext.Get(), m_offset, transform);
+                    auto transform = GetTransform(deviceContext.Get(), *m_stateCache, m_offset);
+                    m_stateCache->SetUnitMode(deviceContext.Get(), unitMode);
+                    SetTransform(deviceContext.Get(), *m_stateCache, m_offset, transform);
                 }
                 else
                 {
-                    deviceContext->SetUnitMode(static_cast<D2D1_UNIT_MODE>(value));
+                    m_stateCache->SetUnitMode(deviceContext.Get(), unitMode);
                 }
             });
     }
@@ -3932,6 +4510,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return ExceptionBoundary(
             [&]
             {
+                auto profile = m_profiler.Profile(DrawingSessionCallFamily::DrawText);
+
                 auto& deviceContext = GetResource();
 
                 CheckInPointer(fontFace);
@@ -3965,6 +4545,656 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+
+    //
+    // Batched primitives
+    //
+    // Consecutive primitives that share an opaque color are added to a single
+    // path geometry, so they cost one Direct2D draw call however many of them
+    // there are.  Translucent primitives are drawn one at a time, because
+    // combining them would stop overlapping primitives from blending with
+    // each other.  The same goes for any primitive blend other than
+    // SourceOver, where an opaque primitive drawn over another does not
+    // simply replace it.  Every figure uses the same winding direction, so
+    // overlapping figures in the same geometry fill as their union.
+    //
+
+    template<typename ADD_FIGURE, typename DRAW_PRIMITIVE, typename DRAW_GEOMETRY>
+    void CanvasDrawingSession::DrawPrimitiveBatch(
+        uint32_t primitiveCount,
+        BroadcastArray<Color> const& colors,
+        ADD_FIGURE const& addFigure,
+        DRAW_PRIMITIVE const& drawPrimitive,
+        DRAW_GEOMETRY const& drawGeometry)
+    {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Geometry);
+
+        auto& deviceContext = GetResource();
+
+        bool canMergeOpaqueRuns = (deviceContext->GetPrimitiveBlend() == D2D1_PRIMITIVE_BLEND_SOURCE_OVER);
+
+        uint32_t runStart = 0;
+
+        while (runStart < primitiveCount)
+        {
+            auto& color = colors[runStart];
+
+            uint32_t runEnd = runStart + 1;
+
+            if (colors.IsShared())
+            {
+                runEnd = primitiveCount;
+            }
+            else
+            {
+                while (runEnd < primitiveCount && IsSameColor(colors[runEnd], color))
+                    ++runEnd;
+            }
+
+            auto brush = GetColorBrush(color);
+
+            if (canMergeOpaqueRuns && color.A == 255 && runEnd - runStart > 1)
+            {
+                auto pathGeometry = As<ICanvasDeviceInternal>(GetDevice())->CreatePathGeometry();
+
+                ComPtr<ID2D1GeometrySink> sink;
+                ThrowIfFailed(pathGeometry->Open(&sink));
+
+                sink->SetFillMode(D2D1_FILL_MODE_WINDING);
+
+                for (uint32_t i = runStart; i < runEnd; ++i)
+                {
+                    addFigure(sink.Get(), i);
+                }
+
+                ThrowIfFailed(sink->Close());
+
+                drawGeometry(deviceContext.Get(), pathGeometry.Get(), brush);
+            }
+            else
+            {
+                for (uint32_t i = runStart; i < runEnd; ++i)
+                {
+                    drawPrimitive(deviceContext.Get(), brush, i);
+                }
+            }
+
+            runStart = runEnd;
+        }
+    }
+
+
+    static void AddRectangleFigure(ID2D1GeometrySink* sink, D2D1_RECT_F const& rect, D2D1_FIGURE_BEGIN figureBegin)
+    {
+        // Normalize so that every figure winds the same way.
+        auto left   = std::min(rect.left, rect.right);
+        auto right  = std::max(rect.left, rect.right);
+        auto top    = std::min(rect.top, rect.bottom);
+        auto bottom = std::max(rect.top, rect.bottom);
+
+        D2D1_POINT_2F points[] =
+        {
+            D2D1_POINT_2F{ right, top },
+            D2D1_POINT_2F{ right, bottom },
+            D2D1_POINT_2F{ left,  bottom },
+        };
+
+        sink->BeginFigure(D2D1_POINT_2F{ left, top }, figureBegin);
+        sink->AddLines(points, _countof(points));
+        sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+    }
+
+
+    static void AddArc(ID2D1GeometrySink* sink, float x, float y, float radiusX, float radiusY)
+    {
+        D2D1_ARC_SEGMENT arc
+        {
+            D2D1_POINT_2F{ x, y },
+            D2D1_SIZE_F{ radiusX, radiusY },
+            0.0f,
+            D2D1_SWEEP_DIRECTION_CLOCKWISE,
+            D2D1_ARC_SIZE_SMALL
+        };
+
+        sink->AddArc(&arc);
+    }
+
+
+    static void AddEllipseFigure(ID2D1GeometrySink* sink, Vector2 const& center, float radiusX, float radiusY)
+    {
+        radiusX = fabs(radiusX);
+        radiusY = fabs(radiusY);
+
+        sink->BeginFigure(D2D1_POINT_2F{ center.X - radiusX, center.Y }, D2D1_FIGURE_BEGIN_FILLED);
+        AddArc(sink, center.X + radiusX, center.Y, radiusX, radiusY);
+        AddArc(sink, center.X - radiusX, center.Y, radiusX, radiusY);
+        sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+    }
+
+
+    static void AddRoundedRectangleFigure(ID2D1GeometrySink* sink, D2D1_RECT_F const& rect, float radiusX, float radiusY)
+    {
+        auto left   = std::min(rect.left, rect.right);
+        auto right  = std::max(rect.left, rect.right);
+        auto top    = std::min(rect.top, rect.bottom);
+        auto bottom = std::max(rect.top, rect.bottom);
+
+        // Like ID2D1DeviceContext::FillRoundedRectangle, radii are limited to
+        // half the size of the rectangle.
+        auto rx = std::min(fabs(radiusX), (right - left) / 2);
+        auto ry = std::min(fabs(radiusY), (bottom - top) / 2);
+
+        sink->BeginFigure(D2D1_POINT_2F{ left + rx, top }, D2D1_FIGURE_BEGIN_FILLED);
+        sink->AddLine(D2D1_POINT_2F{ right - rx, top });
+        AddArc(sink, right, top + ry, rx, ry);
+        sink->AddLine(D2D1_POINT_2F{ right, bottom - ry });
+        AddArc(sink, right - rx, bottom, rx, ry);
+        sink->AddLine(D2D1_POINT_2F{ left + rx, bottom });
+        AddArc(sink, left, bottom - ry, rx, ry);
+        sink->AddLine(D2D1_POINT_2F{ left, top + ry });
+        AddArc(sink, left + rx, top, rx, ry);
+        sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+    }
+
+
+    static void FillBatchGeometry(ID2D1DeviceContext1* deviceContext, ID2D1Geometry* geometry, ID2D1Brush* brush)
+    {
+        deviceContext->FillGeometry(geometry, brush);
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::FillRectangles(
+        uint32_t rectCount,
+        Rect* rects,
+        uint32_t colorCount,
+        Color* colors)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(rectCount, rects);
+
+                if (rectCount == 0)
+                    return;
+
+                BroadcastArray<Color> colorArray(L"colors", rectCount, colorCount, colors);
+
+                DrawPrimitiveBatch(
+                    rectCount,
+                    colorArray,
+                    [=] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        AddRectangleFigure(sink, ToD2DRect(rects[i]), D2D1_FIGURE_BEGIN_FILLED);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        auto d2dRect = ToD2DRect(rects[i]);
+                        deviceContext->FillRectangle(&d2dRect, brush);
+                    },
+                    FillBatchGeometry);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::DrawRectangles(
+        uint32_t rectCount,
+        Rect* rects,
+        uint32_t colorCount,
+        Color* colors,
+        float strokeWidth)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(rectCount, rects);
+
+                if (rectCount == 0)
+                    return;
+
+                BroadcastArray<Color> colorArray(L"colors", rectCount, colorCount, colors);
+
+                DrawPrimitiveBatch(
+                    rectCount,
+                    colorArray,
+                    [=] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        AddRectangleFigure(sink, ToD2DRect(rects[i]), D2D1_FIGURE_BEGIN_HOLLOW);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        auto d2dRect = ToD2DRect(rects[i]);
+                        deviceContext->DrawRectangle(&d2dRect, brush, strokeWidth);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Geometry* geometry, ID2D1Brush* brush)
+                    {
+                        deviceContext->DrawGeometry(geometry, brush, strokeWidth);
+                    });
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::FillRoundedRectangles(
+        uint32_t rectCount,
+        Rect* rects,
+        float radiusX,
+        float radiusY,
+        uint32_t colorCount,
+        Color* colors)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(rectCount, rects);
+
+                if (rectCount == 0)
+                    return;
+
+                BroadcastArray<Color> colorArray(L"colors", rectCount, colorCount, colors);
+
+                DrawPrimitiveBatch(
+                    rectCount,
+                    colorArray,
+                    [=] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        AddRoundedRectangleFigure(sink, ToD2DRect(rects[i]), radiusX, radiusY);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        auto d2dRoundedRect = ToD2DRoundedRect(rects[i], radiusX, radiusY);
+                        deviceContext->FillRoundedRectangle(&d2dRoundedRect, brush);
+                    },
+                    FillBatchGeometry);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::FillEllipses(
+        uint32_t centerPointCount,
+        Vector2* centerPoints,
+        uint32_t radiusCount,
+        Vector2* radii,
+        uint32_t colorCount,
+        Color* colors)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(centerPointCount, centerPoints);
+
+                if (centerPointCount == 0)
+                    return;
+
+                BroadcastArray<Vector2> radiusArray(L"radii", centerPointCount, radiusCount, radii);
+                BroadcastArray<Color> colorArray(L"colors", centerPointCount, colorCount, colors);
+
+                DrawPrimitiveBatch(
+                    centerPointCount,
+                    colorArray,
+                    [&] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        AddEllipseFigure(sink, centerPoints[i], radiusArray[i].X, radiusArray[i].Y);
+                    },
+                    [&] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        auto d2dEllipse = ToD2DEllipse(centerPoints[i], radiusArray[i].X, radiusArray[i].Y);
+                        deviceContext->FillEllipse(&d2dEllipse, brush);
+                    },
+                    FillBatchGeometry);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::FillCircles(
+        uint32_t centerPointCount,
+        Vector2* centerPoints,
+        uint32_t radiusCount,
+        float* radii,
+        uint32_t colorCount,
+        Color* colors)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(centerPointCount, centerPoints);
+
+                if (centerPointCount == 0)
+                    return;
+
+                BroadcastArray<float> radiusArray(L"radii", centerPointCount, radiusCount, radii);
+                BroadcastArray<Color> colorArray(L"colors", centerPointCount, colorCount, colors);
+
+                DrawPrimitiveBatch(
+                    centerPointCount,
+                    colorArray,
+                    [&] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        AddEllipseFigure(sink, centerPoints[i], radiusArray[i], radiusArray[i]);
+                    },
+                    [&] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        auto d2dEllipse = ToD2DEllipse(centerPoints[i], radiusArray[i], radiusArray[i]);
+                        deviceContext->FillEllipse(&d2dEllipse, brush);
+                    },
+                    FillBatchGeometry);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::DrawLines(
+        uint32_t pointCount,
+        Vector2* points,
+        uint32_t colorCount,
+        Color* colors,
+        float strokeWidth)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(pointCount, points);
+
+                if (pointCount % 2 != 0)
+                    ThrowHR(E_INVALIDARG, Strings::DrawLinesOddPointCount);
+
+                auto lineCount = pointCount / 2;
+
+                if (lineCount == 0)
+                    return;
+
+                BroadcastArray<Color> colorArray(L"colors", lineCount, colorCount, colors);
+
+                DrawPrimitiveBatch(
+                    lineCount,
+                    colorArray,
+                    [=] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        sink->BeginFigure(ToD2DPoint(points[i * 2]), D2D1_FIGURE_BEGIN_HOLLOW);
+                        sink->AddLine(ToD2DPoint(points[i * 2 + 1]));
+                        sink->EndFigure(D2D1_FIGURE_END_OPEN);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        deviceContext->DrawLine(ToD2DPoint(points[i * 2]), ToD2DPoint(points[i * 2 + 1]), brush, strokeWidth);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Geometry* geometry, ID2D1Brush* brush)
+                    {
+                        deviceContext->DrawGeometry(geometry, brush, strokeWidth);
+                    });
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::DrawPoints(
+        uint32_t pointCount,
+        Vector2* points,
+        uint32_t colorCount,
+        Color* colors,
+        float size)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckArray(pointCount, points);
+
+                if (pointCount == 0)
+                    return;
+
+                BroadcastArray<Color> colorArray(L"colors", pointCount, colorCount, colors);
+
+                auto halfSize = size / 2;
+
+                auto toD2DRect = [=] (uint32_t i)
+                {
+                    auto& point = points[i];
+                    return D2D1_RECT_F{ point.X - halfSize, point.Y - halfSize, point.X + halfSize, point.Y + halfSize };
+                };
+
+                DrawPrimitiveBatch(
+                    pointCount,
+                    colorArray,
+                    [=] (ID2D1GeometrySink* sink, uint32_t i)
+                    {
+                        AddRectangleFigure(sink, toD2DRect(i), D2D1_FIGURE_BEGIN_FILLED);
+                    },
+                    [=] (ID2D1DeviceContext1* deviceContext, ID2D1Brush* brush, uint32_t i)
+                    {
+                        auto d2dRect = toD2DRect(i);
+                        deviceContext->FillRectangle(&d2dRect, brush);
+                    },
+                    FillBatchGeometry);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_CoalesceColorFills(
+        boolean* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            ResourceWrapper::GetResource();
+            CheckInPointer(value);
+
+            *value = m_coalesceColorFills;
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::put_CoalesceColorFills(
+        boolean value)
+    {
+        return ExceptionBoundary([&]
+        {
+            GetResource();
+
+            m_coalesceColorFills = !!value;
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_ColorFillStatistics(
+        CanvasColorFillStatistics* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckInPointer(value);
+
+            // Statistics stay readable after the session is closed.
+            *value = m_colorFillStatistics;
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_CollectStatistics(
+        boolean* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            ResourceWrapper::GetResource();
+            CheckInPointer(value);
+
+            *value = m_profiler.IsEnabled();
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::put_CollectStatistics(
+        boolean value)
+    {
+        return ExceptionBoundary([&]
+        {
+            ResourceWrapper::GetResource();
+
+            m_profiler.SetEnabled(!!value);
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_Statistics(
+        CanvasDrawingSessionStatistics* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckInPointer(value);
+
+            // Statistics stay readable after the session is closed.
+            *value = m_profiler.GetStatistics();
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_StateChangeStatistics(
+        CanvasStateChangeStatistics* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckInPointer(value);
+
+            // Statistics stay readable after the session is closed.
+            *value = m_stateCache->GetStatistics();
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_CullInvisibleDraws(
+        boolean* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            ResourceWrapper::GetResource();
+            CheckInPointer(value);
+
+            *value = m_culler.IsEnabled();
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::put_CullInvisibleDraws(
+        boolean value)
+    {
+        return ExceptionBoundary([&]
+        {
+            auto& deviceContext = ResourceWrapper::GetResource();
+
+            if (value)
+                m_culler.Enable(deviceContext.Get());
+            else
+                m_culler.Disable();
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_CulledDrawCount(
+        uint32_t* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckInPointer(value);
+
+            // Statistics stay readable after the session is closed.
+            *value = m_culler.GetCulledDrawCount();
+        });
+    }
+
+
+    //
+    // Adds a fill to the pending geometry group, if it is drawn with an opaque
+    // color and the SourceOver blend, and createGeometry can represent it.
+    //
+    // Returns false if the fill was not coalesced, in which case the caller
+    // draws it normally.  Getting the color brush to do that flushes any
+    // pending fills first.
+    //
+    template<typename CREATE_GEOMETRY>
+    bool CanvasDrawingSession::TryCoalesceColorFill(
+        ID2D1DeviceContext1* deviceContext,
+        Color const& color,
+        CREATE_GEOMETRY const& createGeometry)
+    {
+        if (!m_coalesceColorFills)
+            return false;
+
+        // Overlapping translucent fills must blend with each other, so cannot
+        // be drawn as a union.
+        if (color.A != 255)
+            return false;
+
+        if (deviceContext->GetPrimitiveBlend() != D2D1_PRIMITIVE_BLEND_SOURCE_OVER)
+            return false;
+
+        ComPtr<ID2D1Factory> factory;
+        deviceContext->GetFactory(&factory);
+
+        auto geometry = createGeometry(factory.Get());
+
+        if (!geometry)
+            return false;
+
+        if (!m_coalescedFills.empty() && !IsSameColor(color, m_coalescedFillColor))
+            FlushCoalescedColorFills();
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+        FlushCoalescedBitmapDraws();
+#endif
+
+        m_coalescedFills.push_back(std::move(geometry));
+        m_coalescedFillColor = color;
+        m_colorFillStatistics.CoalescedFillCount++;
+
+        return true;
+    }
+
+
+    void CanvasDrawingSession::FlushCoalescedColorFills()
+    {
+        if (m_coalescedFills.empty())
+            return;
+
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Flush);
+
+        // Take the pending fills first, so drawing them does not recurse back
+        // here, and a failure does not leave them behind.
+        auto fills = std::move(m_coalescedFills);
+        m_coalescedFills.clear();
+
+        auto& deviceContext = ResourceWrapper::GetResource();
+        auto brush = GetColorBrush(m_coalescedFillColor);
+
+        if (fills.size() == 1)
+        {
+            deviceContext->FillGeometry(fills[0].Get(), brush);
+            return;
+        }
+
+        std::vector<ID2D1Geometry*> geometries;
+        geometries.reserve(fills.size());
+
+        for (auto& fill : fills)
+        {
+            geometries.push_back(fill.Get());
+        }
+
+        ComPtr<ID2D1Factory> factory;
+        deviceContext->GetFactory(&factory);
+
+        ComPtr<ID2D1GeometryGroup> geometryGroup;
+        ThrowIfFailed(factory->CreateGeometryGroup(
+            D2D1_FILL_MODE_WINDING,
+            geometries.data(),
+            static_cast<uint32_t>(geometries.size()),
+            &geometryGroup));
+
+        deviceContext->FillGeometry(geometryGroup.Get(), brush);
+
+        m_colorFillStatistics.FillCallsAvoided += static_cast<uint32_t>(fills.size() - 1);
+    }
+
+
     // Returns true if the current transform matrix contains only scaling and translation, but no rotation or skew.
     static bool TransformIsAxisPreserving(ID2D1DeviceContext* deviceContext)
     {
@@ -3976,6 +5206,70 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                transform._21 == 0.0f;
     }
 
+    //
+    // Works out roughly how much of the target a layer covers, for choosing
+    // which pooled layer to use.  This is only a size hint, so the units mode
+    // is ignored: Direct2D grows the layer if it turns out to be too small.
+    //
+    static D2D1_RECT_F GetLayerContentBounds(
+        ID2D1DeviceContext* deviceContext,
+        D2D1_RECT_F const* clipRectangle,
+        ID2D1Geometry* clipGeometry,
+        D2D1_MATRIX_3X2_F const& geometryTransform)
+    {
+        D2D1::Matrix3x2F transform;
+        deviceContext->GetTransform(&transform);
+
+        auto targetSize = deviceContext->GetSize();
+        auto bounds = D2D1::InfiniteRect();
+
+        if (targetSize.width > 0 && targetSize.height > 0)
+            bounds = D2D1::RectF(0, 0, targetSize.width, targetSize.height);
+
+        auto intersect = [&] (D2D1_RECT_F const& rect)
+        {
+            bounds.left   = std::max(bounds.left,   rect.left);
+            bounds.top    = std::max(bounds.top,    rect.top);
+            bounds.right  = std::min(bounds.right,  rect.right);
+            bounds.bottom = std::min(bounds.bottom, rect.bottom);
+        };
+
+        if (clipRectangle)
+        {
+            D2D1_POINT_2F corners[] =
+            {
+                transform.TransformPoint(D2D1::Point2F(clipRectangle->left,  clipRectangle->top)),
+                transform.TransformPoint(D2D1::Point2F(clipRectangle->right, clipRectangle->top)),
+                transform.TransformPoint(D2D1::Point2F(clipRectangle->left,  clipRectangle->bottom)),
+                transform.TransformPoint(D2D1::Point2F(clipRectangle->right, clipRectangle->bottom)),
+            };
+
+            D2D1_RECT_F rect{ corners[0].x, corners[0].y, corners[0].x, corners[0].y };
+
+            for (auto& corner : corners)
+            {
+                rect.left   = std::min(rect.left,   corner.x);
+                rect.top    = std::min(rect.top,    corner.y);
+                rect.right  = std::max(rect.right,  corner.x);
+                rect.bottom = std::max(rect.bottom, corner.y);
+            }
+
+            intersect(rect);
+        }
+
+        if (clipGeometry)
+        {
+            auto geometryToTarget = *D2D1::Matrix3x2F::ReinterpretBaseType(&geometryTransform) * transform;
+
+            D2D1_RECT_F rect;
+            ThrowIfFailed(clipGeometry->GetBounds(&geometryToTarget, &rect));
+
+            intersect(rect);
+        }
+
+        return bounds;
+    }
+
     HRESULT CanvasDrawingSession::CreateLayerImpl(
         float opacity,
         ICanvasBrush* opacityBrush,
@@ -3985,6 +5279,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         CanvasLayerOptions options,
         ICanvasActiveLayer** layer)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Layer);
+
         return ExceptionBoundary(
             [&]
             {
@@ -4019,6 +5315,24 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 // interop boundary and then pop from the other, which is what would 
                 // break this tracking were it possible.
 
+                // When the device's layer pool is enabled, reuse an idle
+                // layer rather than letting Direct2D allocate a new one.
+                ComPtr<ID2D1Layer> pooledLayer;
+                LayerPoolBucket pooledLayerBucket{};
+
+                if (!isAxisAlignedClip)
+                {
+                    auto layerPool = As<ICanvasDeviceInternal>(GetDevice())->GetLayerPool();
+
+                    if (layerPool->IsEnabled())
+                    {
+                        auto contentBounds = GetLayerContentBounds(deviceContext.Get(), clipRectangle ? &d2dRect : nullptr, d2dGeometry.Get(), d2dMatrix);
+
+                        if (LayerPool::TryGetBucket(contentBounds, &pooledLayerBucket))
+                            pooledLayer = layerPool->Acquire(deviceContext.Get(), pooledLayerBucket);
+                    }
+                }
+
                 int layerId = ++m_nextLayerId;
 
                 m_activeLayerIds.push_back(layerId);
@@ -4027,17 +5341,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 WeakRef weakSelf = AsWeak(this);
 
                 auto activeLayer = Make<CanvasActiveLayer>(
-                    [weakSelf, layerId, isAxisAlignedClip]() mutable
+                    [weakSelf, layerId, isAxisAlignedClip, pooledLayerBucket, pooledLayer]() mutable
                     {
                         auto strongSelf = LockWeakRef<ICanvasDrawingSession>(weakSelf);
                         auto self = static_cast<CanvasDrawingSession*>(strongSelf.Get());
 
                         if (self)
-                            self->PopLayer(layerId, isAxisAlignedClip);
+                            self->PopLayer(layerId, isAxisAlignedClip, pooledLayerBucket, std::move(pooledLayer));
                     });
 
                 CheckMakeResult(activeLayer);
 
+                // Only track the clip once nothing else can fail, so the culler
+                // stays in step with the layers that are actually pushed.
+                m_culler.PushClip(deviceContext.Get(), clipRectangle ? &d2dRect : nullptr, d2dGeometry.Get(), d2dMatrix);
+
                 if (isAxisAlignedClip)
                 {
                     // Tell D2D to push an axis aligned clip region.
@@ -4057,15 +5375,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                         static_cast<D2D1_LAYER_OPTIONS1>(options)
                     };
 
-                    deviceContext->PushLayer(&parameters, nullptr);
+                    deviceContext->PushLayer(&parameters, pooledLayer.Get());
                 }
 
                 ThrowIfFailed(activeLayer.CopyTo(layer));
             });
     }
 
-    void CanvasDrawingSession::PopLayer(int layerId, bool isAxisAlignedClip)
+    void CanvasDrawingSession::PopLayer(int layerId, bool isAxisAlignedClip, LayerPoolBucket const& pooledLayerBucket, ComPtr<ID2D1Layer>&& pooledLayer)
     {
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Layer);
+
         auto& deviceContext = GetResource();
 
         assert(!m_activeLayerIds.empty());
@@ -4074,6 +5394,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowHR(E_FAIL, Strings::PoppedWrongLayer);
 
         m_activeLayerIds.pop_back();
+        m_culler.PopClip();
 
         if (isAxisAlignedClip)
         {
@@ -4082,6 +5403,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         else
         {
             deviceContext->PopLayer();
+
+            // Once popped, the layer can be pushed again.
+            if (pooledLayer)
+                As<ICanvasDeviceInternal>(GetDevice())->GetLayerPool()->Release(pooledLayerBucket, std::move(pooledLayer));
         }
     }
 
@@ -4162,12 +5487,220 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 deviceContext3,
                 sortMode,
                 static_cast<D2D1_BITMAP_INTERPOLATION_MODE>(interpolation),
-                static_cast<D2D1_SPRITE_OPTIONS>(options));
+                static_cast<D2D1_SPRITE_OPTIONS>(options),
+                m_stateCache);
             CheckMakeResult(newSpriteBatch);
 
             ThrowIfFailed(newSpriteBatch.CopyTo(spriteBatch));
         });
     }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::get_CoalesceBitmapDraws(
+        boolean* value)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckInPointer(value);
+            ResourceWrapper::GetResource();
+
+            *value = m_coalesceBitmapDraws;
+        });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::put_CoalesceBitmapDraws(
+        boolean value)
+    {
+        return ExceptionBoundary([&]
+        {
+            GetResource();
+
+            m_coalesceBitmapDraws = !!value;
+        });
+    }
+
+
+    static bool IsWholeNumber(float value)
+    {
+        return value == std::round(value);
+    }
+
+
+    //
+    // Sprites are drawn aliased, whereas DrawBitmap antialiases any edge that
+    // does not fall exactly on a pixel boundary.  They only match if the
+    // session is already aliased, or if the destination maps to whole device
+    // pixels through a transform with no rotation or skew.
+    //
+    static bool IsDrawnIdenticallyWhenAliased(ID2D1DeviceContext1* deviceContext, Rect const& destRect)
+    {
+        if (deviceContext->GetAntialiasMode() == D2D1_ANTIALIAS_MODE_ALIASED)
+            return true;
+
+        D2D1_MATRIX_3X2_F transform;
+        deviceContext->GetTransform(&transform);
+
+        if (transform._12 != 0 || transform._21 != 0)
+            return false;
+
+        float scale = 1;
+
+        if (deviceContext->GetUnitMode() == D2D1_UNIT_MODE_DIPS)
+        {
+            float dpiX, dpiY;
+            deviceContext->GetDpi(&dpiX, &dpiY);
+            scale = dpiX / DEFAULT_DPI;
+
+            if (dpiY != dpiX)
+                return false;
+        }
+
+        auto toPixelsX = [&](float x) { return (transform._11 * x + transform._31) * scale; };
+        auto toPixelsY = [&](float y) { return (transform._22 * y + transform._32) * scale; };
+
+        return IsWholeNumber(toPixelsX(destRect.X)) &&
+               IsWholeNumber(toPixelsX(destRect.X + destRect.Width)) &&
+               IsWholeNumber(toPixelsY(destRect.Y)) &&
+               IsWholeNumber(toPixelsY(destRect.Y + destRect.Height));
+    }
+
+
+    //
+    // Bitmaps drawn with simple enough options can be added to a sprite batch
+    // rather than drawn immediately.  This only works if the sprite batch draws
+    // exactly what DrawBitmap would have done, so anything that a sprite
+    // cannot represent (effects, perspective, other blend modes, high quality
+    // interpolation, source rectangles outside the bitmap or not on whole
+    // pixels, antialiased edges) is drawn normally.
+    //
+    // Returns false if the draw was not coalesced, in which case the caller
+    // must flush any previously coalesced draws before drawing it.
+    //
+    bool CanvasDrawingSession::TryCoalesceBitmapDraw(
+        ID2D1DeviceContext1* deviceContext,
+        ICanvasBitmap* bitmap,
+        Vector2* offset,
+        Rect* destinationRect,
+        Rect* sourceRect,
+        float opacity,
+        CanvasImageInterpolation interpolation,
+        CanvasComposite const* composite)
+    {
+        if (!m_coalesceBitmapDraws)
+            return false;
+
+        if (interpolation != CanvasImageInterpolation::Linear &&
+            interpolation != CanvasImageInterpolation::NearestNeighbor)
+            return false;
+
+        if (composite && *composite != CanvasComposite::SourceOver)
+            return false;
+
+        if (!(opacity >= 0 && opacity <= 1))
+            return false;
+
+        if (deviceContext->GetPrimitiveBlend() != D2D1_PRIMITIVE_BLEND_SOURCE_OVER)
+            return false;
+
+        auto& d2dBitmap = As<ICanvasBitmapInternal>(bitmap)->GetD2DBitmap();
+        auto bitmapSize = GetBitmapSize(deviceContext->GetUnitMode(), d2dBitmap.Get());
+
+        if (sourceRect)
+        {
+            if (sourceRect->Width <= 0 ||
+                sourceRect->Height <= 0 ||
+                sourceRect->X < 0 ||
+                sourceRect->Y < 0 ||
+                sourceRect->X + sourceRect->Width > bitmapSize.width ||
+                sourceRect->Y + sourceRect->Height > bitmapSize.height)
+                return false;
+
+            // Sprite source rectangles are in whole pixels, so anything else
+            // would be rounded.
+            float sourceScale = 1;
+
+            if (deviceContext->GetUnitMode() == D2D1_UNIT_MODE_DIPS)
+            {
+                float bitmapDpi;
+                ThrowIfFailed(As<ICanvasResourceCreatorWithDpi>(bitmap)->get_Dpi(&bitmapDpi));
+                sourceScale = bitmapDpi / DEFAULT_DPI;
+            }
+
+            if (!IsWholeNumber(sourceRect->X * sourceScale) ||
+                !IsWholeNumber(sourceRect->Y * sourceScale) ||
+                !IsWholeNumber(sourceRect->Width * sourceScale) ||
+                !IsWholeNumber(sourceRect->Height * sourceScale))
+                return false;
+        }
+
+        Rect destRect;
+
+        if (destinationRect)
+        {
+            destRect = *destinationRect;
+        }
+        else if (sourceRect)
+        {
+            destRect = Rect{ offset->X, offset->Y, sourceRect->Width, sourceRect->Height };
+        }
+        else
+        {
+            destRect = Rect{ offset->X, offset->Y, bitmapSize.width, bitmapSize.height };
+        }
+
+        if (!IsDrawnIdenticallyWhenAliased(deviceContext, destRect))
+            return false;
+
+        // Sprite batches use a single interpolation mode for every sprite.
+        if (m_coalescedBitmapDraws && m_coalescedBitmapInterpolation != interpolation)
+            FlushCoalescedBitmapDraws();
+
+        if (!m_coalescedBitmapDraws)
+        {
+            auto deviceContext3 = MaybeAs<ID2D1DeviceContext3>(deviceContext);
+
+            if (!deviceContext3)
+                return false;
+
+            auto spriteBatch = Make<CanvasSpriteBatch>(
+                deviceContext3,
+                CanvasSpriteSortMode::None,
+                static_cast<D2D1_BITMAP_INTERPOLATION_MODE>(interpolation),
+                D2D1_SPRITE_OPTIONS_NONE,
+                m_stateCache);
+            CheckMakeResult(spriteBatch);
+
+            m_coalescedBitmapDraws = spriteBatch;
+            m_coalescedBitmapInterpolation = interpolation;
+        }
+
+        // Sprite tints are not premultiplied, so scaling alpha alone matches
+        // the effect of DrawBitmap's opacity parameter.
+        auto tint = Vector4{ 1, 1, 1, opacity };
+
+        if (sourceRect)
+            ThrowIfFailed(m_coalescedBitmapDraws->DrawFromSpriteSheetToRectWithTint(bitmap, destRect, *sourceRect, tint));
+        else
+            ThrowIfFailed(m_coalescedBitmapDraws->DrawToRectWithTint(bitmap, destRect, tint));
+
+        return true;
+    }
+
+
+    void CanvasDrawingSession::FlushCoalescedBitmapDraws()
+    {
+        if (!m_coalescedBitmapDraws)
+            return;
+
+        auto profile = m_profiler.Profile(DrawingSessionCallFamily::Flush);
+
+        // Reset first, so a failure does not leave a closed batch behind.
+        auto coalescedBitmapDraws = As<IClosable>(m_coalescedBitmapDraws);
+        m_coalescedBitmapDraws.Reset();
+
+        ThrowIfFailed(coalescedBitmapDraws->Close());
+    }
     
 #endif
 
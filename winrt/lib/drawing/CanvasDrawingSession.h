@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include "DeviceContextStateCache.h"
+#include "DrawingSessionProfiler.h"
+#include "VisibilityCuller.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
     using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
@@ -17,6 +21,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     using namespace ::Microsoft::WRL;
 
+    template<typename T> class BroadcastArray;
+
     class ICanvasDrawingSessionAdapter
     {
     public:
@@ -61,8 +67,28 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         D2D1_POINT_2F const m_offset;
         
         ComPtr<ID2D1SolidColorBrush> m_solidColorBrush;
+        ABI::Windows::UI::Color m_solidColorBrushColor;
         ComPtr<ICanvasTextFormat> m_defaultTextFormat;
 
+        //
+        // When CoalesceColorFills is enabled, opaque solid color fills of
+        // simple shapes are collected here, and drawn as a single geometry
+        // group when the color changes or anything else uses the device
+        // context.
+        //
+        bool m_coalesceColorFills;
+        std::vector<ComPtr<ID2D1Geometry>> m_coalescedFills;
+        ABI::Windows::UI::Color m_coalescedFillColor;
+
+        CanvasColorFillStatistics m_colorFillStatistics;
+
+        DrawingSessionProfiler m_profiler;
+
+        // Shared with the sprite batches this session creates.
+        std::shared_ptr<DeviceContextStateCache> m_stateCache;
+
+        VisibilityCuller m_culler;
+
         std::vector<int> m_activeLayerIds;
         int m_nextLayerId;
 
@@ -82,6 +108,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 #if WINVER > _WIN32_WINNT_WINBLUE
         ComPtr<IInkD2DRenderer> m_inkD2DRenderer;
         ComPtr<ID2D1DrawingStateBlock1> m_inkStateBlock;
+
+        //
+        // When CoalesceBitmapDraws is enabled, simple bitmap draws are added
+        // to this sprite batch instead of being drawn immediately.  They are
+        // flushed by anything else that uses the device context.
+        //
+        bool m_coalesceBitmapDraws;
+        ComPtr<ICanvasSpriteBatch> m_coalescedBitmapDraws;
+        CanvasImageInterpolation m_coalescedBitmapInterpolation;
 #endif
 
     public:
@@ -102,10 +137,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual ~CanvasDrawingSession();
 
+        // Hides ResourceWrapper::GetResource, so that everything that uses the
+        // device context first draws any coalesced bitmaps.
+        ComPtr<ID2D1DeviceContext1> const& GetResource();
+
         // IClosable
 
         IFACEMETHOD(Close)() override;
 
+        // ICanvasResourceWrapperNative
+
+        IFACEMETHOD(GetNativeResource)(ICanvasDevice* device, float dpi, REFIID iid, void** resource) override;
+
         // ICanvasDrawingSession
 
         IFACEMETHOD(Clear)(
@@ -1301,6 +1344,93 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             int* clusterMapIndices,
             uint32_t textPosition) override;
 
+        //
+        // Batched primitives
+        //
+
+        IFACEMETHOD(FillRectangles)(
+            uint32_t rectCount,
+            Rect* rects,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors) override;
+
+        IFACEMETHOD(DrawRectangles)(
+            uint32_t rectCount,
+            Rect* rects,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors,
+            float strokeWidth) override;
+
+        IFACEMETHOD(FillRoundedRectangles)(
+            uint32_t rectCount,
+            Rect* rects,
+            float radiusX,
+            float radiusY,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors) override;
+
+        IFACEMETHOD(FillEllipses)(
+            uint32_t centerPointCount,
+            Vector2* centerPoints,
+            uint32_t radiusCount,
+            Vector2* radii,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors) override;
+
+        IFACEMETHOD(FillCircles)(
+            uint32_t centerPointCount,
+            Vector2* centerPoints,
+            uint32_t radiusCount,
+            float* radii,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors) override;
+
+        IFACEMETHOD(DrawLines)(
+            uint32_t pointCount,
+            Vector2* points,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors,
+            float strokeWidth) override;
+
+        IFACEMETHOD(DrawPoints)(
+            uint32_t pointCount,
+            Vector2* points,
+            uint32_t colorCount,
+            ABI::Windows::UI::Color* colors,
+            float size) override;
+
+        //
+        // CoalesceColorFills
+        //
+
+        IFACEMETHOD(get_CoalesceColorFills)(boolean* value) override;
+
+        IFACEMETHOD(put_CoalesceColorFills)(boolean value) override;
+
+        IFACEMETHOD(get_ColorFillStatistics)(CanvasColorFillStatistics* value) override;
+
+        //
+        // Statistics
+        //
+
+        IFACEMETHOD(get_CollectStatistics)(boolean* value) override;
+
+        IFACEMETHOD(put_CollectStatistics)(boolean value) override;
+
+        IFACEMETHOD(get_Statistics)(CanvasDrawingSessionStatistics* value) override;
+
+        IFACEMETHOD(get_StateChangeStatistics)(CanvasStateChangeStatistics* value) override;
+
+        //
+        // CullInvisibleDraws
+        //
+
+        IFACEMETHOD(get_CullInvisibleDraws)(boolean* value) override;
+
+        IFACEMETHOD(put_CullInvisibleDraws)(boolean value) override;
+
+        IFACEMETHOD(get_CulledDrawCount)(uint32_t* value) override;
+
 
 #if WINVER > _WIN32_WINNT_WINBLUE
 
@@ -1326,6 +1456,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             CanvasSpriteOptions options,
             ICanvasSpriteBatch** spriteBatch) override;
 
+        //
+        // CoalesceBitmapDraws
+        //
+
+        IFACEMETHOD(get_CoalesceBitmapDraws)(boolean* value) override;
+
+        IFACEMETHOD(put_CoalesceBitmapDraws)(boolean value) override;
+
 #endif
 
         //
@@ -1408,6 +1546,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             IDWriteTextFormat* format,
             D2D1_DRAW_TEXT_OPTIONS options);
 
+        bool TryDrawCachedTextLayout(
+            HSTRING text,
+            Rect const& rect,
+            ID2D1Brush* brush,
+            ICanvasTextFormat* format,
+            bool noWrap,
+            D2D1_DRAW_TEXT_OPTIONS options);
+
         ICanvasTextFormat* GetDefaultTextFormat();
 
         void DrawGeometryImpl(
@@ -1428,6 +1574,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ID2D1SolidColorBrush* GetColorBrush(ABI::Windows::UI::Color const& color);
         ComPtr<ID2D1Brush> ToD2DBrush(ICanvasBrush* brush);
 
+        template<typename ADD_FIGURE, typename DRAW_PRIMITIVE, typename DRAW_GEOMETRY>
+        void DrawPrimitiveBatch(
+            uint32_t primitiveCount,
+            BroadcastArray<ABI::Windows::UI::Color> const& colors,
+            ADD_FIGURE const& addFigure,
+            DRAW_PRIMITIVE const& drawPrimitive,
+            DRAW_GEOMETRY const& drawGeometry);
+
+        template<typename CREATE_GEOMETRY>
+        bool TryCoalesceColorFill(
+            ID2D1DeviceContext1* deviceContext,
+            ABI::Windows::UI::Color const& color,
+            CREATE_GEOMETRY const& createGeometry);
+
+        void FlushCoalescedColorFills();
+
         HRESULT DrawImageImpl(
             ICanvasImage* image,
             Vector2* offset,
@@ -1446,6 +1608,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             CanvasImageInterpolation interpolation,
             ABI::Microsoft::Graphics::Canvas::Numerics::Matrix4x4* perspective);
 
+        bool IsImageVisible(
+            ID2D1DeviceContext1* deviceContext,
+            ICanvasImage* image,
+            Vector2 const* offset,
+            Rect const* destinationRect,
+            Rect const* sourceRect);
+
+        bool IsTextLayoutVisible(
+            ID2D1DeviceContext1* deviceContext,
+            ICanvasTextLayout* textLayout,
+            float x,
+            float y);
+
         HRESULT CreateLayerImpl(
             float opacity,
             ICanvasBrush* opacityBrush,
@@ -1455,10 +1630,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             CanvasLayerOptions options,
             ICanvasActiveLayer** layer);
 
-        void PopLayer(int layerId, bool isAxisAlignedClip);
+        void PopLayer(int layerId, bool isAxisAlignedClip, LayerPoolBucket const& pooledLayerBucket, ComPtr<ID2D1Layer>&& pooledLayer);
 
 #if WINVER > _WIN32_WINNT_WINBLUE
         void DrawInkImpl(IIterable<InkStroke*>* inkStrokeCollection, bool highContrast);
+
+        bool TryCoalesceBitmapDraw(
+            ID2D1DeviceContext1* deviceContext,
+            ICanvasBitmap* bitmap,
+            Vector2* offset,
+            Rect* destinationRect,
+            Rect* sourceRect,
+            float opacity,
+            CanvasImageInterpolation interpolation,
+            CanvasComposite const* composite);
+
+        void FlushCoalescedBitmapDraws();
 #endif
 
         ComPtr<ICanvasDevice> const& GetDevice();
@@ -1485,4 +1672,49 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowIfFailed(d2dDeviceContext->EndDraw());
         }
     };
+
+
+    //
+    // Draws using a device context leased from the device's DeviceContextPool.
+    // Other users of the pool expect a context in its default state, so
+    // anything a drawing session may have changed is put back before the
+    // lease is returned.
+    //
+    class LeasedCanvasDrawingSessionAdapter : public ICanvasDrawingSessionAdapter,
+                                              private LifespanTracker<LeasedCanvasDrawingSessionAdapter>
+    {
+        DeviceContextLease m_deviceContext;
+
+        // The effect buffer precision and tile size have no fixed defaults,
+        // so they are captured when the lease is taken and put back in EndDraw.
+        D2D1_RENDERING_CONTROLS m_renderingControls;
+
+    public:
+        LeasedCanvasDrawingSessionAdapter(DeviceContextLease&& deviceContext)
+            : m_deviceContext(std::move(deviceContext))
+        {
+            m_deviceContext->GetRenderingControls(&m_renderingControls);
+            m_deviceContext->BeginDraw();
+        }
+
+        virtual void EndDraw(ID2D1DeviceContext1* d2dDeviceContext) override
+        {
+            assert(d2dDeviceContext == m_deviceContext.Get());
+
+            HRESULT hr = d2dDeviceContext->EndDraw();
+
+            d2dDeviceContext->SetTarget(nullptr);
+            d2dDeviceContext->SetDpi(DEFAULT_DPI, DEFAULT_DPI);
+            d2dDeviceContext->SetUnitMode(D2D1_UNIT_MODE_DIPS);
+            d2dDeviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+            d2dDeviceContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
+            d2dDeviceContext->SetPrimitiveBlend(D2D1_PRIMITIVE_BLEND_SOURCE_OVER);
+            d2dDeviceContext->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_DEFAULT);
+            d2dDeviceContext->SetTextRenderingParams(nullptr);
+            d2dDeviceContext->SetRenderingControls(&m_renderingControls);
+
+            // The lease is returned when the adapter is destroyed.
+            ThrowIfFailed(hr);
+        }
+    };
 }}}}
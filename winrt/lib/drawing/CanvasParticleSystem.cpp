@@ -0,0 +1,431 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include "CanvasParticleSystem.h"
+#include "utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+// Particles are integrated in groups of four, one group per SIMD vector.
+static const uint32_t ParticlesPerGroup = 4;
+
+// Below this many groups it is cheaper to run on a single thread.
+static const uint32_t GroupsPerChunk = 2048;
+
+// Lifetime variance is clamped so particles always live for a positive time.
+static const float MinimumLifetime = 1.0f / 1000.0f;
+
+// Leaves room to pad the arrays to a whole group without overflowing.
+static const uint32_t MaximumCapacity = UINT32_MAX - (ParticlesPerGroup - 1);
+
+
+static uint32_t RoundUpToGroup(uint32_t count)
+{
+    return (count + ParticlesPerGroup - 1) / ParticlesPerGroup * ParticlesPerGroup;
+}
+
+
+static ::DirectX::XMVECTOR XM_CALLCONV LoadGroup(float const* values)
+{
+    return ::DirectX::XMLoadFloat4(reinterpret_cast<::DirectX::XMFLOAT4 const*>(values));
+}
+
+
+static void XM_CALLCONV StoreGroup(float* values, ::DirectX::FXMVECTOR group)
+{
+    ::DirectX::XMStoreFloat4(reinterpret_cast<::DirectX::XMFLOAT4*>(values), group);
+}
+
+
+CanvasParticleSystem::CanvasParticleSystem(uint32_t capacity)
+    : m_capacity(capacity)
+    , m_particleCount(0)
+    , m_gravity{}
+    , m_closed(false)
+{
+    assert(capacity <= MaximumCapacity);
+
+    auto paddedCapacity = RoundUpToGroup(capacity);
+
+    m_positionX.resize(paddedCapacity);
+    m_positionY.resize(paddedCapacity);
+    m_velocityX.resize(paddedCapacity);
+    m_velocityY.resize(paddedCapacity);
+    m_age.resize(paddedCapacity);
+    m_inverseLifetime.resize(paddedCapacity);
+    m_startSize.resize(paddedCapacity);
+    m_sizeDelta.resize(paddedCapacity);
+    m_startColor.resize(paddedCapacity);
+    m_colorDelta.resize(paddedCapacity);
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::get_Capacity(uint32_t* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+        ThrowIfClosed();
+
+        *value = m_capacity;
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::get_ParticleCount(uint32_t* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+        ThrowIfClosed();
+
+        *value = m_particleCount;
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::get_Gravity(Vector2* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+        ThrowIfClosed();
+
+        *value = m_gravity;
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::put_Gravity(Vector2 value)
+{
+    return ExceptionBoundary([&]
+    {
+        ThrowIfClosed();
+
+        m_gravity = value;
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::Emit(
+    CanvasParticleEmitterDescription emitter,
+    uint32_t count)
+{
+    return ExceptionBoundary([&]
+    {
+        ThrowIfClosed();
+
+        if (!(emitter.Lifetime > 0))
+            ThrowHR(E_INVALIDARG, Strings::ParticleEmitterInvalidLifetime);
+
+        // Particles that do not fit in the remaining capacity are dropped.
+        auto emitCount = std::min(count, m_capacity - m_particleCount);
+
+        auto colorDelta = Vector4{
+            emitter.EndColor.X - emitter.StartColor.X,
+            emitter.EndColor.Y - emitter.StartColor.Y,
+            emitter.EndColor.Z - emitter.StartColor.Z,
+            emitter.EndColor.W - emitter.StartColor.W };
+
+        for (uint32_t i = 0; i < emitCount; ++i)
+        {
+            auto index = m_particleCount++;
+
+            m_positionX[index] = emitter.Position.X + RandomVariance(emitter.PositionVariance.X);
+            m_positionY[index] = emitter.Position.Y + RandomVariance(emitter.PositionVariance.Y);
+            m_velocityX[index] = emitter.Velocity.X + RandomVariance(emitter.VelocityVariance.X);
+            m_velocityY[index] = emitter.Velocity.Y + RandomVariance(emitter.VelocityVariance.Y);
+
+            auto lifetime = emitter.Lifetime + RandomVariance(emitter.LifetimeVariance);
+
+            m_age[index] = 0;
+            m_inverseLifetime[index] = 1.0f / std::max(lifetime, MinimumLifetime);
+
+            m_startSize[index] = emitter.StartSize;
+            m_sizeDelta[index] = emitter.EndSize - emitter.StartSize;
+
+            m_startColor[index] = emitter.StartColor;
+            m_colorDelta[index] = colorDelta;
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::Update(
+    float elapsedSeconds)
+{
+    return ExceptionBoundary([&]
+    {
+        if (!(elapsedSeconds >= 0))
+            ThrowHR(E_INVALIDARG);
+
+        ThrowIfClosed();
+
+        auto groupCount = RoundUpToGroup(m_particleCount) / ParticlesPerGroup;
+
+        ParallelFor(groupCount, GroupsPerChunk,
+            [&](uint32_t beginGroup, uint32_t endGroup)
+            {
+                IntegrateParticles(beginGroup * ParticlesPerGroup, endGroup * ParticlesPerGroup, elapsedSeconds);
+            });
+
+        RemoveExpiredParticles();
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::Clear()
+{
+    return ExceptionBoundary([&]
+    {
+        ThrowIfClosed();
+
+        m_particleCount = 0;
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::Draw(
+    ICanvasSpriteBatch* spriteBatch,
+    ICanvasBitmap* bitmap)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(spriteBatch);
+        CheckInPointer(bitmap);
+        ThrowIfClosed();
+
+        if (m_particleCount == 0)
+            return;
+
+        Size bitmapSize;
+        ThrowIfFailed(bitmap->get_Size(&bitmapSize));
+
+        m_transforms.resize(m_particleCount);
+        m_tints.resize(m_particleCount);
+
+        auto groupCount = RoundUpToGroup(m_particleCount) / ParticlesPerGroup;
+
+        ParallelFor(groupCount, GroupsPerChunk,
+            [&](uint32_t beginGroup, uint32_t endGroup)
+            {
+                CalculateSprites(beginGroup * ParticlesPerGroup, endGroup * ParticlesPerGroup, bitmapSize);
+            });
+
+        ThrowIfFailed(spriteBatch->DrawManyWithTransforms(
+            bitmap,
+            m_particleCount,
+            m_transforms.data(),
+            m_particleCount,
+            m_tints.data(),
+            0,
+            nullptr));
+    });
+}
+
+
+IFACEMETHODIMP CanvasParticleSystem::Close()
+{
+    m_closed = true;
+    m_particleCount = 0;
+
+    m_positionX.clear();
+    m_positionX.shrink_to_fit();
+    m_positionY.clear();
+    m_positionY.shrink_to_fit();
+    m_velocityX.clear();
+    m_velocityX.shrink_to_fit();
+    m_velocityY.clear();
+    m_velocityY.shrink_to_fit();
+    m_age.clear();
+    m_age.shrink_to_fit();
+    m_inverseLifetime.clear();
+    m_inverseLifetime.shrink_to_fit();
+    m_startSize.clear();
+    m_startSize.shrink_to_fit();
+    m_sizeDelta.clear();
+    m_sizeDelta.shrink_to_fit();
+    m_startColor.clear();
+    m_startColor.shrink_to_fit();
+    m_colorDelta.clear();
+    m_colorDelta.shrink_to_fit();
+    m_transforms.clear();
+    m_transforms.shrink_to_fit();
+    m_tints.clear();
+    m_tints.shrink_to_fit();
+
+    return S_OK;
+}
+
+
+void CanvasParticleSystem::ThrowIfClosed()
+{
+    if (m_closed)
+    {
+        ThrowHR(RO_E_CLOSED);
+    }
+}
+
+
+float CanvasParticleSystem::RandomVariance(float variance)
+{
+    if (variance == 0)
+        return 0;
+
+    variance = std::abs(variance);
+
+    return std::uniform_real_distribution<float>(-variance, variance)(m_random);
+}
+
+
+//
+// Semi-implicit Euler integration of four particles at a time.  The range
+// always covers whole groups; the arrays are padded so the last group may
+// safely include unused slots past the end of the live particles.
+//
+void CanvasParticleSystem::IntegrateParticles(uint32_t begin, uint32_t end, float elapsedSeconds)
+{
+    auto elapsed = ::DirectX::XMVectorReplicate(elapsedSeconds);
+    auto gravityX = ::DirectX::XMVectorReplicate(m_gravity.X * elapsedSeconds);
+    auto gravityY = ::DirectX::XMVectorReplicate(m_gravity.Y * elapsedSeconds);
+
+    for (uint32_t i = begin; i < end; i += ParticlesPerGroup)
+    {
+        auto velocityX = ::DirectX::XMVectorAdd(LoadGroup(&m_velocityX[i]), gravityX);
+        auto velocityY = ::DirectX::XMVectorAdd(LoadGroup(&m_velocityY[i]), gravityY);
+
+        StoreGroup(&m_positionX[i], ::DirectX::XMVectorMultiplyAdd(velocityX, elapsed, LoadGroup(&m_positionX[i])));
+        StoreGroup(&m_positionY[i], ::DirectX::XMVectorMultiplyAdd(velocityY, elapsed, LoadGroup(&m_positionY[i])));
+
+        StoreGroup(&m_velocityX[i], velocityX);
+        StoreGroup(&m_velocityY[i], velocityY);
+
+        StoreGroup(&m_age[i], ::DirectX::XMVectorAdd(LoadGroup(&m_age[i]), elapsed));
+    }
+}
+
+
+//
+// Expired particles are replaced by the last live particle, so the live
+// particles stay packed at the start of the arrays.  This does not preserve
+// the order in which particles were emitted.
+//
+void CanvasParticleSystem::RemoveExpiredParticles()
+{
+    uint32_t i = 0;
+
+    while (i < m_particleCount)
+    {
+        if (m_age[i] * m_inverseLifetime[i] >= 1.0f)
+        {
+            --m_particleCount;
+            MoveParticle(m_particleCount, i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+
+void CanvasParticleSystem::MoveParticle(uint32_t from, uint32_t to)
+{
+    m_positionX[to] = m_positionX[from];
+    m_positionY[to] = m_positionY[from];
+    m_velocityX[to] = m_velocityX[from];
+    m_velocityY[to] = m_velocityY[from];
+    m_age[to] = m_age[from];
+    m_inverseLifetime[to] = m_inverseLifetime[from];
+    m_startSize[to] = m_startSize[from];
+    m_sizeDelta[to] = m_sizeDelta[from];
+    m_startColor[to] = m_startColor[from];
+    m_colorDelta[to] = m_colorDelta[from];
+}
+
+
+//
+// Interpolates size and color over each particle's lifetime, producing a
+// transform that scales the bitmap around its center and moves it to the
+// particle position.
+//
+// Like IntegrateParticles, this works on whole groups of four particles,
+// but only writes sprites for the live particles.  Colors are stored one
+// particle per vector, so each color is interpolated with a single
+// multiply-add once the group's lifetime fractions are known.
+//
+void CanvasParticleSystem::CalculateSprites(uint32_t begin, uint32_t end, Size bitmapSize)
+{
+    auto halfWidth = ::DirectX::XMVectorReplicate(bitmapSize.Width / 2);
+    auto halfHeight = ::DirectX::XMVectorReplicate(bitmapSize.Height / 2);
+    auto one = ::DirectX::XMVectorReplicate(1.0f);
+
+    for (uint32_t i = begin; i < end; i += ParticlesPerGroup)
+    {
+        auto t = ::DirectX::XMVectorMin(::DirectX::XMVectorMultiply(LoadGroup(&m_age[i]), LoadGroup(&m_inverseLifetime[i])), one);
+        auto size = ::DirectX::XMVectorMultiplyAdd(LoadGroup(&m_sizeDelta[i]), t, LoadGroup(&m_startSize[i]));
+        auto offsetX = ::DirectX::XMVectorNegativeMultiplySubtract(size, halfWidth, LoadGroup(&m_positionX[i]));
+        auto offsetY = ::DirectX::XMVectorNegativeMultiplySubtract(size, halfHeight, LoadGroup(&m_positionY[i]));
+
+        float groupT[ParticlesPerGroup];
+        float groupSize[ParticlesPerGroup];
+        float groupOffsetX[ParticlesPerGroup];
+        float groupOffsetY[ParticlesPerGroup];
+
+        StoreGroup(groupT, t);
+        StoreGroup(groupSize, size);
+        StoreGroup(groupOffsetX, offsetX);
+        StoreGroup(groupOffsetY, offsetY);
+
+        auto liveCount = std::min(ParticlesPerGroup, m_particleCount - i);
+
+        for (uint32_t j = 0; j < liveCount; ++j)
+        {
+            m_transforms[i + j] = Matrix3x2{
+                groupSize[j], 0,
+                0, groupSize[j],
+                groupOffsetX[j],
+                groupOffsetY[j] };
+
+            auto startColor = ::DirectX::XMLoadFloat4(ReinterpretAs<::DirectX::XMFLOAT4 const*>(&m_startColor[i + j]));
+            auto colorDelta = ::DirectX::XMLoadFloat4(ReinterpretAs<::DirectX::XMFLOAT4 const*>(&m_colorDelta[i + j]));
+
+            ::DirectX::XMStoreFloat4(
+                ReinterpretAs<::DirectX::XMFLOAT4*>(&m_tints[i + j]),
+                ::DirectX::XMVectorMultiplyAdd(colorDelta, ::DirectX::XMVectorReplicate(groupT[j]), startColor));
+        }
+    }
+}
+
+
+//
+// CanvasParticleSystemFactory
+//
+
+IFACEMETHODIMP CanvasParticleSystemFactory::Create(
+    uint32_t capacity,
+    ICanvasParticleSystem** particleSystem)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckAndClearOutPointer(particleSystem);
+
+        if (capacity == 0 || capacity > MaximumCapacity)
+            ThrowHR(E_INVALIDARG, Strings::ParticleSystemInvalidCapacity);
+
+        auto newParticleSystem = Make<CanvasParticleSystem>(capacity);
+        CheckMakeResult(newParticleSystem);
+
+        ThrowIfFailed(newParticleSystem.CopyTo(particleSystem));
+    });
+}
+
+
+ActivatableClassWithFactory(CanvasParticleSystem, CanvasParticleSystemFactory);
+
+#endif
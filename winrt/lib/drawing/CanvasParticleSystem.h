@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include <random>
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Simulates a fixed-capacity pool of particles on the CPU, and draws them
+    // through a CanvasSpriteBatch.
+    //
+    // Particle state is stored as a structure of arrays, so that Update can
+    // integrate four particles at a time with DirectXMath and split large
+    // systems across multiple threads.  Each array is padded out to a multiple
+    // of four elements.
+    //
+    class CanvasParticleSystem
+        : public RuntimeClass<ICanvasParticleSystem, IClosable>
+        , private LifespanTracker<CanvasParticleSystem>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_CanvasParticleSystem, BaseTrust);
+
+        uint32_t m_capacity;
+        uint32_t m_particleCount;
+        Vector2 m_gravity;
+        bool m_closed;
+
+        std::vector<float> m_positionX;
+        std::vector<float> m_positionY;
+        std::vector<float> m_velocityX;
+        std::vector<float> m_velocityY;
+        std::vector<float> m_age;
+        std::vector<float> m_inverseLifetime;
+        std::vector<float> m_startSize;
+        std::vector<float> m_sizeDelta;
+        std::vector<Vector4> m_startColor;
+        std::vector<Vector4> m_colorDelta;
+
+        // Scratch buffers reused by Draw to avoid reallocating every frame.
+        std::vector<Matrix3x2> m_transforms;
+        std::vector<Vector4> m_tints;
+
+        std::minstd_rand m_random;
+
+    public:
+        CanvasParticleSystem(uint32_t capacity);
+
+        //
+        // ICanvasParticleSystem
+        //
+
+        IFACEMETHOD(get_Capacity)(uint32_t* value) override;
+
+        IFACEMETHOD(get_ParticleCount)(uint32_t* value) override;
+
+        IFACEMETHOD(get_Gravity)(Vector2* value) override;
+
+        IFACEMETHOD(put_Gravity)(Vector2 value) override;
+
+        IFACEMETHOD(Emit)(
+            CanvasParticleEmitterDescription emitter,
+            uint32_t count) override;
+
+        IFACEMETHOD(Update)(
+            float elapsedSeconds) override;
+
+        IFACEMETHOD(Clear)() override;
+
+        IFACEMETHOD(Draw)(
+            ICanvasSpriteBatch* spriteBatch,
+            ICanvasBitmap* bitmap) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        void ThrowIfClosed();
+
+        float RandomVariance(float variance);
+
+        void IntegrateParticles(uint32_t begin, uint32_t end, float elapsedSeconds);
+
+        void RemoveExpiredParticles();
+
+        void MoveParticle(uint32_t from, uint32_t to);
+
+        void CalculateSprites(uint32_t begin, uint32_t end, Size bitmapSize);
+    };
+
+
+    class CanvasParticleSystemFactory
+        : public AgileActivationFactory<ICanvasParticleSystemFactory>
+        , private LifespanTracker<CanvasParticleSystemFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_CanvasParticleSystem, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            uint32_t capacity,
+            ICanvasParticleSystem** particleSystem) override;
+    };
+}}}}
+
+#endif
@@ -9,6 +9,8 @@
 #include <WindowsNumerics.h>
 
 #include "CanvasSpriteBatch.h"
+#include "utils/BroadcastArray.h"
+#include "utils/PerformanceTimer.h"
 
 using namespace ::Windows::Foundation::Numerics;
 
@@ -42,9 +44,8 @@ IFACEMETHODIMP CanvasSpriteBatchStatics::IsSupported(ICanvasDevice* device, bool
 Vector4 const CanvasSpriteBatch::DEFAULT_TINT{ 1.0f, 1.0f, 1.0f, 1.0f };
 
 
-static D2D1_RECT_F MakeDestRect(ComPtr<ID2D1Bitmap> const& d2dBitmap, Vector2 offset = Vector2{ 0, 0 })
+static D2D1_RECT_F MakeDestRect(D2D1_SIZE_F const& sizeInDips, Vector2 offset = Vector2{ 0, 0 })
 {
-    auto sizeInDips = d2dBitmap->GetSize();
     return D2D1_RECT_F{ offset.X, offset.Y, offset.X + sizeInDips.width, offset.Y + sizeInDips.height };
 }
 
@@ -70,20 +71,25 @@ static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, uint32_t left, uint32_t
 }
 
 
-static D2D1_RECT_U MakeSourceRect(ComPtr<ID2D1Bitmap> const& d2dBitmap, CanvasSpriteFlip flip)
+static D2D1_RECT_U MakeSourceRect(D2D1_SIZE_U const& sizeInPixels, CanvasSpriteFlip flip)
 {
-    auto sizeInPixels = d2dBitmap->GetPixelSize();
     return MakeSourceRect(flip, 0, 0, sizeInPixels.width, sizeInPixels.height);
 }
 
 
-static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, D2D1_UNIT_MODE unitMode, ICanvasBitmap* bitmap, Rect sourceRect)
+static float GetSourceRectDpi(D2D1_UNIT_MODE unitMode, ICanvasBitmap* bitmap)
 {
     float dpi = 96.0f;
 
     if (unitMode == D2D1_UNIT_MODE_DIPS)
         ThrowIfFailed(As<ICanvasResourceCreatorWithDpi>(bitmap)->get_Dpi(&dpi));
-    
+
+    return dpi;
+}
+
+
+static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, float dpi, Rect const& sourceRect)
+{
     auto sourceLeft   = DipsToPixels(sourceRect.X,      dpi, CanvasDpiRounding::Round);
     auto sourceTop    = DipsToPixels(sourceRect.Y,      dpi, CanvasDpiRounding::Round);
     auto sourceWidth  = DipsToPixels(sourceRect.Width,  dpi, CanvasDpiRounding::Round);
@@ -115,12 +121,17 @@ CanvasSpriteBatch::CanvasSpriteBatch(
     ComPtr<ID2D1DeviceContext3> const& deviceContext,
     CanvasSpriteSortMode sortMode,
     D2D1_BITMAP_INTERPOLATION_MODE interpolation,
-    D2D1_SPRITE_OPTIONS options)
+    D2D1_SPRITE_OPTIONS options,
+    std::shared_ptr<DeviceContextStateCache> stateCache)
     : m_deviceContext(deviceContext.Get())
     , m_sortMode(sortMode)
     , m_interpolationMode(interpolation)
     , m_spriteOptions(options)
     , m_unitMode(deviceContext->GetUnitMode())
+    , m_stateCache(std::move(stateCache))
+    , m_bitmapCache{}
+    , m_nextBitmapCacheEntry(0)
+    , m_statistics{}
 {
     assert(m_sortMode == CanvasSpriteSortMode::None
         || m_sortMode == CanvasSpriteSortMode::Bitmap);
@@ -182,12 +193,12 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawAtOffsetWithTint(
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
-        auto d2dDestRect = MakeDestRect(d2dBitmap, offset);
-        auto d2dSourceRect = MakeSourceRect(d2dBitmap, CanvasSpriteFlip::None);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto d2dDestRect = MakeDestRect(bitmapInfo.Size, offset);
+        auto d2dSourceRect = MakeSourceRect(bitmapInfo.PixelSize, CanvasSpriteFlip::None);
         
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             d2dDestRect,
             d2dSourceRect,
             tint);
@@ -215,11 +226,11 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawToRectWithTintAndFlip(
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
-        auto d2dSourceRect = MakeSourceRect(d2dBitmap, flip);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto d2dSourceRect = MakeSourceRect(bitmapInfo.PixelSize, flip);
         
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             ToD2DRect(destRect),
             d2dSourceRect,
             tint);
@@ -238,12 +249,12 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawWithTransformAndTintAndFlip(
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
-        auto d2dDestRect = MakeDestRect(d2dBitmap);
-        auto d2dSourceRect = MakeSourceRect(d2dBitmap, flip);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto d2dDestRect = MakeDestRect(bitmapInfo.Size);
+        auto d2dSourceRect = MakeSourceRect(bitmapInfo.PixelSize, flip);
 
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             d2dDestRect,
             d2dSourceRect,
             tint,
@@ -266,13 +277,13 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawAtOffsetWithTintAndTransform(
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
-        auto d2dDestRect = MakeDestRect(d2dBitmap);
-        auto d2dSourceRect = MakeSourceRect(d2dBitmap, flip);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto d2dDestRect = MakeDestRect(bitmapInfo.Size);
+        auto d2dSourceRect = MakeSourceRect(bitmapInfo.PixelSize, flip);
         auto transform = MakeTransform(origin, rotation, scale, offset);
 
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             d2dDestRect,
             d2dSourceRect,
             tint,
@@ -329,12 +340,12 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetAtOffsetWithTint(
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
         auto d2dDestRect = MakeDestRect(sourceRect, offset);
-        auto d2dSourceRect = MakeSourceRect(CanvasSpriteFlip::None, m_unitMode, bitmap, sourceRect);
+        auto d2dSourceRect = MakeSourceRect(CanvasSpriteFlip::None, bitmapInfo.SourceRectDpi, sourceRect);
         
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             d2dDestRect,
             d2dSourceRect,
             tint);
@@ -364,11 +375,11 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetToRectWithTintAndFlip(
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
-        auto d2dSourceRect = MakeSourceRect(flip, m_unitMode, bitmap, sourceRect);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto d2dSourceRect = MakeSourceRect(flip, bitmapInfo.SourceRectDpi, sourceRect);
         
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             ToD2DRect(destRect),
             d2dSourceRect,
             tint);
@@ -388,12 +399,12 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetWithTransformAndTintAndFlip
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
         auto d2dDestRect = MakeDestRect(sourceRect);
-        auto d2dSourceRect = MakeSourceRect(flip, m_unitMode, bitmap, sourceRect);
+        auto d2dSourceRect = MakeSourceRect(flip, bitmapInfo.SourceRectDpi, sourceRect);
         
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             d2dDestRect,
             d2dSourceRect,
             tint,
@@ -417,13 +428,13 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetAtOffsetWithTintAndTransfor
         CheckInPointer(bitmap);
         EnsureNotClosed();
         
-        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
         auto d2dDestRect = MakeDestRect(sourceRect);
-        auto d2dSourceRect = MakeSourceRect(flip, m_unitMode, bitmap, sourceRect);
+        auto d2dSourceRect = MakeSourceRect(flip, bitmapInfo.SourceRectDpi, sourceRect);
         auto transform = MakeTransform(origin, rotation, scale, offset);
 
         m_sprites.emplace_back(
-            std::move(d2dBitmap),
+            bitmapInfo.D2DBitmap.Get(),
             d2dDestRect,
             d2dSourceRect,
             tint,
@@ -432,6 +443,385 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetAtOffsetWithTintAndTransfor
 }
 
 
+//
+// The DrawMany methods add one sprite for each element of their first array.
+// The remaining arrays may either contain one element per sprite, or a single
+// element that is shared by every sprite.  The tint and flip arrays may also
+// be empty.
+//
+// All the per-bitmap work (unwrapping the bitmap, looking up its size and dpi)
+// is done once per call, rather than once per sprite.
+//
+
+static CanvasSpriteFlip const NO_FLIP = CanvasSpriteFlip::None;
+
+
+class SpriteFlipArray : public BroadcastArray<CanvasSpriteFlip>
+{
+public:
+    SpriteFlipArray(uint32_t spriteCount, uint32_t count, CanvasSpriteFlip const* elements)
+        : BroadcastArray(L"flips", spriteCount, count, elements, &NO_FLIP)
+    {
+        // Validate up front so that a bad value doesn't leave the batch
+        // half-populated.
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (static_cast<uint32_t>(elements[i]) > static_cast<uint32_t>(CanvasSpriteFlip::Both))
+            {
+                WinStringBuilder message;
+                message.Format(Strings::SpriteBatchInvalidFlip, i);
+                ThrowHR(E_INVALIDARG, message.Get());
+            }
+        }
+    }
+};
+
+
+//
+// The full-bitmap source rectangle for each of the four CanvasSpriteFlip
+// values, so that the per-sprite work is just a lookup.
+//
+class FlippedSourceRects
+{
+    D2D1_RECT_U m_rects[4];
+
+public:
+    FlippedSourceRects(D2D1_SIZE_U const& sizeInPixels)
+    {
+        for (uint32_t flip = 0; flip < 4; ++flip)
+        {
+            m_rects[flip] = MakeSourceRect(sizeInPixels, static_cast<CanvasSpriteFlip>(flip));
+        }
+    }
+
+    D2D1_RECT_U const& operator[](CanvasSpriteFlip flip) const
+    {
+        return m_rects[static_cast<uint32_t>(flip)];
+    }
+};
+
+
+//
+// Vectorized equivalents of MakeDestRect.  The offset is splatted to
+// (x, y, x, y) and added to (0, 0, width, height).
+//
+
+static ::DirectX::XMVECTOR XM_CALLCONV MakeSizeVector(float width, float height)
+{
+    return ::DirectX::XMVectorSet(0.0f, 0.0f, width, height);
+}
+
+
+static ::DirectX::XMVECTOR XM_CALLCONV MakeSizeVector(Rect const& sourceRect)
+{
+    // (X, Y, Width, Height) -> (0, 0, Width, Height)
+    auto rect = ::DirectX::XMLoadFloat4(ReinterpretAs<::DirectX::XMFLOAT4 const*>(&sourceRect));
+    return ::DirectX::XMVectorPermute<4, 5, 2, 3>(rect, ::DirectX::XMVectorZero());
+}
+
+
+static D2D1_RECT_F XM_CALLCONV MakeDestRect(Vector2 const& offset, ::DirectX::FXMVECTOR size)
+{
+    auto offsetVector = ::DirectX::XMLoadFloat2(ReinterpretAs<::DirectX::XMFLOAT2 const*>(&offset));
+    auto rect = ::DirectX::XMVectorAdd(::DirectX::XMVectorSwizzle<0, 1, 0, 1>(offsetVector), size);
+
+    D2D1_RECT_F result;
+    ::DirectX::XMStoreFloat4(ReinterpretAs<::DirectX::XMFLOAT4*>(&result), rect);
+    return result;
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyAtOffsets(
+    ICanvasBitmap* bitmap,
+    uint32_t offsetCount,
+    Vector2* offsets,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t flipCount,
+    CanvasSpriteFlip* flips)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        CheckArray(offsetCount, offsets);
+        EnsureNotClosed();
+
+        if (offsetCount == 0)
+            return;
+
+        BroadcastArray<Vector4> tintArray(L"tints", offsetCount, tintCount, tints, &DEFAULT_TINT);
+        SpriteFlipArray flipArray(offsetCount, flipCount, flips);
+
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto size = MakeSizeVector(bitmapInfo.Size.width, bitmapInfo.Size.height);
+        FlippedSourceRects sourceRects(bitmapInfo.PixelSize);
+
+        auto rawBitmap = bitmapInfo.D2DBitmap.Get();
+        m_sprites.reserve(m_sprites.size() + offsetCount);
+
+        for (uint32_t i = 0; i < offsetCount; ++i)
+        {
+            m_sprites.emplace_back(
+                rawBitmap,
+                MakeDestRect(offsets[i], size),
+                sourceRects[flipArray[i]],
+                tintArray[i]);
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyToRects(
+    ICanvasBitmap* bitmap,
+    uint32_t destRectCount,
+    Rect* destRects,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t flipCount,
+    CanvasSpriteFlip* flips)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        CheckArray(destRectCount, destRects);
+        EnsureNotClosed();
+
+        if (destRectCount == 0)
+            return;
+
+        BroadcastArray<Vector4> tintArray(L"tints", destRectCount, tintCount, tints, &DEFAULT_TINT);
+        SpriteFlipArray flipArray(destRectCount, flipCount, flips);
+
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        FlippedSourceRects sourceRects(bitmapInfo.PixelSize);
+
+        auto rawBitmap = bitmapInfo.D2DBitmap.Get();
+        m_sprites.reserve(m_sprites.size() + destRectCount);
+
+        for (uint32_t i = 0; i < destRectCount; ++i)
+        {
+            m_sprites.emplace_back(
+                rawBitmap,
+                ToD2DRect(destRects[i]),
+                sourceRects[flipArray[i]],
+                tintArray[i]);
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyWithTransforms(
+    ICanvasBitmap* bitmap,
+    uint32_t transformCount,
+    Matrix3x2* transforms,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t flipCount,
+    CanvasSpriteFlip* flips)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        CheckArray(transformCount, transforms);
+        EnsureNotClosed();
+
+        if (transformCount == 0)
+            return;
+
+        BroadcastArray<Vector4> tintArray(L"tints", transformCount, tintCount, tints, &DEFAULT_TINT);
+        SpriteFlipArray flipArray(transformCount, flipCount, flips);
+
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+        auto d2dDestRect = MakeDestRect(bitmapInfo.Size);
+        FlippedSourceRects sourceRects(bitmapInfo.PixelSize);
+
+        auto rawBitmap = bitmapInfo.D2DBitmap.Get();
+        m_sprites.reserve(m_sprites.size() + transformCount);
+
+        for (uint32_t i = 0; i < transformCount; ++i)
+        {
+            m_sprites.emplace_back(
+                rawBitmap,
+                d2dDestRect,
+                sourceRects[flipArray[i]],
+                tintArray[i],
+                transforms[i]);
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyFromSpriteSheetAtOffsets(
+    ICanvasBitmap* bitmap,
+    uint32_t offsetCount,
+    Vector2* offsets,
+    uint32_t sourceRectCount,
+    Rect* sourceRects,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t flipCount,
+    CanvasSpriteFlip* flips)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        CheckArray(offsetCount, offsets);
+        EnsureNotClosed();
+
+        if (offsetCount == 0)
+            return;
+
+        BroadcastArray<Rect> sourceRectArray(L"sourceRects", offsetCount, sourceRectCount, sourceRects);
+        BroadcastArray<Vector4> tintArray(L"tints", offsetCount, tintCount, tints, &DEFAULT_TINT);
+        SpriteFlipArray flipArray(offsetCount, flipCount, flips);
+
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+
+        auto rawBitmap = bitmapInfo.D2DBitmap.Get();
+        m_sprites.reserve(m_sprites.size() + offsetCount);
+
+        for (uint32_t i = 0; i < offsetCount; ++i)
+        {
+            auto& sourceRect = sourceRectArray[i];
+
+            m_sprites.emplace_back(
+                rawBitmap,
+                MakeDestRect(offsets[i], MakeSizeVector(sourceRect)),
+                MakeSourceRect(flipArray[i], bitmapInfo.SourceRectDpi, sourceRect),
+                tintArray[i]);
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyFromSpriteSheetToRects(
+    ICanvasBitmap* bitmap,
+    uint32_t destRectCount,
+    Rect* destRects,
+    uint32_t sourceRectCount,
+    Rect* sourceRects,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t flipCount,
+    CanvasSpriteFlip* flips)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        CheckArray(destRectCount, destRects);
+        EnsureNotClosed();
+
+        if (destRectCount == 0)
+            return;
+
+        BroadcastArray<Rect> sourceRectArray(L"sourceRects", destRectCount, sourceRectCount, sourceRects);
+        BroadcastArray<Vector4> tintArray(L"tints", destRectCount, tintCount, tints, &DEFAULT_TINT);
+        SpriteFlipArray flipArray(destRectCount, flipCount, flips);
+
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+
+        auto rawBitmap = bitmapInfo.D2DBitmap.Get();
+        m_sprites.reserve(m_sprites.size() + destRectCount);
+
+        for (uint32_t i = 0; i < destRectCount; ++i)
+        {
+            m_sprites.emplace_back(
+                rawBitmap,
+                ToD2DRect(destRects[i]),
+                MakeSourceRect(flipArray[i], bitmapInfo.SourceRectDpi, sourceRectArray[i]),
+                tintArray[i]);
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyFromSpriteSheetWithTransforms(
+    ICanvasBitmap* bitmap,
+    uint32_t transformCount,
+    Matrix3x2* transforms,
+    uint32_t sourceRectCount,
+    Rect* sourceRects,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t flipCount,
+    CanvasSpriteFlip* flips)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        CheckArray(transformCount, transforms);
+        EnsureNotClosed();
+
+        if (transformCount == 0)
+            return;
+
+        BroadcastArray<Rect> sourceRectArray(L"sourceRects", transformCount, sourceRectCount, sourceRects);
+        BroadcastArray<Vector4> tintArray(L"tints", transformCount, tintCount, tints, &DEFAULT_TINT);
+        SpriteFlipArray flipArray(transformCount, flipCount, flips);
+
+        auto& bitmapInfo = GetBitmapInfo(bitmap);
+
+        auto rawBitmap = bitmapInfo.D2DBitmap.Get();
+        m_sprites.reserve(m_sprites.size() + transformCount);
+
+        for (uint32_t i = 0; i < transformCount; ++i)
+        {
+            auto& sourceRect = sourceRectArray[i];
+
+            m_sprites.emplace_back(
+                rawBitmap,
+                MakeDestRect(sourceRect),
+                MakeSourceRect(flipArray[i], bitmapInfo.SourceRectDpi, sourceRect),
+                tintArray[i],
+                transforms[i]);
+        }
+    });
+}
+
+
+CanvasSpriteBatch::BitmapInfo const& CanvasSpriteBatch::GetBitmapInfo(ICanvasBitmap* bitmap)
+{
+    for (auto& entry : m_bitmapCache)
+    {
+        if (entry.Bitmap.Get() == bitmap)
+        {
+            // The bitmap may have been closed since it was cached, so check
+            // it is still open before handing out its D2D resource.
+            if (entry.BitmapInternal)
+                entry.BitmapInternal->GetD2DBitmap();
+            else
+                GetWrappedResource<ID2D1Bitmap>(bitmap);
+
+            return entry;
+        }
+    }
+
+    // Not cached, so replace the oldest entry.
+    auto& entry = m_bitmapCache[m_nextBitmapCacheEntry];
+
+    auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
+    auto size = d2dBitmap->GetSize();
+    auto pixelSize = d2dBitmap->GetPixelSize();
+    auto sourceRectDpi = GetSourceRectDpi(m_unitMode, bitmap);
+
+    // Sprites hold raw bitmap pointers, so we keep one reference here that
+    // lasts until the batch is closed, even if the bitmap is later evicted
+    // from the cache.
+    m_bitmaps.push_back(d2dBitmap);
+
+    entry.Bitmap = bitmap;
+    entry.BitmapInternal = MaybeAs<ICanvasBitmapInternal>(bitmap);
+    entry.D2DBitmap = std::move(d2dBitmap);
+    entry.Size = size;
+    entry.PixelSize = pixelSize;
+    entry.SourceRectDpi = sourceRectDpi;
+
+    m_nextBitmapCacheEntry = (m_nextBitmapCacheEntry + 1) % BITMAP_CACHE_SIZE;
+
+    return entry;
+}
+
+
 template<typename T>
 class BatchFinder
 {
@@ -462,7 +852,7 @@ public:
             return;
         }
 
-        m_bitmap = m_sprites[m_endIndex].Bitmap.Get();
+        m_bitmap = m_sprites[m_endIndex].Bitmap;
 
         for (; InCurrentBatch(); ++m_endIndex)
         {
@@ -500,7 +890,7 @@ private:
         if (m_endIndex - m_startIndex >= m_maxSpritesPerBatch)
             return false;
         
-        return m_endIndex != m_sprites.size() && m_sprites[m_endIndex].Bitmap.Get() == m_bitmap;
+        return m_endIndex != m_sprites.size() && m_sprites[m_endIndex].Bitmap == m_bitmap;
     }
 };
 
@@ -515,17 +905,39 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
         if (m_sprites.empty()) // early out if there's nothing to draw
             return;
 
+        assert(m_sprites.size() < std::numeric_limits<uint32_t>::max());
+
+        m_statistics.SpriteCount = static_cast<uint32_t>(m_sprites.size());
+        m_statistics.PeakSpriteCapacity = static_cast<uint32_t>(std::min<size_t>(m_sprites.capacity(), std::numeric_limits<uint32_t>::max()));
+
+        EventWrite_CanvasSpriteBatch_Close_Start(m_statistics.SpriteCount);
+
+        auto closeEnd = MakeScopeWarden([&]
+            {
+                EventWrite_CanvasSpriteBatch_Close_Stop(
+                    m_statistics.SpriteCount,
+                    m_statistics.DrawCallCount,
+                    m_statistics.PeakSpriteCapacity,
+                    m_statistics.SortTime.Duration,
+                    m_statistics.AddSpritesTime.Duration,
+                    !!m_statistics.SpriteBatchQuirkRequired);
+            });
+
         //
         // Sort the sprites
         //
         
         if (m_sortMode == CanvasSpriteSortMode::Bitmap)
         {
+            PerformanceTimer sortTimer;
+
             std::stable_sort(m_sprites.begin(), m_sprites.end(),
                 [] (auto const& a, auto const& b)
                 {
-                    return a.Bitmap.Get() < b.Bitmap.Get();
+                    return a.Bitmap < b.Bitmap;
                 });
+
+            m_statistics.SortTime = sortTimer.GetElapsedTime();
         }
 
         //
@@ -535,13 +947,13 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
         ComPtr<ID2D1SpriteBatch> spriteBatch;
         ThrowIfFailed(deviceContext->CreateSpriteBatch(&spriteBatch));
 
-        assert(m_sprites.size() < std::numeric_limits<uint32_t>::max());
-
         auto firstSprite = &m_sprites.front();
         auto stride = static_cast<uint32_t>(sizeof(Sprite));
 
+        PerformanceTimer addSpritesTimer;
+
         ThrowIfFailed(spriteBatch->AddSprites(
-            static_cast<uint32_t>(m_sprites.size()),
+            m_statistics.SpriteCount,
             &firstSprite->DestinationRect,
             &firstSprite->SourceRect,
             &firstSprite->Color,
@@ -551,18 +963,25 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
             stride,
             stride));
 
+        m_statistics.AddSpritesTime = addSpritesTimer.GetElapsedTime();
+
         //
-        // Get the device context into the right state
+        // Get the device context into the right state.  Batches created
+        // without a drawing session use a cache that is never enabled, which
+        // passes every call straight through.
         //
+
+        DeviceContextStateCache uncachedState;
+        auto& stateCache = m_stateCache ? *m_stateCache : uncachedState;
         
-        auto originalAntialiasMode = deviceContext->GetAntialiasMode();
+        auto originalAntialiasMode = stateCache.GetAntialiasMode(deviceContext.Get());
 
         if (originalAntialiasMode == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE)
-            deviceContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+            stateCache.SetAntialiasMode(deviceContext.Get(), D2D1_ANTIALIAS_MODE_ALIASED);
 
-        auto originalUnitMode = deviceContext->GetUnitMode();
+        auto originalUnitMode = stateCache.GetUnitMode(deviceContext.Get());
         if (originalUnitMode != m_unitMode)
-            deviceContext->SetUnitMode(m_unitMode);
+            stateCache.SetUnitMode(deviceContext.Get(), m_unitMode);
 
         //
         // Draw the sprites - one DrawSpriteBatch call for each bitmap
@@ -575,6 +994,8 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
         auto device = ResourceManager::GetOrCreate<ICanvasDeviceInternal>(d2dDevice.Get());
         bool quirked = device->IsSpriteBatchQuirkRequired();
         uint32_t maxSpritesPerBatch = quirked ? 256 : std::numeric_limits<uint32_t>::max();
+
+        m_statistics.SpriteBatchQuirkRequired = quirked;
         
         for (BatchFinder<Sprite> batchFinder(m_sprites, maxSpritesPerBatch); !batchFinder.Done(); batchFinder.FindNext())
         {
@@ -586,6 +1007,8 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
                 m_interpolationMode,
                 m_spriteOptions);
 
+            ++m_statistics.DrawCallCount;
+
             if (quirked)
             {
                 // Direct2D will helpfully batch up our DrawSpriteBatch calls - when
@@ -600,10 +1023,10 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
         //
 
         if (originalUnitMode != m_unitMode)
-            deviceContext->SetUnitMode(originalUnitMode);
+            stateCache.SetUnitMode(deviceContext.Get(), originalUnitMode);
 
         if (originalAntialiasMode == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE)
-            deviceContext->SetAntialiasMode(originalAntialiasMode);
+            stateCache.SetAntialiasMode(deviceContext.Get(), originalAntialiasMode);
 
         //
         // Release our working memory
@@ -611,6 +1034,37 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
 
         m_sprites.clear();
         m_sprites.shrink_to_fit();
+        m_bitmaps.clear();
+        m_bitmaps.shrink_to_fit();
+
+        for (auto& entry : m_bitmapCache)
+        {
+            entry = BitmapInfo{};
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::get_Statistics(
+    CanvasSpriteBatchStatistics* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        // Statistics remain available after the batch has been closed, which
+        // is when most of them are gathered.
+        if (m_deviceContext)
+        {
+            auto statistics = CanvasSpriteBatchStatistics{};
+            statistics.SpriteCount = static_cast<uint32_t>(m_sprites.size());
+            statistics.PeakSpriteCapacity = static_cast<uint32_t>(std::min<size_t>(m_sprites.capacity(), std::numeric_limits<uint32_t>::max()));
+            *value = statistics;
+        }
+        else
+        {
+            *value = m_statistics;
+        }
     });
 }
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "DeviceContextStateCache.h"
+
 #if WINVER > _WIN32_WINNT_WINBLUE
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
@@ -29,22 +31,27 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         D2D1_BITMAP_INTERPOLATION_MODE m_interpolationMode;
         D2D1_SPRITE_OPTIONS m_spriteOptions;
         D2D1_UNIT_MODE m_unitMode;
+
+        // Shared with the drawing session that created this batch, if any, so
+        // that Close can skip reading state that the session already knows.
+        std::shared_ptr<DeviceContextStateCache> m_stateCache;
         
         struct Sprite
         {
-            ComPtr<ID2D1Bitmap> Bitmap;
+            // Not reference counted; m_bitmaps keeps the bitmap alive
+            ID2D1Bitmap* Bitmap;
             D2D1_RECT_F DestinationRect;
             D2D1_RECT_U SourceRect;
             D2D1_COLOR_F Color;
             D2D1_MATRIX_3X2_F Transform;
 
             Sprite(
-                ComPtr<ID2D1Bitmap>&& bitmap,
+                ID2D1Bitmap* bitmap,
                 D2D1_RECT_F const& destinationRect,
                 D2D1_RECT_U const& sourceRect,
                 Vector4 const& tint,
                 Matrix3x2 const& transform)
-                : Bitmap(std::move(bitmap))
+                : Bitmap(bitmap)
                 , DestinationRect(destinationRect)
                 , SourceRect(sourceRect)
                 , Color(*ReinterpretAs<D2D1_COLOR_F const*>(&tint))
@@ -53,16 +60,39 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             }
 
             Sprite(
-                ComPtr<ID2D1Bitmap>&& bitmap,
+                ID2D1Bitmap* bitmap,
                 D2D1_RECT_F const& destinationRect,
                 D2D1_RECT_U const& sourceRect,
                 Vector4 const& tint)
-                : Sprite(std::move(bitmap), destinationRect, sourceRect, tint, Identity3x2())
+                : Sprite(bitmap, destinationRect, sourceRect, tint, Identity3x2())
             {
             }
         };
 
         std::vector<Sprite> m_sprites;
+        std::vector<ComPtr<ID2D1Bitmap>> m_bitmaps;
+
+        // Everything a draw needs to know about a bitmap.  The most recently
+        // drawn bitmaps are cached so that repeated draws from the same bitmap
+        // don't need to unwrap it or query its size and dpi each time.  The
+        // cache holds a reference to each ICanvasBitmap so that a key can't be
+        // reused by a different bitmap while it is in the cache.
+        struct BitmapInfo
+        {
+            ComPtr<ICanvasBitmap> Bitmap;
+            ComPtr<ICanvasBitmapInternal> BitmapInternal;
+            ComPtr<ID2D1Bitmap> D2DBitmap;
+            D2D1_SIZE_F Size;
+            D2D1_SIZE_U PixelSize;
+            float SourceRectDpi;
+        };
+
+        static uint32_t const BITMAP_CACHE_SIZE = 4;
+
+        BitmapInfo m_bitmapCache[BITMAP_CACHE_SIZE];
+        uint32_t m_nextBitmapCacheEntry;
+
+        CanvasSpriteBatchStatistics m_statistics;
 
     public:
         static Vector4 const DEFAULT_TINT;
@@ -71,7 +101,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ComPtr<ID2D1DeviceContext3> const& deviceContext,
             CanvasSpriteSortMode sortMode,
             D2D1_BITMAP_INTERPOLATION_MODE interpolation,
-            D2D1_SPRITE_OPTIONS options);
+            D2D1_SPRITE_OPTIONS options,
+            std::shared_ptr<DeviceContextStateCache> stateCache = nullptr);
 
         ~CanvasSpriteBatch();
 
@@ -184,6 +215,69 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             Vector2 scale,
             CanvasSpriteFlip flip) override;
 
+        IFACEMETHODIMP DrawManyAtOffsets(
+            ICanvasBitmap* bitmap,
+            uint32_t offsetCount,
+            Vector2* offsets,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t flipCount,
+            CanvasSpriteFlip* flips) override;
+
+        IFACEMETHODIMP DrawManyToRects(
+            ICanvasBitmap* bitmap,
+            uint32_t destRectCount,
+            Rect* destRects,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t flipCount,
+            CanvasSpriteFlip* flips) override;
+
+        IFACEMETHODIMP DrawManyWithTransforms(
+            ICanvasBitmap* bitmap,
+            uint32_t transformCount,
+            Matrix3x2* transforms,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t flipCount,
+            CanvasSpriteFlip* flips) override;
+
+        IFACEMETHODIMP DrawManyFromSpriteSheetAtOffsets(
+            ICanvasBitmap* bitmap,
+            uint32_t offsetCount,
+            Vector2* offsets,
+            uint32_t sourceRectCount,
+            Rect* sourceRects,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t flipCount,
+            CanvasSpriteFlip* flips) override;
+
+        IFACEMETHODIMP DrawManyFromSpriteSheetToRects(
+            ICanvasBitmap* bitmap,
+            uint32_t destRectCount,
+            Rect* destRects,
+            uint32_t sourceRectCount,
+            Rect* sourceRects,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t flipCount,
+            CanvasSpriteFlip* flips) override;
+
+        IFACEMETHODIMP DrawManyFromSpriteSheetWithTransforms(
+            ICanvasBitmap* bitmap,
+            uint32_t transformCount,
+            Matrix3x2* transforms,
+            uint32_t sourceRectCount,
+            Rect* sourceRects,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t flipCount,
+            CanvasSpriteFlip* flips) override;
+
+        IFACEMETHODIMP get_Statistics(
+            CanvasSpriteBatchStatistics* value) override;
+
         //
         // IClosable
         //
@@ -216,6 +310,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     private:
         void EnsureNotClosed();
+
+        BitmapInfo const& GetBitmapInfo(ICanvasBitmap* bitmap);
     };
 
 } } } }
@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Remembers the device context state that a drawing session last set or
+    // read, so that setting a property to the value it already has does not
+    // call into Direct2D.
+    //
+    // This is only valid while the drawing session is the only thing that can
+    // change the device context's state (anything else that changes it
+    // temporarily, such as ink, must restore it afterwards).  Sprite batches
+    // created by the session share its cache, and make their changes through
+    // it.
+    // Once the device context has been handed out through interop the cache
+    // is disabled for the rest of the session.
+    //
+    class DeviceContextStateCache
+    {
+        template<typename T>
+        class ShadowValue
+        {
+            bool m_isKnown;
+            T m_value;
+
+        public:
+            ShadowValue()
+                : m_isKnown(false)
+                , m_value{}
+            {
+            }
+
+            // Compared bitwise, so that values that only differ in the sign
+            // of zero are not considered the same.
+            bool Matches(T const& value) const
+            {
+                return m_isKnown && memcmp(&m_value, &value, sizeof(T)) == 0;
+            }
+
+            bool IsKnown() const
+            {
+                return m_isKnown;
+            }
+
+            T const& Get() const
+            {
+                return m_value;
+            }
+
+            void Set(T const& value)
+            {
+                m_isKnown = true;
+                m_value = value;
+            }
+
+            void Reset()
+            {
+                m_isKnown = false;
+            }
+        };
+
+        bool m_isEnabled;
+
+        ShadowValue<D2D1_ANTIALIAS_MODE> m_antialiasMode;
+        ShadowValue<D2D1_PRIMITIVE_BLEND> m_primitiveBlend;
+        ShadowValue<D2D1_TEXT_ANTIALIAS_MODE> m_textAntialiasMode;
+        ShadowValue<D2D1_UNIT_MODE> m_unitMode;
+        ShadowValue<D2D1_MATRIX_3X2_F> m_transform;
+
+        CanvasStateChangeStatistics m_statistics;
+
+    public:
+        DeviceContextStateCache()
+            : m_isEnabled(false)
+            , m_statistics{}
+        {
+        }
+
+        void Enable()
+        {
+            m_isEnabled = true;
+        }
+
+        void Disable()
+        {
+            m_isEnabled = false;
+
+            m_antialiasMode.Reset();
+            m_primitiveBlend.Reset();
+            m_textAntialiasMode.Reset();
+            m_unitMode.Reset();
+            m_transform.Reset();
+        }
+
+        CanvasStateChangeStatistics const& GetStatistics() const
+        {
+            return m_statistics;
+        }
+
+        //
+        // Each Set method only calls the device context if the value differs
+        // from the one the cache knows about.  The On*Read methods record
+        // values that the drawing session read back from the device context.
+        //
+
+        void SetAntialiasMode(ID2D1DeviceContext1* deviceContext, D2D1_ANTIALIAS_MODE value)
+        {
+            if (SetValue(m_antialiasMode, value, &m_statistics.AntialiasingChangesAvoided))
+                deviceContext->SetAntialiasMode(value);
+        }
+
+        void OnAntialiasModeRead(D2D1_ANTIALIAS_MODE value)
+        {
+            Remember(m_antialiasMode, value);
+        }
+
+        // Only reads from the device context if the value is not known.
+        D2D1_ANTIALIAS_MODE GetAntialiasMode(ID2D1DeviceContext1* deviceContext)
+        {
+            return GetValue(m_antialiasMode, [=] { return deviceContext->GetAntialiasMode(); });
+        }
+
+        void SetPrimitiveBlend(ID2D1DeviceContext1* deviceContext, D2D1_PRIMITIVE_BLEND value)
+        {
+            if (SetValue(m_primitiveBlend, value, &m_statistics.BlendChangesAvoided))
+                deviceContext->SetPrimitiveBlend(value);
+        }
+
+        void OnPrimitiveBlendRead(D2D1_PRIMITIVE_BLEND value)
+        {
+            Remember(m_primitiveBlend, value);
+        }
+
+        void SetTextAntialiasMode(ID2D1DeviceContext1* deviceContext, D2D1_TEXT_ANTIALIAS_MODE value)
+        {
+            if (SetValue(m_textAntialiasMode, value, &m_statistics.TextAntialiasingChangesAvoided))
+                deviceContext->SetTextAntialiasMode(value);
+        }
+
+        void OnTextAntialiasModeRead(D2D1_TEXT_ANTIALIAS_MODE value)
+        {
+            Remember(m_textAntialiasMode, value);
+        }
+
+        void SetTransform(ID2D1DeviceContext1* deviceContext, D2D1_MATRIX_3X2_F const& value)
+        {
+            if (SetValue(m_transform, value, &m_statistics.TransformChangesAvoided))
+                deviceContext->SetTransform(value);
+        }
+
+        void OnTransformRead(D2D1_MATRIX_3X2_F const& value)
+        {
+            Remember(m_transform, value);
+        }
+
+        // Returns true if the unit mode is already known to be value, in which
+        // case the caller can skip changing it (and fixing up the transform).
+        bool IsUnitModeAlready(D2D1_UNIT_MODE value)
+        {
+            if (!m_isEnabled || !m_unitMode.Matches(value))
+                return false;
+
+            m_statistics.UnitsChangesAvoided++;
+            return true;
+        }
+
+        void SetUnitMode(ID2D1DeviceContext1* deviceContext, D2D1_UNIT_MODE value)
+        {
+            deviceContext->SetUnitMode(value);
+            Remember(m_unitMode, value);
+        }
+
+        void OnUnitModeRead(D2D1_UNIT_MODE value)
+        {
+            Remember(m_unitMode, value);
+        }
+
+        // Only reads from the device context if the value is not known.
+        D2D1_UNIT_MODE GetUnitMode(ID2D1DeviceContext1* deviceContext)
+        {
+            return GetValue(m_unitMode, [=] { return deviceContext->GetUnitMode(); });
+        }
+
+    private:
+        // Returns true if the device context needs to be updated.
+        template<typename T>
+        bool SetValue(ShadowValue<T>& shadow, T const& value, uint32_t* avoidedCount)
+        {
+            if (!m_isEnabled)
+                return true;
+
+            if (shadow.Matches(value))
+            {
+                (*avoidedCount)++;
+                return false;
+            }
+
+            shadow.Set(value);
+            return true;
+        }
+
+        template<typename T>
+        void Remember(ShadowValue<T>& shadow, T const& value)
+        {
+            if (m_isEnabled)
+                shadow.Set(value);
+        }
+
+        template<typename T, typename FN>
+        T GetValue(ShadowValue<T>& shadow, FN&& read)
+        {
+            if (m_isEnabled && shadow.IsKnown())
+                return shadow.Get();
+
+            auto value = read();
+            Remember(shadow, value);
+            return value;
+        }
+    };
+}}}}
@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/PerformanceTimer.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    // The groups of drawing session calls that are profiled separately.
+    enum class DrawingSessionCallFamily
+    {
+        DrawImage,
+        DrawText,
+        Geometry,
+        EffectRealization,
+        Layer,
+        Flush,
+
+        Count
+    };
+
+
+    //
+    // Brackets drawing session calls with ETW start/stop events, and, when
+    // statistics collection is enabled, counts and times them.  The timer is
+    // only read while collection is enabled.
+    //
+    // Calls often go through several layers that each start a profile for the
+    // same family (for instance FillRectangleWithColor calls FillRectangleImpl).
+    // Only the outermost one is counted, so each API call is reported once.
+    // Different families may nest, in which case the inner time is also
+    // included in the outer one (eg. effect realization within DrawImage).
+    //
+    class DrawingSessionProfiler
+    {
+        bool m_isEnabled;
+        uint32_t m_depth[static_cast<int>(DrawingSessionCallFamily::Count)];
+        CanvasDrawingSessionStatistics m_statistics;
+
+    public:
+        class Scope
+        {
+            DrawingSessionProfiler* m_profiler;
+            DrawingSessionCallFamily m_family;
+            bool m_isOutermost;
+            bool m_isTimed;
+            PerformanceTimer m_timer;
+
+        public:
+            Scope(DrawingSessionProfiler* profiler, DrawingSessionCallFamily family)
+                : m_profiler(profiler)
+                , m_family(family)
+                , m_isOutermost(profiler->m_depth[static_cast<int>(family)]++ == 0)
+                , m_isTimed(m_isOutermost && profiler->m_isEnabled)
+                , m_timer(m_isTimed)
+            {
+                if (m_isOutermost)
+                    WriteStartEvent(m_family);
+            }
+
+            Scope(Scope&& other)
+                : m_profiler(other.m_profiler)
+                , m_family(other.m_family)
+                , m_isOutermost(other.m_isOutermost)
+                , m_isTimed(other.m_isTimed)
+                , m_timer(other.m_timer)
+            {
+                other.m_profiler = nullptr;
+            }
+
+            ~Scope()
+            {
+                if (!m_profiler)
+                    return;
+
+                m_profiler->m_depth[static_cast<int>(m_family)]--;
+
+                if (!m_isOutermost)
+                    return;
+
+                if (m_isTimed)
+                    m_profiler->Record(m_family, m_timer.GetElapsedTicks());
+
+                WriteStopEvent(m_family);
+            }
+
+            Scope(Scope const&) = delete;
+            Scope& operator=(Scope const&) = delete;
+        };
+
+        DrawingSessionProfiler()
+            : m_isEnabled(false)
+            , m_depth{}
+            , m_statistics{}
+        {
+        }
+
+        Scope Profile(DrawingSessionCallFamily family)
+        {
+            return Scope(this, family);
+        }
+
+        bool IsEnabled() const
+        {
+            return m_isEnabled;
+        }
+
+        void SetEnabled(bool value)
+        {
+            m_isEnabled = value;
+        }
+
+        CanvasDrawingSessionStatistics const& GetStatistics() const
+        {
+            return m_statistics;
+        }
+
+        void WriteStatisticsEvent() const
+        {
+            EventWrite_CanvasDrawingSession_Statistics(
+                m_statistics.DrawImageCount,
+                m_statistics.DrawImageTime.Duration,
+                m_statistics.DrawTextCount,
+                m_statistics.DrawTextTime.Duration,
+                m_statistics.GeometryCount,
+                m_statistics.GeometryTime.Duration,
+                m_statistics.EffectRealizationCount,
+                m_statistics.EffectRealizationTime.Duration,
+                m_statistics.LayerCount,
+                m_statistics.LayerTime.Duration,
+                m_statistics.FlushCount,
+                m_statistics.FlushTime.Duration);
+        }
+
+    private:
+        void Record(DrawingSessionCallFamily family, int64_t ticks)
+        {
+            switch (family)
+            {
+            case DrawingSessionCallFamily::DrawImage:
+                m_statistics.DrawImageCount++;
+                m_statistics.DrawImageTime.Duration += ticks;
+                break;
+
+            case DrawingSessionCallFamily::DrawText:
+                m_statistics.DrawTextCount++;
+                m_statistics.DrawTextTime.Duration += ticks;
+                break;
+
+            case DrawingSessionCallFamily::Geometry:
+                m_statistics.GeometryCount++;
+                m_statistics.GeometryTime.Duration += ticks;
+                break;
+
+            case DrawingSessionCallFamily::EffectRealization:
+                m_statistics.EffectRealizationCount++;
+                m_statistics.EffectRealizationTime.Duration += ticks;
+                break;
+
+            case DrawingSessionCallFamily::Layer:
+                m_statistics.LayerCount++;
+                m_statistics.LayerTime.Duration += ticks;
+                break;
+
+            case DrawingSessionCallFamily::Flush:
+                m_statistics.FlushCount++;
+                m_statistics.FlushTime.Duration += ticks;
+                break;
+
+            default:
+                assert(false);
+            }
+        }
+
+        static void WriteStartEvent(DrawingSessionCallFamily family)
+        {
+            switch (family)
+            {
+            case DrawingSessionCallFamily::DrawImage:         EventWrite_CanvasDrawingSession_DrawImage_Start();         break;
+            case DrawingSessionCallFamily::DrawText:          EventWrite_CanvasDrawingSession_DrawText_Start();          break;
+            case DrawingSessionCallFamily::Geometry:          EventWrite_CanvasDrawingSession_Geometry_Start();          break;
+            case DrawingSessionCallFamily::EffectRealization: EventWrite_CanvasDrawingSession_EffectRealization_Start(); break;
+            case DrawingSessionCallFamily::Layer:             EventWrite_CanvasDrawingSession_Layer_Start();             break;
+            case DrawingSessionCallFamily::Flush:             EventWrite_CanvasDrawingSession_Flush_Start();             break;
+            default:                                          assert(false);
+            }
+        }
+
+        static void WriteStopEvent(DrawingSessionCallFamily family)
+        {
+            switch (family)
+            {
+            case DrawingSessionCallFamily::DrawImage:         EventWrite_CanvasDrawingSession_DrawImage_Stop();         break;
+            case DrawingSessionCallFamily::DrawText:          EventWrite_CanvasDrawingSession_DrawText_Stop();          break;
+            case DrawingSessionCallFamily::Geometry:          EventWrite_CanvasDrawingSession_Geometry_Stop();          break;
+            case DrawingSessionCallFamily::EffectRealization: EventWrite_CanvasDrawingSession_EffectRealization_Stop(); break;
+            case DrawingSessionCallFamily::Layer:             EventWrite_CanvasDrawingSession_Layer_Stop();             break;
+            case DrawingSessionCallFamily::Flush:             EventWrite_CanvasDrawingSession_Flush_Stop();             break;
+            default:                                          assert(false);
+            }
+        }
+    };
+}}}}
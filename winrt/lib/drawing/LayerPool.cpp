@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "LayerPool.h"
+#include "utils/LockUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+
+static uint32_t RoundUpToBucketSize(float value)
+{
+    uint32_t size = LayerPool::MinimumBucketSize;
+
+    while (size < value && size < LayerPool::MaximumBucketSize)
+        size *= 2;
+
+    return size;
+}
+
+
+LayerPool::LayerPool()
+    : m_maximumBytes(0)
+    , m_sizeInBytes(0)
+    , m_statistics{}
+{
+}
+
+
+bool LayerPool::IsEnabled()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumBytes > 0;
+}
+
+
+bool LayerPool::TryGetBucket(D2D1_RECT_F const& contentBounds, LayerPoolBucket* bucket)
+{
+    auto width = contentBounds.right - contentBounds.left;
+    auto height = contentBounds.bottom - contentBounds.top;
+
+    if (!isfinite(width) || !isfinite(height))
+        return false;
+
+    bucket->Width = RoundUpToBucketSize(width);
+    bucket->Height = RoundUpToBucketSize(height);
+
+    return true;
+}
+
+
+ComPtr<ID2D1Layer> LayerPool::Acquire(ID2D1DeviceContext* deviceContext, LayerPoolBucket const& bucket)
+{
+    {
+        Lock lock(m_mutex);
+
+        for (auto it = m_idleLayers.begin(); it != m_idleLayers.end(); ++it)
+        {
+            if (it->Bucket == bucket)
+            {
+                auto layer = std::move(it->Layer);
+
+                m_idleLayers.erase(it);
+                m_sizeInBytes -= EstimateSizeInBytes(bucket);
+                m_statistics.ReuseCount++;
+
+                return layer;
+            }
+        }
+    }
+
+    // The size is only a hint; Direct2D grows the layer if it needs to.
+    D2D1_SIZE_F size{ static_cast<float>(bucket.Width), static_cast<float>(bucket.Height) };
+
+    ComPtr<ID2D1Layer> layer;
+    ThrowIfFailed(deviceContext->CreateLayer(&size, &layer));
+
+    Lock lock(m_mutex);
+    m_statistics.CreateCount++;
+
+    return layer;
+}
+
+
+void LayerPool::Release(LayerPoolBucket const& bucket, ComPtr<ID2D1Layer>&& layer)
+{
+    Lock lock(m_mutex);
+
+    m_idleLayers.push_front(Entry{ bucket, std::move(layer) });
+    m_sizeInBytes += EstimateSizeInBytes(bucket);
+
+    TrimToBudget();
+}
+
+
+uint64_t LayerPool::GetMaximumBytes()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumBytes;
+}
+
+
+void LayerPool::SetMaximumBytes(uint64_t value)
+{
+    Lock lock(m_mutex);
+
+    m_maximumBytes = value;
+    TrimToBudget();
+}
+
+
+CanvasLayerPoolStatistics LayerPool::GetStatistics()
+{
+    Lock lock(m_mutex);
+
+    auto statistics = m_statistics;
+    statistics.IdleLayerCount = static_cast<uint32_t>(m_idleLayers.size());
+    statistics.SizeInBytes = m_sizeInBytes;
+
+    return statistics;
+}
+
+
+void LayerPool::Clear()
+{
+    Lock lock(m_mutex);
+
+    m_idleLayers.clear();
+    m_sizeInBytes = 0;
+}
+
+
+void LayerPool::TrimToBudget()
+{
+    while (!m_idleLayers.empty() && m_sizeInBytes > m_maximumBytes)
+    {
+        m_sizeInBytes -= EstimateSizeInBytes(m_idleLayers.back().Bucket);
+        m_idleLayers.pop_back();
+        m_statistics.EvictionCount++;
+    }
+}
+
+
+uint64_t LayerPool::EstimateSizeInBytes(LayerPoolBucket const& bucket)
+{
+    // Direct2D doesn't report how much memory a layer uses.  This assumes
+    // a 32 bit per pixel surface the size of the bucket.
+    uint64_t const BytesPerPixel = 4;
+
+    return static_cast<uint64_t>(bucket.Width) * bucket.Height * BytesPerPixel;
+}
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ::Microsoft::WRL;
+
+    //
+    // Layers are pooled by the size of their content, rounded up to a power
+    // of two so that layers of similar sizes can share.
+    //
+    struct LayerPoolBucket
+    {
+        uint32_t Width;
+        uint32_t Height;
+
+        bool operator==(LayerPoolBucket const& other) const
+        {
+            return Width == other.Width && Height == other.Height;
+        }
+    };
+
+
+    //
+    // A device-level pool of the ID2D1Layer objects that CreateLayer pushes,
+    // so that layers created every frame reuse the intermediate surfaces of
+    // earlier ones rather than Direct2D allocating new ones.
+    //
+    // Layers are created from one device context but can be used by any
+    // device context of the same device.  A layer is taken out of the pool
+    // while it is pushed, so it is never used by two drawing sessions at once.
+    //
+    // The pool is bounded by an estimate of the memory used by its idle
+    // layers, and is disabled while this budget is zero, which is the default.
+    //
+    class LayerPool
+    {
+        struct Entry
+        {
+            LayerPoolBucket Bucket;
+            ComPtr<ID2D1Layer> Layer;
+        };
+
+        std::mutex m_mutex;
+        std::list<Entry> m_idleLayers;    // Most recently released first
+
+        uint64_t m_maximumBytes;
+        uint64_t m_sizeInBytes;
+        CanvasLayerPoolStatistics m_statistics;
+
+    public:
+        static uint32_t const MinimumBucketSize = 64;
+        static uint32_t const MaximumBucketSize = 16384;
+
+        LayerPool();
+
+        bool IsEnabled();
+
+        //
+        // Works out which bucket a layer whose content has the specified
+        // bounds belongs in.  Returns false if the bounds are not finite.
+        //
+        static bool TryGetBucket(D2D1_RECT_F const& contentBounds, LayerPoolBucket* bucket);
+
+        //
+        // Returns an idle layer from the bucket, or creates a new one using
+        // deviceContext.  The layer should be returned with Release once it
+        // has been popped.
+        //
+        ComPtr<ID2D1Layer> Acquire(ID2D1DeviceContext* deviceContext, LayerPoolBucket const& bucket);
+
+        void Release(LayerPoolBucket const& bucket, ComPtr<ID2D1Layer>&& layer);
+
+        uint64_t GetMaximumBytes();
+        void SetMaximumBytes(uint64_t value);
+
+        CanvasLayerPoolStatistics GetStatistics();
+
+        void Clear();
+
+    private:
+        void TrimToBudget();
+
+        static uint64_t EstimateSizeInBytes(LayerPoolBucket const& bucket);
+    };
+}}}}
@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "VisibilityCuller.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+
+// Antialiasing can touch pixels just outside the geometric bounds of a shape.
+static const float AntialiasingMargin = 1.0f;
+
+
+static bool IsInfinite(D2D1_RECT_F const& rect)
+{
+    auto infinite = D2D1::InfiniteRect();
+
+    return rect.left <= infinite.left &&
+           rect.top <= infinite.top &&
+           rect.right >= infinite.right &&
+           rect.bottom >= infinite.bottom;
+}
+
+
+static D2D1_RECT_F Intersect(D2D1_RECT_F const& a, D2D1_RECT_F const& b)
+{
+    return D2D1_RECT_F
+    {
+        std::max(a.left, b.left),
+        std::max(a.top, b.top),
+        std::min(a.right, b.right),
+        std::min(a.bottom, b.bottom)
+    };
+}
+
+
+// Written so that NaN bounds are never considered to be outside.
+static bool IsOutside(D2D1_RECT_F const& bounds, D2D1_RECT_F const& visibleBounds)
+{
+    return bounds.right < visibleBounds.left ||
+           bounds.bottom < visibleBounds.top ||
+           bounds.left > visibleBounds.right ||
+           bounds.top > visibleBounds.bottom;
+}
+
+
+VisibilityCuller::VisibilityCuller()
+    : m_isEnabled(false)
+    , m_dipsToPixels(1.0f)
+    , m_targetBounds(D2D1::InfiniteRect())
+    , m_culledDrawCount(0)
+{
+}
+
+
+void VisibilityCuller::Enable(ID2D1DeviceContext1* deviceContext)
+{
+    float dpiX, dpiY;
+    deviceContext->GetDpi(&dpiX, &dpiY);
+
+    m_dipsToPixels = dpiX / DEFAULT_DPI;
+
+    // Only bitmap targets have a known size.  Command lists can grow to any
+    // size, so nothing is culled against them.
+    m_targetBounds = D2D1::InfiniteRect();
+
+    ComPtr<ID2D1Image> target;
+    deviceContext->GetTarget(&target);
+
+    if (auto bitmap = MaybeAs<ID2D1Bitmap>(target))
+    {
+        auto size = bitmap->GetPixelSize();
+        m_targetBounds = D2D1_RECT_F{ 0, 0, static_cast<float>(size.width), static_cast<float>(size.height) };
+    }
+
+    m_isEnabled = true;
+}
+
+
+void VisibilityCuller::Disable()
+{
+    m_isEnabled = false;
+}
+
+
+void VisibilityCuller::PushClip(
+    ID2D1DeviceContext1* deviceContext,
+    D2D1_RECT_F const* clipRectangle,
+    ID2D1Geometry* clipGeometry,
+    D2D1_MATRIX_3X2_F const& geometryTransform)
+{
+    auto clipBounds = GetVisibleBounds();
+
+    if (m_isEnabled)
+    {
+        if (clipRectangle && !IsInfinite(*clipRectangle))
+        {
+            clipBounds = Intersect(clipBounds, ToTargetPixels(deviceContext, *clipRectangle));
+        }
+
+        if (clipGeometry)
+        {
+            D2D1_RECT_F geometryBounds;
+            ThrowIfFailed(clipGeometry->GetBounds(&geometryTransform, &geometryBounds));
+
+            clipBounds = Intersect(clipBounds, ToTargetPixels(deviceContext, geometryBounds));
+        }
+    }
+
+    m_clipStack.push_back(clipBounds);
+}
+
+
+void VisibilityCuller::PopClip()
+{
+    assert(!m_clipStack.empty());
+
+    m_clipStack.pop_back();
+}
+
+
+bool VisibilityCuller::IsVisible(ID2D1DeviceContext1* deviceContext, D2D1_RECT_F const& bounds)
+{
+    if (!m_isEnabled)
+        return true;
+
+    auto& visibleBounds = GetVisibleBounds();
+
+    if (IsInfinite(visibleBounds))
+        return true;
+
+    auto targetBounds = ToTargetPixels(deviceContext, bounds);
+
+    if (!IsOutside(targetBounds, visibleBounds))
+        return true;
+
+    m_culledDrawCount++;
+    return false;
+}
+
+
+D2D1_RECT_F const& VisibilityCuller::GetVisibleBounds() const
+{
+    return m_clipStack.empty() ? m_targetBounds : m_clipStack.back();
+}
+
+
+D2D1_RECT_F VisibilityCuller::ToTargetPixels(ID2D1DeviceContext1* deviceContext, D2D1_RECT_F const& bounds) const
+{
+    D2D1::Matrix3x2F transform;
+    deviceContext->GetTransform(&transform);
+
+    if (deviceContext->GetUnitMode() == D2D1_UNIT_MODE_DIPS)
+        transform = transform * D2D1::Matrix3x2F::Scale(m_dipsToPixels, m_dipsToPixels);
+
+    D2D1_POINT_2F corners[] =
+    {
+        transform.TransformPoint(D2D1_POINT_2F{ bounds.left,  bounds.top }),
+        transform.TransformPoint(D2D1_POINT_2F{ bounds.right, bounds.top }),
+        transform.TransformPoint(D2D1_POINT_2F{ bounds.left,  bounds.bottom }),
+        transform.TransformPoint(D2D1_POINT_2F{ bounds.right, bounds.bottom }),
+    };
+
+    D2D1_RECT_F result{ corners[0].x, corners[0].y, corners[0].x, corners[0].y };
+
+    for (auto& corner : corners)
+    {
+        if (isnan(corner.x) || isnan(corner.y))
+            return D2D1::InfiniteRect();
+
+        result.left   = std::min(result.left,   corner.x);
+        result.top    = std::min(result.top,    corner.y);
+        result.right  = std::max(result.right,  corner.x);
+        result.bottom = std::max(result.bottom, corner.y);
+    }
+
+    result.left   -= AntialiasingMargin;
+    result.top    -= AntialiasingMargin;
+    result.right  += AntialiasingMargin;
+    result.bottom += AntialiasingMargin;
+
+    return result;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Decides whether a drawing call could affect any visible pixels, so that
+    // draws that fall entirely outside the render target or the current layer
+    // clips can be skipped without calling Direct2D.
+    //
+    // All bounds are tracked in render target pixels, so they stay valid when
+    // the transform or unit mode changes.  Bounds are always conservative: if
+    // there is any doubt, a draw is considered visible.
+    //
+    // A clip is pushed for every layer, even while culling is disabled, so that
+    // the clip stack always matches the layers that are active.  Layers pushed
+    // while culling is disabled are treated as not clipping anything.
+    //
+    class VisibilityCuller
+    {
+        bool m_isEnabled;
+        float m_dipsToPixels;
+        D2D1_RECT_F m_targetBounds;
+        std::vector<D2D1_RECT_F> m_clipStack;  // Each entry is already intersected with its parent
+
+        uint32_t m_culledDrawCount;
+
+    public:
+        VisibilityCuller();
+
+        bool IsEnabled() const
+        {
+            return m_isEnabled;
+        }
+
+        void Enable(ID2D1DeviceContext1* deviceContext);
+        void Disable();
+
+        uint32_t GetCulledDrawCount() const
+        {
+            return m_culledDrawCount;
+        }
+
+        //
+        // The clip rectangle and geometry are as passed to PushLayer, in the
+        // current coordinate space of the device context.  Either may be null.
+        //
+        void PushClip(
+            ID2D1DeviceContext1* deviceContext,
+            D2D1_RECT_F const* clipRectangle,
+            ID2D1Geometry* clipGeometry,
+            D2D1_MATRIX_3X2_F const& geometryTransform);
+
+        void PopClip();
+
+        //
+        // Returns false, and counts the draw as culled, if something with the
+        // given bounds (in the current coordinate space of the device context)
+        // cannot be visible.
+        //
+        bool IsVisible(ID2D1DeviceContext1* deviceContext, D2D1_RECT_F const& bounds);
+
+    private:
+        D2D1_RECT_F const& GetVisibleBounds() const;
+
+        D2D1_RECT_F ToTargetPixels(ID2D1DeviceContext1* deviceContext, D2D1_RECT_F const& bounds) const;
+    };
+}}}}
@@ -4,6 +4,7 @@
 
 #include "pch.h"
 #include "CanvasCachedGeometry.h"
+#include "utils/LockUtilities.h"
 
 using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
 using namespace ABI::Microsoft::Graphics::Canvas;
@@ -107,12 +108,23 @@ CanvasCachedGeometry::CanvasCachedGeometry(
     ID2D1GeometryRealization* d2dGeometryRealization)
     : ResourceWrapper(d2dGeometryRealization)
     , m_canvasDevice(device)
+    , m_isStroke(false)
+    , m_strokeWidth(0)
+    , m_flatteningTolerance(D2D1_DEFAULT_FLATTENING_TOLERANCE)
+    , m_hasBounds(false)
+    , m_bounds{}
 {
 
 }
 
 IFACEMETHODIMP CanvasCachedGeometry::Close()
 {
+    {
+        Lock lock(m_boundsMutex);
+        m_sourceGeometry.Reset();
+        m_strokeStyle.Reset();
+    }
+
     m_canvasDevice.Close();
     return ResourceWrapper::Close();
 }
@@ -128,6 +140,28 @@ IFACEMETHODIMP CanvasCachedGeometry::get_Device(ICanvasDevice** device)
         });
 }
 
+bool CanvasCachedGeometry::TryGetBounds(D2D1_RECT_F* bounds)
+{
+    Lock lock(m_boundsMutex);
+
+    if (!m_hasBounds && m_sourceGeometry)
+    {
+        if (m_isStroke)
+            ThrowIfFailed(m_sourceGeometry->GetWidenedBounds(m_strokeWidth, m_strokeStyle.Get(), nullptr, m_flatteningTolerance, &m_bounds));
+        else
+            ThrowIfFailed(m_sourceGeometry->GetBounds(nullptr, &m_bounds));
+
+        m_hasBounds = true;
+
+        // The bounds never change, so there is no need to keep these alive.
+        m_sourceGeometry.Reset();
+        m_strokeStyle.Reset();
+    }
+
+    *bounds = m_bounds;
+    return m_hasBounds;
+}
+
 // Cached fills
 ComPtr<CanvasCachedGeometry> CanvasCachedGeometry::CreateNew(
     ICanvasDevice* device,
@@ -141,13 +175,27 @@ ComPtr<CanvasCachedGeometry> CanvasCachedGeometry::CreateNew(
 
     auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
 
-    auto d2dGeometryRealization = deviceInternal->CreateFilledGeometryRealization(
+    auto createRealization = [&](float tolerance)
+    {
+        return deviceInternal->CreateFilledGeometryRealization(
+            d2dGeometry.Get(),
+            tolerance);
+    };
+
+    auto d2dGeometryRealization = deviceInternal->GetGeometryRealizationCache()->GetOrCreateFill(
         d2dGeometry.Get(),
-        flatteningTolerance);
+        flatteningTolerance,
+        createRealization);
+
+    if (!d2dGeometryRealization)
+        d2dGeometryRealization = createRealization(flatteningTolerance);
 
     auto canvasCachedGeometry = Make<CanvasCachedGeometry>(device, d2dGeometryRealization.Get());
     CheckMakeResult(canvasCachedGeometry);
 
+    canvasCachedGeometry->m_sourceGeometry = d2dGeometry;
+    canvasCachedGeometry->m_flatteningTolerance = flatteningTolerance;
+
     return canvasCachedGeometry;
 }
 
@@ -166,15 +214,36 @@ ComPtr<CanvasCachedGeometry> CanvasCachedGeometry::CreateNew(
 
     auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
 
-    auto d2dGeometryRealization = deviceInternal->CreateStrokedGeometryRealization(
+    auto d2dStrokeStyle = MaybeGetStrokeStyleResource(d2dGeometry.Get(), strokeStyle);
+
+    auto createRealization = [&](float tolerance)
+    {
+        return deviceInternal->CreateStrokedGeometryRealization(
+            d2dGeometry.Get(),
+            strokeWidth,
+            d2dStrokeStyle.Get(),
+            tolerance);
+    };
+
+    auto d2dGeometryRealization = deviceInternal->GetGeometryRealizationCache()->GetOrCreateStroke(
         d2dGeometry.Get(),
         strokeWidth,
-        MaybeGetStrokeStyleResource(d2dGeometry.Get(), strokeStyle).Get(),
-        flatteningTolerance);
+        strokeStyle,
+        flatteningTolerance,
+        createRealization);
+
+    if (!d2dGeometryRealization)
+        d2dGeometryRealization = createRealization(flatteningTolerance);
 
     auto canvasCachedGeometry = Make<CanvasCachedGeometry>(device, d2dGeometryRealization.Get());
     CheckMakeResult(canvasCachedGeometry);
 
+    canvasCachedGeometry->m_sourceGeometry = d2dGeometry;
+    canvasCachedGeometry->m_isStroke = true;
+    canvasCachedGeometry->m_strokeWidth = strokeWidth;
+    canvasCachedGeometry->m_strokeStyle = d2dStrokeStyle;
+    canvasCachedGeometry->m_flatteningTolerance = flatteningTolerance;
+
     return canvasCachedGeometry;
 }
 
@@ -8,16 +8,42 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 {
     using namespace ::Microsoft::WRL;
 
+    class __declspec(uuid("4B2E56A0-69AD-48E6-B067-6EFA2DC270AB"))
+    ICanvasCachedGeometryInternal : public IUnknown
+    {
+    public:
+        // Gets the bounds of what the cached geometry draws, before any
+        // transform is applied.  Returns false if they are not known, which is
+        // the case for cached geometries that were created through interop.
+        virtual bool TryGetBounds(D2D1_RECT_F* bounds) = 0;
+    };
+
     class CanvasCachedGeometry : RESOURCE_WRAPPER_RUNTIME_CLASS(
         ID2D1GeometryRealization,
         CanvasCachedGeometry,
         ICanvasCachedGeometry,
-        CloakedIid<ICanvasResourceWrapperWithDevice>)
+        CloakedIid<ICanvasResourceWrapperWithDevice>,
+        CloakedIid<ICanvasCachedGeometryInternal>)
     {
         InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasCachedGeometry, BaseTrust);
 
         ClosablePtr<ICanvasDevice> m_canvasDevice;
 
+        //
+        // Geometry realizations don't know their bounds, so the source
+        // geometry is kept until they are first asked for.  Most cached
+        // geometries are never drawn with culling enabled, so this avoids
+        // computing bounds that nobody needs.
+        //
+        std::mutex m_boundsMutex;
+        ComPtr<ID2D1Geometry> m_sourceGeometry;
+        bool m_isStroke;
+        float m_strokeWidth;
+        ComPtr<ID2D1StrokeStyle> m_strokeStyle;
+        float m_flatteningTolerance;
+        bool m_hasBounds;
+        D2D1_RECT_F m_bounds;
+
     public:
         // Cached fills
         static ComPtr<CanvasCachedGeometry> CreateNew(
@@ -40,6 +66,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         IFACEMETHOD(Close)();
 
         IFACEMETHOD(get_Device)(ICanvasDevice** device);
+
+        // ICanvasCachedGeometryInternal
+        virtual bool TryGetBounds(D2D1_RECT_F* bounds) override;
     };
 
 
@@ -6,7 +6,12 @@
 
 #include "CanvasGeometry.h"
 #include "CanvasPathBuilder.h"
+#include "CpuTessellator.h"
+#include "GeometryCombiner.h"
 #include "GeometrySink.h"
+#include "PathData.h"
+#include "PolylineDecimation.h"
+#include "SvgPathParser.h"
 #include "TessellationSink.h"
 #include "../images/CanvasCommandList.h"
 #include "../text/DrawGlyphRunHelper.h"
@@ -143,6 +148,73 @@ IFACEMETHODIMP CanvasGeometryFactory::CreatePath(
     });
 }
 
+IFACEMETHODIMP CanvasGeometryFactory::CreatePathFromBytes(
+    ICanvasResourceCreator* resourceCreator,
+    uint32_t byteCount,
+    uint8_t* bytes,
+    ICanvasGeometry** geometry)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckInPointer(bytes);
+            CheckAndClearOutPointer(geometry);
+
+            auto newCanvasGeometry = CanvasGeometry::CreateFromPathBytes(resourceCreator, byteCount, bytes);
+
+            ThrowIfFailed(newCanvasGeometry.CopyTo(geometry));
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::CreatePathFromFile(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING fileName,
+    ICanvasGeometry** geometry)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckAndClearOutPointer(geometry);
+
+            auto newCanvasGeometry = CanvasGeometry::CreateFromPathFile(resourceCreator, fileName);
+
+            ThrowIfFailed(newCanvasGeometry.CopyTo(geometry));
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::CreatePathFromSvgPathData(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING pathData,
+    ICanvasGeometry** geometry)
+{
+    // SVG fills paths using the nonzero rule by default.
+    return CreatePathFromSvgPathDataWithFilledRegionDetermination(
+        resourceCreator,
+        pathData,
+        CanvasFilledRegionDetermination::Winding,
+        geometry);
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::CreatePathFromSvgPathDataWithFilledRegionDetermination(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING pathData,
+    CanvasFilledRegionDetermination filledRegionDetermination,
+    ICanvasGeometry** geometry)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckAndClearOutPointer(geometry);
+
+            auto newCanvasGeometry = CanvasGeometry::CreateFromSvgPathData(resourceCreator, pathData, filledRegionDetermination);
+
+            ThrowIfFailed(newCanvasGeometry.CopyTo(geometry));
+        });
+}
+
 IFACEMETHODIMP CanvasGeometryFactory::CreatePolygon(
     ICanvasResourceCreator* resourceCreator,
     uint32_t pointCount,
@@ -161,6 +233,46 @@ IFACEMETHODIMP CanvasGeometryFactory::CreatePolygon(
         });
 }
 
+IFACEMETHODIMP CanvasGeometryFactory::DecimatePoints(
+    uint32_t pointCount,
+    Numerics::Vector2* points,
+    float tolerance,
+    boolean isClosed,
+    uint32_t* valueCount,
+    Numerics::Vector2** valueElements)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            if (pointCount > 0)
+                CheckInPointer(points);
+
+            CheckInPointer(valueCount);
+            CheckAndClearOutPointer(valueElements);
+
+            if (!(tolerance >= 0))
+                ThrowHR(E_INVALIDARG);
+
+            std::vector<D2D1_POINT_2F> d2dPoints(pointCount);
+
+            for (uint32_t i = 0; i < pointCount; ++i)
+            {
+                d2dPoints[i] = ToD2DPoint(points[i]);
+            }
+
+            auto keptCount = DecimatePolyline(d2dPoints.data(), pointCount, !!isClosed, tolerance);
+
+            ComArray<Vector2> array(keptCount);
+
+            for (uint32_t i = 0; i < keptCount; ++i)
+            {
+                array[i] = Vector2{ d2dPoints[i].x, d2dPoints[i].y };
+            }
+
+            array.Detach(valueCount, valueElements);
+        });
+}
+
 IFACEMETHODIMP CanvasGeometryFactory::CreateGroup(
     ICanvasResourceCreator* resourceCreator,
     uint32_t geometryCount,
@@ -194,6 +306,42 @@ IFACEMETHODIMP CanvasGeometryFactory::CreateGroupWithFilledRegionDetermination(
         });
 }
 
+IFACEMETHODIMP CanvasGeometryFactory::CombineMany(
+    ICanvasResourceCreator* resourceCreator,
+    uint32_t geometryCount,
+    ICanvasGeometry** geometryElements,
+    CanvasGeometryCombine combine,
+    ICanvasGeometry** geometry)
+{
+    return CombineManyWithFlatteningTolerance(
+        resourceCreator,
+        geometryCount,
+        geometryElements,
+        combine,
+        D2D1_DEFAULT_FLATTENING_TOLERANCE,
+        geometry);
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::CombineManyWithFlatteningTolerance(
+    ICanvasResourceCreator* resourceCreator,
+    uint32_t geometryCount,
+    ICanvasGeometry** geometryElements,
+    CanvasGeometryCombine combine,
+    float flatteningTolerance,
+    ICanvasGeometry** geometry)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckAndClearOutPointer(geometry);
+
+            auto newCanvasGeometry = CanvasGeometry::CreateCombination(resourceCreator, geometryCount, geometryElements, combine, flatteningTolerance);
+
+            ThrowIfFailed(newCanvasGeometry.CopyTo(geometry));
+        });
+}
+
 IFACEMETHODIMP CanvasGeometryFactory::CreateText(
     ICanvasTextLayout* textLayout,
     ICanvasGeometry** geometry)
@@ -558,6 +706,59 @@ IFACEMETHODIMP CanvasGeometry::SimplifyWithTransformAndFlatteningTolerance(
         });
 }
 
+IFACEMETHODIMP CanvasGeometry::Decimate(
+    float tolerance,
+    ICanvasGeometry** geometry)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(geometry);
+
+            if (!(tolerance >= 0))
+                ThrowHR(E_INVALIDARG);
+
+            auto& resource = GetResource();
+
+            // Decimation bounds the distance from the flattened lines, and
+            // flattening adds its own error on curves, so the result is within
+            // tolerance plus the flattening tolerance of the original.  Curves
+            // are flattened no more coarsely than tolerance to keep that small.
+            float flatteningTolerance = D2D1_DEFAULT_FLATTENING_TOLERANCE;
+
+            if (tolerance > 0)
+                flatteningTolerance = std::min(tolerance, flatteningTolerance);
+
+            Polylines polylines;
+            PolylineSink::Flatten(resource.Get(), flatteningTolerance, &polylines);
+
+            DecimatePolylines(&polylines, tolerance);
+
+            auto temporaryPathBuilder = Make<CanvasPathBuilder>(m_canvasDevice.EnsureNotClosed().Get());
+            CheckMakeResult(temporaryPathBuilder);
+            auto targetPathBuilderInternal = As<ICanvasPathBuilderInternal>(temporaryPathBuilder);
+
+            auto sink = targetPathBuilderInternal->GetGeometrySink();
+
+            sink->SetFillMode(polylines.FillMode);
+
+            for (auto& figure : polylines.Figures)
+            {
+                if (figure.End == figure.Begin)
+                    continue;
+
+                auto points = polylines.Points.data() + figure.Begin;
+
+                sink->BeginFigure(points[0], figure.IsFilled ? D2D1_FIGURE_BEGIN_FILLED : D2D1_FIGURE_BEGIN_HOLLOW);
+                sink->AddLines(points + 1, figure.End - figure.Begin - 1);
+                sink->EndFigure(figure.IsClosed ? D2D1_FIGURE_END_CLOSED : D2D1_FIGURE_END_OPEN);
+            }
+
+            auto newGeometry = CanvasGeometry::CreateNew(temporaryPathBuilder.Get());
+            ThrowIfFailed(newGeometry.CopyTo(geometry));
+        });
+}
+
 IFACEMETHODIMP CanvasGeometry::Transform(
     Numerics::Matrix3x2 transform,
     ICanvasGeometry** geometry)
@@ -975,6 +1176,49 @@ IFACEMETHODIMP CanvasGeometry::TessellateWithTransformAndFlatteningTolerance(
     float flatteningTolerance,
     UINT32* trianglesCount,
     CanvasTriangleVertices** triangles)
+{
+    return TessellateWithEngine(
+        transform,
+        flatteningTolerance,
+        CanvasTessellationEngine::Direct2D,
+        trianglesCount,
+        triangles);
+}
+
+static Vector2 TransformPoint(Vector2 const& point, D2D1_MATRIX_3X2_F const& transform)
+{
+    return Vector2
+    {
+        point.X * transform._11 + point.Y * transform._21 + transform._31,
+        point.X * transform._12 + point.Y * transform._22 + transform._32
+    };
+}
+
+//
+// Applies a transform to untransformed triangles from the geometry cache.
+// Transforms that mirror the geometry would reverse the winding, so these
+// swap two vertices to keep every triangle clockwise.
+//
+static void TransformTriangles(TriangleList const& triangles, D2D1_MATRIX_3X2_F const& transform, CanvasTriangleVertices* output)
+{
+    bool isMirrored = (transform._11 * transform._22 - transform._12 * transform._21) < 0;
+
+    for (size_t i = 0; i < triangles.size(); ++i)
+    {
+        auto& triangle = triangles[i];
+
+        output[i].Vertex1 = TransformPoint(triangle.Vertex1, transform);
+        output[i].Vertex2 = TransformPoint(isMirrored ? triangle.Vertex3 : triangle.Vertex2, transform);
+        output[i].Vertex3 = TransformPoint(isMirrored ? triangle.Vertex2 : triangle.Vertex3, transform);
+    }
+}
+
+IFACEMETHODIMP CanvasGeometry::TessellateWithEngine(
+    Matrix3x2 transform,
+    float flatteningTolerance,
+    CanvasTessellationEngine engine,
+    UINT32* trianglesCount,
+    CanvasTriangleVertices** triangles)
 {
     return ExceptionBoundary([&]
     {
@@ -983,16 +1227,112 @@ IFACEMETHODIMP CanvasGeometry::TessellateWithTransformAndFlatteningTolerance(
 
         auto& resource = GetResource();
 
-        auto tessellationSink = Make<TessellationSink>();
-        CheckMakeResult(tessellationSink);
+        auto d2dTransform = *ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform);
+
+        if (auto cachedTriangles = GetCachedTessellation(engine, d2dTransform, flatteningTolerance))
+        {
+            ComArray<CanvasTriangleVertices> outputArray(static_cast<uint32_t>(cachedTriangles->size()));
+            TransformTriangles(*cachedTriangles, d2dTransform, outputArray.GetData());
+            outputArray.Detach(trianglesCount, triangles);
+            return;
+        }
+
+        switch (engine)
+        {
+        case CanvasTessellationEngine::Direct2D:
+            {
+                auto tessellationSink = Make<TessellationSink>();
+                CheckMakeResult(tessellationSink);
 
-        ThrowIfFailed(resource->Tessellate(
-            ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform),
-            flatteningTolerance,
-            tessellationSink.Get()));
+                ThrowIfFailed(resource->Tessellate(
+                    ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform),
+                    flatteningTolerance,
+                    tessellationSink.Get()));
 
-        auto outputArray = tessellationSink->GetTriangles();
-        outputArray.Detach(trianglesCount, triangles);
+                tessellationSink->DetachTriangles(trianglesCount, triangles);
+            }
+            break;
+
+        case CanvasTessellationEngine::Cpu:
+            {
+                auto tessellator = Make<CpuTessellator>(*ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform), flatteningTolerance);
+                CheckMakeResult(tessellator);
+
+                StreamTo(resource.Get(), tessellator.Get());
+
+                auto result = tessellator->Tessellate();
+
+                ComArray<CanvasTriangleVertices> outputArray(result.begin(), result.end());
+                outputArray.Detach(trianglesCount, triangles);
+            }
+            break;
+
+        default:
+            ThrowHR(E_INVALIDARG);
+        }
+    });
+}
+
+IFACEMETHODIMP CanvasGeometry::TessellateToIndexedMesh(
+    Matrix3x2 transform,
+    float flatteningTolerance,
+    CanvasTessellationEngine engine,
+    CanvasIndexedMeshOptions options,
+    ICanvasIndexedMesh** mesh)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckAndClearOutPointer(mesh);
+
+        auto& resource = GetResource();
+
+        auto d2dTransform = *ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform);
+
+        IndexedMeshBuilder builder;
+
+        if (auto cachedTriangles = GetCachedTessellation(engine, d2dTransform, flatteningTolerance))
+        {
+            TriangleList transformedTriangles(cachedTriangles->size());
+            TransformTriangles(*cachedTriangles, d2dTransform, transformedTriangles.data());
+            builder.AddTriangles(transformedTriangles.data(), static_cast<uint32_t>(transformedTriangles.size()));
+        }
+        else
+        {
+            switch (engine)
+            {
+            case CanvasTessellationEngine::Direct2D:
+                {
+                    // The sink passes each batch of triangles straight to the
+                    // builder, so they are never collected into a separate list.
+                    auto tessellationSink = Make<TessellationSink>(&builder);
+                    CheckMakeResult(tessellationSink);
+
+                    ThrowIfFailed(resource->Tessellate(
+                        ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform),
+                        flatteningTolerance,
+                        tessellationSink.Get()));
+                }
+                break;
+
+            case CanvasTessellationEngine::Cpu:
+                {
+                    auto tessellator = Make<CpuTessellator>(*ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform), flatteningTolerance);
+                    CheckMakeResult(tessellator);
+
+                    StreamTo(resource.Get(), tessellator.Get());
+
+                    auto result = tessellator->Tessellate();
+
+                    builder.AddTriangles(result.data(), static_cast<uint32_t>(result.size()));
+                }
+                break;
+
+            default:
+                ThrowHR(E_INVALIDARG);
+            }
+        }
+
+        ThrowIfFailed(builder.CreateMesh(options).CopyTo(mesh));
     });
 }
 
@@ -1005,24 +1345,126 @@ IFACEMETHODIMP CanvasGeometry::SendPathTo(
 
         auto& resource = GetResource();
 
-        auto pathGeometry = MaybeAs<ID2D1PathGeometry>(resource);
-
         auto geometrySink = Make<GeometrySink>(streamReader);
         CheckMakeResult(geometrySink);
 
-        if (pathGeometry)
+        StreamTo(resource.Get(), geometrySink.Get());
+    });
+}
+
+IFACEMETHODIMP CanvasGeometry::GetPathBytes(
+    uint32_t* valueCount,
+    uint8_t** valueElements)
+{
+    return GetPathBytesWithQuantizationStep(0, valueCount, valueElements);
+}
+
+IFACEMETHODIMP CanvasGeometry::GetPathBytesWithQuantizationStep(
+    float quantizationStep,
+    uint32_t* valueCount,
+    uint8_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+
+        // Zero means points are stored as floats.
+        if (!(quantizationStep >= 0) || std::isinf(quantizationStep))
+            ThrowHR(E_INVALIDARG);
+
+        auto& resource = GetResource();
+
+        auto writer = Make<PathDataWriter>(quantizationStep);
+        CheckMakeResult(writer);
+
+        StreamTo(resource.Get(), writer.Get());
+
+        auto& data = writer->GetData();
+
+        ComArray<uint8_t> array(data.begin(), data.end());
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+std::shared_ptr<TriangleList const> CanvasGeometry::GetCachedTessellation(
+    CanvasTessellationEngine engine,
+    D2D1_MATRIX_3X2_F const& transform,
+    float flatteningTolerance)
+{
+    auto& resource = GetResource();
+    auto& device = m_canvasDevice.EnsureNotClosed();
+
+    auto cache = As<ICanvasDeviceInternal>(device)->GetGeometryRealizationCache();
+
+    return cache->GetOrCreateTessellation(
+        resource.Get(),
+        engine,
+        transform,
+        flatteningTolerance,
+        [&](float untransformedTolerance)
+        {
+            return TessellateToList(resource.Get(), engine, D2D1::Matrix3x2F::Identity(), untransformedTolerance);
+        });
+}
+
+TriangleList CanvasGeometry::TessellateToList(
+    ID2D1Geometry* d2dGeometry,
+    CanvasTessellationEngine engine,
+    D2D1_MATRIX_3X2_F const& transform,
+    float flatteningTolerance)
+{
+    switch (engine)
+    {
+    case CanvasTessellationEngine::Direct2D:
         {
-            ThrowIfFailed(pathGeometry->Stream(geometrySink.Get()));
+            auto tessellationSink = Make<TessellationSink>();
+            CheckMakeResult(tessellationSink);
+
+            ThrowIfFailed(d2dGeometry->Tessellate(&transform, flatteningTolerance, tessellationSink.Get()));
+
+            uint32_t trianglesCount;
+            CanvasTriangleVertices* triangles;
+            tessellationSink->DetachTriangles(&trianglesCount, &triangles);
+
+            auto freeTriangles = MakeScopeWarden([&] { CoTaskMemFree(triangles); });
+
+            return TriangleList(triangles, triangles + trianglesCount);
         }
-        else
+
+    case CanvasTessellationEngine::Cpu:
         {
-            ThrowIfFailed(resource->Simplify(
-                D2D1_GEOMETRY_SIMPLIFICATION_OPTION_CUBICS_AND_LINES,
-                nullptr,
-                geometrySink.Get()));
+            auto tessellator = Make<CpuTessellator>(transform, flatteningTolerance);
+            CheckMakeResult(tessellator);
+
+            StreamTo(d2dGeometry, tessellator.Get());
+
+            return tessellator->Tessellate();
         }
-        ThrowIfFailed(geometrySink->Close());
-    });
+
+    default:
+        ThrowHR(E_INVALIDARG);
+    }
+}
+
+// Path geometries can be streamed directly.  Everything else is sent through
+// Simplify, which keeps curves but converts arcs to Beziers.
+void CanvasGeometry::StreamTo(ID2D1Geometry* d2dGeometry, ID2D1GeometrySink* sink)
+{
+    auto pathGeometry = MaybeAs<ID2D1PathGeometry>(d2dGeometry);
+
+    if (pathGeometry)
+    {
+        ThrowIfFailed(pathGeometry->Stream(sink));
+    }
+    else
+    {
+        ThrowIfFailed(d2dGeometry->Simplify(
+            D2D1_GEOMETRY_SIMPLIFICATION_OPTION_CUBICS_AND_LINES,
+            nullptr,
+            sink));
+    }
+    ThrowIfFailed(sink->Close());
 }
 
 ComPtr<CanvasGeometry> CanvasGeometry::CreateNew(
@@ -1141,6 +1583,70 @@ ComPtr<CanvasGeometry> CanvasGeometry::CreateNew(
     return canvasGeometry;
 }
 
+// Opens a new path geometry, lets readPath fill it in, then closes it.
+template<typename READ_PATH>
+static ComPtr<CanvasGeometry> CreatePathGeometry(
+    ICanvasResourceCreator* resourceCreator,
+    READ_PATH&& readPath)
+{
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    auto pathGeometry = As<ICanvasDeviceInternal>(device)->CreatePathGeometry();
+
+    ComPtr<ID2D1GeometrySink> geometrySink;
+    ThrowIfFailed(pathGeometry->Open(&geometrySink));
+
+    readPath(geometrySink.Get());
+
+    ThrowIfFailed(geometrySink->Close());
+
+    auto canvasGeometry = Make<CanvasGeometry>(device.Get(), pathGeometry.Get());
+    CheckMakeResult(canvasGeometry);
+
+    return canvasGeometry;
+}
+
+ComPtr<CanvasGeometry> CanvasGeometry::CreateFromPathBytes(
+    ICanvasResourceCreator* resourceCreator,
+    uint32_t byteCount,
+    uint8_t const* bytes)
+{
+    return CreatePathGeometry(resourceCreator,
+        [&](ID2D1GeometrySink* sink)
+        {
+            ReadPathData(bytes, byteCount, sink);
+        });
+}
+
+ComPtr<CanvasGeometry> CanvasGeometry::CreateFromPathFile(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING fileName)
+{
+    return CreatePathGeometry(resourceCreator,
+        [&](ID2D1GeometrySink* sink)
+        {
+            ReadPathDataFromFile(WindowsGetStringRawBuffer(fileName, nullptr), sink);
+        });
+}
+
+ComPtr<CanvasGeometry> CanvasGeometry::CreateFromSvgPathData(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING pathData,
+    CanvasFilledRegionDetermination filledRegionDetermination)
+{
+    return CreatePathGeometry(resourceCreator,
+        [&](ID2D1GeometrySink* sink)
+        {
+            sink->SetFillMode(static_cast<D2D1_FILL_MODE>(filledRegionDetermination));
+
+            uint32_t length;
+            auto data = WindowsGetStringRawBuffer(pathData, &length);
+
+            ParseSvgPathData(data, length, sink);
+        });
+}
+
 ComPtr<CanvasGeometry> CanvasGeometry::CreateNew(
     ICanvasResourceCreator* resourceCreator,
     uint32_t geometryCount,
@@ -1191,6 +1697,46 @@ ComPtr<CanvasGeometry> CanvasGeometry::CreateNew(
 }
 
 
+ComPtr<CanvasGeometry> CanvasGeometry::CreateCombination(
+    ICanvasResourceCreator* resourceCreator,
+    uint32_t geometryCount,
+    ICanvasGeometry** geometryElements,
+    CanvasGeometryCombine combine,
+    float flatteningTolerance)
+{
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    auto deviceInternal = As<ICanvasDeviceInternal>(device);
+
+    if (geometryCount > 0)
+    {
+        CheckInPointer(geometryElements);
+    }
+
+    std::vector<ComPtr<ID2D1Geometry>> d2dGeometries(geometryCount);
+
+    for (uint32_t i = 0; i < geometryCount; ++i)
+    {
+        CheckInPointer(geometryElements[i]);
+        d2dGeometries[i] = GetWrappedResource<ID2D1Geometry>(geometryElements[i]);
+    }
+
+    auto d2dPathGeometry = CombineGeometries(
+        deviceInternal.Get(),
+        d2dGeometries,
+        static_cast<D2D1_COMBINE_MODE>(combine),
+        flatteningTolerance);
+
+    auto canvasGeometry = Make<CanvasGeometry>(
+        device.Get(),
+        d2dPathGeometry.Get());
+    CheckMakeResult(canvasGeometry);
+
+    return canvasGeometry;
+}
+
+
 static ComPtr<ID2D1TransformedGeometry> GetGlyphRunGeometry(
     ComPtr<ICanvasDeviceInternal> const& deviceInternal,
     FLOAT baselineOriginX,
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "drawing/CanvasStrokeStyle.h"
+#include "GeometryRealizationCache.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
 {
@@ -46,12 +47,33 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             uint32_t pointCount,
             Vector2* points);
 
+        static ComPtr<CanvasGeometry> CreateFromPathBytes(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t byteCount,
+            uint8_t const* bytes);
+
+        static ComPtr<CanvasGeometry> CreateFromPathFile(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING fileName);
+
+        static ComPtr<CanvasGeometry> CreateFromSvgPathData(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING pathData,
+            CanvasFilledRegionDetermination filledRegionDetermination);
+
         static ComPtr<CanvasGeometry> CreateNew(
             ICanvasResourceCreator* resourceCreator,
             uint32_t geometryCount,
             ICanvasGeometry** geometryElements,
             CanvasFilledRegionDetermination filledRegionDetermination);
 
+        static ComPtr<CanvasGeometry> CreateCombination(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t geometryCount,
+            ICanvasGeometry** geometryElements,
+            CanvasGeometryCombine combine,
+            float flatteningTolerance);
+
         static ComPtr<CanvasGeometry> CreateNew(
             ICanvasTextLayout* textLayout);
 
@@ -130,6 +152,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             float flatteningTolerance,
             ICanvasGeometry** geometry) override;
 
+        IFACEMETHOD(Decimate)(
+            float tolerance,
+            ICanvasGeometry** geometry) override;
+
         IFACEMETHOD(Transform)(
             Numerics::Matrix3x2 transform,
             ICanvasGeometry** geometry) override;
@@ -238,10 +264,48 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             UINT32* trianglesCount,
             CanvasTriangleVertices** triangles) override;
 
+        IFACEMETHOD(TessellateWithEngine)(
+            Matrix3x2 transform,
+            float flatteningTolerance,
+            CanvasTessellationEngine engine,
+            UINT32* trianglesCount,
+            CanvasTriangleVertices** triangles) override;
+
+        IFACEMETHOD(TessellateToIndexedMesh)(
+            Matrix3x2 transform,
+            float flatteningTolerance,
+            CanvasTessellationEngine engine,
+            CanvasIndexedMeshOptions options,
+            ICanvasIndexedMesh** mesh) override;
+
         IFACEMETHOD(SendPathTo)(
             ICanvasPathReceiver* streamReader) override;
 
+        IFACEMETHOD(GetPathBytes)(
+            uint32_t* valueCount,
+            uint8_t** valueElements) override;
+
+        IFACEMETHOD(GetPathBytesWithQuantizationStep)(
+            float quantizationStep,
+            uint32_t* valueCount,
+            uint8_t** valueElements) override;
+
+        // Sends the geometry's path to sink, simplifying it first if it is
+        // not a path geometry.
+        static void StreamTo(ID2D1Geometry* d2dGeometry, ID2D1GeometrySink* sink);
+
     private:
+        std::shared_ptr<TriangleList const> GetCachedTessellation(
+            CanvasTessellationEngine engine,
+            D2D1_MATRIX_3X2_F const& transform,
+            float flatteningTolerance);
+
+        static TriangleList TessellateToList(
+            ID2D1Geometry* d2dGeometry,
+            CanvasTessellationEngine engine,
+            D2D1_MATRIX_3X2_F const& transform,
+            float flatteningTolerance);
+
         void StrokeImpl(
             float strokeWidth,
             ICanvasStrokeStyle* strokeStyle,
@@ -349,12 +413,42 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             ICanvasPathBuilder* pathBuilder,
             ICanvasGeometry** geometry) override;
 
+        IFACEMETHOD(CreatePathFromBytes)(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t byteCount,
+            uint8_t* bytes,
+            ICanvasGeometry** geometry) override;
+
+        IFACEMETHOD(CreatePathFromFile)(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING fileName,
+            ICanvasGeometry** geometry) override;
+
+        IFACEMETHOD(CreatePathFromSvgPathData)(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING pathData,
+            ICanvasGeometry** geometry) override;
+
+        IFACEMETHOD(CreatePathFromSvgPathDataWithFilledRegionDetermination)(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING pathData,
+            CanvasFilledRegionDetermination filledRegionDetermination,
+            ICanvasGeometry** geometry) override;
+
         IFACEMETHOD(CreatePolygon)(
             ICanvasResourceCreator* resourceCreator,
             uint32_t pointCount,
             Numerics::Vector2* points,
             ICanvasGeometry** geometry) override;
 
+        IFACEMETHOD(DecimatePoints)(
+            uint32_t pointCount,
+            Numerics::Vector2* points,
+            float tolerance,
+            boolean isClosed,
+            uint32_t* valueCount,
+            Numerics::Vector2** valueElements) override;
+
         IFACEMETHOD(CreateGroup)(
             ICanvasResourceCreator* resourceCreator,
             uint32_t geometryCount,
@@ -368,6 +462,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             CanvasFilledRegionDetermination filledRegionDetermination,
             ICanvasGeometry** geometry) override;
 
+        IFACEMETHOD(CombineMany)(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t geometryCount,
+            ICanvasGeometry** geometryElements,
+            CanvasGeometryCombine combine,
+            ICanvasGeometry** geometry) override;
+
+        IFACEMETHOD(CombineManyWithFlatteningTolerance)(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t geometryCount,
+            ICanvasGeometry** geometryElements,
+            CanvasGeometryCombine combine,
+            float flatteningTolerance,
+            ICanvasGeometry** geometry) override;
+
         IFACEMETHOD(CreateText)(
             ICanvasTextLayout* textLayout,
             ICanvasGeometry** geometry) override;
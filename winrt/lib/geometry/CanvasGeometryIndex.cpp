@@ -0,0 +1,973 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasGeometryIndex.h"
+#include "PolylineSink.h"
+#include "utils/LockUtilities.h"
+#include "utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+// Below these sizes it is cheaper to run on a single thread.
+static const uint32_t CandidatesPerChunk = 32;
+static const uint32_t PointsPerChunk = 64;
+
+
+static D2D1_RECT_F Union(D2D1_RECT_F const& a, D2D1_RECT_F const& b)
+{
+    return D2D1_RECT_F{ std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+}
+
+
+// Half the perimeter, which is what the tree tries to minimize.  Unlike the
+// area, this still distinguishes between rectangles with no width or height.
+static float GetCost(D2D1_RECT_F const& rect)
+{
+    return (rect.right - rect.left) + (rect.bottom - rect.top);
+}
+
+
+static bool Overlaps(D2D1_RECT_F const& a, D2D1_RECT_F const& b)
+{
+    return a.left <= b.right && b.left <= a.right &&
+           a.top <= b.bottom && b.top <= a.bottom;
+}
+
+
+static float DistanceSquaredToRect(D2D1_RECT_F const& rect, D2D1_POINT_2F const& point)
+{
+    auto dx = std::max(std::max(rect.left - point.x, point.x - rect.right), 0.0f);
+    auto dy = std::max(std::max(rect.top - point.y, point.y - rect.bottom), 0.0f);
+
+    return dx * dx + dy * dy;
+}
+
+
+static float DistanceSquaredToLine(D2D1_POINT_2F const& point, D2D1_POINT_2F const& a, D2D1_POINT_2F const& b)
+{
+    auto dx = b.x - a.x;
+    auto dy = b.y - a.y;
+    auto lengthSquared = dx * dx + dy * dy;
+
+    auto t = 0.0f;
+
+    if (lengthSquared > 0)
+        t = std::min(std::max(((point.x - a.x) * dx + (point.y - a.y) * dy) / lengthSquared, 0.0f), 1.0f);
+
+    auto ex = a.x + t * dx - point.x;
+    auto ey = a.y + t * dy - point.y;
+
+    return ex * ex + ey * ey;
+}
+
+
+// Liang-Barsky clipping of the line against the rectangle.
+static bool LineIntersectsRect(D2D1_POINT_2F const& a, D2D1_POINT_2F const& b, D2D1_RECT_F const& rect)
+{
+    auto dx = b.x - a.x;
+    auto dy = b.y - a.y;
+
+    auto t0 = 0.0f;
+    auto t1 = 1.0f;
+
+    auto clip = [&](float p, float q)
+    {
+        if (p == 0)
+            return q >= 0;
+
+        auto t = q / p;
+
+        if (p < 0)
+        {
+            if (t > t1)
+                return false;
+
+            t0 = std::max(t0, t);
+        }
+        else
+        {
+            if (t < t0)
+                return false;
+
+            t1 = std::min(t1, t);
+        }
+
+        return true;
+    };
+
+    return clip(-dx, a.x - rect.left) &&
+           clip( dx, rect.right - a.x) &&
+           clip(-dy, a.y - rect.top) &&
+           clip( dy, rect.bottom - a.y);
+}
+
+
+//
+// Calls fn(a, b) for each line of the geometry, stopping if fn returns
+// false.  Figures with a single point are passed as a line of zero length.
+// Returns false if it stopped early.
+//
+template<typename FN>
+static bool ForEachLine(GeometryIndexEntry const& entry, FN&& fn)
+{
+    auto& points = entry.Points;
+
+    for (auto& figure : entry.Figures)
+    {
+        if (figure.End - figure.Begin == 1)
+        {
+            if (!fn(points[figure.Begin], points[figure.Begin]))
+                return false;
+
+            continue;
+        }
+
+        for (auto i = figure.Begin + 1; i < figure.End; ++i)
+        {
+            if (!fn(points[i - 1], points[i]))
+                return false;
+        }
+
+        if (figure.IsFilled || figure.IsClosed)
+        {
+            if (!fn(points[figure.End - 1], points[figure.Begin]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Runs predicate over the candidates in parallel, returning the ids of the
+// ones that match in ascending order.
+template<typename PREDICATE>
+static std::vector<int32_t> FilterCandidates(std::vector<GeometryIndexEntry const*> const& candidates, PREDICATE&& predicate)
+{
+    std::vector<uint8_t> matches(candidates.size());
+
+    ParallelFor(static_cast<uint32_t>(candidates.size()), CandidatesPerChunk,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                matches[i] = predicate(*candidates[i]);
+            }
+        });
+
+    std::vector<int32_t> ids;
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (matches[i])
+            ids.push_back(candidates[i]->Id);
+    }
+
+    std::sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+
+static void ValidateDistance(float distance)
+{
+    // Infinity is allowed, meaning no limit.
+    if (!(distance >= 0))
+        ThrowHR(E_INVALIDARG, Strings::GeometryIndexInvalidDistance);
+}
+
+
+//
+// GeometryIndexEntry implementation
+//
+
+bool GeometryIndexEntry::FillContainsPoint(D2D1_POINT_2F const& point) const
+{
+    int winding = 0;
+
+    for (auto& figure : Figures)
+    {
+        if (!figure.IsFilled)
+            continue;
+
+        for (auto i = figure.Begin; i < figure.End; ++i)
+        {
+            auto& a = Points[i];
+            auto& b = Points[(i + 1 < figure.End) ? i + 1 : figure.Begin];
+
+            // Which side of the line the point is on.
+            auto side = (b.x - a.x) * (point.y - a.y) - (point.x - a.x) * (b.y - a.y);
+
+            if (a.y <= point.y)
+            {
+                if (b.y > point.y && side > 0)
+                    ++winding;
+            }
+            else
+            {
+                if (b.y <= point.y && side < 0)
+                    --winding;
+            }
+        }
+    }
+
+    if (FillMode == D2D1_FILL_MODE_ALTERNATE)
+        return (winding & 1) != 0;
+    else
+        return winding != 0;
+}
+
+
+float GeometryIndexEntry::DistanceSquaredToOutline(D2D1_POINT_2F const& point) const
+{
+    auto result = std::numeric_limits<float>::infinity();
+
+    ForEachLine(*this,
+        [&](D2D1_POINT_2F const& a, D2D1_POINT_2F const& b)
+        {
+            result = std::min(result, DistanceSquaredToLine(point, a, b));
+            return true;
+        });
+
+    return result;
+}
+
+
+float GeometryIndexEntry::DistanceTo(D2D1_POINT_2F const& point) const
+{
+    if (FillContainsPoint(point))
+        return 0;
+
+    return sqrtf(DistanceSquaredToOutline(point));
+}
+
+
+bool GeometryIndexEntry::Intersects(D2D1_RECT_F const& rect) const
+{
+    if (!Overlaps(Bounds, rect))
+        return false;
+
+    bool anyLineIntersects = !ForEachLine(*this,
+        [&](D2D1_POINT_2F const& a, D2D1_POINT_2F const& b)
+        {
+            return !LineIntersectsRect(a, b, rect);
+        });
+
+    if (anyLineIntersects)
+        return true;
+
+    // Nothing crosses the edge of the rectangle, so it is either entirely
+    // inside the fill or entirely outside it.
+    return FillContainsPoint(D2D1_POINT_2F{ rect.left, rect.top });
+}
+
+
+//
+// CanvasGeometryIndex implementation
+//
+
+CanvasGeometryIndex::CanvasGeometryIndex(float flatteningTolerance)
+    : m_flatteningTolerance(flatteningTolerance)
+    , m_closed(false)
+    , m_root(-1)
+{
+}
+
+
+int32_t CanvasGeometryIndex::GetTreeHeight()
+{
+    Lock lock(m_mutex);
+
+    return (m_root < 0) ? 0 : m_nodes[m_root].Height;
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::get_Count(uint32_t* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        *value = static_cast<uint32_t>(m_entries.size());
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::get_FlatteningTolerance(float* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        *value = m_flatteningTolerance;
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::Insert(
+    int32_t id,
+    ICanvasGeometry* geometry)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(geometry);
+
+        // Flattening is the slow part, so is done before taking the lock.
+        auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
+        auto entry = FlattenGeometry(id, d2dGeometry.Get(), m_flatteningTolerance);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        // Inserting an existing id replaces its geometry.
+        RemoveEntry(id);
+
+        auto entryIndex = static_cast<uint32_t>(m_entries.size());
+
+        bool isEmpty = entry.Points.empty() ||
+                       !(entry.Bounds.left <= entry.Bounds.right) ||
+                       !(entry.Bounds.top <= entry.Bounds.bottom);
+
+        m_entries.push_back(std::move(entry));
+        m_entryIndices[id] = entryIndex;
+
+        if (isEmpty)
+            return;
+
+        auto leaf = AllocateNode();
+
+        m_nodes[leaf] = Node{ m_entries[entryIndex].Bounds, -1, { -1, -1 }, 0, static_cast<int32_t>(entryIndex) };
+        m_entries[entryIndex].Leaf = leaf;
+
+        InsertLeaf(leaf);
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::Remove(
+    int32_t id,
+    boolean* removed)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(removed);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        *removed = RemoveEntry(id);
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::Clear()
+{
+    return ExceptionBoundary([&]
+    {
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        m_entries.clear();
+        m_entryIndices.clear();
+        m_nodes.clear();
+        m_freeNodes.clear();
+        m_root = -1;
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::FindAtPoint(
+    Vector2 point,
+    float tolerance,
+    uint32_t* valueCount,
+    int32_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+        ValidateDistance(tolerance);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        auto d2dPoint = ToD2DPoint(point);
+        auto toleranceSquared = tolerance * tolerance;
+
+        auto ids = FilterCandidates(FindCandidatesAtPoint(d2dPoint, tolerance),
+            [&](GeometryIndexEntry const& entry)
+            {
+                return entry.FillContainsPoint(d2dPoint) ||
+                       entry.DistanceSquaredToOutline(d2dPoint) <= toleranceSquared;
+            });
+
+        ComArray<int32_t> array(ids.begin(), ids.end());
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::FindAtPoints(
+    uint32_t pointsCount,
+    Vector2* points,
+    float tolerance,
+    uint32_t* offsetsCount,
+    uint32_t** offsetsElements,
+    uint32_t* valueCount,
+    int32_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        if (pointsCount > 0)
+            CheckInPointer(points);
+
+        CheckInPointer(offsetsCount);
+        CheckAndClearOutPointer(offsetsElements);
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+        ValidateDistance(tolerance);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        auto toleranceSquared = tolerance * tolerance;
+
+        // Each point is tested on a single thread, and the points are
+        // spread across threads.
+        std::vector<std::vector<int32_t>> results(pointsCount);
+
+        ParallelFor(pointsCount, PointsPerChunk,
+            [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    auto point = ToD2DPoint(points[i]);
+
+                    for (auto entry : FindCandidatesAtPoint(point, tolerance))
+                    {
+                        if (entry->FillContainsPoint(point) ||
+                            entry->DistanceSquaredToOutline(point) <= toleranceSquared)
+                        {
+                            results[i].push_back(entry->Id);
+                        }
+                    }
+
+                    std::sort(results[i].begin(), results[i].end());
+                }
+            });
+
+        // The ids found for point i are ids[offsets[i]] to ids[offsets[i + 1] - 1].
+        ComArray<uint32_t> offsets(pointsCount + 1);
+
+        uint32_t total = 0;
+
+        for (uint32_t i = 0; i < pointsCount; ++i)
+        {
+            offsets[i] = total;
+            total += static_cast<uint32_t>(results[i].size());
+        }
+
+        offsets[pointsCount] = total;
+
+        ComArray<int32_t> ids(total);
+
+        for (uint32_t i = 0; i < pointsCount; ++i)
+        {
+            std::copy(results[i].begin(), results[i].end(), stdext::make_checked_array_iterator(ids.GetData() + offsets[i], total - offsets[i]));
+        }
+
+        offsets.Detach(offsetsCount, offsetsElements);
+        ids.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::FindInRectangle(
+    Rect rectangle,
+    uint32_t* valueCount,
+    int32_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        auto d2dRect = ToD2DRect(rectangle);
+
+        std::vector<GeometryIndexEntry const*> candidates;
+
+        VisitEntries(
+            [&](D2D1_RECT_F const& bounds) { return Overlaps(bounds, d2dRect); },
+            [&](GeometryIndexEntry const& entry) { candidates.push_back(&entry); });
+
+        auto ids = FilterCandidates(candidates,
+            [&](GeometryIndexEntry const& entry)
+            {
+                return entry.Intersects(d2dRect);
+            });
+
+        ComArray<int32_t> array(ids.begin(), ids.end());
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::FindNearest(
+    Vector2 point,
+    float maximumDistance,
+    uint32_t maximumCount,
+    uint32_t* valueCount,
+    int32_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+        ValidateDistance(maximumDistance);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        auto d2dPoint = ToD2DPoint(point);
+
+        typedef std::pair<float, int32_t> DistanceAndIndex;
+        typedef std::pair<float, int32_t> DistanceAndId;
+
+        // Best-first search: nodes are visited in order of the distance to
+        // their bounds, which is never more than the distance to anything
+        // inside them.  Once that is further than the last of the results
+        // found so far, nothing closer remains.
+        std::priority_queue<DistanceAndIndex, std::vector<DistanceAndIndex>, std::greater<DistanceAndIndex>> nodesToVisit;
+
+        // Ordered so the furthest result, or the highest id of equally far
+        // results, is on top.
+        std::priority_queue<DistanceAndId> results;
+
+        if (m_root >= 0 && maximumCount > 0)
+            nodesToVisit.emplace(sqrtf(DistanceSquaredToRect(m_nodes[m_root].Bounds, d2dPoint)), m_root);
+
+        while (!nodesToVisit.empty())
+        {
+            auto distance = nodesToVisit.top().first;
+            auto& node = m_nodes[nodesToVisit.top().second];
+            nodesToVisit.pop();
+
+            if (distance > maximumDistance)
+                break;
+
+            if (results.size() == maximumCount && distance > results.top().first)
+                break;
+
+            if (node.EntryIndex < 0)
+            {
+                for (auto child : node.Children)
+                {
+                    nodesToVisit.emplace(sqrtf(DistanceSquaredToRect(m_nodes[child].Bounds, d2dPoint)), child);
+                }
+
+                continue;
+            }
+
+            auto& entry = m_entries[node.EntryIndex];
+            auto entryDistance = entry.DistanceTo(d2dPoint);
+
+            if (entryDistance > maximumDistance)
+                continue;
+
+            results.emplace(entryDistance, entry.Id);
+
+            if (results.size() > maximumCount)
+                results.pop();
+        }
+
+        // Nearest first, with ties broken by id.
+        ComArray<int32_t> array(results.size());
+
+        for (auto i = results.size(); i > 0; --i)
+        {
+            array[static_cast<uint32_t>(i - 1)] = results.top().second;
+            results.pop();
+        }
+
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndex::Close()
+{
+    return ExceptionBoundary([&]
+    {
+        Lock lock(m_mutex);
+
+        m_closed = true;
+
+        m_entries.clear();
+        m_entryIndices.clear();
+        m_nodes.clear();
+        m_freeNodes.clear();
+        m_root = -1;
+    });
+}
+
+
+void CanvasGeometryIndex::ThrowIfClosed()
+{
+    if (m_closed)
+    {
+        ThrowHR(RO_E_CLOSED);
+    }
+}
+
+
+GeometryIndexEntry CanvasGeometryIndex::FlattenGeometry(int32_t id, ID2D1Geometry* d2dGeometry, float flatteningTolerance)
+{
+    GeometryIndexEntry entry{};
+
+    entry.Id = id;
+    entry.Leaf = -1;
+
+    ThrowIfFailed(d2dGeometry->GetBounds(nullptr, &entry.Bounds));
+
+    PolylineSink::Flatten(d2dGeometry, flatteningTolerance, &entry);
+
+    return entry;
+}
+
+
+bool CanvasGeometryIndex::RemoveEntry(int32_t id)
+{
+    auto it = m_entryIndices.find(id);
+
+    if (it == m_entryIndices.end())
+        return false;
+
+    auto entryIndex = it->second;
+    auto leaf = m_entries[entryIndex].Leaf;
+
+    if (leaf >= 0)
+    {
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+    }
+
+    m_entryIndices.erase(it);
+
+    // Move the last entry into the gap.
+    auto lastIndex = static_cast<uint32_t>(m_entries.size() - 1);
+
+    if (entryIndex != lastIndex)
+    {
+        auto& moved = m_entries[entryIndex];
+
+        moved = std::move(m_entries[lastIndex]);
+        m_entryIndices[moved.Id] = entryIndex;
+
+        if (moved.Leaf >= 0)
+            m_nodes[moved.Leaf].EntryIndex = static_cast<int32_t>(entryIndex);
+    }
+
+    m_entries.pop_back();
+
+    return true;
+}
+
+
+template<typename OVERLAPS, typename FN>
+void CanvasGeometryIndex::VisitEntries(OVERLAPS&& overlaps, FN&& fn)
+{
+    if (m_root < 0)
+        return;
+
+    std::vector<int32_t> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty())
+    {
+        auto& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if (!overlaps(node.Bounds))
+            continue;
+
+        if (node.EntryIndex >= 0)
+        {
+            fn(m_entries[node.EntryIndex]);
+        }
+        else
+        {
+            stack.push_back(node.Children[0]);
+            stack.push_back(node.Children[1]);
+        }
+    }
+}
+
+
+std::vector<GeometryIndexEntry const*> CanvasGeometryIndex::FindCandidatesAtPoint(D2D1_POINT_2F const& point, float tolerance)
+{
+    auto toleranceSquared = tolerance * tolerance;
+
+    std::vector<GeometryIndexEntry const*> candidates;
+
+    VisitEntries(
+        [&](D2D1_RECT_F const& bounds) { return DistanceSquaredToRect(bounds, point) <= toleranceSquared; },
+        [&](GeometryIndexEntry const& entry) { candidates.push_back(&entry); });
+
+    return candidates;
+}
+
+
+int32_t CanvasGeometryIndex::AllocateNode()
+{
+    if (!m_freeNodes.empty())
+    {
+        auto node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        return node;
+    }
+
+    m_nodes.push_back(Node{});
+
+    return static_cast<int32_t>(m_nodes.size() - 1);
+}
+
+
+void CanvasGeometryIndex::FreeNode(int32_t node)
+{
+    m_freeNodes.push_back(node);
+}
+
+
+void CanvasGeometryIndex::InsertLeaf(int32_t leaf)
+{
+    if (m_root < 0)
+    {
+        m_root = leaf;
+        m_nodes[leaf].Parent = -1;
+        return;
+    }
+
+    auto leafBounds = m_nodes[leaf].Bounds;
+
+    //
+    // Walk down the tree towards whichever child would grow the least by
+    // including the new leaf.  Stop when pairing the leaf with the current
+    // node is cheaper than going further down.
+    //
+    auto sibling = m_root;
+
+    while (!IsLeaf(sibling))
+    {
+        auto& node = m_nodes[sibling];
+
+        auto combinedCost = GetCost(Union(node.Bounds, leafBounds));
+
+        // The cost of a new parent for this node and the leaf.
+        auto pairCost = 2 * combinedCost;
+
+        // Anything below here also grows this node by this much.
+        auto inheritedCost = 2 * (combinedCost - GetCost(node.Bounds));
+
+        float childCosts[2];
+
+        for (int i = 0; i < 2; ++i)
+        {
+            auto child = node.Children[i];
+            auto enlargedCost = GetCost(Union(m_nodes[child].Bounds, leafBounds));
+
+            if (IsLeaf(child))
+                childCosts[i] = enlargedCost + inheritedCost;
+            else
+                childCosts[i] = (enlargedCost - GetCost(m_nodes[child].Bounds)) + inheritedCost;
+        }
+
+        if (pairCost < childCosts[0] && pairCost < childCosts[1])
+            break;
+
+        sibling = node.Children[(childCosts[0] <= childCosts[1]) ? 0 : 1];
+    }
+
+    auto oldParent = m_nodes[sibling].Parent;
+    auto newParent = AllocateNode();
+
+    m_nodes[newParent] = Node{ D2D1_RECT_F{}, oldParent, { sibling, leaf }, 0, -1 };
+    m_nodes[sibling].Parent = newParent;
+    m_nodes[leaf].Parent = newParent;
+
+    if (oldParent < 0)
+        m_root = newParent;
+    else
+        ReplaceChild(oldParent, sibling, newParent);
+
+    RefitAncestors(newParent);
+}
+
+
+void CanvasGeometryIndex::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = -1;
+        return;
+    }
+
+    auto parent = m_nodes[leaf].Parent;
+    auto grandparent = m_nodes[parent].Parent;
+    auto sibling = m_nodes[parent].Children[(m_nodes[parent].Children[0] == leaf) ? 1 : 0];
+
+    // The sibling takes the parent's place.
+    m_nodes[sibling].Parent = grandparent;
+    FreeNode(parent);
+
+    if (grandparent < 0)
+    {
+        m_root = sibling;
+    }
+    else
+    {
+        ReplaceChild(grandparent, parent, sibling);
+        RefitAncestors(grandparent);
+    }
+}
+
+
+void CanvasGeometryIndex::ReplaceChild(int32_t parent, int32_t oldChild, int32_t newChild)
+{
+    auto& children = m_nodes[parent].Children;
+
+    if (children[0] == oldChild)
+        children[0] = newChild;
+    else
+        children[1] = newChild;
+}
+
+
+void CanvasGeometryIndex::UpdateNode(int32_t node)
+{
+    auto& a = m_nodes[m_nodes[node].Children[0]];
+    auto& b = m_nodes[m_nodes[node].Children[1]];
+
+    m_nodes[node].Bounds = Union(a.Bounds, b.Bounds);
+    m_nodes[node].Height = 1 + std::max(a.Height, b.Height);
+}
+
+
+void CanvasGeometryIndex::RefitAncestors(int32_t node)
+{
+    while (node >= 0)
+    {
+        UpdateNode(node);
+        node = Balance(node);
+        node = m_nodes[node].Parent;
+    }
+}
+
+
+//
+// If one child of the node is more than one level taller than the other,
+// rotates it up to take the node's place.  Returns the node now in that
+// position.
+//
+int32_t CanvasGeometryIndex::Balance(int32_t node)
+{
+    if (IsLeaf(node) || m_nodes[node].Height < 2)
+        return node;
+
+    auto balance = m_nodes[m_nodes[node].Children[1]].Height - m_nodes[m_nodes[node].Children[0]].Height;
+
+    if (balance > 1)
+        return RotateUp(node, 1);
+    else if (balance < -1)
+        return RotateUp(node, 0);
+    else
+        return node;
+}
+
+
+int32_t CanvasGeometryIndex::RotateUp(int32_t node, int side)
+{
+    auto child = m_nodes[node].Children[side];
+    auto grandchild0 = m_nodes[child].Children[0];
+    auto grandchild1 = m_nodes[child].Children[1];
+
+    // The child takes the node's place.
+    auto parent = m_nodes[node].Parent;
+
+    m_nodes[child].Parent = parent;
+    m_nodes[node].Parent = child;
+
+    if (parent < 0)
+        m_root = child;
+    else
+        ReplaceChild(parent, node, child);
+
+    // The child keeps its taller subtree, and gives the shorter one to the
+    // node in its own place.
+    bool firstIsTaller = m_nodes[grandchild0].Height > m_nodes[grandchild1].Height;
+    auto taller = firstIsTaller ? grandchild0 : grandchild1;
+    auto shorter = firstIsTaller ? grandchild1 : grandchild0;
+
+    m_nodes[child].Children[0] = node;
+    m_nodes[child].Children[1] = taller;
+
+    m_nodes[node].Children[side] = shorter;
+    m_nodes[shorter].Parent = node;
+
+    UpdateNode(node);
+    UpdateNode(child);
+
+    return child;
+}
+
+
+//
+// CanvasGeometryIndexFactory implementation
+//
+
+IFACEMETHODIMP CanvasGeometryIndexFactory::ActivateInstance(IInspectable** object)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckAndClearOutPointer(object);
+
+        auto geometryIndex = Make<CanvasGeometryIndex>(D2D1_DEFAULT_FLATTENING_TOLERANCE);
+        CheckMakeResult(geometryIndex);
+
+        ThrowIfFailed(geometryIndex.CopyTo(object));
+    });
+}
+
+
+IFACEMETHODIMP CanvasGeometryIndexFactory::Create(
+    float flatteningTolerance,
+    ICanvasGeometryIndex** geometryIndex)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckAndClearOutPointer(geometryIndex);
+
+        if (!(flatteningTolerance > 0))
+            ThrowHR(E_INVALIDARG, Strings::ExpectedPositiveNonzero);
+
+        auto newGeometryIndex = Make<CanvasGeometryIndex>(flatteningTolerance);
+        CheckMakeResult(newGeometryIndex);
+
+        ThrowIfFailed(newGeometryIndex.CopyTo(geometryIndex));
+    });
+}
+
+
+ActivatableClassWithFactory(CanvasGeometryIndex, CanvasGeometryIndexFactory);
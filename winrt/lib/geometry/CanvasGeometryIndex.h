@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "PolylineSink.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // A geometry flattened to polylines, along with everything needed to
+    // hit-test it without going back to Direct2D.
+    //
+    struct GeometryIndexEntry : public Polylines
+    {
+        int32_t Id;
+        D2D1_RECT_F Bounds;
+        int32_t Leaf;               // -1 for empty geometries, which are never found
+
+        bool FillContainsPoint(D2D1_POINT_2F const& point) const;
+
+        // The distance to the nearest line of any figure.  Filled figures
+        // include their closing line, as it is part of the edge of the fill.
+        float DistanceSquaredToOutline(D2D1_POINT_2F const& point) const;
+
+        // Zero for points inside the fill.
+        float DistanceTo(D2D1_POINT_2F const& point) const;
+
+        bool Intersects(D2D1_RECT_F const& rect) const;
+    };
+
+
+    //
+    // Hit-tests large numbers of geometries at once.
+    //
+    // Each geometry is flattened to polylines when it is inserted, and its
+    // bounds are added to a bounding volume hierarchy.  Queries walk the
+    // hierarchy to find the few geometries whose bounds could match, then
+    // test their polylines exactly, so the cost depends on how many
+    // geometries are near the query rather than how many are in the index.
+    //
+    // The hierarchy is updated incrementally, using the insertion cost
+    // heuristic and AVL style rotations of Box2D's dynamic tree, so that
+    // geometries can be added and removed at any time without rebuilding it.
+    //
+    // Methods lock the index, so it can be shared between threads.  Queries
+    // test their candidates, or in the case of FindAtPoints their points, in
+    // parallel.
+    //
+    class CanvasGeometryIndex
+        : public RuntimeClass<ICanvasGeometryIndex, IClosable>
+        , private LifespanTracker<CanvasGeometryIndex>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasGeometryIndex, BaseTrust);
+
+        struct Node
+        {
+            D2D1_RECT_F Bounds;
+            int32_t Parent;
+            int32_t Children[2];
+            int32_t Height;         // 0 for leaves
+            int32_t EntryIndex;     // -1 for internal nodes
+        };
+
+        float m_flatteningTolerance;
+        bool m_closed;
+
+        std::mutex m_mutex;
+
+        std::vector<GeometryIndexEntry> m_entries;
+        std::unordered_map<int32_t, uint32_t> m_entryIndices;
+
+        std::vector<Node> m_nodes;
+        std::vector<int32_t> m_freeNodes;
+        int32_t m_root;
+
+    public:
+        CanvasGeometryIndex(float flatteningTolerance);
+
+        // Exposed for testing.
+        int32_t GetTreeHeight();
+
+        //
+        // ICanvasGeometryIndex
+        //
+
+        IFACEMETHOD(get_Count)(uint32_t* value) override;
+
+        IFACEMETHOD(get_FlatteningTolerance)(float* value) override;
+
+        IFACEMETHOD(Insert)(
+            int32_t id,
+            ICanvasGeometry* geometry) override;
+
+        IFACEMETHOD(Remove)(
+            int32_t id,
+            boolean* removed) override;
+
+        IFACEMETHOD(Clear)() override;
+
+        IFACEMETHOD(FindAtPoint)(
+            Vector2 point,
+            float tolerance,
+            uint32_t* valueCount,
+            int32_t** valueElements) override;
+
+        IFACEMETHOD(FindAtPoints)(
+            uint32_t pointsCount,
+            Vector2* points,
+            float tolerance,
+            uint32_t* offsetsCount,
+            uint32_t** offsetsElements,
+            uint32_t* valueCount,
+            int32_t** valueElements) override;
+
+        IFACEMETHOD(FindInRectangle)(
+            Rect rectangle,
+            uint32_t* valueCount,
+            int32_t** valueElements) override;
+
+        IFACEMETHOD(FindNearest)(
+            Vector2 point,
+            float maximumDistance,
+            uint32_t maximumCount,
+            uint32_t* valueCount,
+            int32_t** valueElements) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        void ThrowIfClosed();
+
+        static GeometryIndexEntry FlattenGeometry(int32_t id, ID2D1Geometry* d2dGeometry, float flatteningTolerance);
+
+        bool RemoveEntry(int32_t id);
+
+        template<typename OVERLAPS, typename FN>
+        void VisitEntries(OVERLAPS&& overlaps, FN&& fn);
+
+        std::vector<GeometryIndexEntry const*> FindCandidatesAtPoint(D2D1_POINT_2F const& point, float tolerance);
+
+        bool IsLeaf(int32_t node) const { return m_nodes[node].EntryIndex >= 0; }
+
+        int32_t AllocateNode();
+        void FreeNode(int32_t node);
+
+        void InsertLeaf(int32_t leaf);
+        void RemoveLeaf(int32_t leaf);
+        void ReplaceChild(int32_t parent, int32_t oldChild, int32_t newChild);
+        void UpdateNode(int32_t node);
+        void RefitAncestors(int32_t node);
+        int32_t Balance(int32_t node);
+        int32_t RotateUp(int32_t node, int side);
+    };
+
+
+    class CanvasGeometryIndexFactory
+        : public AgileActivationFactory<ICanvasGeometryIndexFactory>
+        , private LifespanTracker<CanvasGeometryIndexFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasGeometryIndex, BaseTrust);
+
+    public:
+        IFACEMETHOD(ActivateInstance)(IInspectable** object) override;
+
+        IFACEMETHOD(Create)(
+            float flatteningTolerance,
+            ICanvasGeometryIndex** geometryIndex) override;
+    };
+}}}}}
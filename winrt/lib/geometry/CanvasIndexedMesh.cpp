@@ -0,0 +1,310 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasIndexedMesh.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+static bool IsSet(CanvasIndexedMeshOptions options, CanvasIndexedMeshOptions flag)
+{
+    return (static_cast<uint32_t>(options) & static_cast<uint32_t>(flag)) != 0;
+}
+
+
+// Positive and negative zero are the same position, so must share a vertex.
+static uint32_t GetPositionBits(float value)
+{
+    if (value == 0)
+        value = 0;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+static uint64_t MakeEdgeKey(uint32_t a, uint32_t b)
+{
+    if (a > b)
+        std::swap(a, b);
+
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+
+//
+// CanvasIndexedMesh implementation
+//
+
+CanvasIndexedMesh::CanvasIndexedMesh(
+    uint32_t vertexCount,
+    uint32_t indexCount,
+    CanvasIndexFormat indexFormat,
+    bool hasEdgeFlags)
+    : m_vertexCount(vertexCount)
+    , m_indexCount(indexCount)
+    , m_indexFormat(indexFormat)
+    , m_hasEdgeFlags(hasEdgeFlags)
+{
+    size_t size = static_cast<size_t>(vertexCount) * sizeof(Vector2) +
+                  static_cast<size_t>(indexCount) * GetIndexSize() +
+                  (hasEdgeFlags ? vertexCount : 0);
+
+    m_storage.resize(size);
+}
+
+
+Vector2* CanvasIndexedMesh::GetVertexData()
+{
+    return reinterpret_cast<Vector2*>(m_storage.data());
+}
+
+
+uint8_t* CanvasIndexedMesh::GetIndexData()
+{
+    return m_storage.data() + m_vertexCount * sizeof(Vector2);
+}
+
+
+uint8_t* CanvasIndexedMesh::GetEdgeFlagData()
+{
+    assert(m_hasEdgeFlags);
+
+    return GetIndexData() + m_indexCount * GetIndexSize();
+}
+
+
+uint32_t CanvasIndexedMesh::GetIndex(uint32_t i)
+{
+    if (m_indexFormat == CanvasIndexFormat::UInt16)
+        return reinterpret_cast<uint16_t*>(GetIndexData())[i];
+    else
+        return reinterpret_cast<uint32_t*>(GetIndexData())[i];
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::get_VertexCount(uint32_t* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        *value = m_vertexCount;
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::get_IndexCount(uint32_t* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        *value = m_indexCount;
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::get_IndexFormat(CanvasIndexFormat* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        *value = m_indexFormat;
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::get_HasEdgeFlags(boolean* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        *value = m_hasEdgeFlags;
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::GetVertices(
+    uint32_t* valueCount,
+    Vector2** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+
+        auto vertices = GetVertexData();
+
+        ComArray<Vector2> array(vertices, vertices + m_vertexCount);
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::GetIndices(
+    uint32_t* valueCount,
+    uint32_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+
+        ComArray<uint32_t> array(m_indexCount);
+
+        for (uint32_t i = 0; i < m_indexCount; ++i)
+        {
+            array[i] = GetIndex(i);
+        }
+
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::GetEdgeFlags(
+    uint32_t* valueCount,
+    uint8_t** valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+
+        if (!m_hasEdgeFlags)
+            ThrowHR(E_INVALIDARG, Strings::IndexedMeshHasNoEdgeFlags);
+
+        auto flags = GetEdgeFlagData();
+
+        ComArray<uint8_t> array(flags, flags + m_vertexCount);
+        array.Detach(valueCount, valueElements);
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::CopyVerticesTo(
+    uint32_t valueCount,
+    Vector2* valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueElements);
+
+        if (valueCount < m_vertexCount)
+            ThrowHR(E_INVALIDARG, Strings::IndexedMeshBufferTooSmall);
+
+        std::copy(GetVertexData(), GetVertexData() + m_vertexCount, stdext::make_checked_array_iterator(valueElements, valueCount));
+    });
+}
+
+
+IFACEMETHODIMP CanvasIndexedMesh::CopyIndexBytesTo(
+    uint32_t valueCount,
+    uint8_t* valueElements)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(valueElements);
+
+        auto byteCount = static_cast<size_t>(m_indexCount) * GetIndexSize();
+
+        if (valueCount < byteCount)
+            ThrowHR(E_INVALIDARG, Strings::IndexedMeshBufferTooSmall);
+
+        memcpy(valueElements, GetIndexData(), byteCount);
+    });
+}
+
+
+//
+// IndexedMeshBuilder implementation
+//
+
+void IndexedMeshBuilder::AddTriangles(CanvasTriangleVertices const* triangles, uint32_t trianglesCount)
+{
+    for (uint32_t i = 0; i < trianglesCount; ++i)
+    {
+        m_indices.push_back(GetVertexIndex(triangles[i].Vertex1));
+        m_indices.push_back(GetVertexIndex(triangles[i].Vertex2));
+        m_indices.push_back(GetVertexIndex(triangles[i].Vertex3));
+    }
+}
+
+
+ComPtr<CanvasIndexedMesh> IndexedMeshBuilder::CreateMesh(CanvasIndexedMeshOptions options)
+{
+    auto vertexCount = static_cast<uint32_t>(m_vertices.size());
+    auto indexCount = static_cast<uint32_t>(m_indices.size());
+
+    bool use16BitIndices = !IsSet(options, CanvasIndexedMeshOptions::Force32BitIndices) &&
+                           vertexCount <= std::numeric_limits<uint16_t>::max() + 1u;
+
+    bool includeEdgeFlags = IsSet(options, CanvasIndexedMeshOptions::IncludeEdgeFlags);
+
+    auto mesh = Make<CanvasIndexedMesh>(
+        vertexCount,
+        indexCount,
+        use16BitIndices ? CanvasIndexFormat::UInt16 : CanvasIndexFormat::UInt32,
+        includeEdgeFlags);
+    CheckMakeResult(mesh);
+
+    std::copy(m_vertices.begin(), m_vertices.end(), stdext::make_checked_array_iterator(mesh->GetVertexData(), vertexCount));
+
+    if (use16BitIndices)
+    {
+        std::transform(m_indices.begin(), m_indices.end(), stdext::make_checked_array_iterator(reinterpret_cast<uint16_t*>(mesh->GetIndexData()), indexCount),
+            [](uint32_t index) { return static_cast<uint16_t>(index); });
+    }
+    else
+    {
+        std::copy(m_indices.begin(), m_indices.end(), stdext::make_checked_array_iterator(reinterpret_cast<uint32_t*>(mesh->GetIndexData()), indexCount));
+    }
+
+    if (includeEdgeFlags)
+    {
+        // Count how many triangles use each edge.
+        std::unordered_map<uint64_t, uint32_t> edgeUseCounts;
+        edgeUseCounts.reserve(m_indices.size());
+
+        for (size_t i = 0; i < m_indices.size(); i += 3)
+        {
+            edgeUseCounts[MakeEdgeKey(m_indices[i],     m_indices[i + 1])]++;
+            edgeUseCounts[MakeEdgeKey(m_indices[i + 1], m_indices[i + 2])]++;
+            edgeUseCounts[MakeEdgeKey(m_indices[i + 2], m_indices[i])]++;
+        }
+
+        auto flags = mesh->GetEdgeFlagData();
+        std::fill_n(flags, vertexCount, static_cast<uint8_t>(0));
+
+        for (auto& edge : edgeUseCounts)
+        {
+            if (edge.second == 1)
+            {
+                flags[edge.first >> 32] = 1;
+                flags[edge.first & UINT_MAX] = 1;
+            }
+        }
+    }
+
+    return mesh;
+}
+
+
+uint32_t IndexedMeshBuilder::GetVertexIndex(Vector2 const& vertex)
+{
+    auto key = (static_cast<uint64_t>(GetPositionBits(vertex.X)) << 32) | GetPositionBits(vertex.Y);
+
+    auto result = m_vertexIndices.emplace(key, static_cast<uint32_t>(m_vertices.size()));
+
+    if (result.second)
+        m_vertices.push_back(vertex);
+
+    return result.first->second;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // A tessellation stored as a list of unique vertices plus a list of
+    // indices, three per triangle.  Everything lives in a single allocation:
+    //
+    //      vertices    (Vector2 * VertexCount)
+    //      indices     (2 or 4 bytes * IndexCount)
+    //      edge flags  (1 byte * VertexCount, if requested)
+    //
+    class CanvasIndexedMesh
+        : public RuntimeClass<ICanvasIndexedMesh>
+        , private LifespanTracker<CanvasIndexedMesh>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasIndexedMesh, BaseTrust);
+
+        uint32_t m_vertexCount;
+        uint32_t m_indexCount;
+        CanvasIndexFormat m_indexFormat;
+        bool m_hasEdgeFlags;
+
+        std::vector<uint8_t> m_storage;
+
+    public:
+        CanvasIndexedMesh(
+            uint32_t vertexCount,
+            uint32_t indexCount,
+            CanvasIndexFormat indexFormat,
+            bool hasEdgeFlags);
+
+        Vector2* GetVertexData();
+        uint8_t* GetIndexData();
+        uint8_t* GetEdgeFlagData();
+
+        uint32_t GetIndexSize() const
+        {
+            return (m_indexFormat == CanvasIndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+
+        uint32_t GetIndex(uint32_t i);
+
+        //
+        // ICanvasIndexedMesh
+        //
+
+        IFACEMETHOD(get_VertexCount)(uint32_t* value) override;
+
+        IFACEMETHOD(get_IndexCount)(uint32_t* value) override;
+
+        IFACEMETHOD(get_IndexFormat)(CanvasIndexFormat* value) override;
+
+        IFACEMETHOD(get_HasEdgeFlags)(boolean* value) override;
+
+        IFACEMETHOD(GetVertices)(
+            uint32_t* valueCount,
+            Vector2** valueElements) override;
+
+        IFACEMETHOD(GetIndices)(
+            uint32_t* valueCount,
+            uint32_t** valueElements) override;
+
+        IFACEMETHOD(GetEdgeFlags)(
+            uint32_t* valueCount,
+            uint8_t** valueElements) override;
+
+        IFACEMETHOD(CopyVerticesTo)(
+            uint32_t valueCount,
+            Vector2* valueElements) override;
+
+        IFACEMETHOD(CopyIndexBytesTo)(
+            uint32_t valueCount,
+            uint8_t* valueElements) override;
+    };
+
+
+    //
+    // Turns a stream of triangles into an indexed mesh, merging vertices
+    // that have exactly the same position.
+    //
+    class IndexedMeshBuilder
+    {
+        std::unordered_map<uint64_t, uint32_t> m_vertexIndices;
+        std::vector<Vector2> m_vertices;
+        std::vector<uint32_t> m_indices;
+
+    public:
+        void AddTriangles(CanvasTriangleVertices const* triangles, uint32_t trianglesCount);
+
+        //
+        // Uses 16 bit indices when every vertex can be addressed by one,
+        // unless Force32BitIndices is set.  With IncludeEdgeFlags, a vertex's
+        // flag is 1 if it is on an edge that belongs to only one triangle,
+        // ie. on the outline of the mesh, which is where antialiasing is
+        // needed.
+        //
+        ComPtr<CanvasIndexedMesh> CreateMesh(CanvasIndexedMeshOptions options);
+
+    private:
+        uint32_t GetVertexIndex(Vector2 const& vertex);
+    };
+}}}}}
@@ -9,6 +9,15 @@
 using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
 using namespace ABI::Microsoft::Graphics::Canvas;
 
+// Commands are recorded before they reach Direct2D, so out of range enum
+// values must be rejected here rather than left for the sink to report.
+template<typename T>
+static void ValidateEnum(T value, T maximumValue)
+{
+    if (static_cast<uint32_t>(value) > static_cast<uint32_t>(maximumValue))
+        ThrowHR(E_INVALIDARG);
+}
+
 IFACEMETHODIMP CanvasPathBuilderFactory::Create(
     ICanvasResourceCreator* resourceAllocator,
     ICanvasPathBuilder** canvasPathBuilder)
@@ -35,33 +44,30 @@ CanvasPathBuilder::CanvasPathBuilder(
     , m_isInFigure(false)
     , m_beginFigureOccurred(false)
 {
-    auto deviceInternal = As<ICanvasDeviceInternal>(canvasDevice);
-
-    auto d2dPathGeometry = deviceInternal->CreatePathGeometry();
-
-    ComPtr<ID2D1GeometrySink> d2dGeometrySink;
-    ThrowIfFailed(d2dPathGeometry->Open(&d2dGeometrySink));
-
-    m_d2dGeometrySink = d2dGeometrySink;
-
-    m_d2dPathGeometry = d2dPathGeometry;
+    auto recorder = Make<PathDataWriter>(0.0f);
+    CheckMakeResult(recorder);
 
+    m_recorder = recorder;
 }
 
 IFACEMETHODIMP CanvasPathBuilder::Close()
 {
-    if (m_d2dGeometrySink)
+    if (m_recorder)
     {
-        auto d2dGeometrySink = m_d2dGeometrySink.Close();
+        m_recorder.Close();
 
-        //
-        // The word 'Close' is overloaded here.
-        // ID2D1GeometrySink::Close is required to make the sink usable by the 
-        // path geometry. This is different from simply closing the smart pointer. 
-        //
-        d2dGeometrySink->Close();
+        if (m_d2dGeometrySink)
+        {
+            //
+            // The word 'Close' is overloaded here.
+            // ID2D1GeometrySink::Close is required to make the sink usable by the 
+            // path geometry. This is different from simply closing the smart pointer. 
+            //
+            m_d2dGeometrySink->Close();
+            m_d2dGeometrySink.Reset();
+        }
 
-        m_d2dPathGeometry.Close();
+        m_d2dPathGeometry.Reset();
 
         m_canvasDevice.Close();
     }
@@ -76,14 +82,18 @@ IFACEMETHODIMP CanvasPathBuilder::BeginFigureWithFigureFill(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
+
+            ValidateEnum(figureFill, CanvasFigureFill::DoesNotAffectFills);
 
             if (m_isInFigure)
             {
                 ThrowHR(E_INVALIDARG, Strings::TwoBeginFigures);
             }
 
-            d2dGeometrySink->BeginFigure(ToD2DPoint(startPoint), static_cast<D2D1_FIGURE_BEGIN>(figureFill));
+            sink->BeginFigure(ToD2DPoint(startPoint), static_cast<D2D1_FIGURE_BEGIN>(figureFill));
+
+            ThrowIfRecordingFailed();
 
             m_isInFigure = true;
 
@@ -123,17 +133,22 @@ IFACEMETHODIMP CanvasPathBuilder::AddArcToPoint(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
+
+            ValidateEnum(sweepDirection, CanvasSweepDirection::Clockwise);
+            ValidateEnum(arcSize, CanvasArcSize::Large);
 
             ValidateIsInFigure();
 
-            d2dGeometrySink->AddArc(
+            sink->AddArc(
                 D2D1::ArcSegment(
                     ToD2DPoint(endPoint), 
                     D2D1::SizeF(xRadius, yRadius), 
                     ::DirectX::XMConvertToDegrees(rotationAngle),
                     static_cast<D2D1_SWEEP_DIRECTION>(sweepDirection),
                     static_cast<D2D1_ARC_SIZE>(arcSize)));
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -149,7 +164,7 @@ IFACEMETHODIMP CanvasPathBuilder::AddArcAroundEllipse(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
 
             ValidateIsInFigure();
 
@@ -188,17 +203,19 @@ IFACEMETHODIMP CanvasPathBuilder::AddArcAroundEllipse(
             };
 
             // Insert a line to move the current path location to the arc start point.
-            d2dGeometrySink->AddLine(startPoint);
+            sink->AddLine(startPoint);
 
             // Add the arc.
-            d2dGeometrySink->AddArc(arc);
+            sink->AddArc(arc);
 
             // If necessary, add a second arc to complete a full circle.
             if (isFullCircle)
             {
                 arc.point = startPoint;
-                d2dGeometrySink->AddArc(arc);
+                sink->AddArc(arc);
             }
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -210,11 +227,13 @@ IFACEMETHODIMP CanvasPathBuilder::AddCubicBezier(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
 
             ValidateIsInFigure();
 
-            d2dGeometrySink->AddBezier(D2D1::BezierSegment(ToD2DPoint(controlPoint1), ToD2DPoint(controlPoint2), ToD2DPoint(endPoint)));
+            sink->AddBezier(D2D1::BezierSegment(ToD2DPoint(controlPoint1), ToD2DPoint(controlPoint2), ToD2DPoint(endPoint)));
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -224,11 +243,13 @@ IFACEMETHODIMP CanvasPathBuilder::AddLine(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
 
             ValidateIsInFigure();
 
-            d2dGeometrySink->AddLine(ToD2DPoint(endPoint));
+            sink->AddLine(ToD2DPoint(endPoint));
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -246,11 +267,13 @@ IFACEMETHODIMP CanvasPathBuilder::AddQuadraticBezier(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
 
             ValidateIsInFigure();
 
-            d2dGeometrySink->AddQuadraticBezier(D2D1::QuadraticBezierSegment(ToD2DPoint(controlPoint), ToD2DPoint(endPoint)));
+            sink->AddQuadraticBezier(D2D1::QuadraticBezierSegment(ToD2DPoint(controlPoint), ToD2DPoint(endPoint)));
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -262,7 +285,7 @@ IFACEMETHODIMP CanvasPathBuilder::AddGeometry(
         {
             CheckInPointer(geometry);
 
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
 
             auto otherD2DGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
 
@@ -275,15 +298,17 @@ IFACEMETHODIMP CanvasPathBuilder::AddGeometry(
 
             if (otherD2DPathGeometry)
             {
-                ThrowIfFailed(otherD2DPathGeometry->Stream(d2dGeometrySink.Get()));
+                ThrowIfFailed(otherD2DPathGeometry->Stream(sink));
             }
             else
             {
                 ThrowIfFailed(otherD2DGeometry->Simplify(
                     D2D1_GEOMETRY_SIMPLIFICATION_OPTION_CUBICS_AND_LINES,
                     nullptr,
-                    d2dGeometrySink.Get()));
+                    sink));
             }
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -293,9 +318,17 @@ IFACEMETHODIMP CanvasPathBuilder::SetSegmentOptions(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
 
-            d2dGeometrySink->SetSegmentFlags(static_cast<D2D1_PATH_SEGMENT>(figureSegmentOptions));
+            uint32_t const validOptions = static_cast<uint32_t>(CanvasFigureSegmentOptions::ForceUnstroked) |
+                                          static_cast<uint32_t>(CanvasFigureSegmentOptions::ForceRoundLineJoin);
+
+            if (static_cast<uint32_t>(figureSegmentOptions) & ~validOptions)
+                ThrowHR(E_INVALIDARG);
+
+            sink->SetSegmentFlags(static_cast<D2D1_PATH_SEGMENT>(figureSegmentOptions));
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -305,14 +338,18 @@ IFACEMETHODIMP CanvasPathBuilder::SetFilledRegionDetermination(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
+
+            ValidateEnum(filledRegionDetermination, CanvasFilledRegionDetermination::Winding);
 
             if (m_beginFigureOccurred)
             {
                 ThrowHR(E_INVALIDARG, Strings::SetFilledRegionDeterminationAfterBeginFigure);
             }
 
-            d2dGeometrySink->SetFillMode(static_cast<D2D1_FILL_MODE>(filledRegionDetermination));
+            sink->SetFillMode(static_cast<D2D1_FILL_MODE>(filledRegionDetermination));
+
+            ThrowIfRecordingFailed();
         });
 }
 
@@ -322,14 +359,18 @@ IFACEMETHODIMP CanvasPathBuilder::EndFigure(
     return ExceptionBoundary(
         [&]
         {
-            auto& d2dGeometrySink = m_d2dGeometrySink.EnsureNotClosed();
+            auto sink = GetRecordingSink();
+
+            ValidateEnum(figureLoop, CanvasFigureLoop::Closed);
 
             if (!m_isInFigure)
             {
                 ThrowHR(E_INVALIDARG, Strings::EndFigureWithoutBeginFigure);
             }
 
-            d2dGeometrySink->EndFigure(static_cast<D2D1_FIGURE_END>(figureLoop));
+            sink->EndFigure(static_cast<D2D1_FIGURE_END>(figureLoop));
+
+            ThrowIfRecordingFailed();
 
             m_isInFigure = false;
         });
@@ -344,29 +385,61 @@ ComPtr<ICanvasDevice> CanvasPathBuilder::GetDevice()
 
 ComPtr<ID2D1GeometrySink> CanvasPathBuilder::GetGeometrySink()
 {
-    auto& geometrySink = m_d2dGeometrySink.EnsureNotClosed();
+    auto& recorder = m_recorder.EnsureNotClosed();
+
+    if (!m_d2dGeometrySink)
+    {
+        auto d2dPathGeometry = As<ICanvasDeviceInternal>(m_canvasDevice.EnsureNotClosed())->CreatePathGeometry();
+
+        ThrowIfFailed(d2dPathGeometry->Open(&m_d2dGeometrySink));
 
-    return geometrySink;
+        m_d2dPathGeometry = d2dPathGeometry;
+    }
+
+    ThrowIfFailed(recorder->Close());
+
+    auto& data = recorder->GetData();
+    ReadPathData(data.data(), data.size(), m_d2dGeometrySink.Get());
+
+    recorder->Reset();
+
+    return m_d2dGeometrySink;
 }
 
 ComPtr<ID2D1PathGeometry1> CanvasPathBuilder::CloseAndReturnPath()
 {
-    //
-    // The call to Close() below will actually close out m_d2dPathGeometry,
-    // so it is necessary to transfer ownership of it here.
-    //
-    ComPtr<ID2D1PathGeometry1> returnedPathGeometry = m_d2dPathGeometry.EnsureNotClosed();
+    m_recorder.EnsureNotClosed();
 
     if (m_isInFigure)
     {
         ThrowHR(E_INVALIDARG, Strings::PathBuilderClosedMidFigure);
     }
 
+    GetGeometrySink();
+
+    //
+    // The call to Close() below will release m_d2dPathGeometry, so it is
+    // necessary to take a reference to it here.
+    //
+    ComPtr<ID2D1PathGeometry1> returnedPathGeometry = m_d2dPathGeometry;
+
     ThrowIfFailed(Close());
 
     return returnedPathGeometry;
 }
 
+ID2D1GeometrySink* CanvasPathBuilder::GetRecordingSink()
+{
+    return m_recorder.EnsureNotClosed().Get();
+}
+
+void CanvasPathBuilder::ThrowIfRecordingFailed()
+{
+    // The recorder holds on to the first error, such as running out of
+    // memory, so that each later call fails with it too.
+    ThrowIfFailed(m_recorder.EnsureNotClosed()->GetResult());
+}
+
 void CanvasPathBuilder::ValidateIsInFigure()
 {
     if (!m_isInFigure)
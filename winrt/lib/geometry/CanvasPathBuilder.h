@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "PathData.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
 {
     using namespace ::Microsoft::WRL;
@@ -27,6 +29,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     public:
         virtual ComPtr<ICanvasDevice> GetDevice() = 0;
 
+        // Sends everything recorded so far to the D2D path and returns its
+        // sink, so that D2D can write into the path directly.  Anything
+        // written to the sink must be finished before the next call to the
+        // path builder.
         virtual ComPtr<ID2D1GeometrySink> GetGeometrySink() = 0;
 
         virtual ComPtr<ID2D1PathGeometry1> CloseAndReturnPath() = 0;
@@ -49,8 +55,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         //
         
         ClosablePtr<ICanvasDevice> m_canvasDevice;
-        ClosablePtr<ID2D1GeometrySink> m_d2dGeometrySink;
-        ClosablePtr<ID2D1PathGeometry1> m_d2dPathGeometry;
+
+        //
+        // Commands are recorded in one growing buffer, in the same format as
+        // CanvasGeometry.GetPathBytes, rather than being passed to D2D one at
+        // a time.  The D2D path is only opened when it is needed, and the
+        // recording is replayed into it with each run of lines or curves
+        // added in a single call.  Recording errors are reported by the call
+        // that caused them.
+        //
+        ClosablePtr<PathDataWriter> m_recorder;
+
+        ComPtr<ID2D1PathGeometry1> m_d2dPathGeometry;
+        ComPtr<ID2D1GeometrySink> m_d2dGeometrySink;
+
         bool m_isInFigure;
         bool m_beginFigureOccurred;
 
@@ -130,6 +148,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual ComPtr<ID2D1PathGeometry1> CloseAndReturnPath() override;
 
     private:
+        ID2D1GeometrySink* GetRecordingSink();
+        void ThrowIfRecordingFailed();
+
         void ValidateIsInFigure();
     };
 }}}}}
@@ -0,0 +1,337 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasPathSampler.h"
+#include "utils/LockUtilities.h"
+#include "utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+// Points are interpolated in groups of four, one group per SIMD vector.
+static const uint32_t PointsPerGroup = 4;
+
+// Below this many points it is cheaper to run on a single thread.
+static const uint32_t PointsPerChunk = 4096;
+
+
+static ::DirectX::XMVECTOR XM_CALLCONV Gather(std::vector<float> const& values, uint32_t const* indices)
+{
+    return ::DirectX::XMVectorSet(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]]);
+}
+
+
+// Stores four x and four y values as four consecutive Vector2.
+static void XM_CALLCONV StoreGroup(Vector2* values, ::DirectX::FXMVECTOR x, ::DirectX::FXMVECTOR y)
+{
+    ::DirectX::XMStoreFloat4(reinterpret_cast<::DirectX::XMFLOAT4*>(&values[0]), ::DirectX::XMVectorMergeXY(x, y));
+    ::DirectX::XMStoreFloat4(reinterpret_cast<::DirectX::XMFLOAT4*>(&values[2]), ::DirectX::XMVectorMergeZW(x, y));
+}
+
+
+CanvasPathSampler::CanvasPathSampler(Polylines const& polylines, float flatteningTolerance)
+    : m_flatteningTolerance(flatteningTolerance)
+    , m_totalLength(0)
+    , m_closed(false)
+{
+    auto& points = polylines.Points;
+
+    // Lengths are summed in double precision so that long paths made of
+    // many short segments do not drift.
+    double length = 0;
+
+    for (auto& figure : polylines.Figures)
+    {
+        for (auto i = figure.Begin + 1; i < figure.End; ++i)
+        {
+            AddSegment(points[i - 1], points[i], &length);
+        }
+
+        if (figure.IsClosed && figure.End > figure.Begin)
+        {
+            AddSegment(points[figure.End - 1], points[figure.Begin], &length);
+        }
+    }
+
+    // A path with no length still has somewhere to put points: its first
+    // point, or the origin if it is empty, with a zero tangent.
+    if (m_segmentStarts.empty())
+    {
+        auto start = points.empty() ? D2D1_POINT_2F{ 0, 0 } : points.front();
+
+        m_segmentStarts.push_back(0);
+        m_startX.push_back(start.x);
+        m_startY.push_back(start.y);
+        m_directionX.push_back(0);
+        m_directionY.push_back(0);
+    }
+
+    m_totalLength = static_cast<float>(length);
+}
+
+
+void CanvasPathSampler::AddSegment(D2D1_POINT_2F const& start, D2D1_POINT_2F const& end, double* length)
+{
+    double dx = end.x - start.x;
+    double dy = end.y - start.y;
+    double segmentLength = sqrt(dx * dx + dy * dy);
+
+    // Zero length segments can never be found by the search, so are left out.
+    if (!(segmentLength > 0))
+        return;
+
+    m_segmentStarts.push_back(static_cast<float>(*length));
+    m_startX.push_back(start.x);
+    m_startY.push_back(start.y);
+    m_directionX.push_back(static_cast<float>(dx / segmentLength));
+    m_directionY.push_back(static_cast<float>(dy / segmentLength));
+
+    *length += segmentLength;
+}
+
+
+IFACEMETHODIMP CanvasPathSampler::get_TotalLength(float* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        *value = m_totalLength;
+    });
+}
+
+
+IFACEMETHODIMP CanvasPathSampler::get_FlatteningTolerance(float* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        *value = m_flatteningTolerance;
+    });
+}
+
+
+IFACEMETHODIMP CanvasPathSampler::ComputePointOnPath(
+    float distance,
+    Vector2* point)
+{
+    Vector2 tangent;
+    return ComputePointOnPathWithTangent(distance, &tangent, point);
+}
+
+
+IFACEMETHODIMP CanvasPathSampler::ComputePointOnPathWithTangent(
+    float distance,
+    Vector2* tangent,
+    Vector2* point)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(tangent);
+        CheckInPointer(point);
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        ComputePoints(0, 1, &distance, point, tangent);
+    });
+}
+
+
+IFACEMETHODIMP CanvasPathSampler::ComputePointsOnPath(
+    uint32_t distancesCount,
+    float* distances,
+    uint32_t pointsCount,
+    Vector2* points,
+    uint32_t tangentsCount,
+    Vector2* tangents)
+{
+    return ExceptionBoundary([&]
+    {
+        if (distancesCount > 0)
+        {
+            CheckInPointer(distances);
+            CheckInPointer(points);
+        }
+
+        if (tangentsCount > 0)
+            CheckInPointer(tangents);
+
+        if (pointsCount != distancesCount)
+        {
+            WinStringBuilder message;
+            message.Format(Strings::WrongNamedArrayLength, L"points", distancesCount, pointsCount);
+            ThrowHR(E_INVALIDARG, message.Get());
+        }
+
+        // Tangents are optional.
+        if (tangentsCount != 0 && tangentsCount != distancesCount)
+        {
+            WinStringBuilder message;
+            message.Format(Strings::WrongNamedArrayLength, L"tangents", distancesCount, tangentsCount);
+            ThrowHR(E_INVALIDARG, message.Get());
+        }
+
+        Lock lock(m_mutex);
+        ThrowIfClosed();
+
+        ParallelFor(distancesCount, PointsPerChunk,
+            [&](uint32_t begin, uint32_t end)
+            {
+                ComputePoints(begin, end, distances, points, tangentsCount ? tangents : nullptr);
+            });
+    });
+}
+
+
+IFACEMETHODIMP CanvasPathSampler::Close()
+{
+    Lock lock(m_mutex);
+
+    m_closed = true;
+
+    m_segmentStarts.clear();
+    m_startX.clear();
+    m_startY.clear();
+    m_directionX.clear();
+    m_directionY.clear();
+
+    return S_OK;
+}
+
+
+void CanvasPathSampler::ThrowIfClosed()
+{
+    if (m_closed)
+    {
+        ThrowHR(RO_E_CLOSED);
+    }
+}
+
+
+// Distances before the start of the path map to its first point, and
+// distances past the end to its last, as with CanvasGeometry.ComputePointOnPath.
+float CanvasPathSampler::ClampDistance(float distance) const
+{
+    if (!(distance > 0))
+        return 0;
+
+    return std::min(distance, m_totalLength);
+}
+
+
+// Returns the last segment that starts at or before distance.  Batches are
+// usually sorted, or nearly so, so the segment found for the previous
+// distance is tried before falling back to a binary search.
+uint32_t CanvasPathSampler::FindSegment(float distance, uint32_t hint) const
+{
+    auto count = static_cast<uint32_t>(m_segmentStarts.size());
+
+    for (auto i = hint; i < std::min(hint + 2, count); ++i)
+    {
+        if (m_segmentStarts[i] <= distance && (i + 1 == count || distance < m_segmentStarts[i + 1]))
+            return i;
+    }
+
+    auto it = std::upper_bound(m_segmentStarts.begin(), m_segmentStarts.end(), distance);
+
+    return static_cast<uint32_t>(std::max(it - m_segmentStarts.begin(), ptrdiff_t(1)) - 1);
+}
+
+
+//
+// Finds the segment for each distance one at a time, then interpolates four
+// points at a time.  Tangents may be null.
+//
+void CanvasPathSampler::ComputePoints(uint32_t begin, uint32_t end, float const* distances, Vector2* points, Vector2* tangents) const
+{
+    uint32_t hint = 0;
+    uint32_t i = begin;
+
+    for (; i + PointsPerGroup <= end; i += PointsPerGroup)
+    {
+        float clamped[PointsPerGroup];
+        uint32_t segments[PointsPerGroup];
+
+        for (uint32_t j = 0; j < PointsPerGroup; ++j)
+        {
+            clamped[j] = ClampDistance(distances[i + j]);
+            segments[j] = hint = FindSegment(clamped[j], hint);
+        }
+
+        auto t = ::DirectX::XMVectorSubtract(::DirectX::XMLoadFloat4(reinterpret_cast<::DirectX::XMFLOAT4 const*>(clamped)), Gather(m_segmentStarts, segments));
+        auto directionX = Gather(m_directionX, segments);
+        auto directionY = Gather(m_directionY, segments);
+
+        StoreGroup(&points[i],
+                   ::DirectX::XMVectorMultiplyAdd(directionX, t, Gather(m_startX, segments)),
+                   ::DirectX::XMVectorMultiplyAdd(directionY, t, Gather(m_startY, segments)));
+
+        if (tangents)
+            StoreGroup(&tangents[i], directionX, directionY);
+    }
+
+    for (; i < end; ++i)
+    {
+        auto distance = ClampDistance(distances[i]);
+        auto segment = hint = FindSegment(distance, hint);
+        auto t = distance - m_segmentStarts[segment];
+
+        points[i] = Vector2{ m_startX[segment] + m_directionX[segment] * t,
+                             m_startY[segment] + m_directionY[segment] * t };
+
+        if (tangents)
+            tangents[i] = Vector2{ m_directionX[segment], m_directionY[segment] };
+    }
+}
+
+
+//
+// CanvasPathSamplerFactory implementation
+//
+
+IFACEMETHODIMP CanvasPathSamplerFactory::Create(
+    ICanvasGeometry* geometry,
+    ICanvasPathSampler** pathSampler)
+{
+    return CreateWithFlatteningTolerance(geometry, D2D1_DEFAULT_FLATTENING_TOLERANCE, pathSampler);
+}
+
+
+IFACEMETHODIMP CanvasPathSamplerFactory::CreateWithFlatteningTolerance(
+    ICanvasGeometry* geometry,
+    float flatteningTolerance,
+    ICanvasPathSampler** pathSampler)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(geometry);
+        CheckAndClearOutPointer(pathSampler);
+
+        if (!(flatteningTolerance > 0))
+            ThrowHR(E_INVALIDARG, Strings::ExpectedPositiveNonzero);
+
+        auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
+
+        Polylines polylines;
+        PolylineSink::Flatten(d2dGeometry.Get(), flatteningTolerance, &polylines);
+
+        auto newPathSampler = Make<CanvasPathSampler>(polylines, flatteningTolerance);
+        CheckMakeResult(newPathSampler);
+
+        ThrowIfFailed(newPathSampler.CopyTo(pathSampler));
+    });
+}
+
+
+ActivatableClassWithFactory(CanvasPathSampler, CanvasPathSamplerFactory);
@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "PolylineSink.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // Samples points along a path without going back to Direct2D.
+    //
+    // The geometry is flattened once, when the sampler is created, into a
+    // table of line segments holding the distance along the path at which
+    // each one starts.  Each query is then a binary search of that table
+    // followed by a linear interpolation.  Batched queries interpolate four
+    // points at a time with DirectXMath, and spread large batches across
+    // threads.
+    //
+    // The table is stored as separate arrays per field, and never changes
+    // after construction, so queries only need to lock out Close.
+    //
+    class CanvasPathSampler
+        : public RuntimeClass<ICanvasPathSampler, IClosable>
+        , private LifespanTracker<CanvasPathSampler>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasPathSampler, BaseTrust);
+
+        float m_flatteningTolerance;
+        float m_totalLength;
+        bool m_closed;
+
+        std::mutex m_mutex;
+
+        std::vector<float> m_segmentStarts;     // Distance along the path, in ascending order
+        std::vector<float> m_startX;
+        std::vector<float> m_startY;
+        std::vector<float> m_directionX;        // Unit vectors
+        std::vector<float> m_directionY;
+
+    public:
+        CanvasPathSampler(Polylines const& polylines, float flatteningTolerance);
+
+        // Exposed for testing.
+        uint32_t GetSegmentCount() const { return static_cast<uint32_t>(m_segmentStarts.size()); }
+
+        //
+        // ICanvasPathSampler
+        //
+
+        IFACEMETHOD(get_TotalLength)(float* value) override;
+
+        IFACEMETHOD(get_FlatteningTolerance)(float* value) override;
+
+        IFACEMETHOD(ComputePointOnPath)(
+            float distance,
+            Vector2* point) override;
+
+        IFACEMETHOD(ComputePointOnPathWithTangent)(
+            float distance,
+            Vector2* tangent,
+            Vector2* point) override;
+
+        IFACEMETHOD(ComputePointsOnPath)(
+            uint32_t distancesCount,
+            float* distances,
+            uint32_t pointsCount,
+            Vector2* points,
+            uint32_t tangentsCount,
+            Vector2* tangents) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        void ThrowIfClosed();
+
+        void AddSegment(D2D1_POINT_2F const& start, D2D1_POINT_2F const& end, double* length);
+
+        float ClampDistance(float distance) const;
+        uint32_t FindSegment(float distance, uint32_t hint) const;
+
+        void ComputePoints(uint32_t begin, uint32_t end, float const* distances, Vector2* points, Vector2* tangents) const;
+    };
+
+
+    class CanvasPathSamplerFactory
+        : public AgileActivationFactory<ICanvasPathSamplerFactory>
+        , private LifespanTracker<CanvasPathSamplerFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasPathSampler, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            ICanvasGeometry* geometry,
+            ICanvasPathSampler** pathSampler) override;
+
+        IFACEMETHOD(CreateWithFlatteningTolerance)(
+            ICanvasGeometry* geometry,
+            float flatteningTolerance,
+            ICanvasPathSampler** pathSampler) override;
+    };
+}}}}}
@@ -0,0 +1,628 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CpuTessellator.h"
+#include "utils/LockUtilities.h"
+#include "utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+// Very small tolerances would split curves into huge numbers of segments.
+static const float MinimumFlatteningTolerance = 1.0f / 1000.0f;
+static const float MaximumSubdivisions = 1024;
+
+// Below these sizes it is cheaper to run on a single thread.
+static const uint32_t FiguresPerChunk = 16;
+static const uint32_t SlabsPerChunk = 64;
+
+
+namespace
+{
+    struct Edge
+    {
+        float TopX;
+        float TopY;
+        float BottomY;
+        float InverseSlope;     // Change in x per unit of y
+        int Winding;            // +1 if the edge originally went down, -1 if up
+
+        float XAt(float y) const
+        {
+            return TopX + (y - TopY) * InverseSlope;
+        }
+    };
+
+    struct SlabEdge
+    {
+        Edge const* Source;
+        float TopX;
+        float BottomX;
+    };
+}
+
+
+static D2D1_POINT_2F Lerp(D2D1_POINT_2F const& a, D2D1_POINT_2F const& b, float t)
+{
+    return D2D1_POINT_2F{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+
+static float SecondDifference(D2D1_POINT_2F const& a, D2D1_POINT_2F const& b, D2D1_POINT_2F const& c)
+{
+    auto x = a.x - 2 * b.x + c.x;
+    auto y = a.y - 2 * b.y + c.y;
+
+    return sqrtf(x * x + y * y);
+}
+
+
+//
+// Uses Wang's formula to work out how many equal steps in t keep a Bezier
+// curve within the tolerance.  factor is degree * (degree - 1) / 8.
+//
+static uint32_t GetSubdivisionCount(float factor, float secondDifference, float tolerance)
+{
+    auto count = ceilf(sqrtf(factor * secondDifference / tolerance));
+
+    // Also catches NaN.
+    if (!(count >= 1))
+        return 1;
+
+    return static_cast<uint32_t>(std::min(count, MaximumSubdivisions));
+}
+
+
+static void FlattenQuadraticBezier(
+    D2D1_POINT_2F const& p0,
+    D2D1_POINT_2F const& p1,
+    D2D1_POINT_2F const& p2,
+    float tolerance,
+    std::vector<D2D1_POINT_2F>* points)
+{
+    auto count = GetSubdivisionCount(2.0f / 8.0f, SecondDifference(p0, p1, p2), tolerance);
+
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        auto t = static_cast<float>(i) / count;
+
+        points->push_back(Lerp(Lerp(p0, p1, t), Lerp(p1, p2, t), t));
+    }
+
+    points->push_back(p2);
+}
+
+
+static void FlattenCubicBezier(
+    D2D1_POINT_2F const& p0,
+    D2D1_POINT_2F const& p1,
+    D2D1_POINT_2F const& p2,
+    D2D1_POINT_2F const& p3,
+    float tolerance,
+    std::vector<D2D1_POINT_2F>* points)
+{
+    auto secondDifference = std::max(SecondDifference(p0, p1, p2), SecondDifference(p1, p2, p3));
+    auto count = GetSubdivisionCount(6.0f / 8.0f, secondDifference, tolerance);
+
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        auto t = static_cast<float>(i) / count;
+
+        auto a = Lerp(p0, p1, t);
+        auto b = Lerp(p1, p2, t);
+        auto c = Lerp(p2, p3, t);
+
+        points->push_back(Lerp(Lerp(a, b, t), Lerp(b, c, t), t));
+    }
+
+    points->push_back(p3);
+}
+
+
+static float AngleBetween(float ux, float uy, float vx, float vy)
+{
+    return atan2f(ux * vy - uy * vx, ux * vx + uy * vy);
+}
+
+
+//
+// Converts the arc from endpoint to center parameterization (as described in
+// the SVG specification, appendix F.6) in the coordinate space of the path,
+// then steps around the ellipse by an angle small enough to stay within the
+// tolerance once the transform is applied.
+//
+static void FlattenArc(
+    D2D1_POINT_2F const& startPoint,
+    D2D1_ARC_SEGMENT const& arc,
+    D2D1::Matrix3x2F const& transform,
+    float transformScale,
+    float tolerance,
+    std::vector<D2D1_POINT_2F>* points)
+{
+    auto& endPoint = arc.point;
+
+    if (startPoint.x == endPoint.x && startPoint.y == endPoint.y)
+        return;
+
+    auto rx = fabsf(arc.size.width);
+    auto ry = fabsf(arc.size.height);
+
+    if (rx == 0 || ry == 0)
+    {
+        points->push_back(transform.TransformPoint(endPoint));
+        return;
+    }
+
+    auto rotation = ::DirectX::XMConvertToRadians(arc.rotationAngle);
+    auto cosRotation = cosf(rotation);
+    auto sinRotation = sinf(rotation);
+
+    auto dx = (startPoint.x - endPoint.x) / 2;
+    auto dy = (startPoint.y - endPoint.y) / 2;
+
+    auto x1 =  cosRotation * dx + sinRotation * dy;
+    auto y1 = -sinRotation * dx + cosRotation * dy;
+
+    // Scale up radii that are too small to reach the end point.
+    auto lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+
+    if (lambda > 1)
+    {
+        rx *= sqrtf(lambda);
+        ry *= sqrtf(lambda);
+    }
+
+    auto numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    auto denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+
+    bool isClockwise = (arc.sweepDirection == D2D1_SWEEP_DIRECTION_CLOCKWISE);
+    bool isLarge = (arc.arcSize == D2D1_ARC_SIZE_LARGE);
+
+    auto coefficient = sqrtf(std::max(0.0f, numerator / denominator));
+
+    if (isLarge == isClockwise)
+        coefficient = -coefficient;
+
+    auto cx1 =  coefficient * rx * y1 / ry;
+    auto cy1 = -coefficient * ry * x1 / rx;
+
+    auto cx = cosRotation * cx1 - sinRotation * cy1 + (startPoint.x + endPoint.x) / 2;
+    auto cy = sinRotation * cx1 + cosRotation * cy1 + (startPoint.y + endPoint.y) / 2;
+
+    auto startAngle = AngleBetween(1, 0, (x1 - cx1) / rx, (y1 - cy1) / ry);
+    auto sweepAngle = AngleBetween((x1 - cx1) / rx, (y1 - cy1) / ry, (-x1 - cx1) / rx, (-y1 - cy1) / ry);
+
+    if (isClockwise && sweepAngle < 0)
+        sweepAngle += ::DirectX::XM_2PI;
+    else if (!isClockwise && sweepAngle > 0)
+        sweepAngle -= ::DirectX::XM_2PI;
+
+    // The largest angle step whose chord stays within the tolerance of a
+    // circle with the larger radius.
+    auto radius = std::max(rx, ry) * transformScale;
+    auto maximumStep = (radius > tolerance) ? 2 * acosf(1 - tolerance / radius) : ::DirectX::XM_PI;
+    auto count = ceilf(fabsf(sweepAngle) / maximumStep);
+
+    if (!(count >= 1))
+        count = 1;
+
+    auto stepCount = static_cast<uint32_t>(std::min(count, MaximumSubdivisions));
+
+    for (uint32_t i = 1; i < stepCount; ++i)
+    {
+        auto angle = startAngle + sweepAngle * i / stepCount;
+        auto ex = rx * cosf(angle);
+        auto ey = ry * sinf(angle);
+
+        D2D1_POINT_2F point
+        {
+            cx + ex * cosRotation - ey * sinRotation,
+            cy + ex * sinRotation + ey * cosRotation
+        };
+
+        points->push_back(transform.TransformPoint(point));
+    }
+
+    points->push_back(transform.TransformPoint(endPoint));
+}
+
+
+static void AddPolygonEdges(std::vector<D2D1_POINT_2F> const& polygon, std::vector<Edge>* edges)
+{
+    auto count = polygon.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& a = polygon[i];
+        auto& b = polygon[(i + 1) % count];
+
+        // Horizontal edges never bound a span, and edges with non-finite
+        // coordinates cannot be sorted.
+        if (a.y == b.y || !isfinite(a.x) || !isfinite(a.y) || !isfinite(b.x) || !isfinite(b.y))
+            continue;
+
+        auto& top = (a.y < b.y) ? a : b;
+        auto& bottom = (a.y < b.y) ? b : a;
+
+        edges->push_back(Edge{ top.x, top.y, bottom.y, (bottom.x - top.x) / (bottom.y - top.y), (a.y < b.y) ? 1 : -1 });
+    }
+}
+
+
+static void AddTrapezoid(
+    float top,
+    float bottom,
+    SlabEdge const& left,
+    SlabEdge const& right,
+    std::vector<CanvasTriangleVertices>* triangles)
+{
+    Vector2 leftTop{ left.TopX, top };
+    Vector2 rightTop{ right.TopX, top };
+    Vector2 leftBottom{ left.BottomX, bottom };
+    Vector2 rightBottom{ right.BottomX, bottom };
+
+    if (right.TopX > left.TopX)
+        triangles->push_back(CanvasTriangleVertices{ leftTop, rightTop, leftBottom });
+
+    if (right.BottomX > left.BottomX)
+        triangles->push_back(CanvasTriangleVertices{ rightTop, rightBottom, leftBottom });
+}
+
+
+//
+// Triangulates the part of the fill between two consecutive vertex heights.
+// Every active edge spans the whole slab, but edges may cross inside it, so
+// the slab is split again at each crossing.
+//
+static void TriangulateSlab(
+    float top,
+    float bottom,
+    std::vector<Edge const*> const& activeEdges,
+    D2D1_FILL_MODE fillMode,
+    std::vector<SlabEdge>* slabEdges,
+    std::vector<CanvasTriangleVertices>* triangles)
+{
+    auto isInside = [=](int winding) { return (fillMode == D2D1_FILL_MODE_ALTERNATE) ? (winding & 1) != 0 : winding != 0; };
+
+    while (top < bottom)
+    {
+        slabEdges->clear();
+
+        for (auto edge : activeEdges)
+        {
+            slabEdges->push_back(SlabEdge{ edge, edge->XAt(top), edge->XAt(bottom) });
+        }
+
+        std::sort(slabEdges->begin(), slabEdges->end(),
+            [](SlabEdge const& a, SlabEdge const& b)
+            {
+                return (a.TopX != b.TopX) ? a.TopX < b.TopX : a.BottomX < b.BottomX;
+            });
+
+        // The first crossing in the slab is always between edges that are
+        // next to each other at the top.
+        auto splitY = bottom;
+
+        for (size_t i = 1; i < slabEdges->size(); ++i)
+        {
+            auto& a = (*slabEdges)[i - 1];
+            auto& b = (*slabEdges)[i];
+
+            if (b.BottomX < a.BottomX)
+            {
+                auto topGap = b.TopX - a.TopX;
+                auto t = topGap / (topGap - (b.BottomX - a.BottomX));
+                auto crossingY = top + t * (bottom - top);
+
+                if (crossingY > top && crossingY < splitY)
+                    splitY = crossingY;
+            }
+        }
+
+        if (splitY != bottom)
+        {
+            for (auto& slabEdge : *slabEdges)
+            {
+                slabEdge.BottomX = slabEdge.Source->XAt(splitY);
+            }
+
+            std::sort(slabEdges->begin(), slabEdges->end(),
+                [](SlabEdge const& a, SlabEdge const& b)
+                {
+                    return a.TopX + a.BottomX < b.TopX + b.BottomX;
+                });
+        }
+
+        // Walk across the slab, emitting one trapezoid per filled span.
+        int winding = 0;
+        size_t spanStart = 0;
+
+        for (size_t i = 0; i < slabEdges->size(); ++i)
+        {
+            bool wasInside = isInside(winding);
+            winding += (*slabEdges)[i].Source->Winding;
+
+            if (!wasInside && isInside(winding))
+                spanStart = i;
+            else if (wasInside && !isInside(winding))
+                AddTrapezoid(top, splitY, (*slabEdges)[spanStart], (*slabEdges)[i], triangles);
+        }
+
+        top = splitY;
+    }
+}
+
+
+CpuTessellator::CpuTessellator(D2D1_MATRIX_3X2_F const& transform, float flatteningTolerance)
+    : m_transform(transform)
+    , m_flatteningTolerance(flatteningTolerance)
+    , m_fillMode(D2D1_FILL_MODE_ALTERNATE)
+    , m_inFilledFigure(false)
+    , m_result(S_OK)
+{
+    if (!(m_flatteningTolerance >= MinimumFlatteningTolerance))
+        m_flatteningTolerance = MinimumFlatteningTolerance;
+}
+
+
+std::vector<CanvasTriangleVertices> CpuTessellator::Tessellate()
+{
+    ThrowIfFailed(m_result);
+
+    // Flatten each figure to a polygon.
+    std::vector<std::vector<D2D1_POINT_2F>> polygons(m_figures.size());
+
+    ParallelFor(static_cast<uint32_t>(m_figures.size()), FiguresPerChunk,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                polygons[i] = FlattenFigure(m_figures[i]);
+            }
+        });
+
+    std::vector<Edge> edges;
+
+    for (auto& polygon : polygons)
+    {
+        AddPolygonEdges(polygon, &edges);
+    }
+
+    std::sort(edges.begin(), edges.end(), [](Edge const& a, Edge const& b) { return a.TopY < b.TopY; });
+
+    // Every vertex starts a new slab.
+    std::vector<float> slabBoundaries;
+    slabBoundaries.reserve(edges.size() * 2);
+
+    for (auto& edge : edges)
+    {
+        slabBoundaries.push_back(edge.TopY);
+        slabBoundaries.push_back(edge.BottomY);
+    }
+
+    std::sort(slabBoundaries.begin(), slabBoundaries.end());
+    slabBoundaries.erase(std::unique(slabBoundaries.begin(), slabBoundaries.end()), slabBoundaries.end());
+
+    auto slabCount = slabBoundaries.empty() ? 0 : static_cast<uint32_t>(slabBoundaries.size() - 1);
+
+    // Each chunk of slabs is triangulated separately, and the results are
+    // joined in order so the output does not depend on the thread count.
+    std::mutex chunksMutex;
+    std::vector<std::pair<uint32_t, std::vector<CanvasTriangleVertices>>> chunks;
+
+    ParallelFor(slabCount, SlabsPerChunk,
+        [&](uint32_t begin, uint32_t end)
+        {
+            std::vector<CanvasTriangleVertices> triangles;
+            std::vector<Edge const*> activeEdges;
+            std::vector<SlabEdge> slabEdges;
+
+            auto nextEdge = edges.begin();
+
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                auto top = slabBoundaries[i];
+                auto bottom = slabBoundaries[i + 1];
+
+                for (; nextEdge != edges.end() && nextEdge->TopY <= top; ++nextEdge)
+                {
+                    if (nextEdge->BottomY > top)
+                        activeEdges.push_back(&*nextEdge);
+                }
+
+                activeEdges.erase(
+                    std::remove_if(activeEdges.begin(), activeEdges.end(), [=](Edge const* edge) { return edge->BottomY <= top; }),
+                    activeEdges.end());
+
+                TriangulateSlab(top, bottom, activeEdges, m_fillMode, &slabEdges, &triangles);
+            }
+
+            Lock lock(chunksMutex);
+            chunks.emplace_back(begin, std::move(triangles));
+        });
+
+    std::sort(chunks.begin(), chunks.end(),
+        [](std::pair<uint32_t, std::vector<CanvasTriangleVertices>> const& a, std::pair<uint32_t, std::vector<CanvasTriangleVertices>> const& b)
+        {
+            return a.first < b.first;
+        });
+
+    size_t triangleCount = 0;
+
+    for (auto& chunk : chunks)
+    {
+        triangleCount += chunk.second.size();
+    }
+
+    std::vector<CanvasTriangleVertices> result;
+    result.reserve(triangleCount);
+
+    for (auto& chunk : chunks)
+    {
+        result.insert(result.end(), chunk.second.begin(), chunk.second.end());
+    }
+
+    return result;
+}
+
+
+std::vector<D2D1_POINT_2F> CpuTessellator::FlattenFigure(Figure const& figure) const
+{
+    // Arcs are flattened before they are transformed, so their tolerance
+    // is scaled by (an upper bound of) how much the transform enlarges them.
+    auto transformScale = sqrtf(m_transform._11 * m_transform._11 +
+                                m_transform._12 * m_transform._12 +
+                                m_transform._21 * m_transform._21 +
+                                m_transform._22 * m_transform._22);
+
+    std::vector<D2D1_POINT_2F> points;
+
+    auto currentPoint = figure.StartPoint;
+    points.push_back(m_transform.TransformPoint(currentPoint));
+
+    for (auto& segment : figure.Segments)
+    {
+        auto start = points.back();
+
+        switch (segment.Type)
+        {
+        case SegmentType::Line:
+            points.push_back(m_transform.TransformPoint(segment.Points[0]));
+            currentPoint = segment.Points[0];
+            break;
+
+        case SegmentType::QuadraticBezier:
+            FlattenQuadraticBezier(
+                start,
+                m_transform.TransformPoint(segment.Points[0]),
+                m_transform.TransformPoint(segment.Points[1]),
+                m_flatteningTolerance,
+                &points);
+            currentPoint = segment.Points[1];
+            break;
+
+        case SegmentType::CubicBezier:
+            FlattenCubicBezier(
+                start,
+                m_transform.TransformPoint(segment.Points[0]),
+                m_transform.TransformPoint(segment.Points[1]),
+                m_transform.TransformPoint(segment.Points[2]),
+                m_flatteningTolerance,
+                &points);
+            currentPoint = segment.Points[2];
+            break;
+
+        case SegmentType::Arc:
+            FlattenArc(currentPoint, segment.Arc, m_transform, transformScale, m_flatteningTolerance, &points);
+            currentPoint = segment.Arc.point;
+            break;
+        }
+    }
+
+    return points;
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::SetFillMode(D2D1_FILL_MODE fillMode)
+{
+    m_fillMode = fillMode;
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::SetSegmentFlags(D2D1_PATH_SEGMENT)
+{
+    // Segment flags only affect stroking.
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::BeginFigure(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin)
+{
+    m_inFilledFigure = (figureBegin == D2D1_FIGURE_BEGIN_FILLED);
+
+    if (!m_inFilledFigure || FAILED(m_result))
+        return;
+
+    m_result = ExceptionBoundary([&]
+    {
+        m_figures.push_back(Figure{ startPoint });
+    });
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddLine(D2D1_POINT_2F point)
+{
+    AddSegment(Segment{ SegmentType::Line, { point } });
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddLines(CONST D2D1_POINT_2F* points, UINT32 pointsCount)
+{
+    for (uint32_t i = 0; i < pointsCount; ++i)
+    {
+        AddLine(points[i]);
+    }
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddBezier(CONST D2D1_BEZIER_SEGMENT* bezier)
+{
+    AddSegment(Segment{ SegmentType::CubicBezier, { bezier->point1, bezier->point2, bezier->point3 } });
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddBeziers(CONST D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount)
+{
+    for (uint32_t i = 0; i < beziersCount; ++i)
+    {
+        AddBezier(&beziers[i]);
+    }
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddQuadraticBezier(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* bezier)
+{
+    AddSegment(Segment{ SegmentType::QuadraticBezier, { bezier->point1, bezier->point2 } });
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddQuadraticBeziers(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount)
+{
+    for (uint32_t i = 0; i < beziersCount; ++i)
+    {
+        AddQuadraticBezier(&beziers[i]);
+    }
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::AddArc(CONST D2D1_ARC_SEGMENT* arc)
+{
+    AddSegment(Segment{ SegmentType::Arc, { arc->point }, *arc });
+}
+
+
+IFACEMETHODIMP_(void) CpuTessellator::EndFigure(D2D1_FIGURE_END)
+{
+    // Filled figures are always closed.
+    m_inFilledFigure = false;
+}
+
+
+IFACEMETHODIMP CpuTessellator::Close()
+{
+    return m_result;
+}
+
+
+void CpuTessellator::AddSegment(Segment const& segment)
+{
+    if (!m_inFilledFigure || FAILED(m_result))
+        return;
+
+    m_result = ExceptionBoundary([&]
+    {
+        m_figures.back().Segments.push_back(segment);
+    });
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // Tessellates the interior of a path on the CPU, without using Direct2D.
+    //
+    // Path commands are received through ID2D1GeometrySink, so this can be
+    // passed to ID2D1PathGeometry::Stream or ID2D1Geometry::Simplify exactly
+    // like GeometrySink.  Nothing is computed until Tessellate is called:
+    //
+    //  - Each figure is flattened to a polygon, with curves and arcs split
+    //    into just enough line segments to stay within the flattening
+    //    tolerance.  Figures are flattened in parallel.
+    //
+    //  - The polygons are cut into horizontal slabs at every vertex and edge
+    //    intersection.  Within a slab no edges cross, so the filled spans
+    //    between edges (chosen by the fill mode) are trapezoids, which are
+    //    emitted as pairs of triangles.  Slabs are triangulated in parallel.
+    //
+    // Figures that begin with D2D1_FIGURE_BEGIN_HOLLOW do not affect fills,
+    // so are ignored.  All other figures are treated as closed.
+    //
+    class CpuTessellator : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1GeometrySink>,
+                           private LifespanTracker<CpuTessellator>
+    {
+    public:
+        enum class SegmentType
+        {
+            Line,
+            QuadraticBezier,
+            CubicBezier,
+            Arc
+        };
+
+        struct Segment
+        {
+            SegmentType Type;
+            D2D1_POINT_2F Points[3];    // End point is always the last one used by the type
+            D2D1_ARC_SEGMENT Arc;
+        };
+
+        struct Figure
+        {
+            D2D1_POINT_2F StartPoint;
+            std::vector<Segment> Segments;
+        };
+
+    private:
+        D2D1::Matrix3x2F m_transform;
+        float m_flatteningTolerance;
+        D2D1_FILL_MODE m_fillMode;
+
+        std::vector<Figure> m_figures;
+        bool m_inFilledFigure;
+
+        HRESULT m_result;
+
+    public:
+        CpuTessellator(D2D1_MATRIX_3X2_F const& transform, float flatteningTolerance);
+
+        //
+        // Flattens and triangulates everything received so far.
+        //
+        std::vector<CanvasTriangleVertices> Tessellate();
+
+        //
+        // Flattens a single figure to a polygon in output coordinates.
+        // Exposed for testing.
+        //
+        std::vector<D2D1_POINT_2F> FlattenFigure(Figure const& figure) const;
+
+        //
+        // ID2D1GeometrySink
+        //
+
+        IFACEMETHODIMP_(void) SetFillMode(D2D1_FILL_MODE fillMode) override;
+        IFACEMETHODIMP_(void) SetSegmentFlags(D2D1_PATH_SEGMENT vertexFlags) override;
+        IFACEMETHODIMP_(void) BeginFigure(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin) override;
+        IFACEMETHODIMP_(void) AddLine(D2D1_POINT_2F point) override;
+        IFACEMETHODIMP_(void) AddLines(CONST D2D1_POINT_2F* points, UINT32 pointsCount) override;
+        IFACEMETHODIMP_(void) AddBezier(CONST D2D1_BEZIER_SEGMENT* bezier) override;
+        IFACEMETHODIMP_(void) AddBeziers(CONST D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override;
+        IFACEMETHODIMP_(void) AddQuadraticBezier(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* bezier) override;
+        IFACEMETHODIMP_(void) AddQuadraticBeziers(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override;
+        IFACEMETHODIMP_(void) AddArc(CONST D2D1_ARC_SEGMENT* arc) override;
+        IFACEMETHODIMP_(void) EndFigure(D2D1_FIGURE_END figureEnd) override;
+        IFACEMETHODIMP Close() override;
+
+    private:
+        void AddSegment(Segment const& segment);
+    };
+}}}}}
@@ -0,0 +1,273 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasGeometry.h"
+#include "GeometryCombiner.h"
+#include "utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+namespace
+{
+    // Fewer items than these are processed on the calling thread.
+    const uint32_t MinimumGeometriesPerChunk = 64;
+    const uint32_t MinimumPairsPerChunk = 4;
+
+
+    bool BoundsIntersect(D2D1_RECT_F const& a, D2D1_RECT_F const& b)
+    {
+        return a.left < b.right && b.left < a.right &&
+               a.top < b.bottom && b.top < a.bottom;
+    }
+
+
+    D2D1_RECT_F UnionBounds(D2D1_RECT_F const& a, D2D1_RECT_F const& b)
+    {
+        return D2D1_RECT_F{ std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+    }
+
+
+    D2D1_RECT_F IntersectBounds(D2D1_RECT_F const& a, D2D1_RECT_F const& b)
+    {
+        return D2D1_RECT_F{ std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right), std::min(a.bottom, b.bottom) };
+    }
+
+
+    // Rectangles, rounded rectangles and ellipses are single convex figures,
+    // so they fill the same region whatever the fill mode.
+    bool IsFillModeIndependent(ID2D1Geometry* geometry)
+    {
+        if (MaybeAs<ID2D1RectangleGeometry>(geometry) ||
+            MaybeAs<ID2D1RoundedRectangleGeometry>(geometry) ||
+            MaybeAs<ID2D1EllipseGeometry>(geometry))
+        {
+            return true;
+        }
+
+        auto transformedGeometry = MaybeAs<ID2D1TransformedGeometry>(geometry);
+
+        if (transformedGeometry)
+        {
+            ComPtr<ID2D1Geometry> sourceGeometry;
+            transformedGeometry->GetSourceGeometry(&sourceGeometry);
+
+            return IsFillModeIndependent(sourceGeometry.Get());
+        }
+
+        return false;
+    }
+
+
+    struct CombinerNode
+    {
+        ComPtr<ID2D1Geometry> Geometry;
+
+        // May be larger than the geometry, but never smaller.
+        D2D1_RECT_F Bounds;
+
+        // Fill mode independent nodes can be grouped together without
+        // combining them, as long as their bounds do not overlap.
+        bool IsFillModeIndependent;
+
+        // True if Geometry is a path written by the combiner.
+        bool IsCombinedPath;
+    };
+
+
+    class Combiner
+    {
+        ICanvasDeviceInternal* m_device;
+        float m_flatteningTolerance;
+
+    public:
+        Combiner(ICanvasDeviceInternal* device, float flatteningTolerance)
+            : m_device(device)
+            , m_flatteningTolerance(flatteningTolerance)
+        {
+        }
+
+        std::vector<CombinerNode> MakeLeaves(std::vector<ComPtr<ID2D1Geometry>> const& geometries)
+        {
+            std::vector<CombinerNode> leaves(geometries.size());
+
+            ParallelFor(static_cast<uint32_t>(geometries.size()), MinimumGeometriesPerChunk,
+                [&](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        auto& leaf = leaves[i];
+
+                        leaf.Geometry = geometries[i];
+                        leaf.IsFillModeIndependent = IsFillModeIndependent(geometries[i].Get());
+                        leaf.IsCombinedPath = false;
+
+                        ThrowIfFailed(geometries[i]->GetBounds(nullptr, &leaf.Bounds));
+                    }
+                });
+
+            return leaves;
+        }
+
+        CombinerNode Combine(CombinerNode const& a, CombinerNode const& b, D2D1_COMBINE_MODE combineMode)
+        {
+            bool isUnionOrXor = (combineMode == D2D1_COMBINE_MODE_UNION || combineMode == D2D1_COMBINE_MODE_XOR);
+
+            if (isUnionOrXor &&
+                a.IsFillModeIndependent &&
+                b.IsFillModeIndependent &&
+                !BoundsIntersect(a.Bounds, b.Bounds))
+            {
+                // With nothing in common, the union or xor of the pair is
+                // simply both of them, so there is no need to combine them.
+                ID2D1Geometry* pair[] = { a.Geometry.Get(), b.Geometry.Get() };
+
+                auto group = m_device->CreateGeometryGroup(D2D1_FILL_MODE_ALTERNATE, pair, _countof(pair));
+
+                return CombinerNode{ group, UnionBounds(a.Bounds, b.Bounds), true, false };
+            }
+
+            auto path = m_device->CreatePathGeometry();
+
+            ComPtr<ID2D1GeometrySink> sink;
+            ThrowIfFailed(path->Open(&sink));
+
+            ThrowIfFailed(a.Geometry->CombineWithGeometry(b.Geometry.Get(), combineMode, nullptr, m_flatteningTolerance, sink.Get()));
+
+            ThrowIfFailed(sink->Close());
+
+            D2D1_RECT_F bounds;
+
+            switch (combineMode)
+            {
+            case D2D1_COMBINE_MODE_INTERSECT:
+                bounds = IntersectBounds(a.Bounds, b.Bounds);
+                break;
+
+            case D2D1_COMBINE_MODE_EXCLUDE:
+                bounds = a.Bounds;
+                break;
+
+            default:
+                bounds = UnionBounds(a.Bounds, b.Bounds);
+                break;
+            }
+
+            // D2D writes the result of a combine as figures that do not
+            // overlap, so its fill does not depend on the fill mode.
+            return CombinerNode{ path, bounds, true, true };
+        }
+
+        CombinerNode Reduce(std::vector<CombinerNode> nodes, D2D1_COMBINE_MODE combineMode)
+        {
+            assert(!nodes.empty());
+
+            while (nodes.size() > 1)
+            {
+                auto pairCount = static_cast<uint32_t>(nodes.size() / 2);
+
+                std::vector<CombinerNode> nextLevel((nodes.size() + 1) / 2);
+
+                ParallelFor(pairCount, MinimumPairsPerChunk,
+                    [&](uint32_t begin, uint32_t end)
+                    {
+                        for (uint32_t i = begin; i < end; ++i)
+                        {
+                            nextLevel[i] = Combine(nodes[i * 2], nodes[i * 2 + 1], combineMode);
+                        }
+                    });
+
+                // An odd node out moves up to the next level unchanged.
+                if (nodes.size() % 2)
+                {
+                    nextLevel.back() = std::move(nodes.back());
+                }
+
+                nodes.swap(nextLevel);
+            }
+
+            return std::move(nodes[0]);
+        }
+
+        ComPtr<ID2D1PathGeometry1> ToPath(CombinerNode const* node)
+        {
+            if (node && node->IsCombinedPath)
+                return As<ID2D1PathGeometry1>(node->Geometry);
+
+            auto path = m_device->CreatePathGeometry();
+
+            ComPtr<ID2D1GeometrySink> sink;
+            ThrowIfFailed(path->Open(&sink));
+
+            if (node)
+                CanvasGeometry::StreamTo(node->Geometry.Get(), sink.Get());
+            else
+                ThrowIfFailed(sink->Close());
+
+            return path;
+        }
+    };
+}
+
+
+ComPtr<ID2D1PathGeometry1> ABI::Microsoft::Graphics::Canvas::Geometry::CombineGeometries(
+    ICanvasDeviceInternal* device,
+    std::vector<ComPtr<ID2D1Geometry>> const& geometries,
+    D2D1_COMBINE_MODE combineMode,
+    float flatteningTolerance)
+{
+    Combiner combiner(device, flatteningTolerance);
+
+    if (geometries.empty())
+        return combiner.ToPath(nullptr);
+
+    auto leaves = combiner.MakeLeaves(geometries);
+
+    switch (combineMode)
+    {
+    case D2D1_COMBINE_MODE_INTERSECT:
+        {
+            // If the bounds have no area in common, neither do the geometries.
+            auto commonBounds = leaves[0].Bounds;
+
+            for (auto& leaf : leaves)
+            {
+                commonBounds = IntersectBounds(commonBounds, leaf.Bounds);
+            }
+
+            if (!(commonBounds.left < commonBounds.right && commonBounds.top < commonBounds.bottom))
+                return combiner.ToPath(nullptr);
+
+            auto result = combiner.Reduce(std::move(leaves), combineMode);
+            return combiner.ToPath(&result);
+        }
+
+    case D2D1_COMBINE_MODE_EXCLUDE:
+        {
+            // Only geometries that may overlap the first can remove anything from it.
+            std::vector<CombinerNode> excluded;
+
+            for (size_t i = 1; i < leaves.size(); ++i)
+            {
+                if (BoundsIntersect(leaves[0].Bounds, leaves[i].Bounds))
+                    excluded.push_back(leaves[i]);
+            }
+
+            if (excluded.empty())
+                return combiner.ToPath(&leaves[0]);
+
+            auto excludedUnion = combiner.Reduce(std::move(excluded), D2D1_COMBINE_MODE_UNION);
+            auto result = combiner.Combine(leaves[0], excludedUnion, D2D1_COMBINE_MODE_EXCLUDE);
+            return combiner.ToPath(&result);
+        }
+
+    default:
+        {
+            auto result = combiner.Reduce(std::move(leaves), combineMode);
+            return combiner.ToPath(&result);
+        }
+    }
+}
@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // Combines any number of geometries into a new path.  Rather than folding
+    // them into an ever growing result one at a time, geometries are combined
+    // in pairs, then the results of those in pairs, and so on, with the pairs
+    // at each level of the tree spread across threads.
+    //
+    // For Exclude, everything after the first geometry is unioned together
+    // and then excluded from the first.
+    //
+    ComPtr<ID2D1PathGeometry1> CombineGeometries(
+        ICanvasDeviceInternal* device,
+        std::vector<ComPtr<ID2D1Geometry>> const& geometries,
+        D2D1_COMBINE_MODE combineMode,
+        float flatteningTolerance);
+}}}}}
@@ -0,0 +1,388 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasGeometry.h"
+#include "GeometryRealizationCache.h"
+#include "utils/HashUtilities.h"
+#include "utils/LockUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+//
+// 64 bit FNV-1a.  Content hashes are compared without the original path
+// data, so this uses more bits than std::hash to make collisions unlikely.
+//
+class ContentHasher
+{
+    uint64_t m_hash;
+
+public:
+    ContentHasher()
+        : m_hash(14695981039346656037ull)
+    { }
+
+    void AddBytes(void const* data, size_t size)
+    {
+        auto bytes = static_cast<uint8_t const*>(data);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_hash ^= bytes[i];
+            m_hash *= 1099511628211ull;
+        }
+    }
+
+    template<typename T>
+    void Add(T const& value)
+    {
+        AddBytes(&value, sizeof(value));
+    }
+
+    uint64_t GetHash() const
+    {
+        return m_hash;
+    }
+};
+
+
+//
+// Hashes every call made to it, along with which method it was, so that
+// geometries only hash the same if Direct2D streams them identically.
+//
+class GeometryHashingSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1GeometrySink>
+{
+    enum class Command : uint8_t
+    {
+        SetFillMode,
+        SetSegmentFlags,
+        BeginFigure,
+        Line,
+        Bezier,
+        QuadraticBezier,
+        Arc,
+        EndFigure
+    };
+
+    ContentHasher m_hasher;
+    uint32_t m_pointCount;
+
+public:
+    GeometryHashingSink()
+        : m_pointCount(0)
+    { }
+
+    uint64_t GetHash() const { return m_hasher.GetHash(); }
+    uint32_t GetPointCount() const { return m_pointCount; }
+
+    IFACEMETHODIMP_(void) SetFillMode(D2D1_FILL_MODE fillMode) override
+    {
+        m_hasher.Add(Command::SetFillMode);
+        m_hasher.Add(fillMode);
+    }
+
+    IFACEMETHODIMP_(void) SetSegmentFlags(D2D1_PATH_SEGMENT vertexFlags) override
+    {
+        m_hasher.Add(Command::SetSegmentFlags);
+        m_hasher.Add(vertexFlags);
+    }
+
+    IFACEMETHODIMP_(void) BeginFigure(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin) override
+    {
+        m_hasher.Add(Command::BeginFigure);
+        m_hasher.Add(startPoint);
+        m_hasher.Add(figureBegin);
+        m_pointCount++;
+    }
+
+    IFACEMETHODIMP_(void) AddLine(D2D1_POINT_2F point) override
+    {
+        AddLines(&point, 1);
+    }
+
+    IFACEMETHODIMP_(void) AddLines(CONST D2D1_POINT_2F* points, UINT32 pointsCount) override
+    {
+        AddSegments(Command::Line, points, pointsCount, 1);
+    }
+
+    IFACEMETHODIMP_(void) AddBezier(CONST D2D1_BEZIER_SEGMENT* bezier) override
+    {
+        AddBeziers(bezier, 1);
+    }
+
+    IFACEMETHODIMP_(void) AddBeziers(CONST D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override
+    {
+        AddSegments(Command::Bezier, beziers, beziersCount, 3);
+    }
+
+    IFACEMETHODIMP_(void) AddQuadraticBezier(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* bezier) override
+    {
+        AddQuadraticBeziers(bezier, 1);
+    }
+
+    IFACEMETHODIMP_(void) AddQuadraticBeziers(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override
+    {
+        AddSegments(Command::QuadraticBezier, beziers, beziersCount, 2);
+    }
+
+    IFACEMETHODIMP_(void) AddArc(CONST D2D1_ARC_SEGMENT* arc) override
+    {
+        AddSegments(Command::Arc, arc, 1, 1);
+    }
+
+    IFACEMETHODIMP_(void) EndFigure(D2D1_FIGURE_END figureEnd) override
+    {
+        m_hasher.Add(Command::EndFigure);
+        m_hasher.Add(figureEnd);
+    }
+
+    IFACEMETHODIMP Close() override
+    {
+        return S_OK;
+    }
+
+private:
+    template<typename T>
+    void AddSegments(Command command, T const* segments, uint32_t count, uint32_t pointsPerSegment)
+    {
+        m_hasher.Add(command);
+        m_hasher.Add(count);
+        m_hasher.AddBytes(segments, count * sizeof(T));
+        m_pointCount += count * pointsPerSegment;
+    }
+};
+
+
+size_t GeometryCacheKeyHash::operator()(GeometryCacheKey const& key) const
+{
+    size_t hash = std::hash<uint64_t>()(key.ContentHash);
+
+    HashCombine(hash, static_cast<int>(key.Type));
+    HashCombine(hash, key.StrokeStyleHash);
+    HashCombine(hash, key.StrokeWidth);
+    HashCombine(hash, key.ToleranceBucket);
+
+    return hash;
+}
+
+
+GeometryRealizationCache::GeometryRealizationCache()
+    : m_maximumBytes(0)
+    , m_statistics{}
+{
+}
+
+
+bool GeometryRealizationCache::IsEnabled()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumBytes > 0;
+}
+
+
+uint64_t GeometryRealizationCache::GetMaximumBytes()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumBytes;
+}
+
+
+void GeometryRealizationCache::SetMaximumBytes(uint64_t value)
+{
+    Lock lock(m_mutex);
+
+    m_maximumBytes = value;
+    TrimToBudget();
+}
+
+
+CanvasGeometryRealizationCacheStatistics GeometryRealizationCache::GetStatistics()
+{
+    Lock lock(m_mutex);
+
+    auto statistics = m_statistics;
+    statistics.EntryCount = static_cast<uint32_t>(m_entries.GetCount());
+    statistics.SizeInBytes = m_entries.GetTotalSize();
+
+    return statistics;
+}
+
+
+void GeometryRealizationCache::Clear()
+{
+    Lock lock(m_mutex);
+
+    m_entries.Clear();
+}
+
+
+bool GeometryRealizationCache::TryGetToleranceBucket(float flatteningTolerance, int32_t* bucket)
+{
+    if (!(flatteningTolerance > 0) || !isfinite(flatteningTolerance))
+        return false;
+
+    // Rounding down means the bucket's tolerance is never larger than the
+    // one that was asked for.
+    *bucket = static_cast<int32_t>(floorf(log2f(flatteningTolerance) * BucketsPerOctave));
+
+    // Guard against log2f rounding up for exact bucket boundaries.
+    if (GetBucketTolerance(*bucket) > flatteningTolerance)
+        (*bucket)--;
+
+    return true;
+}
+
+
+float GeometryRealizationCache::GetBucketTolerance(int32_t bucket)
+{
+    return exp2f(static_cast<float>(bucket) / BucketsPerOctave);
+}
+
+
+float GeometryRealizationCache::GetMaximumScale(D2D1_MATRIX_3X2_F const& transform)
+{
+    // The largest singular value of the 2x2 part of the matrix.
+    auto a = transform._11;
+    auto b = transform._12;
+    auto c = transform._21;
+    auto d = transform._22;
+
+    auto sumOfSquares = a * a + b * b + c * c + d * d;
+    auto determinant = a * d - b * c;
+
+    auto discriminant = std::max(0.0f, sumOfSquares * sumOfSquares - 4 * determinant * determinant);
+
+    return sqrtf((sumOfSquares + sqrtf(discriminant)) / 2);
+}
+
+
+void GeometryRealizationCache::HashGeometry(ID2D1Geometry* geometry, uint64_t* contentHash, uint32_t* pointCount)
+{
+    auto sink = Make<GeometryHashingSink>();
+    CheckMakeResult(sink);
+
+    CanvasGeometry::StreamTo(geometry, sink.Get());
+
+    *contentHash = sink->GetHash();
+    *pointCount = sink->GetPointCount();
+}
+
+
+uint64_t GeometryRealizationCache::HashStrokeStyle(ICanvasStrokeStyle* strokeStyle)
+{
+    if (!strokeStyle)
+        return 0;
+
+    CanvasCapStyle startCap, endCap, dashCap;
+    CanvasLineJoin lineJoin;
+    float miterLimit, dashOffset;
+    CanvasDashStyle dashStyle;
+    CanvasStrokeTransformBehavior transformBehavior;
+    ComArray<float> customDashStyle;
+
+    ThrowIfFailed(strokeStyle->get_StartCap(&startCap));
+    ThrowIfFailed(strokeStyle->get_EndCap(&endCap));
+    ThrowIfFailed(strokeStyle->get_DashCap(&dashCap));
+    ThrowIfFailed(strokeStyle->get_LineJoin(&lineJoin));
+    ThrowIfFailed(strokeStyle->get_MiterLimit(&miterLimit));
+    ThrowIfFailed(strokeStyle->get_DashStyle(&dashStyle));
+    ThrowIfFailed(strokeStyle->get_DashOffset(&dashOffset));
+    ThrowIfFailed(strokeStyle->get_CustomDashStyle(customDashStyle.GetAddressOfSize(), customDashStyle.GetAddressOfData()));
+    ThrowIfFailed(strokeStyle->get_TransformBehavior(&transformBehavior));
+
+    ContentHasher hasher;
+
+    hasher.Add(startCap);
+    hasher.Add(endCap);
+    hasher.Add(dashCap);
+    hasher.Add(lineJoin);
+    hasher.Add(miterLimit);
+    hasher.Add(dashStyle);
+    hasher.Add(dashOffset);
+    hasher.Add(transformBehavior);
+    hasher.Add(customDashStyle.GetSize());
+    hasher.AddBytes(customDashStyle.GetData(), customDashStyle.GetSize() * sizeof(float));
+
+    // Zero is kept for "no stroke style".
+    return hasher.GetHash() | 1;
+}
+
+
+bool GeometryRealizationCache::TryMakeKey(
+    GeometryCacheEntryType type,
+    ID2D1Geometry* geometry,
+    float strokeWidth,
+    ICanvasStrokeStyle* strokeStyle,
+    float flatteningTolerance,
+    GeometryCacheKey* key)
+{
+    if (!TryGetToleranceBucket(flatteningTolerance, &key->ToleranceBucket))
+        return false;
+
+    key->Type = type;
+    key->StrokeWidth = strokeWidth;
+    key->StrokeStyleHash = HashStrokeStyle(strokeStyle);
+
+    HashGeometry(geometry, &key->ContentHash, &key->PointCount);
+
+    return true;
+}
+
+
+GeometryCacheValue GeometryRealizationCache::Find(GeometryCacheKey const& key)
+{
+    Lock lock(m_mutex);
+
+    auto value = m_entries.Find(key);
+
+    if (!value)
+    {
+        m_statistics.MissCount++;
+        return GeometryCacheValue{};
+    }
+
+    m_statistics.HitCount++;
+    return *value;
+}
+
+
+void GeometryRealizationCache::Add(GeometryCacheKey const& key, GeometryCacheValue const& value)
+{
+    Lock lock(m_mutex);
+
+    m_entries.Add(key, value, EstimateSizeInBytes(key, value));
+
+    TrimToBudget();
+}
+
+
+void GeometryRealizationCache::TrimToBudget()
+{
+    m_statistics.EvictionCount += m_entries.Trim(SIZE_MAX, m_maximumBytes);
+}
+
+
+uint64_t GeometryRealizationCache::EstimateSizeInBytes(GeometryCacheKey const& key, GeometryCacheValue const& value)
+{
+    uint64_t const EntryOverhead = sizeof(GeometryCacheKey) + sizeof(GeometryCacheValue);
+
+    if (value.Triangles)
+        return EntryOverhead + value.Triangles->size() * sizeof(CanvasTriangleVertices);
+
+    //
+    // Direct2D doesn't report how much memory a realization uses.  This
+    // assumes a fixed overhead plus a few antialiased triangles for each
+    // point of the source path, which is roughly what realizations of
+    // polygons need; curves flattened at fine tolerances use more.
+    //
+    uint64_t const RealizationOverhead = 1024;
+    uint64_t const BytesPerPoint = 4 * sizeof(CanvasTriangleVertices);
+
+    return EntryOverhead + RealizationOverhead + key.PointCount * BytesPerPoint;
+}
@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/LruCache.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    using namespace ::Microsoft::WRL;
+
+    enum class GeometryCacheEntryType
+    {
+        Fill,
+        Stroke,
+        Direct2DTessellation,
+        CpuTessellation
+    };
+
+    //
+    // Identifies a realization or tessellation by the content of the geometry
+    // rather than by the object, so that equal geometries built separately
+    // (eg. every time a map tile is loaded) share an entry.
+    //
+    // Flattening tolerances are quantised into buckets, so that small
+    // changes in zoom still find the same entry.
+    //
+    struct GeometryCacheKey
+    {
+        GeometryCacheEntryType Type;
+        uint64_t ContentHash;
+        uint32_t PointCount;
+        uint64_t StrokeStyleHash;
+        float StrokeWidth;
+        int32_t ToleranceBucket;
+
+        bool operator==(GeometryCacheKey const& other) const
+        {
+            return Type == other.Type &&
+                   ContentHash == other.ContentHash &&
+                   PointCount == other.PointCount &&
+                   StrokeStyleHash == other.StrokeStyleHash &&
+                   StrokeWidth == other.StrokeWidth &&
+                   ToleranceBucket == other.ToleranceBucket;
+        }
+    };
+
+    struct GeometryCacheKeyHash
+    {
+        size_t operator()(GeometryCacheKey const& key) const;
+    };
+
+    typedef std::vector<CanvasTriangleVertices> TriangleList;
+
+    struct GeometryCacheValue
+    {
+        ComPtr<ID2D1GeometryRealization> Realization;
+        std::shared_ptr<TriangleList const> Triangles;
+    };
+
+
+    //
+    // A device-level least-recently-used cache of the geometry realizations
+    // created by CanvasCachedGeometry and the triangles produced by
+    // CanvasGeometry.Tessellate.  Pan and zoom views that recreate these for
+    // the same shapes at slightly different scales then reuse earlier ones.
+    //
+    // Entries are created with the finest tolerance in their bucket, so a
+    // cached result is never coarser than the one that was asked for.
+    // Tessellations are cached before they are transformed, so the same
+    // entry serves any transform with a similar scale.
+    //
+    // The geometry is streamed to compute its content hash on every lookup.
+    // This is much cheaper than realizing or tessellating it, but means that
+    // the cache only pays off for geometries that are reused.
+    //
+    // The cache is bounded by an estimate of the memory used by its entries,
+    // and is disabled while this budget is zero, which is the default.
+    //
+    class GeometryRealizationCache
+    {
+        std::mutex m_mutex;
+        LruCache<GeometryCacheKey, GeometryCacheValue, GeometryCacheKeyHash> m_entries;
+
+        uint64_t m_maximumBytes;
+        CanvasGeometryRealizationCacheStatistics m_statistics;
+
+    public:
+        // Each bucket covers a quarter of an octave of flattening tolerance.
+        static int32_t const BucketsPerOctave = 4;
+
+        GeometryRealizationCache();
+
+        bool IsEnabled();
+
+        //
+        // These return the cached value, or call create with the tolerance to
+        // use and cache what it returns.  They return null if the cache is
+        // disabled or the tolerance cannot be cached.
+        //
+        template<typename FN>
+        ComPtr<ID2D1GeometryRealization> GetOrCreateFill(
+            ID2D1Geometry* geometry,
+            float flatteningTolerance,
+            FN&& create)
+        {
+            return GetOrCreateRealization(GeometryCacheEntryType::Fill, geometry, 0, nullptr, flatteningTolerance, create);
+        }
+
+        template<typename FN>
+        ComPtr<ID2D1GeometryRealization> GetOrCreateStroke(
+            ID2D1Geometry* geometry,
+            float strokeWidth,
+            ICanvasStrokeStyle* strokeStyle,
+            float flatteningTolerance,
+            FN&& create)
+        {
+            return GetOrCreateRealization(GeometryCacheEntryType::Stroke, geometry, strokeWidth, strokeStyle, flatteningTolerance, create);
+        }
+
+        //
+        // The tessellation is cached untransformed, using a tolerance scaled
+        // to match the transform.  The caller applies the transform.
+        //
+        template<typename FN>
+        std::shared_ptr<TriangleList const> GetOrCreateTessellation(
+            ID2D1Geometry* geometry,
+            CanvasTessellationEngine engine,
+            D2D1_MATRIX_3X2_F const& transform,
+            float flatteningTolerance,
+            FN&& create)
+        {
+            GeometryCacheEntryType type;
+
+            switch (engine)
+            {
+            case CanvasTessellationEngine::Direct2D:
+                type = GeometryCacheEntryType::Direct2DTessellation;
+                break;
+
+            case CanvasTessellationEngine::Cpu:
+                type = GeometryCacheEntryType::CpuTessellation;
+                break;
+
+            default:
+                ThrowHR(E_INVALIDARG);
+            }
+
+            if (!IsEnabled())
+                return nullptr;
+
+            auto untransformedTolerance = flatteningTolerance / GetMaximumScale(transform);
+
+            GeometryCacheKey key;
+            if (!TryMakeKey(type, geometry, 0, nullptr, untransformedTolerance, &key))
+                return nullptr;
+
+            auto value = Find(key);
+
+            if (!value.Triangles)
+            {
+                value.Triangles = std::make_shared<TriangleList const>(create(GetBucketTolerance(key.ToleranceBucket)));
+                Add(key, value);
+            }
+
+            return value.Triangles;
+        }
+
+        uint64_t GetMaximumBytes();
+        void SetMaximumBytes(uint64_t value);
+
+        CanvasGeometryRealizationCacheStatistics GetStatistics();
+
+        void Clear();
+
+        // Returns false for tolerances that are not positive and finite.
+        static bool TryGetToleranceBucket(float flatteningTolerance, int32_t* bucket);
+        static float GetBucketTolerance(int32_t bucket);
+
+        // The largest factor by which the transform stretches any vector.
+        static float GetMaximumScale(D2D1_MATRIX_3X2_F const& transform);
+
+        static void HashGeometry(ID2D1Geometry* geometry, uint64_t* contentHash, uint32_t* pointCount);
+        static uint64_t HashStrokeStyle(ICanvasStrokeStyle* strokeStyle);
+
+    private:
+        template<typename FN>
+        ComPtr<ID2D1GeometryRealization> GetOrCreateRealization(
+            GeometryCacheEntryType type,
+            ID2D1Geometry* geometry,
+            float strokeWidth,
+            ICanvasStrokeStyle* strokeStyle,
+            float flatteningTolerance,
+            FN& create)
+        {
+            if (!IsEnabled())
+                return nullptr;
+
+            GeometryCacheKey key;
+            if (!TryMakeKey(type, geometry, strokeWidth, strokeStyle, flatteningTolerance, &key))
+                return nullptr;
+
+            auto value = Find(key);
+
+            if (!value.Realization)
+            {
+                // Created without holding the lock, as with TextLayoutCache.
+                value.Realization = create(GetBucketTolerance(key.ToleranceBucket));
+                Add(key, value);
+            }
+
+            return value.Realization;
+        }
+
+        static bool TryMakeKey(
+            GeometryCacheEntryType type,
+            ID2D1Geometry* geometry,
+            float strokeWidth,
+            ICanvasStrokeStyle* strokeStyle,
+            float flatteningTolerance,
+            GeometryCacheKey* key);
+
+        GeometryCacheValue Find(GeometryCacheKey const& key);
+        void Add(GeometryCacheKey const& key, GeometryCacheValue const& value);
+        void TrimToBudget();
+
+        static uint64_t EstimateSizeInBytes(GeometryCacheKey const& key, GeometryCacheValue const& value);
+    };
+}}}}}
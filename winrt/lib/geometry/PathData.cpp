@@ -0,0 +1,680 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "PathData.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+static_assert(sizeof(D2D1_BEZIER_SEGMENT) == 3 * sizeof(D2D1_POINT_2F), "D2D1_BEZIER_SEGMENT must be three points");
+static_assert(sizeof(D2D1_QUADRATIC_BEZIER_SEGMENT) == 2 * sizeof(D2D1_POINT_2F), "D2D1_QUADRATIC_BEZIER_SEGMENT must be two points");
+
+// Quantized coordinates are kept within this range so that the difference
+// between any two of them fits in an int64_t.
+static const double MaximumQuantizedValue = 4611686018427387904.0;     // 2^62
+
+// Every encoded point takes at least this many bytes, which bounds the
+// counts that can be valid for the remaining data.
+static const size_t MinimumQuantizedPointSize = 2;
+static const size_t FloatPointSize = 2 * sizeof(float);
+
+// The count at the start of each run of lines or curves is written before
+// the run's length is known, so it is given room for any uint32_t.  Float
+// runs pad their count beyond this, so that their points are aligned for
+// the reader to pass them to the sink in place.
+static const size_t MinimumPendingCountSize = 5;
+
+
+static uint32_t GetPointsPerSegment(PathDataCommand command)
+{
+    switch (command)
+    {
+    case PathDataCommand::Beziers:          return 3;
+    case PathDataCommand::QuadraticBeziers: return 2;
+    default:                                return 1;
+    }
+}
+
+
+static uint64_t ZigZagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+
+static int64_t ZigZagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+
+//
+// PathDataWriter implementation
+//
+
+PathDataWriter::PathDataWriter(float quantizationStep)
+    : m_result(S_OK)
+    , m_isQuantized(quantizationStep > 0)
+    , m_quantizationStep(quantizationStep)
+    , m_previousX(0)
+    , m_previousY(0)
+    , m_pendingCommand(PathDataCommand::Lines)
+    , m_pendingCountOffset(0)
+    , m_pendingCountSize(0)
+    , m_pendingCount(0)
+{
+    PathDataHeader header{ Magic, Version, m_isQuantized ? PathDataFlags::Quantized : PathDataFlags::None, m_isQuantized ? quantizationStep : 0 };
+
+    m_data.resize(sizeof(header));
+    memcpy(m_data.data(), &header, sizeof(header));
+}
+
+
+template<typename FN>
+void PathDataWriter::Write(FN&& fn)
+{
+    if (FAILED(m_result))
+        return;
+
+    m_result = ExceptionBoundary(fn);
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::SetFillMode(D2D1_FILL_MODE fillMode)
+{
+    Write([&]
+    {
+        WriteCommand(PathDataCommand::SetFillMode);
+        WriteByte(static_cast<uint8_t>(fillMode));
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::SetSegmentFlags(D2D1_PATH_SEGMENT vertexFlags)
+{
+    Write([&]
+    {
+        WriteCommand(PathDataCommand::SetSegmentFlags);
+        WriteByte(static_cast<uint8_t>(vertexFlags));
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::BeginFigure(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin)
+{
+    Write([&]
+    {
+        WriteCommand(PathDataCommand::BeginFigure);
+        WriteByte(static_cast<uint8_t>(figureBegin));
+        WritePoint(startPoint);
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddLine(D2D1_POINT_2F point)
+{
+    Write([&]
+    {
+        AddPending(PathDataCommand::Lines, &point, 1);
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddLines(CONST D2D1_POINT_2F* points, UINT32 pointsCount)
+{
+    Write([&]
+    {
+        AddPending(PathDataCommand::Lines, points, pointsCount);
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddBezier(CONST D2D1_BEZIER_SEGMENT* bezier)
+{
+    AddBeziers(bezier, 1);
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddBeziers(CONST D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount)
+{
+    Write([&]
+    {
+        AddPending(PathDataCommand::Beziers, reinterpret_cast<D2D1_POINT_2F const*>(beziers), beziersCount);
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddQuadraticBezier(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* bezier)
+{
+    AddQuadraticBeziers(bezier, 1);
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddQuadraticBeziers(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount)
+{
+    Write([&]
+    {
+        AddPending(PathDataCommand::QuadraticBeziers, reinterpret_cast<D2D1_POINT_2F const*>(beziers), beziersCount);
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::AddArc(CONST D2D1_ARC_SEGMENT* arc)
+{
+    Write([&]
+    {
+        WriteCommand(PathDataCommand::Arc);
+        WritePoint(arc->point);
+        WriteFloat(arc->size.width);
+        WriteFloat(arc->size.height);
+        WriteFloat(arc->rotationAngle);
+        WriteByte(static_cast<uint8_t>(arc->sweepDirection));
+        WriteByte(static_cast<uint8_t>(arc->arcSize));
+    });
+}
+
+
+IFACEMETHODIMP_(void) PathDataWriter::EndFigure(D2D1_FIGURE_END figureEnd)
+{
+    Write([&]
+    {
+        WriteCommand(PathDataCommand::EndFigure);
+        WriteByte(static_cast<uint8_t>(figureEnd));
+    });
+}
+
+
+IFACEMETHODIMP PathDataWriter::Close()
+{
+    Write([&]
+    {
+        FlushPending();
+    });
+
+    return m_result;
+}
+
+
+void PathDataWriter::Reset()
+{
+    m_data.resize(sizeof(PathDataHeader));
+    m_pendingCommand = PathDataCommand::Lines;
+    m_pendingCountOffset = 0;
+    m_pendingCountSize = 0;
+    m_pendingCount = 0;
+    m_previousX = 0;
+    m_previousY = 0;
+    m_result = S_OK;
+}
+
+
+void PathDataWriter::AddPending(PathDataCommand command, D2D1_POINT_2F const* points, uint32_t count)
+{
+    if (count == 0)
+        return;
+
+    // Runs are split where their count would no longer fit in a uint32_t.
+    if (m_pendingCountOffset == 0 || command != m_pendingCommand || count > UINT32_MAX - m_pendingCount)
+    {
+        FlushPending();
+        BeginPending(command);
+    }
+
+    WritePoints(points, static_cast<size_t>(count) * GetPointsPerSegment(command));
+
+    m_pendingCount += count;
+}
+
+
+void PathDataWriter::BeginPending(PathDataCommand command)
+{
+    // WriteCommand would recurse back here.
+    WriteByte(static_cast<uint8_t>(command));
+
+    auto countSize = MinimumPendingCountSize;
+
+    if (!m_isQuantized)
+    {
+        // Relies on m_data, like the header, starting suitably aligned.
+        auto misalignment = (m_data.size() + countSize) % alignof(D2D1_POINT_2F);
+
+        if (misalignment)
+            countSize += alignof(D2D1_POINT_2F) - misalignment;
+    }
+
+    m_pendingCommand = command;
+    m_pendingCountOffset = m_data.size();
+    m_pendingCountSize = countSize;
+    m_pendingCount = 0;
+
+    m_data.resize(m_data.size() + countSize);
+}
+
+
+void PathDataWriter::FlushPending()
+{
+    if (m_pendingCountOffset == 0)
+        return;
+
+    // A varint padded out with continuation bytes.
+    auto count = m_pendingCount;
+    auto countBytes = m_data.data() + m_pendingCountOffset;
+
+    for (size_t i = 0; i < m_pendingCountSize - 1; ++i)
+    {
+        countBytes[i] = static_cast<uint8_t>(count | 0x80);
+        count >>= 7;
+    }
+
+    countBytes[m_pendingCountSize - 1] = static_cast<uint8_t>(count);
+
+    m_pendingCountOffset = 0;
+    m_pendingCountSize = 0;
+    m_pendingCount = 0;
+}
+
+
+void PathDataWriter::WriteCommand(PathDataCommand command)
+{
+    FlushPending();
+    WriteByte(static_cast<uint8_t>(command));
+}
+
+
+void PathDataWriter::WriteByte(uint8_t value)
+{
+    m_data.push_back(value);
+}
+
+
+void PathDataWriter::WriteVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_data.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    m_data.push_back(static_cast<uint8_t>(value));
+}
+
+
+void PathDataWriter::WriteFloat(float value)
+{
+    auto bytes = reinterpret_cast<uint8_t const*>(&value);
+
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(value));
+}
+
+
+void PathDataWriter::WritePoint(D2D1_POINT_2F const& point)
+{
+    if (!m_isQuantized)
+    {
+        WriteFloat(point.x);
+        WriteFloat(point.y);
+        return;
+    }
+
+    auto quantize = [&](float value)
+    {
+        auto scaled = static_cast<double>(value) / m_quantizationStep;
+
+        // Also rejects NaN.
+        if (!(std::abs(scaled) < MaximumQuantizedValue))
+            ThrowHR(E_INVALIDARG, Strings::PathDataCannotQuantize);
+
+        return static_cast<int64_t>(std::llround(scaled));
+    };
+
+    auto x = quantize(point.x);
+    auto y = quantize(point.y);
+
+    WriteVarint(ZigZagEncode(x - m_previousX));
+    WriteVarint(ZigZagEncode(y - m_previousY));
+
+    m_previousX = x;
+    m_previousY = y;
+}
+
+
+void PathDataWriter::WritePoints(D2D1_POINT_2F const* points, size_t pointCount)
+{
+    if (!m_isQuantized)
+    {
+        // Float points are stored exactly as D2D passes them.
+        auto bytes = reinterpret_cast<uint8_t const*>(points);
+
+        m_data.insert(m_data.end(), bytes, bytes + pointCount * FloatPointSize);
+        return;
+    }
+
+    for (size_t i = 0; i < pointCount; ++i)
+    {
+        WritePoint(points[i]);
+    }
+}
+
+
+//
+// Reading path data
+//
+
+namespace
+{
+    class PathDataReader
+    {
+        uint8_t const* m_next;
+        uint8_t const* m_end;
+
+        bool m_isQuantized;
+        double m_quantizationStep;
+        int64_t m_previousX;
+        int64_t m_previousY;
+
+    public:
+        PathDataReader(uint8_t const* data, size_t size)
+            : m_next(data)
+            , m_end(data + size)
+            , m_previousX(0)
+            , m_previousY(0)
+        {
+            PathDataHeader header;
+
+            if (size < sizeof(header))
+                ThrowInvalid();
+
+            memcpy(&header, data, sizeof(header));
+            m_next += sizeof(header);
+
+            m_isQuantized = (header.Flags == PathDataFlags::Quantized);
+            m_quantizationStep = header.QuantizationStep;
+
+            if (header.Magic != PathDataWriter::Magic ||
+                header.Version != PathDataWriter::Version ||
+                (header.Flags != PathDataFlags::None && !m_isQuantized) ||
+                (m_isQuantized && !(m_quantizationStep > 0 && std::isfinite(m_quantizationStep))))
+            {
+                ThrowInvalid();
+            }
+        }
+
+        bool AtEnd() const
+        {
+            return m_next == m_end;
+        }
+
+        uint8_t ReadByte()
+        {
+            if (m_next == m_end)
+                ThrowInvalid();
+
+            return *m_next++;
+        }
+
+        template<typename T>
+        T ReadEnum(T maximumValue)
+        {
+            auto value = ReadByte();
+
+            if (value > static_cast<uint8_t>(maximumValue))
+                ThrowInvalid();
+
+            return static_cast<T>(value);
+        }
+
+        uint64_t ReadVarint()
+        {
+            uint64_t value = 0;
+
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                auto byte = ReadByte();
+
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+                if (!(byte & 0x80))
+                    return value;
+            }
+
+            ThrowInvalid();
+        }
+
+        // Rejects counts that could not fit in the remaining data, before
+        // anything is allocated for them.
+        uint32_t ReadCount(uint32_t pointsPerSegment)
+        {
+            auto count = ReadVarint();
+            auto minimumPointSize = m_isQuantized ? MinimumQuantizedPointSize : FloatPointSize;
+            auto maximumCount = static_cast<uint64_t>(m_end - m_next) / minimumPointSize / pointsPerSegment;
+
+            if (count > maximumCount)
+                ThrowInvalid();
+
+            return static_cast<uint32_t>(count);
+        }
+
+        float ReadFloat()
+        {
+            float value;
+
+            if (m_end - m_next < static_cast<ptrdiff_t>(sizeof(value)))
+                ThrowInvalid();
+
+            memcpy(&value, m_next, sizeof(value));
+            m_next += sizeof(value);
+
+            return value;
+        }
+
+        D2D1_POINT_2F ReadPoint()
+        {
+            if (!m_isQuantized)
+            {
+                auto x = ReadFloat();
+                auto y = ReadFloat();
+                return D2D1_POINT_2F{ x, y };
+            }
+
+            // Wraps rather than overflowing on corrupt data.
+            m_previousX = static_cast<int64_t>(static_cast<uint64_t>(m_previousX) + static_cast<uint64_t>(ZigZagDecode(ReadVarint())));
+            m_previousY = static_cast<int64_t>(static_cast<uint64_t>(m_previousY) + static_cast<uint64_t>(ZigZagDecode(ReadVarint())));
+
+            return D2D1_POINT_2F{ static_cast<float>(m_previousX * m_quantizationStep),
+                                  static_cast<float>(m_previousY * m_quantizationStep) };
+        }
+
+        // Returns a pointer to count points.  Float points are stored exactly
+        // as D2D expects them, so where they are suitably aligned this points
+        // straight into the data.  Otherwise the points are decoded or copied
+        // into buffer.
+        D2D1_POINT_2F const* ReadPoints(size_t count, std::vector<D2D1_POINT_2F>& buffer)
+        {
+            if (m_isQuantized)
+            {
+                buffer.resize(count);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    buffer[i] = ReadPoint();
+                }
+
+                return buffer.data();
+            }
+
+            auto size = count * FloatPointSize;
+
+            if (static_cast<size_t>(m_end - m_next) < size)
+                ThrowInvalid();
+
+            auto points = m_next;
+            m_next += size;
+
+            if (reinterpret_cast<uintptr_t>(points) % alignof(D2D1_POINT_2F) == 0)
+                return reinterpret_cast<D2D1_POINT_2F const*>(points);
+
+            buffer.resize(count);
+            memcpy(buffer.data(), points, size);
+
+            return buffer.data();
+        }
+
+    private:
+        __declspec(noreturn) static void ThrowInvalid()
+        {
+            ThrowHR(E_INVALIDARG, Strings::InvalidPathData);
+        }
+    };
+
+
+    //
+    // Maps a whole file into memory for reading, so that its contents can be
+    // decoded without first being copied into a buffer.
+    //
+    class MappedFile
+    {
+        Wrappers::FileHandle m_file;
+        Wrappers::HandleT<Wrappers::HandleTraits::HANDLENullTraits> m_mapping;
+        void const* m_view;
+        size_t m_size;
+
+    public:
+        MappedFile(wchar_t const* fileName)
+            : m_view(nullptr)
+            , m_size(0)
+        {
+            m_file.Attach(CreateFile2(fileName, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr));
+
+            if (!m_file.IsValid())
+                ThrowLastError();
+
+            FILE_STANDARD_INFO info;
+
+            if (!GetFileInformationByHandleEx(m_file.Get(), FileStandardInfo, &info, sizeof(info)))
+                ThrowLastError();
+
+            if (static_cast<uint64_t>(info.EndOfFile.QuadPart) > SIZE_MAX)
+                ThrowHR(E_OUTOFMEMORY);
+
+            m_size = static_cast<size_t>(info.EndOfFile.QuadPart);
+
+            // Empty files cannot be mapped.
+            if (m_size == 0)
+                return;
+
+            m_mapping.Attach(CreateFileMappingFromApp(m_file.Get(), nullptr, PAGE_READONLY, 0, nullptr));
+
+            if (!m_mapping.IsValid())
+                ThrowLastError();
+
+            m_view = MapViewOfFileFromApp(m_mapping.Get(), FILE_MAP_READ, 0, 0);
+
+            if (!m_view)
+                ThrowLastError();
+        }
+
+        ~MappedFile()
+        {
+            if (m_view)
+                UnmapViewOfFile(m_view);
+        }
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+
+        uint8_t const* GetData() const { return static_cast<uint8_t const*>(m_view); }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        __declspec(noreturn) static void ThrowLastError()
+        {
+            ThrowHR(HRESULT_FROM_WIN32(GetLastError()));
+        }
+    };
+}
+
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    void ReadPathData(uint8_t const* data, size_t size, ID2D1GeometrySink* sink)
+    {
+        PathDataReader reader(data, size);
+
+        // Reused for every run of lines or curves that cannot be passed to
+        // the sink in place.
+        std::vector<D2D1_POINT_2F> buffer;
+
+        while (!reader.AtEnd())
+        {
+            auto command = static_cast<PathDataCommand>(reader.ReadByte());
+
+            switch (command)
+            {
+            case PathDataCommand::SetFillMode:
+                sink->SetFillMode(reader.ReadEnum(D2D1_FILL_MODE_WINDING));
+                break;
+
+            case PathDataCommand::SetSegmentFlags:
+                sink->SetSegmentFlags(reader.ReadEnum(static_cast<D2D1_PATH_SEGMENT>(D2D1_PATH_SEGMENT_FORCE_UNSTROKED | D2D1_PATH_SEGMENT_FORCE_ROUND_LINE_JOIN)));
+                break;
+
+            case PathDataCommand::BeginFigure:
+                {
+                    auto figureBegin = reader.ReadEnum(D2D1_FIGURE_BEGIN_HOLLOW);
+                    sink->BeginFigure(reader.ReadPoint(), figureBegin);
+                }
+                break;
+
+            case PathDataCommand::Lines:
+            case PathDataCommand::Beziers:
+            case PathDataCommand::QuadraticBeziers:
+                {
+                    auto pointsPerSegment = GetPointsPerSegment(command);
+                    auto count = reader.ReadCount(pointsPerSegment);
+
+                    auto points = reader.ReadPoints(static_cast<size_t>(count) * pointsPerSegment, buffer);
+
+                    if (command == PathDataCommand::Lines)
+                        sink->AddLines(points, count);
+                    else if (command == PathDataCommand::Beziers)
+                        sink->AddBeziers(reinterpret_cast<D2D1_BEZIER_SEGMENT const*>(points), count);
+                    else
+                        sink->AddQuadraticBeziers(reinterpret_cast<D2D1_QUADRATIC_BEZIER_SEGMENT const*>(points), count);
+                }
+                break;
+
+            case PathDataCommand::Arc:
+                {
+                    D2D1_ARC_SEGMENT arc;
+
+                    arc.point = reader.ReadPoint();
+                    arc.size.width = reader.ReadFloat();
+                    arc.size.height = reader.ReadFloat();
+                    arc.rotationAngle = reader.ReadFloat();
+                    arc.sweepDirection = reader.ReadEnum(D2D1_SWEEP_DIRECTION_CLOCKWISE);
+                    arc.arcSize = reader.ReadEnum(D2D1_ARC_SIZE_LARGE);
+
+                    sink->AddArc(&arc);
+                }
+                break;
+
+            case PathDataCommand::EndFigure:
+                sink->EndFigure(reader.ReadEnum(D2D1_FIGURE_END_CLOSED));
+                break;
+
+            default:
+                ThrowHR(E_INVALIDARG, Strings::InvalidPathData);
+            }
+        }
+    }
+
+
+    void ReadPathDataFromFile(wchar_t const* fileName, ID2D1GeometrySink* sink)
+    {
+        MappedFile file(fileName);
+
+        ReadPathData(file.GetData(), file.GetSize(), sink);
+    }
+}}}}}
@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // Path data is a PathDataHeader followed by a stream of commands, each a
+    // PathDataCommand byte followed by its operands:
+    //
+    //   SetFillMode                 fill mode byte
+    //   SetSegmentFlags             segment flags byte
+    //   BeginFigure                 figure begin byte, point
+    //   Lines                       count, count points
+    //   Beziers                     count, 3 * count points
+    //   QuadraticBeziers            count, 2 * count points
+    //   Arc                         point, width, height, rotation angle, sweep direction byte, arc size byte
+    //   EndFigure                   figure end byte
+    //
+    // Counts are unsigned LEB128 varints, which need not use the fewest bytes
+    // possible.  Consecutive lines or curves of the same type share one
+    // command, so they can be passed to the sink in a single call when the
+    // data is read back.
+    //
+    // Points are stored as pairs of little-endian floats, unless the header
+    // has PathDataFlags::Quantized set.  Quantized points are rounded to
+    // multiples of QuantizationStep, and stored as the zigzag varint encoded
+    // difference from the previous point, in units of that step.  Arc sizes
+    // and angles are always stored as floats.
+    //
+    enum class PathDataCommand : uint8_t
+    {
+        SetFillMode = 1,
+        SetSegmentFlags,
+        BeginFigure,
+        Lines,
+        Beziers,
+        QuadraticBeziers,
+        Arc,
+        EndFigure
+    };
+
+    enum class PathDataFlags : uint32_t
+    {
+        None = 0,
+        Quantized = 1
+    };
+
+    struct PathDataHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        PathDataFlags Flags;
+        float QuantizationStep;
+    };
+
+
+    //
+    // Encodes the commands it receives as path data.  Pass this to
+    // CanvasGeometry::StreamTo to encode a geometry.
+    //
+    class PathDataWriter : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1GeometrySink>,
+                           private LifespanTracker<PathDataWriter>
+    {
+        std::vector<uint8_t> m_data;
+        HRESULT m_result;
+
+        bool m_isQuantized;
+        float m_quantizationStep;
+        int64_t m_previousX;
+        int64_t m_previousY;
+
+        // Lines and curves are written straight into m_data as they arrive.
+        // Space for the count is reserved at the start of each run and filled
+        // in once a different command arrives.  An offset of zero means that
+        // no run is in progress.
+        PathDataCommand m_pendingCommand;
+        size_t m_pendingCountOffset;
+        size_t m_pendingCountSize;
+        uint32_t m_pendingCount;
+
+    public:
+        static uint32_t const Magic = 0x50443257;   // "W2DP"
+        static uint32_t const Version = 1;
+
+        // A quantization step of zero stores points as floats.
+        PathDataWriter(float quantizationStep);
+
+        // Only valid after Close has succeeded.
+        std::vector<uint8_t> const& GetData() const { return m_data; }
+
+        // The sink methods cannot report errors, so the first failure is kept
+        // here and returned again by Close.
+        HRESULT GetResult() const { return m_result; }
+
+        // Discards everything written so far, keeping the buffers so that
+        // the writer can be reused without allocating.
+        void Reset();
+
+        //
+        // ID2D1GeometrySink
+        //
+
+        IFACEMETHOD_(void, SetFillMode)(D2D1_FILL_MODE fillMode) override;
+        IFACEMETHOD_(void, SetSegmentFlags)(D2D1_PATH_SEGMENT vertexFlags) override;
+        IFACEMETHOD_(void, BeginFigure)(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin) override;
+        IFACEMETHOD_(void, AddLines)(CONST D2D1_POINT_2F* points, UINT32 pointsCount) override;
+        IFACEMETHOD_(void, AddBeziers)(CONST D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override;
+        IFACEMETHOD_(void, EndFigure)(D2D1_FIGURE_END figureEnd) override;
+        IFACEMETHOD(Close)() override;
+
+        IFACEMETHOD_(void, AddLine)(D2D1_POINT_2F point) override;
+        IFACEMETHOD_(void, AddBezier)(CONST D2D1_BEZIER_SEGMENT* bezier) override;
+        IFACEMETHOD_(void, AddQuadraticBezier)(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* bezier) override;
+        IFACEMETHOD_(void, AddQuadraticBeziers)(CONST D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override;
+        IFACEMETHOD_(void, AddArc)(CONST D2D1_ARC_SEGMENT* arc) override;
+
+    private:
+        template<typename FN>
+        void Write(FN&& fn);
+
+        void AddPending(PathDataCommand command, D2D1_POINT_2F const* points, uint32_t count);
+        void BeginPending(PathDataCommand command);
+        void FlushPending();
+
+        void WriteCommand(PathDataCommand command);
+        void WriteByte(uint8_t value);
+        void WriteVarint(uint64_t value);
+        void WriteFloat(float value);
+        void WritePoint(D2D1_POINT_2F const& point);
+        void WritePoints(D2D1_POINT_2F const* points, size_t pointCount);
+    };
+
+
+    // Sends the commands encoded in data to sink, passing each run of lines
+    // or curves in a single call.  Float points that are suitably aligned are
+    // passed as a pointer into data rather than being copied.  Throws
+    // E_INVALIDARG if the data is not valid.  The sink is not closed.
+    void ReadPathData(uint8_t const* data, size_t size, ID2D1GeometrySink* sink);
+
+    // Memory maps the file and reads the path data it contains.
+    void ReadPathDataFromFile(wchar_t const* fileName, ID2D1GeometrySink* sink);
+}}}}}
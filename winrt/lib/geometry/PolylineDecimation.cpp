@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "PolylineDecimation.h"
+#include "utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+namespace
+{
+    // Paths with fewer points than this are decimated on the calling thread.
+    const size_t MinimumPointsForThreading = 65536;
+
+
+    float GetDistanceToSegmentSquared(D2D1_POINT_2F const& point, D2D1_POINT_2F const& start, float dx, float dy, float lengthSquared)
+    {
+        float x = point.x - start.x;
+        float y = point.y - start.y;
+
+        if (lengthSquared > 0)
+        {
+            float t = std::min(std::max((x * dx + y * dy) / lengthSquared, 0.0f), 1.0f);
+
+            x -= t * dx;
+            y -= t * dy;
+        }
+
+        return x * x + y * y;
+    }
+
+
+    //
+    // Runs Douglas-Peucker without recursion, so that polylines with millions
+    // of points cannot overflow the stack.  The scratch buffers are kept
+    // between calls.
+    //
+    class Decimator
+    {
+        std::vector<uint8_t> m_isKept;
+        std::vector<std::pair<uint32_t, uint32_t>> m_ranges;
+
+    public:
+        uint32_t Decimate(D2D1_POINT_2F* points, uint32_t pointCount, bool isClosed, float tolerance)
+        {
+            if (pointCount < 3)
+                return pointCount;
+
+            // Index pointCount stands for the copy of the first point that
+            // closes a closed polyline.
+            uint32_t lastIndex = isClosed ? pointCount : pointCount - 1;
+
+            auto getPoint = [&](uint32_t index) -> D2D1_POINT_2F const&
+            {
+                return points[(index == pointCount) ? 0 : index];
+            };
+
+            m_isKept.assign(lastIndex + 1, false);
+            m_isKept[0] = true;
+            m_isKept[lastIndex] = true;
+
+            float toleranceSquared = tolerance * tolerance;
+
+            m_ranges.clear();
+            m_ranges.emplace_back(0, lastIndex);
+
+            while (!m_ranges.empty())
+            {
+                auto first = m_ranges.back().first;
+                auto last = m_ranges.back().second;
+
+                m_ranges.pop_back();
+
+                if (last - first < 2)
+                    continue;
+
+                auto& start = getPoint(first);
+                auto& end = getPoint(last);
+
+                float dx = end.x - start.x;
+                float dy = end.y - start.y;
+                float lengthSquared = dx * dx + dy * dy;
+
+                float farthestDistanceSquared = -1;
+                uint32_t farthest = first;
+
+                // Points between first and last are never the closing copy.
+                for (uint32_t i = first + 1; i < last; ++i)
+                {
+                    float distanceSquared = GetDistanceToSegmentSquared(points[i], start, dx, dy, lengthSquared);
+
+                    if (distanceSquared > farthestDistanceSquared)
+                    {
+                        farthestDistanceSquared = distanceSquared;
+                        farthest = i;
+                    }
+                }
+
+                if (farthestDistanceSquared > toleranceSquared)
+                {
+                    m_isKept[farthest] = true;
+
+                    m_ranges.emplace_back(first, farthest);
+                    m_ranges.emplace_back(farthest, last);
+                }
+            }
+
+            uint32_t keptCount = 0;
+
+            for (uint32_t i = 0; i < pointCount; ++i)
+            {
+                if (m_isKept[i])
+                {
+                    points[keptCount++] = points[i];
+                }
+            }
+
+            return keptCount;
+        }
+    };
+}
+
+
+uint32_t ABI::Microsoft::Graphics::Canvas::Geometry::DecimatePolyline(D2D1_POINT_2F* points, uint32_t pointCount, bool isClosed, float tolerance)
+{
+    return Decimator().Decimate(points, pointCount, isClosed, tolerance);
+}
+
+
+void ABI::Microsoft::Graphics::Canvas::Geometry::DecimatePolylines(Polylines* polylines, float tolerance)
+{
+    auto figureCount = static_cast<uint32_t>(polylines->Figures.size());
+
+    // A minimum chunk of every figure keeps small paths on this thread.
+    auto minimumFiguresPerChunk = (polylines->Points.size() < MinimumPointsForThreading) ? figureCount : 1u;
+
+    ParallelFor(figureCount, minimumFiguresPerChunk,
+        [&](uint32_t begin, uint32_t end)
+        {
+            Decimator decimator;
+
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                auto& figure = polylines->Figures[i];
+
+                auto keptCount = decimator.Decimate(polylines->Points.data() + figure.Begin, figure.End - figure.Begin, figure.IsClosed, tolerance);
+
+                figure.End = figure.Begin + keptCount;
+            }
+        });
+}
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "PolylineSink.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // Removes points from a polyline using the Douglas-Peucker algorithm,
+    // so that no removed point is further than tolerance from the result.
+    // The first point is always kept, and so is the last point of an open
+    // polyline.  A closed polyline is decimated as if it ended with a copy
+    // of its first point.
+    //
+    // The kept points are moved to the front of the array, in order, and
+    // their count is returned.
+    //
+    uint32_t DecimatePolyline(D2D1_POINT_2F* points, uint32_t pointCount, bool isClosed, float tolerance);
+
+    //
+    // Decimates each figure in place, shrinking its End.  Figures are spread
+    // across threads when there are enough points to be worth it.
+    //
+    void DecimatePolylines(Polylines* polylines, float tolerance);
+}}}}}
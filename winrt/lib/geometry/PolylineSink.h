@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    struct PolylineFigure
+    {
+        uint32_t Begin;         // Range of Polylines::Points used by this figure
+        uint32_t End;
+        bool IsFilled;
+        bool IsClosed;
+    };
+
+    struct Polylines
+    {
+        D2D1_FILL_MODE FillMode;
+        std::vector<D2D1_POINT_2F> Points;
+        std::vector<PolylineFigure> Figures;
+    };
+
+
+    //
+    // Collects the output of ID2D1Geometry::Simplify into Polylines.
+    //
+    class PolylineSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1SimplifiedGeometrySink>,
+                         private LifespanTracker<PolylineSink>
+    {
+        Polylines* m_polylines;
+        HRESULT m_result;
+
+    public:
+        PolylineSink(Polylines* polylines)
+            : m_polylines(polylines)
+            , m_result(S_OK)
+        {
+            m_polylines->FillMode = D2D1_FILL_MODE_ALTERNATE;
+        }
+
+        //
+        // Flattens the geometry, in its own coordinate space, to lines.
+        //
+        static void Flatten(ID2D1Geometry* geometry, float flatteningTolerance, Polylines* polylines)
+        {
+            auto sink = Make<PolylineSink>(polylines);
+            CheckMakeResult(sink);
+
+            ThrowIfFailed(geometry->Simplify(D2D1_GEOMETRY_SIMPLIFICATION_OPTION_LINES, nullptr, flatteningTolerance, sink.Get()));
+            ThrowIfFailed(sink->Close());
+        }
+
+        IFACEMETHODIMP_(void) SetFillMode(D2D1_FILL_MODE fillMode) override
+        {
+            m_polylines->FillMode = fillMode;
+        }
+
+        IFACEMETHODIMP_(void) SetSegmentFlags(D2D1_PATH_SEGMENT) override
+        {
+            // Segment flags only affect stroking.
+        }
+
+        IFACEMETHODIMP_(void) BeginFigure(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin) override
+        {
+            if (FAILED(m_result))
+                return;
+
+            m_result = ExceptionBoundary([&]
+            {
+                auto begin = static_cast<uint32_t>(m_polylines->Points.size());
+
+                m_polylines->Figures.push_back(PolylineFigure{ begin, begin, figureBegin == D2D1_FIGURE_BEGIN_FILLED, false });
+
+                AddPoint(startPoint);
+            });
+        }
+
+        IFACEMETHODIMP_(void) AddLines(CONST D2D1_POINT_2F* points, UINT32 pointsCount) override
+        {
+            if (FAILED(m_result))
+                return;
+
+            m_result = ExceptionBoundary([&]
+            {
+                for (uint32_t i = 0; i < pointsCount; ++i)
+                {
+                    AddPoint(points[i]);
+                }
+            });
+        }
+
+        IFACEMETHODIMP_(void) AddBeziers(CONST D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override
+        {
+            if (FAILED(m_result))
+                return;
+
+            // Simplifying to lines should never produce curves, but if it does
+            // they are replaced by their chords.
+            m_result = ExceptionBoundary([&]
+            {
+                for (uint32_t i = 0; i < beziersCount; ++i)
+                {
+                    AddPoint(beziers[i].point3);
+                }
+            });
+        }
+
+        IFACEMETHODIMP_(void) EndFigure(D2D1_FIGURE_END figureEnd) override
+        {
+            if (!m_polylines->Figures.empty())
+                m_polylines->Figures.back().IsClosed = (figureEnd == D2D1_FIGURE_END_CLOSED);
+        }
+
+        IFACEMETHODIMP Close() override
+        {
+            return m_result;
+        }
+
+    private:
+        void AddPoint(D2D1_POINT_2F const& point)
+        {
+            if (m_polylines->Figures.empty())
+                ThrowHR(E_UNEXPECTED);
+
+            m_polylines->Points.push_back(point);
+            m_polylines->Figures.back().End = static_cast<uint32_t>(m_polylines->Points.size());
+        }
+    };
+}}}}}
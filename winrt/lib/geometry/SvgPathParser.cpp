@@ -0,0 +1,530 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "SvgPathParser.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+namespace
+{
+    // Lines are collected into a buffer of this many points before being
+    // passed to the sink.
+    const uint32_t LineBatchSize = 64;
+
+    // Digits after this many significant ones only affect the exponent.
+    const uint64_t MaximumMantissa = 100000000000000000;    // 10^17
+
+    const int MaximumExponent = 10000;
+
+    // Powers of ten that are exactly representable as doubles.
+    const double ExactPowersOfTen[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const int MaximumExactPowerOfTen = _countof(ExactPowersOfTen) - 1;
+
+
+    bool IsDigit(wchar_t c)
+    {
+        return c >= L'0' && c <= L'9';
+    }
+
+
+    bool IsWhitespace(wchar_t c)
+    {
+        return c == L' ' || c == L'\t' || c == L'\n' || c == L'\r' || c == L'\f';
+    }
+
+
+    D2D1_POINT_2F Reflect(D2D1_POINT_2F const& point, D2D1_POINT_2F const& center)
+    {
+        return D2D1_POINT_2F{ 2 * center.x - point.x, 2 * center.y - point.y };
+    }
+
+
+    class SvgPathParser
+    {
+        // Which kind of curve the previous segment was, so that S and T can
+        // reflect its last control point.
+        enum class PreviousCurve
+        {
+            None,
+            Cubic,
+            Quadratic
+        };
+
+        wchar_t const* m_begin;
+        wchar_t const* m_current;
+        wchar_t const* m_end;
+        ID2D1GeometrySink* m_sink;
+
+        D2D1_POINT_2F m_currentPoint;
+        D2D1_POINT_2F m_figureStart;
+        bool m_isInFigure;
+
+        PreviousCurve m_previousCurve;
+        D2D1_POINT_2F m_previousControlPoint;
+
+        // Whether the separator skipped after the last argument was a comma,
+        // which must be followed by another argument.
+        bool m_skippedComma;
+
+        D2D1_POINT_2F m_lines[LineBatchSize];
+        uint32_t m_lineCount;
+
+    public:
+        SvgPathParser(wchar_t const* data, size_t length, ID2D1GeometrySink* sink)
+            : m_begin(data)
+            , m_current(data)
+            , m_end(data + length)
+            , m_sink(sink)
+            , m_currentPoint{}
+            , m_figureStart{}
+            , m_isInFigure(false)
+            , m_previousCurve(PreviousCurve::None)
+            , m_previousControlPoint{}
+            , m_skippedComma(false)
+            , m_lineCount(0)
+        {
+        }
+
+        void Parse()
+        {
+            SkipWhitespace();
+
+            if (m_current == m_end)
+                return;
+
+            // Path data must start with a moveto.
+            if (*m_current != L'M' && *m_current != L'm')
+                ThrowInvalid();
+
+            while (m_current != m_end)
+            {
+                ParseCommand();
+            }
+
+            EndFigure(D2D1_FIGURE_END_OPEN);
+        }
+
+    private:
+        void ParseCommand()
+        {
+            auto commandPosition = m_current;
+            auto command = *m_current;
+            bool isRelative = (command >= L'a' && command <= L'z');
+
+            ++m_current;
+            SkipWhitespace();
+
+            switch (command)
+            {
+            case L'Z': case L'z':
+                EndFigure(D2D1_FIGURE_END_CLOSED);
+                m_currentPoint = m_figureStart;
+                m_previousCurve = PreviousCurve::None;
+                return;
+
+            case L'M': case L'm':
+                MoveTo(ReadPoint(isRelative));
+
+                // Further coordinate pairs are treated as lines.
+                while (IsAtAnotherArgument())
+                {
+                    LineTo(ReadPoint(isRelative));
+                }
+                return;
+
+            case L'L': case L'l':
+                ParseArguments([&] { LineTo(ReadPoint(isRelative)); });
+                return;
+
+            case L'H': case L'h':
+                ParseArguments([&] { LineTo(D2D1_POINT_2F{ ReadCoordinate(isRelative, m_currentPoint.x), m_currentPoint.y }); });
+                return;
+
+            case L'V': case L'v':
+                ParseArguments([&] { LineTo(D2D1_POINT_2F{ m_currentPoint.x, ReadCoordinate(isRelative, m_currentPoint.y) }); });
+                return;
+
+            case L'C': case L'c':
+                ParseArguments(
+                    [&]
+                    {
+                        auto point1 = ReadPoint(isRelative);
+                        auto point2 = ReadPoint(isRelative);
+                        CubicTo(point1, point2, ReadPoint(isRelative));
+                    });
+                return;
+
+            case L'S': case L's':
+                ParseArguments(
+                    [&]
+                    {
+                        auto point1 = GetReflectedControlPoint(PreviousCurve::Cubic);
+                        auto point2 = ReadPoint(isRelative);
+                        CubicTo(point1, point2, ReadPoint(isRelative));
+                    });
+                return;
+
+            case L'Q': case L'q':
+                ParseArguments(
+                    [&]
+                    {
+                        auto point1 = ReadPoint(isRelative);
+                        QuadraticTo(point1, ReadPoint(isRelative));
+                    });
+                return;
+
+            case L'T': case L't':
+                ParseArguments(
+                    [&]
+                    {
+                        auto point1 = GetReflectedControlPoint(PreviousCurve::Quadratic);
+                        QuadraticTo(point1, ReadPoint(isRelative));
+                    });
+                return;
+
+            case L'A': case L'a':
+                ParseArguments(
+                    [&]
+                    {
+                        auto radiusX = ReadNumber();
+                        auto radiusY = ReadNumber();
+                        auto rotationAngle = ReadNumber();
+                        auto isLargeArc = ReadFlag();
+                        auto isClockwise = ReadFlag();
+                        ArcTo(radiusX, radiusY, rotationAngle, isLargeArc, isClockwise, ReadPoint(isRelative));
+                    });
+                return;
+
+            default:
+                m_current = commandPosition;
+                ThrowInvalid();
+            }
+        }
+
+        // Parses one set of arguments for the current command, followed by
+        // as many more sets as there are.
+        template<typename FN>
+        void ParseArguments(FN&& parseOne)
+        {
+            do
+            {
+                parseOne();
+            } while (IsAtAnotherArgument());
+        }
+
+        bool IsAtAnotherArgument()
+        {
+            if (m_current != m_end)
+            {
+                auto c = *m_current;
+
+                if (IsDigit(c) || c == L'.' || c == L'-' || c == L'+')
+                    return true;
+            }
+
+            if (m_skippedComma)
+                ThrowInvalid();
+
+            return false;
+        }
+
+        //
+        // Segments
+        //
+
+        void MoveTo(D2D1_POINT_2F const& point)
+        {
+            EndFigure(D2D1_FIGURE_END_OPEN);
+
+            m_currentPoint = point;
+            m_figureStart = point;
+            m_previousCurve = PreviousCurve::None;
+        }
+
+        void LineTo(D2D1_POINT_2F const& point)
+        {
+            EnsureFigure();
+
+            if (m_lineCount == LineBatchSize)
+                FlushLines();
+
+            m_lines[m_lineCount++] = point;
+
+            m_currentPoint = point;
+            m_previousCurve = PreviousCurve::None;
+        }
+
+        void CubicTo(D2D1_POINT_2F const& point1, D2D1_POINT_2F const& point2, D2D1_POINT_2F const& point3)
+        {
+            EnsureFigure();
+            FlushLines();
+
+            D2D1_BEZIER_SEGMENT bezier{ point1, point2, point3 };
+            m_sink->AddBezier(&bezier);
+
+            m_currentPoint = point3;
+            m_previousCurve = PreviousCurve::Cubic;
+            m_previousControlPoint = point2;
+        }
+
+        void QuadraticTo(D2D1_POINT_2F const& point1, D2D1_POINT_2F const& point2)
+        {
+            EnsureFigure();
+            FlushLines();
+
+            D2D1_QUADRATIC_BEZIER_SEGMENT bezier{ point1, point2 };
+            m_sink->AddQuadraticBezier(&bezier);
+
+            m_currentPoint = point2;
+            m_previousCurve = PreviousCurve::Quadratic;
+            m_previousControlPoint = point1;
+        }
+
+        void ArcTo(float radiusX, float radiusY, float rotationAngle, bool isLargeArc, bool isClockwise, D2D1_POINT_2F const& point)
+        {
+            // As specified by SVG, an arc to the current point is omitted,
+            // and an arc with a zero radius is a straight line.
+            if (point.x == m_currentPoint.x && point.y == m_currentPoint.y)
+            {
+                m_previousCurve = PreviousCurve::None;
+                return;
+            }
+
+            if (radiusX == 0 || radiusY == 0)
+            {
+                LineTo(point);
+                return;
+            }
+
+            EnsureFigure();
+            FlushLines();
+
+            // SVG angles are in degrees, and a positive sweep flag means
+            // clockwise in a y-down coordinate space, just like D2D.
+            D2D1_ARC_SEGMENT arc
+            {
+                point,
+                D2D1_SIZE_F{ fabs(radiusX), fabs(radiusY) },
+                rotationAngle,
+                isClockwise ? D2D1_SWEEP_DIRECTION_CLOCKWISE : D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE,
+                isLargeArc ? D2D1_ARC_SIZE_LARGE : D2D1_ARC_SIZE_SMALL
+            };
+
+            m_sink->AddArc(&arc);
+
+            m_currentPoint = point;
+            m_previousCurve = PreviousCurve::None;
+        }
+
+        D2D1_POINT_2F GetReflectedControlPoint(PreviousCurve curve)
+        {
+            if (m_previousCurve == curve)
+                return Reflect(m_previousControlPoint, m_currentPoint);
+            else
+                return m_currentPoint;
+        }
+
+        // Figures are begun by their first segment rather than by the moveto,
+        // so that a moveto with nothing after it produces nothing.
+        void EnsureFigure()
+        {
+            if (!m_isInFigure)
+            {
+                m_sink->BeginFigure(m_figureStart, D2D1_FIGURE_BEGIN_FILLED);
+                m_isInFigure = true;
+            }
+        }
+
+        void EndFigure(D2D1_FIGURE_END figureEnd)
+        {
+            if (m_isInFigure)
+            {
+                FlushLines();
+                m_sink->EndFigure(figureEnd);
+                m_isInFigure = false;
+            }
+        }
+
+        void FlushLines()
+        {
+            if (m_lineCount > 0)
+            {
+                m_sink->AddLines(m_lines, m_lineCount);
+                m_lineCount = 0;
+            }
+        }
+
+        //
+        // Arguments
+        //
+
+        D2D1_POINT_2F ReadPoint(bool isRelative)
+        {
+            auto x = ReadCoordinate(isRelative, m_currentPoint.x);
+            auto y = ReadCoordinate(isRelative, m_currentPoint.y);
+
+            return D2D1_POINT_2F{ x, y };
+        }
+
+        float ReadCoordinate(bool isRelative, float origin)
+        {
+            auto value = ReadNumber();
+
+            return isRelative ? origin + value : value;
+        }
+
+        // Reads a number, in the form [+-]digits[.digits][(e|E)[+-]digits],
+        // and the separator after it.  The mantissa is accumulated as an
+        // integer and scaled once, which is exact for the numbers paths
+        // usually contain.
+        float ReadNumber()
+        {
+            auto p = m_current;
+
+            bool isNegative = false;
+
+            if (p != m_end && (*p == L'+' || *p == L'-'))
+            {
+                isNegative = (*p == L'-');
+                ++p;
+            }
+
+            uint64_t mantissa = 0;
+            int exponent = 0;
+            bool hasDigits = false;
+
+            for (; p != m_end && IsDigit(*p); ++p)
+            {
+                if (mantissa < MaximumMantissa)
+                    mantissa = mantissa * 10 + (*p - L'0');
+                else
+                    ++exponent;
+
+                hasDigits = true;
+            }
+
+            if (p != m_end && *p == L'.')
+            {
+                for (++p; p != m_end && IsDigit(*p); ++p)
+                {
+                    if (mantissa < MaximumMantissa)
+                    {
+                        mantissa = mantissa * 10 + (*p - L'0');
+                        --exponent;
+                    }
+
+                    hasDigits = true;
+                }
+            }
+
+            if (!hasDigits)
+                ThrowInvalid();
+
+            // An 'e' only starts an exponent when digits follow it.
+            if (p != m_end && (*p == L'e' || *p == L'E'))
+            {
+                auto q = p + 1;
+                bool isExponentNegative = false;
+
+                if (q != m_end && (*q == L'+' || *q == L'-'))
+                {
+                    isExponentNegative = (*q == L'-');
+                    ++q;
+                }
+
+                if (q != m_end && IsDigit(*q))
+                {
+                    int explicitExponent = 0;
+
+                    for (; q != m_end && IsDigit(*q); ++q)
+                    {
+                        if (explicitExponent < MaximumExponent)
+                            explicitExponent = explicitExponent * 10 + (*q - L'0');
+                    }
+
+                    exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+                    p = q;
+                }
+            }
+
+            double value = static_cast<double>(mantissa);
+
+            if (mantissa != 0 && exponent != 0)
+            {
+                if (exponent > 0 && exponent <= MaximumExactPowerOfTen)
+                    value *= ExactPowersOfTen[exponent];
+                else if (exponent < 0 && exponent >= -MaximumExactPowerOfTen)
+                    value /= ExactPowersOfTen[-exponent];
+                else
+                    value *= pow(10.0, exponent);
+            }
+
+            auto result = static_cast<float>(isNegative ? -value : value);
+
+            if (!isfinite(result))
+                ThrowInvalid();
+
+            m_current = p;
+            SkipSeparator();
+
+            return result;
+        }
+
+        // Flags are a single digit, which need not be separated from
+        // whatever follows.
+        bool ReadFlag()
+        {
+            if (m_current == m_end || (*m_current != L'0' && *m_current != L'1'))
+                ThrowInvalid();
+
+            bool value = (*m_current == L'1');
+
+            ++m_current;
+            SkipSeparator();
+
+            return value;
+        }
+
+        void SkipWhitespace()
+        {
+            while (m_current != m_end && IsWhitespace(*m_current))
+            {
+                ++m_current;
+            }
+        }
+
+        void SkipSeparator()
+        {
+            SkipWhitespace();
+
+            m_skippedComma = (m_current != m_end && *m_current == L',');
+
+            if (m_skippedComma)
+            {
+                ++m_current;
+                SkipWhitespace();
+            }
+        }
+
+        __declspec(noreturn) void ThrowInvalid()
+        {
+            WinStringBuilder message;
+            message.Format(Strings::InvalidSvgPathData, static_cast<int>(m_current - m_begin));
+            ThrowHR(E_INVALIDARG, message.Get());
+        }
+    };
+}
+
+
+void ABI::Microsoft::Graphics::Canvas::Geometry::ParseSvgPathData(wchar_t const* data, size_t length, ID2D1GeometrySink* sink)
+{
+    SvgPathParser(data, length, sink).Parse();
+}
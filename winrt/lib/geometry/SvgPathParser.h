@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // Parses SVG path data (the "d" attribute of an SVG path element) and
+    // sends it to sink as it goes.  All SVG path commands are supported, in
+    // both their absolute and relative forms.  Elliptical arcs map directly
+    // onto D2D1_ARC_SEGMENT, which takes the same end point parameterization.
+    //
+    // Nothing is allocated: numbers are parsed in place, and lines are
+    // batched in a fixed size buffer so that polylines reach the sink in
+    // a few AddLines calls.
+    //
+    // Throws E_INVALIDARG at the first character that does not follow the
+    // SVG path grammar.  The sink is not closed.
+    //
+    void ParseSvgPathData(wchar_t const* data, size_t length, ID2D1GeometrySink* sink);
+}}}}}
@@ -4,19 +4,42 @@
 
 #pragma once
 
+#include "CanvasIndexedMesh.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
 {
+    //
+    // Collects the triangles that Direct2D produces.
+    //
+    // Triangles are either appended to a CoTaskMem buffer that is handed
+    // directly to the caller (so they are only copied once, out of Direct2D),
+    // or passed straight on to an IndexedMeshBuilder.
+    //
     class TessellationSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1TessellationSink>,
                              private LifespanTracker<TessellationSink>
     {
-        std::vector<CanvasTriangleVertices> m_triangles;
+        CanvasTriangleVertices* m_triangles;
+        uint32_t m_triangleCount;
+        uint32_t m_capacity;
+
+        IndexedMeshBuilder* m_meshBuilder;
+
         HRESULT m_result;
 
     public:
-        TessellationSink()
-            : m_result(S_OK)
+        TessellationSink(IndexedMeshBuilder* meshBuilder = nullptr)
+            : m_triangles(nullptr)
+            , m_triangleCount(0)
+            , m_capacity(0)
+            , m_meshBuilder(meshBuilder)
+            , m_result(S_OK)
         { }
 
+        ~TessellationSink()
+        {
+            CoTaskMemFree(m_triangles);
+        }
+
         IFACEMETHODIMP_(void) AddTriangles(D2D1_TRIANGLE const* triangles, UINT32 trianglesCount)
         {
             if (FAILED(m_result))
@@ -26,7 +49,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             {
                 auto canvasTriangles = ReinterpretAs<CanvasTriangleVertices const*>(triangles);
 
-                m_triangles.insert(m_triangles.end(), canvasTriangles, canvasTriangles + trianglesCount);
+                if (m_meshBuilder)
+                {
+                    m_meshBuilder->AddTriangles(canvasTriangles, trianglesCount);
+                    return;
+                }
+
+                if (trianglesCount > m_capacity - m_triangleCount)
+                    Grow(trianglesCount);
+
+                std::copy(canvasTriangles, canvasTriangles + trianglesCount, stdext::make_checked_array_iterator(m_triangles + m_triangleCount, trianglesCount));
+                m_triangleCount += trianglesCount;
             });
         }
 
@@ -35,11 +68,53 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             return m_result;
         }
 
-        ComArray<CanvasTriangleVertices> GetTriangles()
+        //
+        // Hands the triangles over to the caller, who must free them with
+        // CoTaskMemFree.
+        //
+        void DetachTriangles(uint32_t* trianglesCount, CanvasTriangleVertices** triangles)
         {
             ThrowIfFailed(m_result);
 
-            return ComArray<CanvasTriangleVertices>(m_triangles.begin(), m_triangles.end());
+            // Give back any spare capacity.  This shrinks the allocation in
+            // place, so does not copy the triangles again.
+            if (m_triangleCount < m_capacity && m_triangleCount > 0)
+            {
+                auto shrunk = CoTaskMemRealloc(m_triangles, m_triangleCount * sizeof(CanvasTriangleVertices));
+
+                if (shrunk)
+                    m_triangles = static_cast<CanvasTriangleVertices*>(shrunk);
+            }
+
+            *trianglesCount = m_triangleCount;
+            *triangles = m_triangleCount ? m_triangles : nullptr;
+
+            if (!m_triangleCount)
+                CoTaskMemFree(m_triangles);
+
+            m_triangles = nullptr;
+            m_triangleCount = 0;
+            m_capacity = 0;
+        }
+
+    private:
+        void Grow(uint32_t additionalCount)
+        {
+            uint64_t required = static_cast<uint64_t>(m_triangleCount) + additionalCount;
+            uint64_t capacity = std::max<uint64_t>(required, static_cast<uint64_t>(m_capacity) * 2);
+
+            capacity = std::min<uint64_t>(capacity, UINT_MAX / sizeof(CanvasTriangleVertices));
+
+            if (capacity < required)
+                ThrowHR(E_OUTOFMEMORY);
+
+            auto grown = CoTaskMemRealloc(m_triangles, static_cast<size_t>(capacity * sizeof(CanvasTriangleVertices)));
+
+            if (!grown)
+                ThrowHR(E_OUTOFMEMORY);
+
+            m_triangles = static_cast<CanvasTriangleVertices*>(grown);
+            m_capacity = static_cast<uint32_t>(capacity);
         }
     };
 }}}}}
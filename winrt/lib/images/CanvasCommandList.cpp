@@ -31,6 +31,48 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    IFACEMETHODIMP CanvasCommandListFactory::CreateCombined(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t commandListsCount,
+        ICanvasCommandList** commandLists,
+        ICanvasCommandList** commandList)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckAndClearOutPointer(commandList);
+
+                if (commandListsCount > 0)
+                    CheckInPointer(commandLists);
+
+                for (uint32_t i = 0; i < commandListsCount; i++)
+                {
+                    CheckInPointer(commandLists[i]);
+                }
+
+                ComPtr<ICanvasDevice> device;
+                ThrowIfFailed(resourceCreator->get_Device(&device));
+
+                auto cl = CanvasCommandList::CreateNew(device.Get());
+
+                ComPtr<ICanvasDrawingSession> drawingSession;
+                ThrowIfFailed(cl->CreateDrawingSession(&drawingSession));
+
+                // Each command list is played back as an image, so the order
+                // they are passed in is the order they are drawn.
+                for (uint32_t i = 0; i < commandListsCount; i++)
+                {
+                    ThrowIfFailed(drawingSession->DrawImageAtOrigin(As<ICanvasImage>(commandLists[i]).Get()));
+                }
+
+                ThrowIfFailed(As<IClosable>(drawingSession)->Close());
+
+                ThrowIfFailed(cl.CopyTo(commandList));
+            });
+    }
+
+
     //
     // CanvasCommandList
     //
@@ -77,12 +119,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& d2dCommandList = GetResource();
                 auto& device = m_device.EnsureNotClosed();
 
-                auto deviceContext = As<ICanvasDeviceInternal>(device)->CreateDeviceContextForDrawingSession();
-                deviceContext->SetTarget(d2dCommandList.Get());
+                // Recording uses a device context leased from the device's
+                // pool, so that command lists recorded on several threads at
+                // once each get their own context without creating a new one
+                // every time.
+                auto deviceContext = As<ICanvasDeviceInternal>(device)->GetResourceCreationDeviceContext();
+                auto d2dDeviceContext = deviceContext.Get();
+
+                d2dDeviceContext->SetTarget(d2dCommandList.Get());
 
-                auto adapter = std::make_shared<SimpleCanvasDrawingSessionAdapter>(deviceContext.Get());
+                auto adapter = std::make_shared<LeasedCanvasDrawingSessionAdapter>(std::move(deviceContext));
 
-                auto ds = CanvasDrawingSession::CreateNew(deviceContext.Get(), adapter, device.Get(), m_hasActiveDrawingSession);
+                auto ds = CanvasDrawingSession::CreateNew(d2dDeviceContext, adapter, device.Get(), m_hasActiveDrawingSession);
 
                 ThrowIfFailed(ds.CopyTo(drawingSession));
             });
@@ -71,7 +71,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
 
     class CanvasCommandListFactory
-        : public AgileActivationFactory<ICanvasCommandListFactory>
+        : public AgileActivationFactory<ICanvasCommandListFactory, ICanvasCommandListStatics>
         , private LifespanTracker<CanvasCommandListFactory>
     {
         InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_CanvasCommandList, BaseTrust);
@@ -80,5 +80,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHOD(Create)(
             ICanvasResourceCreator* resourceCreator,
             ICanvasCommandList** commandList) override;
+
+        //
+        // ICanvasCommandListStatics
+        //
+
+        IFACEMETHOD(CreateCombined)(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t commandListsCount,
+            ICanvasCommandList** commandLists,
+            ICanvasCommandList** commandList) override;
     };
 }}}}
@@ -25,6 +25,7 @@
 #include <functional>
 #include <future>
 #include <iterator>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -491,7 +491,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetFonts(
             CheckInPointer(textFormat);
             CheckAndClearOutPointer(result);
 
-            auto dwriteTextFormat = GetWrappedResource<IDWriteTextFormat>(textFormat);
+            auto dwriteTextFormat = As<ICanvasTextFormatInternal>(textFormat)->GetSharedTextFormat();
 
             WinString localeNameString = GetLocaleName(dwriteTextFormat.Get());
 
@@ -95,11 +95,26 @@ IFACEMETHODIMP CanvasTextFormatFactory::ActivateInstance(IInspectable** object)
 // CanvasTextFormat implementation
 //
 
+//
+// Formats that are created with the default properties all start with the
+// same version, so that text layouts cached for one of them (eg. the default
+// format of a drawing session) can be reused by the others.
+//
+static uint64_t const DefaultTextFormatVersion = 1;
+
+static uint64_t GetNextTextFormatVersion()
+{
+    static std::atomic<uint64_t> nextVersion{ DefaultTextFormatVersion };
+
+    return ++nextVersion;
+}
+
 
 CanvasTextFormat::CanvasTextFormat()
     : ResourceWrapper(nullptr)
     , m_customFontManager(CustomFontManager::GetInstance())
     , m_closed(false)
+    , m_version(DefaultTextFormatVersion)
     , m_direction(CanvasTextDirection::LeftToRightThenTopToBottom)
     , m_fontFamilyName(L"Segoe UI")
     , m_fontSize(20.0f)
@@ -127,6 +142,7 @@ CanvasTextFormat::CanvasTextFormat(IDWriteTextFormat1* format)
     : ResourceWrapper(format)
     , m_customFontManager(CustomFontManager::GetInstance())
     , m_closed(false)
+    , m_version(UncacheableTextFormatVersion)     // the format came from interop, so may be modified there
     , m_drawTextOptions(CanvasDrawTextOptions::Default)
     , m_lineSpacingMode(CanvasLineSpacingMode::Default)
 {
@@ -137,6 +153,7 @@ CanvasTextFormat::CanvasTextFormat(IDWriteTextFormat1* format)
 IFACEMETHODIMP CanvasTextFormat::Close()
 {
     m_closed = true;
+    m_sharedTextFormat.Reset();
     return ResourceWrapper::Close();
 }
 
@@ -148,6 +165,13 @@ void CanvasTextFormat::ThrowIfClosed()
 }
 
 
+void CanvasTextFormat::UpdateVersion()
+{
+    if (m_version != UncacheableTextFormatVersion)
+        m_version = GetNextTextFormatVersion();
+}
+
+
 IFACEMETHODIMP CanvasTextFormat::GetNativeResource(ICanvasDevice* device, float dpi, REFIID iid, void** value)
 {
     UNREFERENCED_PARAMETER(device);
@@ -158,7 +182,17 @@ IFACEMETHODIMP CanvasTextFormat::GetNativeResource(ICanvasDevice* device, float
         {
             CheckAndClearOutPointer(value);
             ThrowIfClosed();
-            ThrowIfFailed(GetRealizedTextFormat().CopyTo(iid, value));
+
+            auto lock = GetLock();
+
+            //
+            // The caller may modify the resource we hand out without going
+            // through our properties, so from now on nothing may cache text
+            // layouts built from this format.
+            //
+            m_version = UncacheableTextFormatVersion;
+
+            ThrowIfFailed(GetOrCreateResource().CopyTo(iid, value));
         });
 }
 
@@ -167,6 +201,12 @@ ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetRealizedTextFormat()
 {
     auto lock = GetLock();
 
+    return GetOrCreateResource();
+}
+
+
+ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetOrCreateResource()
+{
     auto& existingResource = MaybeGetResource();
 
     if (existingResource)
@@ -179,11 +219,90 @@ ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetRealizedTextFormat()
 
         SetResource(newResource.Get());
 
+        // From now on the resource is the authoritative copy of our state,
+        // and it may be modified, so it can't be shared.
+        m_sharedTextFormat.Reset();
+
         return newResource;
     }
 }
 
 
+ComPtr<IDWriteTextFormat> CanvasTextFormat::GetSharedTextFormat()
+{
+    auto lock = GetLock();
+
+    if (HasResource() || !CanShareRealizedTextFormat())
+        return GetOrCreateResource();
+
+    if (!m_sharedTextFormat)
+    {
+        m_sharedTextFormat = m_customFontManager->GetTextFormatCache().GetOrCreate(
+            GetTextFormatCacheKey(m_wordWrapping),
+            [&] { return CreateRealizedTextFormat(); });
+    }
+
+    return m_sharedTextFormat;
+}
+
+
+ComPtr<IDWriteTextFormat> CanvasTextFormat::GetSharedTextFormatWithWordWrapping(CanvasWordWrapping wordWrapping)
+{
+    ThrowIfInvalid<CanvasWordWrapping>(wordWrapping);
+
+    auto lock = GetLock();
+
+    if (HasResource() || !CanShareRealizedTextFormat())
+        return CreateRealizedTextFormatClone(wordWrapping);
+
+    return m_customFontManager->GetTextFormatCache().GetOrCreate(
+        GetTextFormatCacheKey(wordWrapping),
+        [&] { return CreateRealizedTextFormatClone(wordWrapping); });
+}
+
+
+bool CanvasTextFormat::CanShareRealizedTextFormat()
+{
+    //
+    // Trimming signs are inline objects that belong to a single
+    // CanvasTextFormat (the ellipsis sign is recognized by comparing it
+    // against the one we created), so formats that use them always get their
+    // own IDWriteTextFormat.
+    //
+    return m_trimmingSignInformation.GetTrimmingSignShadowState() == CanvasTrimmingSign::None &&
+           !m_trimmingSignInformation.GetCustomTrimmingSignShadowState();
+}
+
+
+TextFormatCacheKey CanvasTextFormat::GetTextFormatCacheKey(CanvasWordWrapping wordWrapping)
+{
+    return TextFormatCacheKey
+    {
+        m_fontCollection,
+        std::wstring(static_cast<wchar_t const*>(m_fontFamilyName)),
+        std::wstring(static_cast<wchar_t const*>(m_localeName)),
+        std::wstring(static_cast<wchar_t const*>(m_trimmingDelimiter)),
+        m_direction,
+        m_fontSize,
+        m_fontStretch,
+        m_fontStyle,
+        m_fontWeight.Weight,
+        m_incrementalTabStop,
+        m_lineSpacingMode,
+        m_lineSpacing,
+        m_lineSpacingBaseline,
+        m_verticalAlignment,
+        m_horizontalAlignment,
+        m_trimmingGranularity,
+        m_trimmingDelimiterCount,
+        wordWrapping,
+        m_verticalGlyphOrientation,
+        m_opticalAlignment,
+        m_lastLineWrapping
+    };
+}
+
+
 ComPtr<IDWriteTextFormat1> CanvasTextFormat::CreateRealizedTextFormat(bool skipWordWrapping)
 {
     auto factory = m_customFontManager->GetSharedFactory();
@@ -252,6 +371,12 @@ ComPtr<IDWriteTextFormat> CanvasTextFormat::GetRealizedTextFormatClone(CanvasWor
 
     auto lock = GetLock();
 
+    return CreateRealizedTextFormatClone(overrideWordWrapping);
+}
+
+
+ComPtr<IDWriteTextFormat1> CanvasTextFormat::CreateRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping)
+{
     if (HasResource())
     {
         SetShadowPropertiesFromDWrite();
@@ -271,6 +396,14 @@ D2D1_DRAW_TEXT_OPTIONS CanvasTextFormat::GetDrawTextOptions()
 }
 
 
+uint64_t CanvasTextFormat::GetVersion()
+{
+    auto lock = GetLock();
+
+    return m_version;
+}
+
+
 void CanvasTextFormat::Unrealize()
 {
     //
@@ -475,6 +608,8 @@ HRESULT __declspec(nothrow) CanvasTextFormat::PropertyPut(T value, TT* dest, FNV
 
             // Set the shadow value
             SetFrom(dest, value);
+            UpdateVersion();
+            m_sharedTextFormat.Reset();
 
             // Realize the value on the dwrite object, if we can
             auto& textFormat = MaybeGetResource();
@@ -620,6 +755,8 @@ IFACEMETHODIMP CanvasTextFormat::put_FontFamily(HSTRING value)
             m_fontCollection.Reset();
 
             SetFrom(&m_fontFamilyName, value);
+            UpdateVersion();
+            m_sharedTextFormat.Reset();
 
             //
             // For properties like this that change something, unrealize and 
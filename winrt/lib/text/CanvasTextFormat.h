@@ -8,15 +8,6 @@
 #include "CustomFontManager.h"
 #include "TrimmingSignInformation.h"
 
-//
-// CanvasLineSpacingMode is a type that is only available on Win10.
-// To reduce the number of guards around places that consume this type,
-// we define a placeholder for 8.1.
-//
-#if WINVER <= _WIN32_WINNT_WINBLUE
-enum CanvasLineSpacingMode { Default };
-#endif
-
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
 {
     using namespace ::Microsoft::WRL;
@@ -49,6 +40,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     // ICanvasTextFormatInternal
     //
 
+    // The version of formats whose text layouts must not be cached.
+    static uint64_t const UncacheableTextFormatVersion = 0;
+
     class __declspec(uuid("E295AC1E-B763-49D4-9AE3-6E75D0C429AA"))
     ICanvasTextFormatInternal : public IUnknown
     {
@@ -56,6 +50,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual ComPtr<IDWriteTextFormat1> GetRealizedTextFormat() = 0;
         virtual ComPtr<IDWriteTextFormat> GetRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping) = 0;
         virtual D2D1_DRAW_TEXT_OPTIONS GetDrawTextOptions() = 0;
+
+        // These return a realized format for read-only use, such as drawing or
+        // creating a text layout.  Formats with identical properties may
+        // return the same object, so it must never be modified.
+        virtual ComPtr<IDWriteTextFormat> GetSharedTextFormat() = 0;
+        virtual ComPtr<IDWriteTextFormat> GetSharedTextFormatWithWordWrapping(CanvasWordWrapping wordWrapping) = 0;
+
+        // Identifies the current state of the format.  This changes whenever a
+        // property that affects text layout is modified.  Formats that have
+        // never been modified may share a version, but two formats with the
+        // same version always have identical properties.
+        //
+        // Returns UncacheableTextFormatVersion once the DirectWrite format may
+        // be modified through interop, since those changes can't be tracked.
+        virtual uint64_t GetVersion() = 0;
     };
 
 
@@ -87,6 +96,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         // be updated atomically.
         //
         std::mutex m_mutex;
+
+        //
+        // Updated whenever a property is set, so that text layouts built from
+        // the format can be cached (see TextLayoutCache).  This sticks at
+        // UncacheableTextFormatVersion once the resource has been handed out.
+        //
+        uint64_t m_version;
+
+        //
+        // Realized format shared with other CanvasTextFormats that have the
+        // same properties (see TextFormatCache).  This is only used while we
+        // have no resource of our own, and is never modified.
+        //
+        ComPtr<IDWriteTextFormat1> m_sharedTextFormat;
         
         //
         // Shadow properties.  These values are used to recreate the IDWriteTextFormat when
@@ -180,6 +203,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual ComPtr<IDWriteTextFormat1> GetRealizedTextFormat() override;
         virtual ComPtr<IDWriteTextFormat> GetRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping) override;
         virtual D2D1_DRAW_TEXT_OPTIONS GetDrawTextOptions() override;
+        virtual ComPtr<IDWriteTextFormat> GetSharedTextFormat() override;
+        virtual ComPtr<IDWriteTextFormat> GetSharedTextFormatWithWordWrapping(CanvasWordWrapping wordWrapping) override;
+        virtual uint64_t GetVersion() override;
 
         //
         // ICanvasResourceWrapperNative
@@ -195,6 +221,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         
         void ThrowIfClosed();
 
+        void UpdateVersion();
+
         template<typename T, typename ST, typename FN>
         HRESULT __declspec(nothrow) PropertyGet(T* value, ST const& shadowValue, FN realizedGetter);
 
@@ -221,7 +249,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         void RealizeTrimmingSign(IDWriteTextFormat1* textFormat);
         void RealizeCustomTrimmingSign(IDWriteTextFormat1* textFormat);
 
+        ComPtr<IDWriteTextFormat1> GetOrCreateResource();
         ComPtr<IDWriteTextFormat1> CreateRealizedTextFormat(bool skipWordWrapping = false);
+        ComPtr<IDWriteTextFormat1> CreateRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping);
+
+        bool CanShareRealizedTextFormat();
+        TextFormatCacheKey GetTextFormatCacheKey(CanvasWordWrapping wordWrapping);
 };
 
 
@@ -65,7 +65,7 @@ ComPtr<CanvasTextLayout> CanvasTextLayout::CreateNew(
     ThrowIfFailed(dwriteFactory->CreateTextLayout(
         textBuffer,
         textLength,
-        GetWrappedResource<IDWriteTextFormat>(textFormat).Get(),
+        As<ICanvasTextFormatInternal>(textFormat)->GetSharedTextFormat().Get(),
         requestedWidth,
         requestedHeight,
         &dwriteTextLayout));
@@ -243,6 +243,11 @@ ComPtr<IDWriteFontFallback> const& CustomFontManager::GetSystemFontFallback()
     return m_systemFontFallback;
 }
 
+TextFormatCache& CustomFontManager::GetTextFormatCache()
+{
+    return m_textFormatCache;
+}
+
 void CustomFontManager::ValidateUri(WinString const& uriString)
 {
     if (uriString == WinString())
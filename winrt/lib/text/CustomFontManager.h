@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "TextFormatCache.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
 {
     class DefaultCustomFontManagerAdapter;
@@ -41,6 +43,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ComPtr<IDWriteTextAnalyzer2> m_textAnalyzer;
         ComPtr<IDWriteFontFallback> m_systemFontFallback;
 
+        TextFormatCache m_textFormatCache;
+
     public:
         CustomFontManager();
 
@@ -56,6 +60,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ComPtr<IDWriteFontFallback> const& GetSystemFontFallback();
 
+        TextFormatCache& GetTextFormatCache();
+
     private:
         ComPtr<IDWriteFactory> const& GetIsolatedFactory();
 
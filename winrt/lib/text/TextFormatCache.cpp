@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextFormatCache.h"
+#include "utils/HashUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+// Line spacing uses the sign of the value (including -0) to choose the
+// spacing method, so floats must match exactly rather than just compare equal.
+static bool IsSameFloat(float a, float b)
+{
+    return a == b && signbit(a) == signbit(b);
+}
+
+
+bool TextFormatCacheKey::operator==(TextFormatCacheKey const& other) const
+{
+    return FontCollection == other.FontCollection &&
+           FontFamilyName == other.FontFamilyName &&
+           LocaleName == other.LocaleName &&
+           TrimmingDelimiter == other.TrimmingDelimiter &&
+           Direction == other.Direction &&
+           IsSameFloat(FontSize, other.FontSize) &&
+           FontStretch == other.FontStretch &&
+           FontStyle == other.FontStyle &&
+           FontWeight == other.FontWeight &&
+           IsSameFloat(IncrementalTabStop, other.IncrementalTabStop) &&
+           LineSpacingMode == other.LineSpacingMode &&
+           IsSameFloat(LineSpacing, other.LineSpacing) &&
+           IsSameFloat(LineSpacingBaseline, other.LineSpacingBaseline) &&
+           VerticalAlignment == other.VerticalAlignment &&
+           HorizontalAlignment == other.HorizontalAlignment &&
+           TrimmingGranularity == other.TrimmingGranularity &&
+           TrimmingDelimiterCount == other.TrimmingDelimiterCount &&
+           WordWrapping == other.WordWrapping &&
+           VerticalGlyphOrientation == other.VerticalGlyphOrientation &&
+           OpticalAlignment == other.OpticalAlignment &&
+           LastLineWrapping == other.LastLineWrapping;
+}
+
+
+size_t TextFormatCacheKeyHash::operator()(TextFormatCacheKey const& key) const
+{
+    size_t hash = std::hash<std::wstring>()(key.FontFamilyName);
+
+    HashCombine(hash, static_cast<void*>(key.FontCollection.Get()));
+    HashCombine(hash, key.LocaleName);
+    HashCombine(hash, key.FontSize);
+    HashCombine(hash, key.FontWeight);
+    HashCombine(hash, static_cast<int>(key.FontStyle));
+    HashCombine(hash, static_cast<int>(key.FontStretch));
+    HashCombine(hash, static_cast<int>(key.WordWrapping));
+    HashCombine(hash, static_cast<int>(key.HorizontalAlignment));
+    HashCombine(hash, static_cast<int>(key.VerticalAlignment));
+
+    // The remaining properties are rarely changed, so are left to operator==.
+
+    return hash;
+}
+
+
+uint32_t TextFormatCache::GetEntryCount()
+{
+    Lock lock(m_mutex);
+
+    return static_cast<uint32_t>(m_entries.GetCount());
+}
+
+
+void TextFormatCache::Clear()
+{
+    Lock lock(m_mutex);
+
+    m_entries.Clear();
+}
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/LockUtilities.h"
+#include "utils/LruCache.h"
+
+//
+// CanvasLineSpacingMode is a type that is only available on Win10.
+// To reduce the number of guards around places that consume this type,
+// we define a placeholder for 8.1.
+//
+#if WINVER <= _WIN32_WINNT_WINBLUE
+enum CanvasLineSpacingMode { Default };
+#endif
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    using namespace ::Microsoft::WRL;
+
+    //
+    // Every CanvasTextFormat property that affects the realized
+    // IDWriteTextFormat.  Trimming signs are not included, since formats that
+    // use them are never shared.
+    //
+    struct TextFormatCacheKey
+    {
+        ComPtr<IDWriteFontCollection> FontCollection;
+        std::wstring FontFamilyName;
+        std::wstring LocaleName;
+        std::wstring TrimmingDelimiter;
+        CanvasTextDirection Direction;
+        float FontSize;
+        ABI::Windows::UI::Text::FontStretch FontStretch;
+        ABI::Windows::UI::Text::FontStyle FontStyle;
+        uint16_t FontWeight;
+        float IncrementalTabStop;
+        CanvasLineSpacingMode LineSpacingMode;
+        float LineSpacing;
+        float LineSpacingBaseline;
+        CanvasVerticalAlignment VerticalAlignment;
+        CanvasHorizontalAlignment HorizontalAlignment;
+        CanvasTextTrimmingGranularity TrimmingGranularity;
+        int32_t TrimmingDelimiterCount;
+        CanvasWordWrapping WordWrapping;
+        CanvasVerticalGlyphOrientation VerticalGlyphOrientation;
+        CanvasOpticalAlignment OpticalAlignment;
+        bool LastLineWrapping;
+
+        bool operator==(TextFormatCacheKey const& other) const;
+    };
+
+    struct TextFormatCacheKeyHash
+    {
+        size_t operator()(TextFormatCacheKey const& key) const;
+    };
+
+
+    //
+    // Process-wide cache of realized text formats, so that CanvasTextFormats
+    // with identical properties (such as the default format used by every
+    // drawing session) share a single IDWriteTextFormat rather than each
+    // creating their own.
+    //
+    // Text formats are device independent, so the cache is owned by the
+    // CustomFontManager alongside the shared DirectWrite factory.  Formats
+    // returned from the cache are shared between threads and must never be
+    // modified.
+    //
+    class TextFormatCache
+    {
+        std::mutex m_mutex;
+        LruCache<TextFormatCacheKey, ComPtr<IDWriteTextFormat1>, TextFormatCacheKeyHash> m_entries;
+
+    public:
+        static uint32_t const MaximumEntries = 64;
+
+        //
+        // Returns the format for key, creating it with createFormat if it is
+        // not already cached.
+        //
+        template<typename FN>
+        ComPtr<IDWriteTextFormat1> GetOrCreate(TextFormatCacheKey&& key, FN&& createFormat)
+        {
+            {
+                Lock lock(m_mutex);
+
+                if (auto existing = m_entries.Find(key))
+                    return *existing;
+            }
+
+            // The format is created without holding the lock.  If two threads
+            // race to create the same format, the first one to finish wins so
+            // that both end up sharing it.
+            ComPtr<IDWriteTextFormat1> format = createFormat();
+
+            Lock lock(m_mutex);
+
+            if (auto existing = m_entries.Find(key))
+                return *existing;
+
+            m_entries.Add(std::move(key), format, 1);
+            m_entries.Trim(MaximumEntries, MaximumEntries);
+
+            return format;
+        }
+
+        uint32_t GetEntryCount();
+
+        void Clear();
+    };
+}}}}}
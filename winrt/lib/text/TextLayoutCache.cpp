@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextLayoutCache.h"
+#include "CustomFontManager.h"
+#include "utils/HashUtilities.h"
+#include "utils/LockUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+size_t TextLayoutCacheKeyHash::operator()(TextLayoutCacheKey const& key) const
+{
+    size_t hash = std::hash<std::wstring>()(key.Text);
+
+    HashCombine(hash, key.FormatVersion);
+    HashCombine(hash, key.Width);
+    HashCombine(hash, key.Height);
+    HashCombine(hash, key.NoWrap);
+
+    return hash;
+}
+
+
+TextLayoutCache::TextLayoutCache()
+    : m_maximumEntries(0)
+    , m_maximumBytes(DefaultMaximumBytes)
+    , m_statistics{}
+{
+}
+
+
+bool TextLayoutCache::IsEnabled()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumEntries > 0 && m_maximumBytes > 0;
+}
+
+
+uint32_t TextLayoutCache::GetMaximumEntries()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumEntries;
+}
+
+
+void TextLayoutCache::SetMaximumEntries(uint32_t value)
+{
+    Lock lock(m_mutex);
+
+    m_maximumEntries = value;
+    TrimToBudget();
+}
+
+
+uint64_t TextLayoutCache::GetMaximumBytes()
+{
+    Lock lock(m_mutex);
+
+    return m_maximumBytes;
+}
+
+
+void TextLayoutCache::SetMaximumBytes(uint64_t value)
+{
+    Lock lock(m_mutex);
+
+    m_maximumBytes = value;
+    TrimToBudget();
+}
+
+
+CanvasTextLayoutCacheStatistics TextLayoutCache::GetStatistics()
+{
+    Lock lock(m_mutex);
+
+    auto statistics = m_statistics;
+    statistics.EntryCount = static_cast<uint32_t>(m_entries.GetCount());
+    statistics.SizeInBytes = m_entries.GetTotalSize();
+
+    return statistics;
+}
+
+
+void TextLayoutCache::Clear()
+{
+    Lock lock(m_mutex);
+
+    m_entries.Clear();
+}
+
+
+ComPtr<IDWriteTextLayout> TextLayoutCache::Find(TextLayoutCacheKey const& key)
+{
+    Lock lock(m_mutex);
+
+    auto layout = m_entries.Find(key);
+
+    if (!layout)
+    {
+        m_statistics.MissCount++;
+        return nullptr;
+    }
+
+    m_statistics.HitCount++;
+    return *layout;
+}
+
+
+void TextLayoutCache::Add(TextLayoutCacheKey&& key, ComPtr<IDWriteTextLayout> const& layout)
+{
+    Lock lock(m_mutex);
+
+    auto sizeInBytes = EstimateSizeInBytes(key);
+
+    m_entries.Add(std::move(key), layout, sizeInBytes);
+
+    TrimToBudget();
+}
+
+
+void TextLayoutCache::TrimToBudget()
+{
+    m_statistics.EvictionCount += m_entries.Trim(m_maximumEntries, m_maximumBytes);
+}
+
+
+ComPtr<IDWriteTextLayout> TextLayoutCache::CreateLayout(TextLayoutCacheKey const& key, IDWriteTextFormat* format)
+{
+    auto customFontManager = CustomFontManager::GetInstance();
+    auto dwriteFactory = customFontManager->GetSharedFactory();
+
+    ComPtr<IDWriteTextLayout> layout;
+    ThrowIfFailed(dwriteFactory->CreateTextLayout(
+        key.Text.c_str(),
+        static_cast<uint32_t>(key.Text.size()),
+        format,
+        key.Width,
+        key.Height,
+        &layout));
+
+    // DirectWrite formats layouts lazily.  Asking for the metrics forces this
+    // to happen now, so that the cached layout is not modified when it is
+    // drawn.
+    DWRITE_TEXT_METRICS metrics;
+    ThrowIfFailed(layout->GetMetrics(&metrics));
+
+    return layout;
+}
+
+
+uint64_t TextLayoutCache::EstimateSizeInBytes(TextLayoutCacheKey const& key)
+{
+    //
+    // DirectWrite doesn't report how much memory a layout uses, so this is a
+    // rough estimate: a fixed overhead per layout plus the glyph, cluster and
+    // line information that is kept for each character.
+    //
+    uint64_t const LayoutOverhead = 1024;
+    uint64_t const BytesPerCharacter = 64;
+
+    uint64_t const EntryOverhead = sizeof(TextLayoutCacheKey) + sizeof(ComPtr<IDWriteTextLayout>);
+
+    return EntryOverhead + LayoutOverhead + key.Text.size() * (BytesPerCharacter + sizeof(wchar_t));
+}
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/LruCache.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    using namespace ::Microsoft::WRL;
+
+    //
+    // Identifies a text layout built by DrawText.  The format is identified by
+    // its version (see ICanvasTextFormatInternal::GetVersion), which is unique
+    // across all text formats and changes whenever the format is modified.
+    //
+    struct TextLayoutCacheKey
+    {
+        std::wstring Text;
+        uint64_t FormatVersion;
+        float Width;
+        float Height;
+        bool NoWrap;
+
+        bool operator==(TextLayoutCacheKey const& other) const
+        {
+            return FormatVersion == other.FormatVersion &&
+                   Width == other.Width &&
+                   Height == other.Height &&
+                   NoWrap == other.NoWrap &&
+                   Text == other.Text;
+        }
+    };
+
+    struct TextLayoutCacheKeyHash
+    {
+        size_t operator()(TextLayoutCacheKey const& key) const;
+    };
+
+
+    //
+    // A device-level least-recently-used cache of the DirectWrite text layouts
+    // that DrawText would otherwise create on every call.  Drawing the same
+    // string with the same format and size, frame after frame, then only
+    // costs a lookup.
+    //
+    // The cache is bounded both by number of entries and by an estimate of
+    // the memory used by each layout.  It is disabled while either budget is
+    // zero, which is the default.
+    //
+    // Layouts are fully formatted before they are added to the cache, so that
+    // drawing them from several threads at once does not modify them.
+    //
+    class TextLayoutCache
+    {
+        std::mutex m_mutex;
+        LruCache<TextLayoutCacheKey, ComPtr<IDWriteTextLayout>, TextLayoutCacheKeyHash> m_entries;
+
+        uint32_t m_maximumEntries;
+        uint64_t m_maximumBytes;
+        CanvasTextLayoutCacheStatistics m_statistics;
+
+    public:
+        static uint32_t const DefaultMaximumBytes = 4 * 1024 * 1024;
+
+        TextLayoutCache();
+
+        bool IsEnabled();
+
+        //
+        // Returns the layout for the specified text, format and size, creating
+        // it with the text format returned by getFormat if it is not already
+        // cached.  Returns null if the cache is disabled.
+        //
+        template<typename FN>
+        ComPtr<IDWriteTextLayout> GetOrCreate(
+            HSTRING text,
+            uint64_t formatVersion,
+            float width,
+            float height,
+            bool noWrap,
+            FN&& getFormat)
+        {
+            if (!IsEnabled())
+                return nullptr;
+
+            uint32_t textLength;
+            auto textBuffer = WindowsGetStringRawBuffer(text, &textLength);
+            ThrowIfNullPointer(textBuffer, E_INVALIDARG);
+
+            TextLayoutCacheKey key{ std::wstring(textBuffer, textLength), formatVersion, width, height, noWrap };
+
+            auto layout = Find(key);
+
+            if (!layout)
+            {
+                // The layout is created without holding the lock, since this
+                // is the expensive part.  If two threads race to create the
+                // same layout the second one to finish replaces the first.
+                ComPtr<IDWriteTextFormat> format = getFormat();
+                layout = CreateLayout(key, format.Get());
+                Add(std::move(key), layout);
+            }
+
+            return layout;
+        }
+
+        uint32_t GetMaximumEntries();
+        void SetMaximumEntries(uint32_t value);
+
+        uint64_t GetMaximumBytes();
+        void SetMaximumBytes(uint64_t value);
+
+        CanvasTextLayoutCacheStatistics GetStatistics();
+
+        void Clear();
+
+    private:
+        ComPtr<IDWriteTextLayout> Find(TextLayoutCacheKey const& key);
+        void Add(TextLayoutCacheKey&& key, ComPtr<IDWriteTextLayout> const& layout);
+        void TrimToBudget();
+
+        static ComPtr<IDWriteTextLayout> CreateLayout(TextLayoutCacheKey const& key, IDWriteTextFormat* format);
+        static uint64_t EstimateSizeInBytes(TextLayoutCacheKey const& key);
+    };
+}}}}}
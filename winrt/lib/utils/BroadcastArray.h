@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Wraps an array parameter of a method that processes many items at once.
+    // The array may either contain one element per item, or a single element
+    // that is shared by every item.  If a default value is provided, the array
+    // may also be empty.
+    //
+    template<typename T>
+    class BroadcastArray
+    {
+        T const* m_elements;
+        uint32_t m_step;
+
+    public:
+        BroadcastArray(wchar_t const* name, uint32_t itemCount, uint32_t count, T const* elements, T const* defaultValue = nullptr)
+        {
+            if (count == 0 && defaultValue)
+            {
+                m_elements = defaultValue;
+                m_step = 0;
+                return;
+            }
+
+            if (count != 1 && count != itemCount)
+            {
+                WinStringBuilder message;
+                message.Format(Strings::WrongBroadcastArrayLength, name, itemCount, count);
+                ThrowHR(E_INVALIDARG, message.Get());
+            }
+
+            CheckInPointer(elements);
+
+            m_elements = elements;
+            m_step = (count == 1) ? 0 : 1;
+        }
+
+        T const& operator[](uint32_t index) const
+        {
+            return m_elements[index * m_step];
+        }
+
+        // True if every item uses the same element.
+        bool IsShared() const
+        {
+            return m_step == 0;
+        }
+    };
+
+
+    // Validates the array that determines how many items there are.
+    inline void CheckArray(uint32_t count, void const* elements)
+    {
+        if (count > 0)
+            CheckInPointer(elements);
+    }
+}}}}
@@ -125,6 +125,36 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         static_assert(offsetof(D2D1_RECT_F, bottom) == offsetof(Numerics::Vector4, W), "Vector4 layout must match D2D1_RECT_F");
     };
 
+    template<> struct ValidateReinterpretAs<::DirectX::XMFLOAT2*, Numerics::Vector2*> : std::true_type
+    {
+        static_assert(offsetof(::DirectX::XMFLOAT2, x) == offsetof(Numerics::Vector2, X), "Vector2 layout must match XMFLOAT2");
+        static_assert(offsetof(::DirectX::XMFLOAT2, y) == offsetof(Numerics::Vector2, Y), "Vector2 layout must match XMFLOAT2");
+    };
+
+    template<> struct ValidateReinterpretAs<::DirectX::XMFLOAT4*, ABI::Windows::Foundation::Rect*> : std::true_type
+    {
+        static_assert(offsetof(::DirectX::XMFLOAT4, x) == offsetof(ABI::Windows::Foundation::Rect, X),      "Rect layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, y) == offsetof(ABI::Windows::Foundation::Rect, Y),      "Rect layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, z) == offsetof(ABI::Windows::Foundation::Rect, Width),  "Rect layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, w) == offsetof(ABI::Windows::Foundation::Rect, Height), "Rect layout must match XMFLOAT4");
+    };
+
+    template<> struct ValidateReinterpretAs<::DirectX::XMFLOAT4*, D2D1_RECT_F*> : std::true_type
+    {
+        static_assert(offsetof(::DirectX::XMFLOAT4, x) == offsetof(D2D1_RECT_F, left),   "D2D1_RECT_F layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, y) == offsetof(D2D1_RECT_F, top),    "D2D1_RECT_F layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, z) == offsetof(D2D1_RECT_F, right),  "D2D1_RECT_F layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, w) == offsetof(D2D1_RECT_F, bottom), "D2D1_RECT_F layout must match XMFLOAT4");
+    };
+
+    template<> struct ValidateReinterpretAs<::DirectX::XMFLOAT4*, Numerics::Vector4*> : std::true_type
+    {
+        static_assert(offsetof(::DirectX::XMFLOAT4, x) == offsetof(Numerics::Vector4, X), "Vector4 layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, y) == offsetof(Numerics::Vector4, Y), "Vector4 layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, z) == offsetof(Numerics::Vector4, Z), "Vector4 layout must match XMFLOAT4");
+        static_assert(offsetof(::DirectX::XMFLOAT4, w) == offsetof(Numerics::Vector4, W), "Vector4 layout must match XMFLOAT4");
+    };
+
     template<> struct ValidateReinterpretAs<DXGI_SURFACE_DESC*, Direct3DSurfaceDescription*> : std::true_type
     {
         static_assert(offsetof(DXGI_SURFACE_DESC, Width)      == offsetof(Direct3DSurfaceDescription,     Width),                  "Direct3DSurfaceDescription layout must match DXGI_SURFACE_DESC layout");
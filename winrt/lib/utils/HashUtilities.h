@@ -9,5 +9,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     ComArray<BYTE> GetSha1Hash(BYTE const* data, size_t dataSize);
 
     IID GetVersion5Uuid(IID const& namespaceId, BYTE const* name, size_t nameSize);
+
+    // Mixes the hash of value into hash, for building hashes of compound keys.
+    template<typename T>
+    inline void HashCombine(size_t& hash, T const& value)
+    {
+        hash ^= std::hash<T>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
     
 }}}}
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Map that remembers the order in which its entries were used, so that
+    // the least recently used ones can be discarded to keep it within budget.
+    // Each entry has a size, in whatever units the owner chooses to budget.
+    //
+    // This is not thread safe; owners are expected to provide their own lock.
+    //
+    template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+    class LruCache
+    {
+        struct Entry
+        {
+            TKey Key;
+            TValue Value;
+            uint64_t Size;
+        };
+
+        typedef std::list<Entry> EntryList;
+
+        EntryList m_entries;    // Most recently used first
+        std::unordered_map<TKey, typename EntryList::iterator, THash> m_index;
+        uint64_t m_totalSize;
+
+    public:
+        LruCache()
+            : m_totalSize(0)
+        {
+        }
+
+        // Returns the value for key, or null if there isn't one.  A value that
+        // is found becomes the most recently used.
+        TValue const* Find(TKey const& key)
+        {
+            auto it = m_index.find(key);
+
+            if (it == m_index.end())
+                return nullptr;
+
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+            return &it->second->Value;
+        }
+
+        // Adds a value as the most recently used, replacing any existing
+        // value for the same key.
+        void Add(TKey key, TValue value, uint64_t size)
+        {
+            auto existing = m_index.find(key);
+
+            if (existing != m_index.end())
+                Remove(existing->second);
+
+            m_entries.push_front(Entry{ std::move(key), std::move(value), size });
+            m_index.emplace(m_entries.front().Key, m_entries.begin());
+
+            m_totalSize += size;
+        }
+
+        // Discards least recently used entries until there are no more than
+        // maximumCount entries and their total size is no more than
+        // maximumSize.  Returns the number of entries that were discarded.
+        uint32_t Trim(size_t maximumCount, uint64_t maximumSize)
+        {
+            uint32_t discardedCount = 0;
+
+            while (!m_entries.empty() && (m_entries.size() > maximumCount || m_totalSize > maximumSize))
+            {
+                Remove(std::prev(m_entries.end()));
+                discardedCount++;
+            }
+
+            return discardedCount;
+        }
+
+        void Clear()
+        {
+            m_index.clear();
+            m_entries.clear();
+            m_totalSize = 0;
+        }
+
+        size_t GetCount() const
+        {
+            return m_entries.size();
+        }
+
+        uint64_t GetTotalSize() const
+        {
+            return m_totalSize;
+        }
+
+    private:
+        void Remove(typename EntryList::iterator entry)
+        {
+            m_totalSize -= entry->Size;
+
+            m_index.erase(entry->Key);
+            m_entries.erase(entry);
+        }
+    };
+}}}}
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Splits the range [0, count) into contiguous chunks of at least
+    // minChunkSize elements and calls fn(begin, end) for each chunk, spreading
+    // them across the available hardware threads.  The calling thread
+    // processes the first chunk itself, and does not return until all chunks
+    // have completed.
+    //
+    // Small ranges (or machines with a single hardware thread) are processed
+    // inline with no threading overhead.  If any chunk throws, the exception
+    // is rethrown on the calling thread once all the other chunks are done.
+    //
+    template<typename FN>
+    void ParallelFor(uint32_t count, uint32_t minChunkSize, FN&& fn)
+    {
+        if (count == 0)
+            return;
+
+        minChunkSize = std::max(minChunkSize, 1u);
+
+        // Chunk counts and bounds are computed in 64 bits so that counts near
+        // UINT_MAX cannot wrap around.
+        uint64_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        uint64_t minChunkCount = (static_cast<uint64_t>(count) + minChunkSize - 1) / minChunkSize;
+        auto chunkCount = static_cast<uint32_t>(std::min(threadCount, minChunkCount));
+
+        if (chunkCount <= 1)
+        {
+            fn(0u, count);
+            return;
+        }
+
+        uint64_t chunkSize = (static_cast<uint64_t>(count) + chunkCount - 1) / chunkCount;
+
+        auto getChunkBound = [=](uint32_t chunkIndex)
+        {
+            return static_cast<uint32_t>(std::min<uint64_t>(count, chunkIndex * chunkSize));
+        };
+
+        // Futures returned by std::async block in their destructor, so an
+        // exception from the inline chunk still waits for the others to finish.
+        std::vector<std::future<void>> futures;
+        futures.reserve(chunkCount - 1);
+
+        for (uint32_t chunkIndex = 1; chunkIndex < chunkCount; ++chunkIndex)
+        {
+            uint32_t begin = getChunkBound(chunkIndex);
+            uint32_t end = getChunkBound(chunkIndex + 1);
+
+            if (begin >= end)
+                break;
+
+            futures.push_back(std::async(std::launch::async, [&fn, begin, end] { fn(begin, end); }));
+        }
+
+        fn(0u, getChunkBound(1));
+
+        for (auto& future : futures)
+        {
+            future.get();
+        }
+    }
+}}}}
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    // Measures elapsed time for the diagnostic statistics reported by various
+    // objects.  Results are in 100ns units, to match Windows.Foundation.TimeSpan.
+    class PerformanceTimer
+    {
+        int64_t m_start;
+
+    public:
+        PerformanceTimer()
+            : m_start(GetCounter())
+        {
+        }
+
+        // Allows callers to avoid reading the counter when they do not need a
+        // measurement.  A timer that is not started must be restarted before use.
+        explicit PerformanceTimer(bool start)
+            : m_start(start ? GetCounter() : 0)
+        {
+        }
+
+        void Restart()
+        {
+            m_start = GetCounter();
+        }
+
+        int64_t GetElapsedTicks() const
+        {
+            static int64_t const frequency = GetFrequency();
+
+            auto elapsed = GetCounter() - m_start;
+
+            // Split the conversion to avoid overflowing for large counter values.
+            auto seconds = elapsed / frequency;
+            auto remainder = elapsed % frequency;
+
+            return seconds * TicksPerSecond + (remainder * TicksPerSecond) / frequency;
+        }
+
+        TimeSpan GetElapsedTime() const
+        {
+            return TimeSpan{ GetElapsedTicks() };
+        }
+
+    private:
+        static int64_t const TicksPerSecond = 10000000;
+
+        static int64_t GetCounter()
+        {
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+            return counter.QuadPart;
+        }
+
+        static int64_t GetFrequency()
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            return frequency.QuadPart;
+        }
+    };
+}}}}
@@ -39,6 +39,7 @@ STRING(CustomEffectWrongPropertyTypeArray, L"Wrong type. Shader property '%s' is
 STRING(DeviceExpectedToBeLost, L"This API was unexpectedly called when the Direct3D device is not lost.")
 STRING(DidNotPopLayer, L"After calling CanvasDrawingSession.CreateLayer, you must close the resulting CanvasActiveLayer before ending the CanvasDrawingSession.")
 STRING(DrawImageMinBlendNotSupported, L"This DrawImage overload is not valid when CanvasDrawingSession.Blend is set to CanvasBlend.Min.")
+STRING(DrawLinesOddPointCount, L"DrawLines requires an even number of points, as each pair of points describes one line.")
 STRING(EffectNoSources, L"Effect Sources collection is empty.")
 STRING(EffectNullSource, L"Effect source #%d is null.")
 STRING(EffectWrongDevice, L"Effect source #%d is associated with a different device.")
@@ -47,16 +48,24 @@ STRING(EndFigureWithoutBeginFigure, L"A call to CanvasPathBuilder.EndFigure occu
 STRING(ExpectedPositiveNonzero, L"A positive, non-zero number was expected for this method.")
 STRING(ExternalInlineObject, L"Attempted to retrieve an inline object which was not implemented as an ICanvasTextInlineObject.")
 STRING_A(GameLoopThreadName, "Win2D game loop thread")
+STRING(GeometryIndexInvalidDistance, L"Distances and tolerances passed to CanvasGeometryIndex must be zero or greater.")
 STRING(GetResourceNoDevice, L"To unwrap this resource type, a device parameter must be passed to GetWrappedResource.")
 STRING(ImageBrushRequiresSourceRectangle, L"When using image types other than CanvasBitmap, CanvasImageBrush.SourceRectangle must not be null.")
+STRING(IndexedMeshBufferTooSmall, L"The buffer is too small to hold the contents of the CanvasIndexedMesh.")
+STRING(IndexedMeshHasNoEdgeFlags, L"This CanvasIndexedMesh was not created with CanvasIndexedMeshOptions.IncludeEdgeFlags.")
 STRING(InvalidAlphaModeForImageSource, L"An invalid alpha mode was specified. Use either CanvasAlphaMode.Ignore or CanvasAlphaMode.Premultiplied.")
 STRING(InvalidFontFamilyUri, L"The font URI specified is not a valid application URI that can be opened by StorageFile.GetFileFromApplicationUriAsync.")
 STRING(InvalidFontFamilyUriScheme, L"The URI specified in the CanvasTextFormat's FontFamily has an invalid scheme; the scheme may be omitted, or must be one of ms-appx:// or ms-appdata://.")
+STRING(InvalidPathData, L"The data does not contain valid CanvasGeometry path bytes.")
+STRING(InvalidSvgPathData, L"The SVG path data is not valid at character %d.")
 STRING(InvalidTypographyFeatureName, L"Attempted to add a typography feature without setting a valid feature name.")
 STRING(MultipleAsyncCreateResourcesNotSupported, L"Only one asynchronous CreateResources action can be tracked at a time.")
 STRING(NotSupportedOnThisVersionOfWindows, L"This API is not supported on this version of Windows.")
+STRING(ParticleEmitterInvalidLifetime, L"CanvasParticleEmitterDescription.Lifetime must be greater than zero.")
+STRING(ParticleSystemInvalidCapacity, L"The capacity of a CanvasParticleSystem must be greater than zero and no more than 4294967292.")
 STRING(PathBuilderAddGeometryMidFigure, L"CanvasPathBuilder.AddGeometry may not be called in the middle of a figure.")
 STRING(PathBuilderClosedMidFigure, L"There was an attempt to use a CanvasPathBuilder, which was missing a call to CanvasPathBuilder.EndFigure.")
+STRING(PathDataCannotQuantize, L"The path contains a point that is not finite, or is too large to be stored with this quantization step.")
 STRING(PixelColorsFormatRestriction, L"This method only supports resources with pixel format DirectXPixelFormat.B8G8R8A8UIntNormalized.")
 STRING(PoppedWrongLayer, L"Attempting to close a CanvasActiveLayer that is not top of the stack. The most recently created layer must be closed first.")
 STRING(RemoteFontUnavailable, L"The requested font is not locally available.")
@@ -68,6 +77,7 @@ STRING(ResourceManagerWrongDpi, L"Existing resource wrapper has a different DPI.
 STRING(SetFilledRegionDeterminationAfterBeginFigure, L"This operation is not allowed after the first call to CanvasPathBuilder.BeginFigure.")
 STRING(SetPageCountCalledBeforePreviewing, L"CanvasPrintDocument.SetPageCount or CanvasPrintDocument.SetIntermediatePageCount cannot be called until the Paginate event has been raised.")
 STRING(SharedDeviceWrongDebugLevel, L"CanvasDevice.DebugLevel has changed since this shared device was created. The debug level must be set before the first call to GetSharedDevice.")
+STRING(SpriteBatchInvalidFlip, L"Invalid CanvasSpriteFlip value specified for sprite %d.")
 STRING(SpriteBatchInvalidInterpolation, L"Invalid interpolation mode specified. Sprite batches only support CanvasImageInterpolation.NearestNeighbor or CanvasImageInterpolation.Linear.")
 STRING(SpriteBatchNotAvailable, L"Sprite batches are not supported on this device. Use CanvasSpriteBatch.IsSupported to determine if sprite batches are supported.")
 STRING(SurfaceTooBig, L"Cannot create %s sized %d x %d; MaximumBitmapSizeInPixels for this device is %d.")
@@ -75,4 +85,5 @@ STRING(TextRendererNotValid, L"The application called a method on a text rendere
 STRING(TwoBeginFigures, L"A call to CanvasPathBuilder.BeginFigure occurred, when the figure was already begun.")
 STRING(UnrecognizedImageFileExtension, L"When saving a CanvasBitmap without specifying a CanvasBitmapFileFormat, the file name must include a recognized file extension such as '.jpeg' or '.png'.")
 STRING(WrongArrayLength, L"The array was expected to be of size %d; actual array was of size %d.")
+STRING(WrongBroadcastArrayLength, L"The array %s was expected to contain either 1 or %d elements; actual array contained %d elements.")
 STRING(WrongNamedArrayLength, L"The array %s was expected to be of size %d; actual array was of size %d.")
@@ -23,7 +23,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     public:
         TemporaryTransform(T* target, Vector2 const& offset, bool postMultiply = false)
-            : m_target(target)
+            : m_target(IsZero(offset) ? nullptr : target)
         {
             if (m_target)
             {
@@ -32,7 +32,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         }
 
         TemporaryTransform(T* target, Vector2 const& offset, Vector2 const& scale, bool postMultiply = false)
-            : m_target(target)
+            : m_target(IsZero(offset) && scale.X == 1 && scale.Y == 1 ? nullptr : target)
         {
             if (m_target)
             {
@@ -51,6 +51,13 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         }
 
     private:
+        // Drawing at the origin is common enough that it is worth skipping the
+        // save, set and restore of the transform when there's nothing to apply.
+        static bool IsZero(Vector2 const& offset)
+        {
+            return offset.X == 0 && offset.Y == 0;
+        }
+
         void Apply(D2D1::Matrix3x2F const& transform, bool postMultiply)
         {
             assert(m_target);
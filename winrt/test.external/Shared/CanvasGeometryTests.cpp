@@ -279,6 +279,24 @@ public:
             });
     }
 
+    TEST_METHOD(CanvasGeometry_CombineMany_MatchesSequentialCombine)
+    {
+        auto rectangles = MakeOverlappingRectangles(m_device, 1000);
+
+        auto sequential = rectangles[0];
+
+        for (unsigned i = 1; i < rectangles->Length; ++i)
+        {
+            sequential = sequential->CombineWith(rectangles[i], float3x2::identity(), CanvasGeometryCombine::Union);
+        }
+
+        auto combined = CanvasGeometry::CombineMany(m_device, rectangles, CanvasGeometryCombine::Union);
+
+        // 100 columns and 10 rows of 15x15 rectangles, 10 apart.
+        Assert::AreEqual(1005.0f * 105.0f, sequential->ComputeArea(), 1.0f);
+        Assert::AreEqual(1005.0f * 105.0f, combined->ComputeArea(), 1.0f);
+    }
+
 private:
     ComPtr<ID2D1Factory> GetD2DFactory()
     {
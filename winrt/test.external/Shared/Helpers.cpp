@@ -111,3 +111,18 @@ int NextValueRepresentableAsFloat(int value)
 
     return nextValue;
 }
+
+Platform::Array<CanvasGeometry^>^ MakeOverlappingRectangles(CanvasDevice^ device, unsigned count)
+{
+    auto rectangles = ref new Platform::Array<CanvasGeometry^>(count);
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        float x = static_cast<float>(i % 100) * 10;
+        float y = static_cast<float>(i / 100) * 10;
+
+        rectangles[i] = CanvasGeometry::CreateRectangle(device, Rect{ x, y, 15, 15 });
+    }
+
+    return rectangles;
+}
@@ -592,6 +592,9 @@ bool GpuMatchesDescription(CanvasDevice^ canvasDevice, wchar_t const* descriptio
 
 int NextValueRepresentableAsFloat(int value);
 
+// Rows of 100 15x15 rectangles, 10 apart, so each overlaps its neighbors.
+Platform::Array<CanvasGeometry^>^ MakeOverlappingRectangles(CanvasDevice^ device, unsigned count);
+
 struct WicBitmapTestFixture
 {
     ComPtr<ID2D1DeviceContext1> RenderTarget;
@@ -0,0 +1,360 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+using namespace Windows::UI;
+
+//
+// Timings of large workloads, run against a real device.  These take far
+// longer than the rest of the suite and their results are for a person to
+// read, so they are only built when WIN2D_PERFORMANCE_TESTS is defined.  Pass
+// /p:Win2DPerformanceTests=true to msbuild to define it.  Win2D.proj compiles
+// them once, but does not run them.
+//
+// Each measurement runs a few times and logs the fastest run.
+//
+
+#ifdef WIN2D_PERFORMANCE_TESTS
+
+TEST_CLASS(PerformanceTests)
+{
+    CanvasDevice^ m_device;
+
+    static const int RunCount = 5;
+
+    template<typename FN>
+    static double MeasureMilliseconds(FN&& fn)
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+
+        double fastest = DBL_MAX;
+
+        for (int i = 0; i < RunCount; i++)
+        {
+            LARGE_INTEGER start, end;
+
+            QueryPerformanceCounter(&start);
+            fn();
+            QueryPerformanceCounter(&end);
+
+            fastest = std::min(fastest, (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart);
+        }
+
+        return fastest;
+    }
+
+    static void Log(wchar_t const* format, ...)
+    {
+        wchar_t message[256];
+
+        va_list args;
+        va_start(args, format);
+        vswprintf_s(message, format, args);
+        va_end(args);
+
+        Logger::WriteMessage(message);
+    }
+
+    // Figures of zig-zagging line segments, as found in plotted data.
+    CanvasGeometry^ MakeLinePath(unsigned segmentCount, unsigned segmentsPerFigure)
+    {
+        auto pathBuilder = ref new CanvasPathBuilder(m_device);
+
+        for (unsigned figure = 0; figure < segmentCount / segmentsPerFigure; figure++)
+        {
+            pathBuilder->BeginFigure(0, static_cast<float>(figure));
+
+            for (unsigned i = 0; i < segmentsPerFigure; i++)
+            {
+                pathBuilder->AddLine(i * 0.5f, figure + (i % 7) * 0.125f);
+            }
+
+            pathBuilder->EndFigure(CanvasFigureLoop::Open);
+        }
+
+        return CanvasGeometry::CreatePath(pathBuilder);
+    }
+
+public:
+    PerformanceTests()
+        : m_device(ref new CanvasDevice())
+    {
+    }
+
+    TEST_METHOD(Performance_CanvasPathBuilder_MillionSegments)
+    {
+        const unsigned segmentCount = 1000000;
+
+        // Short figures are dominated by per-command costs, long ones by the
+        // cost of recording and replaying each point.
+        for (auto segmentsPerFigure : { 10u, 1000u, segmentCount })
+        {
+            auto buildTime = MeasureMilliseconds([&] { MakeLinePath(segmentCount, segmentsPerFigure); });
+
+            Log(L"CanvasPathBuilder: %u segments in figures of %u, added one at a time and created in %.1f ms (%.1f million segments/s)",
+                segmentCount, segmentsPerFigure, buildTime, segmentCount / buildTime / 1000);
+        }
+    }
+
+    TEST_METHOD(Performance_PathBytes_MillionSegments)
+    {
+        auto geometry = MakeLinePath(1000000, 1000);
+
+        for (auto quantizationStep : { 0.0f, 1.0f / 16 })
+        {
+            Platform::Array<uint8_t>^ bytes;
+
+            auto saveTime = MeasureMilliseconds([&] { bytes = geometry->GetPathBytes(quantizationStep); });
+            auto loadTime = MeasureMilliseconds([&] { CanvasGeometry::CreatePathFromBytes(m_device, bytes); });
+
+            Log(L"PathBytes, step %g: %u bytes, saved in %.1f ms, loaded in %.1f ms", quantizationStep, bytes->Length, saveTime, loadTime);
+        }
+    }
+
+    TEST_METHOD(Performance_SvgPathData_HundredThousandFigures)
+    {
+        // Mixes every kind of command, as found in map and icon data.
+        std::wstring pathData;
+
+        for (unsigned i = 0; i < 100000; i++)
+        {
+            wchar_t segment[128];
+            swprintf_s(segment, L"M%u.5,%u l1.25-2.5 .75.5h3v-4c1 2 3 4 5 6s1-1 2 2q3 3 1 1t2 2a4 5 30 1 0 6 6z", i % 1000, i / 1000);
+            pathData += segment;
+        }
+
+        auto pathString = ref new Platform::String(pathData.c_str(), static_cast<unsigned>(pathData.size()));
+
+        auto parseTime = MeasureMilliseconds([&] { CanvasGeometry::CreatePathFromSvgPathData(m_device, pathString); });
+
+        Log(L"SvgPathData: %u characters, parsed in %.1f ms", static_cast<unsigned>(pathData.size()), parseTime);
+    }
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+    TEST_METHOD(Performance_CanvasParticleSystem_MillionParticles)
+    {
+        const unsigned particleCount = 1000000;
+
+        CanvasParticleEmitterDescription emitter{};
+        emitter.Position = float2(512, 512);
+        emitter.VelocityVariance = float2(100, 100);
+        emitter.Lifetime = 1000;
+        emitter.StartSize = 1;
+        emitter.EndSize = 2;
+        emitter.StartColor = float4(1, 1, 1, 1);
+        emitter.EndColor = float4(1, 1, 1, 0);
+
+        auto particleSystem = ref new CanvasParticleSystem(particleCount);
+        particleSystem->Gravity = float2(0, 10);
+        particleSystem->Emit(emitter, particleCount);
+
+        auto particleBitmap = ref new CanvasRenderTarget(m_device, 4, 4, DEFAULT_DPI);
+        auto renderTarget = ref new CanvasRenderTarget(m_device, 1024, 1024, DEFAULT_DPI);
+
+        auto updateTime = MeasureMilliseconds([&] { particleSystem->Update(1.0f / 60); });
+
+        auto drawTime = MeasureMilliseconds([&]
+        {
+            auto ds = renderTarget->CreateDrawingSession();
+            auto spriteBatch = ds->CreateSpriteBatch();
+            particleSystem->Draw(spriteBatch, particleBitmap);
+            delete spriteBatch;
+            delete ds;
+        });
+
+        Log(L"CanvasParticleSystem: %u particles updated in %.1f ms, drawn in %.1f ms", particleCount, updateTime, drawTime);
+    }
+
+    TEST_METHOD(Performance_CanvasSpriteBatch_DrawMany_HundredThousandSprites)
+    {
+        const unsigned spriteCount = 100000;
+
+        auto offsets = ref new Platform::Array<float2>(spriteCount);
+
+        for (unsigned i = 0; i < spriteCount; i++)
+        {
+            offsets[i] = float2(static_cast<float>(i % 1000), static_cast<float>(i / 1000));
+        }
+
+        auto noTints = ref new Platform::Array<float4>(0);
+        auto noFlips = ref new Platform::Array<CanvasSpriteFlip>(0);
+
+        auto spriteBitmap = ref new CanvasRenderTarget(m_device, 4, 4, DEFAULT_DPI);
+        auto renderTarget = ref new CanvasRenderTarget(m_device, 1024, 1024, DEFAULT_DPI);
+
+        auto timeSprites = [&](std::function<void(CanvasSpriteBatch^)> const& draw)
+        {
+            return MeasureMilliseconds([&]
+            {
+                auto ds = renderTarget->CreateDrawingSession();
+                auto spriteBatch = ds->CreateSpriteBatch();
+                draw(spriteBatch);
+                delete spriteBatch;
+                delete ds;
+            });
+        };
+
+        auto drawTime = timeSprites([&](CanvasSpriteBatch^ spriteBatch)
+        {
+            for (unsigned i = 0; i < spriteCount; i++)
+            {
+                spriteBatch->Draw(spriteBitmap, offsets[i]);
+            }
+        });
+
+        auto drawFromSpriteSheetTime = timeSprites([&](CanvasSpriteBatch^ spriteBatch)
+        {
+            for (unsigned i = 0; i < spriteCount; i++)
+            {
+                spriteBatch->DrawFromSpriteSheet(spriteBitmap, offsets[i], Rect(0, 0, 2, 2));
+            }
+        });
+
+        auto drawManyTime = timeSprites([&](CanvasSpriteBatch^ spriteBatch)
+        {
+            spriteBatch->DrawMany(spriteBitmap, offsets, noTints, noFlips);
+        });
+
+        Log(L"CanvasSpriteBatch: %u sprites, Draw %.1f ms, DrawFromSpriteSheet %.1f ms, DrawMany %.1f ms", spriteCount, drawTime, drawFromSpriteSheetTime, drawManyTime);
+    }
+
+#endif
+
+    TEST_METHOD(Performance_CombineMany_Rectangles)
+    {
+        auto rectangles = MakeOverlappingRectangles(m_device, 1000);
+
+        auto sequentialTime = MeasureMilliseconds([&]
+        {
+            auto sequential = rectangles[0];
+
+            for (unsigned i = 1; i < rectangles->Length; ++i)
+            {
+                sequential = sequential->CombineWith(rectangles[i], float3x2::identity(), CanvasGeometryCombine::Union);
+            }
+        });
+
+        auto combineManyTime = MeasureMilliseconds([&] { CanvasGeometry::CombineMany(m_device, rectangles, CanvasGeometryCombine::Union); });
+
+        Log(L"1000 rectangles: CombineWith %.1f ms, CombineMany %.1f ms", sequentialTime, combineManyTime);
+
+        auto moreRectangles = MakeOverlappingRectangles(m_device, 10000);
+
+        auto tenThousandTime = MeasureMilliseconds([&] { CanvasGeometry::CombineMany(m_device, moreRectangles, CanvasGeometryCombine::Union); });
+
+        Log(L"10000 rectangles: CombineMany %.1f ms", tenThousandTime);
+    }
+
+    TEST_METHOD(Performance_Decimate_DrawTime)
+    {
+        // A circle traced with small jitter, as found in digitized outlines.
+        const unsigned pointCount = 200000;
+        const float tolerance = 0.5f;
+
+        auto points = ref new Platform::Array<float2>(pointCount);
+
+        for (unsigned i = 0; i < pointCount; i++)
+        {
+            float angle = i * 6.2831853f / pointCount;
+            float radius = 400 + ((i * 7919) % 13) * 0.025f;
+
+            points[i] = float2(512 + radius * cosf(angle), 512 + radius * sinf(angle));
+        }
+
+        auto original = CanvasGeometry::CreatePolygon(m_device, points);
+        auto decimated = original->Decimate(tolerance);
+
+        auto renderTarget = ref new CanvasRenderTarget(m_device, 1024, 1024, DEFAULT_DPI);
+
+        // Closing the drawing session submits the work, so each timing
+        // includes tessellating the geometry.
+        auto timeFill = [&](CanvasGeometry^ geometry)
+        {
+            return MeasureMilliseconds([&]
+            {
+                auto ds = renderTarget->CreateDrawingSession();
+                ds->FillGeometry(geometry, Colors::Black);
+                ds->DrawGeometry(geometry, Colors::White, 2);
+                delete ds;
+            });
+        };
+
+        auto originalTime = timeFill(original);
+        auto decimatedTime = timeFill(decimated);
+
+        auto decimatedPointCount = CanvasGeometry::DecimatePoints(points, tolerance, true)->Length;
+
+        Log(L"Decimate, tolerance %g: %u points drawn in %.1f ms, %u points drawn in %.1f ms", tolerance, pointCount, originalTime, decimatedPointCount, decimatedTime);
+    }
+
+    TEST_METHOD(Performance_TessellateToIndexedMesh_DetailedCircles)
+    {
+        auto pathBuilder = ref new CanvasPathBuilder(m_device);
+
+        for (unsigned i = 0; i < 100; i++)
+        {
+            pathBuilder->AddGeometry(CanvasGeometry::CreateCircle(m_device, float2(static_cast<float>(i * 25), 0), 500));
+        }
+
+        auto geometry = CanvasGeometry::CreatePath(pathBuilder);
+
+        Platform::Array<CanvasTriangleVertices>^ triangles;
+        CanvasIndexedMesh^ mesh;
+
+        auto tolerance = CanvasGeometry::ComputeFlatteningTolerance(DEFAULT_DPI, 1);
+        auto engine = CanvasTessellationEngine::Direct2D;
+
+        auto tessellateTime = MeasureMilliseconds([&] { triangles = geometry->Tessellate(float3x2::identity(), tolerance, engine); });
+        auto indexedTime = MeasureMilliseconds([&] { mesh = geometry->TessellateToIndexedMesh(float3x2::identity(), tolerance, engine, CanvasIndexedMeshOptions::None); });
+
+        auto indexSize = (mesh->IndexFormat == CanvasIndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        Log(L"Tessellate: %u triangles, %u bytes, %.1f ms.  TessellateToIndexedMesh: %u vertices, %u bytes, %.1f ms",
+            triangles->Length, static_cast<unsigned>(triangles->Length * sizeof(CanvasTriangleVertices)), tessellateTime,
+            mesh->VertexCount, static_cast<unsigned>(mesh->VertexCount * sizeof(float2) + mesh->IndexCount * indexSize), indexedTime);
+    }
+
+    TEST_METHOD(Performance_DrawLines_HalfMillionLines)
+    {
+        const unsigned lineCount = 500000;
+
+        auto points = ref new Platform::Array<float2>(lineCount * 2);
+
+        for (unsigned i = 0; i < points->Length; i++)
+        {
+            points[i] = float2(static_cast<float>(i % 1024), static_cast<float>((i * 7) % 1024));
+        }
+
+        auto colors = ref new Platform::Array<Color>(1);
+        colors[0] = Colors::Black;
+
+        auto renderTarget = ref new CanvasRenderTarget(m_device, 1024, 1024, DEFAULT_DPI);
+
+        auto oneAtATimeTime = MeasureMilliseconds([&]
+        {
+            auto ds = renderTarget->CreateDrawingSession();
+
+            for (unsigned i = 0; i < points->Length; i += 2)
+            {
+                ds->DrawLine(points[i], points[i + 1], Colors::Black);
+            }
+
+            delete ds;
+        });
+
+        auto batchedTime = MeasureMilliseconds([&]
+        {
+            auto ds = renderTarget->CreateDrawingSession();
+            ds->DrawLines(points, colors, 1);
+            delete ds;
+        });
+
+        Log(L"%u lines: DrawLine %.1f ms, DrawLines %.1f ms", lineCount, oneAtATimeTime, batchedTime);
+    }
+};
+
+#endif
@@ -135,6 +135,27 @@ TEST_CLASS(CanvasCachedGeometryTests)
         f.VerifyStrokeStyle();
     }
 
+    TEST_METHOD_EX(CanvasCachedGeometry_Close_ReleasesTheSourceGeometry)
+    {
+        GeometryObjectAccess_Fixture f;
+
+        f.Device->CreateStrokedGeometryRealizationMethod.AllowAnyCall(
+            [](ID2D1Geometry*, FLOAT, ID2D1StrokeStyle*, FLOAT)
+            {
+                return Make<MockD2DGeometryRealization>();
+            });
+
+        auto cachedGeometry = CanvasCachedGeometry::CreateNew(f.Device.Get(), f.CanvasRectangleGeometry.Get(), 99.0f, f.StrokeStyle.Get(), 5.0f);
+
+        ThrowIfFailed(cachedGeometry->Close());
+
+        // With the source geometry gone, there is nothing to compute bounds from.
+        f.D2DRectangleGeometry->GetWidenedBoundsMethod.SetExpectedCalls(0);
+
+        D2D1_RECT_F bounds;
+        Assert::IsFalse(cachedGeometry->TryGetBounds(&bounds));
+    }
+
     TEST_METHOD_EX(CanvasCachedGeometry_CreateStroke_NullArgs)
     {
         GeometryObjectAccess_Fixture f;
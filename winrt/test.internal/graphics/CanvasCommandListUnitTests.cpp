@@ -146,7 +146,15 @@ TEST_CLASS(CanvasCommandListTests)
                 Assert::AreEqual(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE, mode);
             });
 
-        f.Device->CreateDeviceContextForDrawingSessionMethod.SetExpectedCalls(1, [=] { return dc; });
+        f.Device->GetResourceCreationDeviceContextMethod.SetExpectedCalls(1, [=] { return DeviceContextLease(ComPtr<ID2D1DeviceContext1>(dc)); });
+
+        D2D1_RENDERING_CONTROLS originalRenderingControls{ D2D1_BUFFER_PRECISION_8BPC_UNORM, D2D1_SIZE_U{ 1024, 512 } };
+
+        dc->GetRenderingControlsMethod.SetExpectedCalls(1,
+            [=](D2D1_RENDERING_CONTROLS* renderingControls)
+            {
+                *renderingControls = originalRenderingControls;
+            });
 
         dc->SetTargetMethod.SetExpectedCalls(1, 
             [=](ID2D1Image* target)
@@ -166,9 +174,98 @@ TEST_CLASS(CanvasCommandListTests)
         auto wrappedDc = GetWrappedResource<ID2D1DeviceContext1>(ds);
         Assert::IsTrue(IsSameInstance(dc.Get(), wrappedDc.Get()));
 
+        // The leased context is put back into its default state when the
+        // drawing session is closed.
+        dc->SetTargetMethod.SetExpectedCalls(1, [](ID2D1Image* target) { Assert::IsNull(target); });
+        dc->SetDpiMethod.SetExpectedCalls(1, [](float dpiX, float dpiY) { Assert::AreEqual(DEFAULT_DPI, dpiX); Assert::AreEqual(DEFAULT_DPI, dpiY); });
+        dc->SetUnitModeMethod.SetExpectedCalls(1, [](D2D1_UNIT_MODE mode) { Assert::AreEqual(D2D1_UNIT_MODE_DIPS, mode); });
+        dc->SetTransformMethod.SetExpectedCalls(1, [](D2D1_MATRIX_3X2_F const* transform) { Assert::AreEqual<D2D1_MATRIX_3X2_F>(D2D1::Matrix3x2F::Identity(), *transform); });
+        dc->SetAntialiasModeMethod.SetExpectedCalls(1, [](D2D1_ANTIALIAS_MODE mode) { Assert::AreEqual(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE, mode); });
+        dc->SetPrimitiveBlendMethod.SetExpectedCalls(1, [](D2D1_PRIMITIVE_BLEND blend) { Assert::AreEqual(D2D1_PRIMITIVE_BLEND_SOURCE_OVER, blend); });
+        dc->SetTextAntialiasModeMethod.SetExpectedCalls(1, [](D2D1_TEXT_ANTIALIAS_MODE mode) { Assert::AreEqual(D2D1_TEXT_ANTIALIAS_MODE_DEFAULT, mode); });
+        dc->SetTextRenderingParamsMethod.SetExpectedCalls(1, [](IDWriteRenderingParams* params) { Assert::IsNull(params); });
+        dc->SetRenderingControlsMethod.SetExpectedCalls(1,
+            [=](D2D1_RENDERING_CONTROLS const* renderingControls)
+            {
+                Assert::AreEqual(originalRenderingControls.bufferPrecision, renderingControls->bufferPrecision);
+                Assert::AreEqual(originalRenderingControls.tileSize.width, renderingControls->tileSize.width);
+                Assert::AreEqual(originalRenderingControls.tileSize.height, renderingControls->tileSize.height);
+            });
+
         ThrowIfFailed(As<IClosable>(ds)->Close());
     }
 
+    TEST_METHOD_EX(CanvasCommandList_CreateCombined_DrawsEachCommandListInOrder)
+    {
+        Fixture f;
+
+        ComPtr<ICanvasCommandList> commandLists[3];
+        std::vector<ID2D1Image*> expectedImages;
+
+        for (auto& commandList : commandLists)
+        {
+            ThrowIfFailed(f.Factory->Create(f.Device.Get(), &commandList));
+
+            auto d2dCommandList = GetWrappedResource<ID2D1CommandList>(commandList);
+            static_cast<MockD2DCommandList*>(d2dCommandList.Get())->CloseMethod.AllowAnyCall();
+            expectedImages.push_back(d2dCommandList.Get());
+        }
+
+        auto dc = Make<StubD2DDeviceContextWithGetFactory>();
+        dc->GetDeviceMethod.AllowAnyCallAlwaysCopyValueToParam(f.Device->GetD2DDevice());
+        dc->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_SOURCE_OVER; });
+        dc->GetDpiMethod.AllowAnyCall([](float* dpiX, float* dpiY) { *dpiX = *dpiY = DEFAULT_DPI; });
+        dc->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+        dc->BeginDrawMethod.AllowAnyCall();
+        dc->EndDrawMethod.AllowAnyCall();
+        dc->SetDpiMethod.AllowAnyCall();
+        dc->SetUnitModeMethod.AllowAnyCall();
+        dc->SetTransformMethod.AllowAnyCall();
+        dc->SetAntialiasModeMethod.AllowAnyCall();
+        dc->SetPrimitiveBlendMethod.AllowAnyCall();
+        dc->GetRenderingControlsMethod.AllowAnyCall();
+        dc->SetRenderingControlsMethod.AllowAnyCall();
+
+        ComPtr<ID2D1Image> target;
+        dc->SetTargetMethod.AllowAnyCall([&](ID2D1Image* value) { target = value; });
+        dc->GetTargetMethod.AllowAnyCall([&](ID2D1Image** value) { target.CopyTo(value); });
+
+        std::vector<ID2D1Image*> drawnImages;
+        dc->DrawImageMethod.AllowAnyCall(
+            [&](ID2D1Image* image, D2D1_POINT_2F const*, D2D1_RECT_F const*, D2D1_INTERPOLATION_MODE, D2D1_COMPOSITE_MODE)
+            {
+                drawnImages.push_back(image);
+            });
+
+        f.Device->GetResourceCreationDeviceContextMethod.AllowAnyCall([=] { return DeviceContextLease(ComPtr<ID2D1DeviceContext1>(dc)); });
+
+        ICanvasCommandList* commandListPointers[] = { commandLists[0].Get(), commandLists[1].Get(), commandLists[2].Get() };
+
+        ComPtr<ICanvasCommandList> combined;
+        ThrowIfFailed(f.Factory->CreateCombined(f.Device.Get(), 3, commandListPointers, &combined));
+
+        Assert::IsNotNull(combined.Get());
+        Assert::AreEqual<size_t>(3, drawnImages.size());
+
+        for (size_t i = 0; i < 3; i++)
+        {
+            Assert::IsTrue(IsSameInstance(expectedImages[i], drawnImages[i]));
+        }
+    }
+
+    TEST_METHOD_EX(CanvasCommandList_CreateCombined_ValidatesArguments)
+    {
+        Fixture f;
+
+        ICanvasCommandList* nullCommandList = nullptr;
+        ComPtr<ICanvasCommandList> combined;
+
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CreateCombined(nullptr, 0, nullptr, &combined));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CreateCombined(f.Device.Get(), 0, nullptr, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CreateCombined(f.Device.Get(), 1, nullptr, &combined));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CreateCombined(f.Device.Get(), 1, &nullCommandList, &combined));
+    }
+
     TEST_METHOD_EX(CanvasCommandList_GetD2DImage_ClosesD2DCommandListOnFirstCall)
     {
         Fixture f;
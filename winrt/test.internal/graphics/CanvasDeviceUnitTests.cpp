@@ -151,6 +151,29 @@ public:
         uint64_t cacheSize;
         Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_MaximumCacheSize(&cacheSize));
         Assert::AreEqual(RO_E_CLOSED, canvasDevice->put_MaximumCacheSize(0));
+
+        uint32_t maximumEntries;
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_TextLayoutCacheMaximumEntries(&maximumEntries));
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->put_TextLayoutCacheMaximumEntries(0));
+
+        uint64_t maximumBytes;
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_TextLayoutCacheMaximumBytes(&maximumBytes));
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->put_TextLayoutCacheMaximumBytes(0));
+
+        CanvasTextLayoutCacheStatistics statistics;
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_TextLayoutCacheStatistics(&statistics));
+
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_LayerPoolMaximumBytes(&maximumBytes));
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->put_LayerPoolMaximumBytes(0));
+
+        CanvasLayerPoolStatistics layerPoolStatistics;
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_LayerPoolStatistics(&layerPoolStatistics));
+
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_GeometryRealizationCacheMaximumBytes(&maximumBytes));
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->put_GeometryRealizationCacheMaximumBytes(0));
+
+        CanvasGeometryRealizationCacheStatistics geometryCacheStatistics;
+        Assert::AreEqual(RO_E_CLOSED, canvasDevice->get_GeometryRealizationCacheStatistics(&geometryCacheStatistics));
     }
 
     ComPtr<ID2D1Device1> GetD2DDevice(ComPtr<ICanvasDevice> const& canvasDevice)
@@ -419,6 +442,90 @@ public:
         ThrowIfFailed(canvasDevice->put_MaximumCacheSize(someOtherValue));
     }
 
+    TEST_METHOD_EX(CanvasDevice_TextLayoutCache_Properties)
+    {
+        Fixture f;
+
+        auto canvasDevice = Make<CanvasDevice>(Make<MockD2DDevice>().Get());
+
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_TextLayoutCacheMaximumEntries(nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_TextLayoutCacheMaximumBytes(nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_TextLayoutCacheStatistics(nullptr));
+
+        // The cache is disabled by default.
+        uint32_t maximumEntries;
+        ThrowIfFailed(canvasDevice->get_TextLayoutCacheMaximumEntries(&maximumEntries));
+        Assert::AreEqual(0U, maximumEntries);
+
+        uint64_t maximumBytes;
+        ThrowIfFailed(canvasDevice->get_TextLayoutCacheMaximumBytes(&maximumBytes));
+        Assert::AreEqual<uint64_t>(Text::TextLayoutCache::DefaultMaximumBytes, maximumBytes);
+
+        ThrowIfFailed(canvasDevice->put_TextLayoutCacheMaximumEntries(100));
+        ThrowIfFailed(canvasDevice->get_TextLayoutCacheMaximumEntries(&maximumEntries));
+        Assert::AreEqual(100U, maximumEntries);
+
+        ThrowIfFailed(canvasDevice->put_TextLayoutCacheMaximumBytes(12345));
+        ThrowIfFailed(canvasDevice->get_TextLayoutCacheMaximumBytes(&maximumBytes));
+        Assert::AreEqual<uint64_t>(12345, maximumBytes);
+
+        CanvasTextLayoutCacheStatistics statistics;
+        ThrowIfFailed(canvasDevice->get_TextLayoutCacheStatistics(&statistics));
+        Assert::AreEqual(0U, statistics.HitCount);
+        Assert::AreEqual(0U, statistics.MissCount);
+        Assert::AreEqual(0U, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasDevice_LayerPool_Properties)
+    {
+        Fixture f;
+
+        auto canvasDevice = Make<CanvasDevice>(Make<MockD2DDevice>().Get());
+
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_LayerPoolMaximumBytes(nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_LayerPoolStatistics(nullptr));
+
+        // The pool is disabled by default.
+        uint64_t maximumBytes;
+        ThrowIfFailed(canvasDevice->get_LayerPoolMaximumBytes(&maximumBytes));
+        Assert::AreEqual<uint64_t>(0, maximumBytes);
+
+        ThrowIfFailed(canvasDevice->put_LayerPoolMaximumBytes(12345));
+        ThrowIfFailed(canvasDevice->get_LayerPoolMaximumBytes(&maximumBytes));
+        Assert::AreEqual<uint64_t>(12345, maximumBytes);
+
+        CanvasLayerPoolStatistics statistics;
+        ThrowIfFailed(canvasDevice->get_LayerPoolStatistics(&statistics));
+        Assert::AreEqual(0U, statistics.CreateCount);
+        Assert::AreEqual(0U, statistics.ReuseCount);
+        Assert::AreEqual(0U, statistics.IdleLayerCount);
+    }
+
+    TEST_METHOD_EX(CanvasDevice_GeometryRealizationCache_Properties)
+    {
+        Fixture f;
+
+        auto canvasDevice = Make<CanvasDevice>(Make<MockD2DDevice>().Get());
+
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_GeometryRealizationCacheMaximumBytes(nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_GeometryRealizationCacheStatistics(nullptr));
+
+        // The cache is disabled by default.
+        uint64_t maximumBytes;
+        ThrowIfFailed(canvasDevice->get_GeometryRealizationCacheMaximumBytes(&maximumBytes));
+        Assert::AreEqual<uint64_t>(0, maximumBytes);
+
+        ThrowIfFailed(canvasDevice->put_GeometryRealizationCacheMaximumBytes(12345));
+        ThrowIfFailed(canvasDevice->get_GeometryRealizationCacheMaximumBytes(&maximumBytes));
+        Assert::AreEqual<uint64_t>(12345, maximumBytes);
+
+        CanvasGeometryRealizationCacheStatistics statistics;
+        ThrowIfFailed(canvasDevice->get_GeometryRealizationCacheStatistics(&statistics));
+        Assert::AreEqual(0U, statistics.HitCount);
+        Assert::AreEqual(0U, statistics.MissCount);
+        Assert::AreEqual(0U, statistics.EntryCount);
+    }
+
     TEST_METHOD_EX(CanvasDevice_CreateCommandList_ReturnsCommandListFromDeviceContext)
     {
         auto d2dDevice = Make<MockD2DDevice>();
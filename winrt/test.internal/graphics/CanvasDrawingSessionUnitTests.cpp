@@ -13,8 +13,15 @@
 #include "stubs/StubInkAdapter.h"
 #endif
 
+#include "mocks/MockD2DEllipseGeometry.h"
+#include "mocks/MockD2DGeometryGroup.h"
 #include "mocks/MockD2DGeometryRealization.h"
+#include "mocks/MockD2DGeometrySink.h"
+#include "mocks/MockD2DLayer.h"
+#include "mocks/MockD2DPathGeometry.h"
 #include "mocks/MockD2DRectangleGeometry.h"
+#include "mocks/MockD2DRoundedRectangleGeometry.h"
+#include "mocks/MockD2DTransformedGeometry.h"
 #include "mocks/MockDWriteRenderingParams.h"
 #include "stubs/StubCanvasBrush.h"
 #include "stubs/StubCanvasTextLayoutAdapter.h"
@@ -4633,6 +4640,167 @@ TEST_CLASS(CanvasDrawingSession_DrawTextTests)
             Color{ 1, 2, 3, 4 },
             f.Format.Get()));
     }
+
+    struct TextLayoutCacheFixture : public Fixture
+    {
+        Text::TextLayoutCache* Cache;
+        std::vector<IDWriteTextLayout*> DrawnLayouts;
+
+        TextLayoutCacheFixture()
+            : Cache(CanvasDevice->GetTextLayoutCache())
+        {
+            Cache->SetMaximumEntries(16);
+
+            DeviceContext->DrawTextLayoutMethod.AllowAnyCall(
+                [=] (D2D1_POINT_2F, IDWriteTextLayout* textLayout, ID2D1Brush*, D2D1_DRAW_TEXT_OPTIONS)
+                {
+                    DrawnLayouts.push_back(textLayout);
+                });
+        }
+
+        void DrawText(wchar_t const* text, Rect const& rect)
+        {
+            ThrowIfFailed(DS->DrawTextAtRectWithBrushAndFormat(HStringReference(text).Get(), rect, Brush.Get(), Format.Get()));
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawText_WhenTextLayoutCacheIsEnabled_RepeatedTextReusesLayout)
+    {
+        TextLayoutCacheFixture f;
+
+        ThrowIfFailed(f.Format->put_Options(CanvasDrawTextOptions::Clip));
+
+        f.DeviceContext->DrawTextLayoutMethod.SetExpectedCalls(2,
+            [&] (D2D1_POINT_2F point, IDWriteTextLayout* textLayout, ID2D1Brush*, D2D1_DRAW_TEXT_OPTIONS options)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 1, 2 }, point);
+                Assert::AreEqual(3.0f, textLayout->GetMaxWidth());
+                Assert::AreEqual(4.0f, textLayout->GetMaxHeight());
+                Assert::AreEqual(D2D1_DRAW_TEXT_OPTIONS_CLIP, options);
+                f.DrawnLayouts.push_back(textLayout);
+            });
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+
+        Assert::AreEqual(f.DrawnLayouts[0], f.DrawnLayouts[1]);
+
+        auto statistics = f.Cache->GetStatistics();
+        Assert::AreEqual(1U, statistics.HitCount);
+        Assert::AreEqual(1U, statistics.MissCount);
+        Assert::AreEqual(1U, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawText_WhenTextLayoutCacheIsEnabled_DifferentTextOrSizeIsNotShared)
+    {
+        TextLayoutCacheFixture f;
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+        f.DrawText(L"other", Rect{ 1, 2, 3, 4 });
+        f.DrawText(L"label", Rect{ 1, 2, 5, 4 });
+        f.DrawText(L"label", Rect{ 7, 8, 3, 4 });  // only the position differs
+
+        Assert::AreEqual(4U, static_cast<uint32_t>(f.DrawnLayouts.size()));
+        Assert::AreEqual(f.DrawnLayouts[0], f.DrawnLayouts[3]);
+
+        auto statistics = f.Cache->GetStatistics();
+        Assert::AreEqual(1U, statistics.HitCount);
+        Assert::AreEqual(3U, statistics.MissCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawText_WhenTextFormatIsModified_CachedLayoutIsNotUsed)
+    {
+        TextLayoutCacheFixture f;
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+
+        ThrowIfFailed(f.Format->put_FontSize(50));
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+
+        Assert::AreNotEqual(f.DrawnLayouts[0], f.DrawnLayouts[1]);
+        Assert::AreEqual(50.0f, f.DrawnLayouts[1]->GetFontSize());
+        Assert::AreEqual(0U, f.Cache->GetStatistics().HitCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawText_WhenTextFormatIsModifiedThroughInterop_CachedLayoutIsNotUsed)
+    {
+        TextLayoutCacheFixture f;
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+
+        auto nativeFormat = GetWrappedResource<IDWriteTextFormat1>(f.Format);
+        ThrowIfFailed(nativeFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER));
+
+        f.DeviceContext->DrawTextMethod.SetExpectedCalls(2,
+            [&] (wchar_t const*, uint32_t, IDWriteTextFormat* format, D2D1_RECT_F const*, ID2D1Brush*, D2D1_DRAW_TEXT_OPTIONS, DWRITE_MEASURING_MODE)
+            {
+                Assert::AreEqual(DWRITE_PARAGRAPH_ALIGNMENT_CENTER, format->GetParagraphAlignment());
+            });
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+
+        Assert::AreEqual(1U, static_cast<uint32_t>(f.DrawnLayouts.size()));
+
+        auto statistics = f.Cache->GetStatistics();
+        Assert::AreEqual(0U, statistics.HitCount);
+        Assert::AreEqual(1U, statistics.MissCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawTextAtPoint_WhenTextLayoutCacheIsEnabled_UsesNoWrapLayout)
+    {
+        TextLayoutCacheFixture f;
+
+        ThrowIfFailed(f.Format->put_WordWrapping(CanvasWordWrapping::Wrap));
+
+        ThrowIfFailed(f.DS->DrawTextAtPointWithBrushAndFormat(HStringReference(L"label").Get(), Vector2{ 1, 2 }, f.Brush.Get(), f.Format.Get()));
+        ThrowIfFailed(f.DS->DrawTextAtRectWithBrushAndFormat(HStringReference(L"label").Get(), Rect{ 1, 2, 0, 0 }, f.Brush.Get(), f.Format.Get()));
+
+        Assert::AreEqual(DWRITE_WORD_WRAPPING_NO_WRAP, f.DrawnLayouts[0]->GetWordWrapping());
+        Assert::AreEqual(DWRITE_WORD_WRAPPING_WRAP, f.DrawnLayouts[1]->GetWordWrapping());
+
+        CanvasWordWrapping wordWrapping;
+        ThrowIfFailed(f.Format->get_WordWrapping(&wordWrapping));
+        Assert::AreEqual(CanvasWordWrapping::Wrap, wordWrapping);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawText_TextLayoutCacheEvictsLeastRecentlyUsed)
+    {
+        TextLayoutCacheFixture f;
+        f.Cache->SetMaximumEntries(2);
+
+        f.DrawText(L"a", Rect{ 0, 0, 10, 10 });
+        f.DrawText(L"b", Rect{ 0, 0, 10, 10 });
+        f.DrawText(L"a", Rect{ 0, 0, 10, 10 });     // "a" is now the most recently used
+        f.DrawText(L"c", Rect{ 0, 0, 10, 10 });     // evicts "b"
+        f.DrawText(L"a", Rect{ 0, 0, 10, 10 });
+
+        auto statistics = f.Cache->GetStatistics();
+        Assert::AreEqual(2U, statistics.HitCount);
+        Assert::AreEqual(3U, statistics.MissCount);
+        Assert::AreEqual(1U, statistics.EvictionCount);
+        Assert::AreEqual(2U, statistics.EntryCount);
+
+        // Shrinking the byte budget below the size of one entry empties the cache.
+        f.Cache->SetMaximumBytes(1);
+        statistics = f.Cache->GetStatistics();
+        Assert::AreEqual(0U, statistics.EntryCount);
+        Assert::AreEqual<uint64_t>(0, statistics.SizeInBytes);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawText_WhenTextLayoutCacheIsDisabled_DrawTextIsUsed)
+    {
+        TextLayoutCacheFixture f;
+        f.Cache->SetMaximumEntries(0);
+
+        f.DeviceContext->DrawTextMethod.SetExpectedCalls(1);
+
+        f.DrawText(L"label", Rect{ 1, 2, 3, 4 });
+
+        Assert::AreEqual(0U, static_cast<uint32_t>(f.DrawnLayouts.size()));
+        Assert::AreEqual(0U, f.Cache->GetStatistics().MissCount);
+    }
 };
 
 TEST_CLASS(CanvasDrawingSession_CloseTests)
@@ -4801,6 +4969,18 @@ TEST_CLASS(CanvasDrawingSession_CloseTests)
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->DrawGlyphRunWithMeasuringMode(Vector2{}, nullptr, 0, 0, nullptr, false, 0u, nullptr, CanvasTextMeasuringMode::Natural));
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->DrawGlyphRunWithMeasuringModeAndDescription(Vector2{}, nullptr, 0, 0, nullptr, false, 0u, nullptr, CanvasTextMeasuringMode::Natural, nullptr, nullptr, 0, nullptr, 0));
 
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->FillRectangles(0, nullptr, 0, nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->DrawRectangles(0, nullptr, 0, nullptr, 0));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->FillRoundedRectangles(0, nullptr, 0, 0, 0, nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->FillEllipses(0, nullptr, 0, nullptr, 0, nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->FillCircles(0, nullptr, 0, nullptr, 0, nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->DrawLines(0, nullptr, 0, nullptr, 0));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->DrawPoints(0, nullptr, 0, nullptr, 0));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->get_CoalesceColorFills(nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->put_CoalesceColorFills(false));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->get_CollectStatistics(nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->put_CollectStatistics(false));
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->DrawInk(nullptr));
 #endif
@@ -4861,6 +5041,1412 @@ TEST_CLASS(CanvasDrawingSession_CloseTests)
     }
 };
 
+TEST_CLASS(CanvasDrawingSession_BatchedPrimitivesTests)
+{
+    static Color const OpaqueColor1;
+    static Color const OpaqueColor2;
+    static Color const TranslucentColor;
+
+    struct Fixture : public CanvasDrawingSessionFixture
+    {
+        ComPtr<MockD2DPathGeometry> PathGeometry;
+        uint32_t FigureCount;
+        std::vector<D2D1_FIGURE_BEGIN> FigureBegins;
+        std::vector<D2D1_FIGURE_END> FigureEnds;
+
+        Fixture()
+            : FigureCount(0)
+        {
+            DeviceContext->CreateSolidColorBrushMethod.AllowAnyCall(
+                [](D2D1_COLOR_F const*, D2D1_BRUSH_PROPERTIES const*, ID2D1SolidColorBrush** value)
+                {
+                    auto brush = Make<MockD2DSolidColorBrush>();
+                    brush->SetColorMethod.AllowAnyCall();
+                    return brush.CopyTo(value);
+                });
+
+            DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_SOURCE_OVER; });
+        }
+
+        void ExpectPathGeometries(int count, bool recordFigures = true)
+        {
+            CanvasDevice->CreatePathGeometryMethod.SetExpectedCalls(count,
+                [=]
+                {
+                    PathGeometry = Make<MockD2DPathGeometry>();
+
+                    PathGeometry->OpenMethod.SetExpectedCalls(1,
+                        [=] (ID2D1GeometrySink** value)
+                        {
+                            auto sink = Make<MockD2DGeometrySink>();
+
+                            sink->SetFillModeMethod.SetExpectedCalls(1,
+                                [] (D2D1_FILL_MODE fillMode)
+                                {
+                                    Assert::AreEqual(D2D1_FILL_MODE_WINDING, fillMode);
+                                });
+
+                            sink->BeginFigureMethod.AllowAnyCall(
+                                [=] (D2D1_POINT_2F, D2D1_FIGURE_BEGIN figureBegin)
+                                {
+                                    ++FigureCount;
+                                    if (recordFigures)
+                                        FigureBegins.push_back(figureBegin);
+                                });
+
+                            sink->EndFigureMethod.AllowAnyCall(
+                                [=] (D2D1_FIGURE_END figureEnd)
+                                {
+                                    if (recordFigures)
+                                        FigureEnds.push_back(figureEnd);
+                                });
+
+                            sink->AddLineMethod.AllowAnyCall();
+                            sink->AddLinesMethod.AllowAnyCall();
+                            sink->AddArcMethod.AllowAnyCall();
+                            sink->CloseMethod.SetExpectedCalls(1);
+
+                            return sink.CopyTo(value);
+                        });
+
+                    return PathGeometry;
+                });
+        }
+
+        void ExpectFillGeometry()
+        {
+            DeviceContext->FillGeometryMethod.SetExpectedCalls(1,
+                [=] (ID2D1Geometry* geometry, ID2D1Brush* brush, ID2D1Brush* opacityBrush)
+                {
+                    Assert::IsTrue(IsSameInstance(PathGeometry.Get(), geometry));
+                    Assert::IsNotNull(brush);
+                    Assert::IsNull(opacityBrush);
+                });
+        }
+
+        void ExpectDrawGeometry(float expectedStrokeWidth)
+        {
+            DeviceContext->DrawGeometryMethod.SetExpectedCalls(1,
+                [=] (ID2D1Geometry* geometry, ID2D1Brush* brush, float strokeWidth, ID2D1StrokeStyle* strokeStyle)
+                {
+                    Assert::IsTrue(IsSameInstance(PathGeometry.Get(), geometry));
+                    Assert::IsNotNull(brush);
+                    Assert::AreEqual(expectedStrokeWidth, strokeWidth);
+                    Assert::IsNull(strokeStyle);
+                });
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_NullArgs)
+    {
+        Fixture f;
+
+        Rect rect{};
+        Vector2 point{};
+        Vector2 radii{};
+        float radius = 0;
+        Color color{};
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillRectangles(1, nullptr, 1, &color));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillRectangles(1, &rect, 1, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawRectangles(1, nullptr, 1, &color, 1));
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawRectangles(1, &rect, 1, nullptr, 1));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillRoundedRectangles(1, nullptr, 1, 1, 1, &color));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillRoundedRectangles(1, &rect, 1, 1, 1, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillEllipses(1, nullptr, 1, &radii, 1, &color));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillEllipses(1, &point, 1, nullptr, 1, &color));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillEllipses(1, &point, 1, &radii, 1, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillCircles(1, nullptr, 1, &radius, 1, &color));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillCircles(1, &point, 1, nullptr, 1, &color));
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillCircles(1, &point, 1, &radius, 1, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawPoints(1, nullptr, 1, &color, 1));
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawPoints(1, &point, 1, nullptr, 1));
+
+        Vector2 points[2]{};
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawLines(2, nullptr, 1, &color, 1));
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawLines(2, points, 1, nullptr, 1));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_FailWhenArraysAreTheWrongLength)
+    {
+        Fixture f;
+
+        Rect rects[3]{};
+        Vector2 points[3]{};
+        Color colors[2]{};
+        float radii[2]{};
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillRectangles(3, rects, 2, colors));
+        ValidateStoredErrorState(E_INVALIDARG, L"The array colors was expected to contain either 1 or 3 elements; actual array contained 2 elements.");
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->FillCircles(3, points, 2, radii, 1, colors));
+        ValidateStoredErrorState(E_INVALIDARG, L"The array radii was expected to contain either 1 or 3 elements; actual array contained 2 elements.");
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->DrawLines(3, points, 1, colors, 1));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::DrawLinesOddPointCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_WithNoPrimitives_DoNothing)
+    {
+        Fixture f;
+
+        ThrowIfFailed(f.DS->FillRectangles(0, nullptr, 0, nullptr));
+        ThrowIfFailed(f.DS->DrawRectangles(0, nullptr, 0, nullptr, 1));
+        ThrowIfFailed(f.DS->FillRoundedRectangles(0, nullptr, 1, 1, 0, nullptr));
+        ThrowIfFailed(f.DS->FillEllipses(0, nullptr, 0, nullptr, 0, nullptr));
+        ThrowIfFailed(f.DS->FillCircles(0, nullptr, 0, nullptr, 0, nullptr));
+        ThrowIfFailed(f.DS->DrawLines(0, nullptr, 0, nullptr, 1));
+        ThrowIfFailed(f.DS->DrawPoints(0, nullptr, 0, nullptr, 1));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_WithSharedOpaqueColor_DrawOneGeometry)
+    {
+        Rect rects[] = { Rect{ 1, 2, 3, 4 }, Rect{ 5, 6, 7, 8 }, Rect{ 9, 10, -11, -12 } };
+        Vector2 points[] = { Vector2{ 1, 2 }, Vector2{ 3, 4 }, Vector2{ 5, 6 } };
+        Vector2 ellipseRadii = Vector2{ 3, 4 };
+        float circleRadius = 5;
+        Color color = OpaqueColor1;
+
+        {
+            Fixture f;
+            f.ExpectPathGeometries(1);
+            f.ExpectFillGeometry();
+            ThrowIfFailed(f.DS->FillRectangles(3, rects, 1, &color));
+            Assert::AreEqual(3U, f.FigureCount);
+        }
+
+        {
+            Fixture f;
+            f.ExpectPathGeometries(1);
+            f.ExpectDrawGeometry(5);
+            ThrowIfFailed(f.DS->DrawRectangles(3, rects, 1, &color, 5));
+            Assert::AreEqual(3U, f.FigureCount);
+        }
+
+        {
+            Fixture f;
+            f.ExpectPathGeometries(1);
+            f.ExpectFillGeometry();
+            ThrowIfFailed(f.DS->FillRoundedRectangles(3, rects, 1, 2, 1, &color));
+            Assert::AreEqual(3U, f.FigureCount);
+        }
+
+        {
+            Fixture f;
+            f.ExpectPathGeometries(1);
+            f.ExpectFillGeometry();
+            ThrowIfFailed(f.DS->FillEllipses(3, points, 1, &ellipseRadii, 1, &color));
+            Assert::AreEqual(3U, f.FigureCount);
+        }
+
+        {
+            Fixture f;
+            f.ExpectPathGeometries(1);
+            f.ExpectFillGeometry();
+            ThrowIfFailed(f.DS->FillCircles(3, points, 1, &circleRadius, 1, &color));
+            Assert::AreEqual(3U, f.FigureCount);
+        }
+
+        {
+            Fixture f;
+            f.ExpectPathGeometries(1);
+            f.ExpectFillGeometry();
+            ThrowIfFailed(f.DS->DrawPoints(3, points, 1, &color, 2));
+            Assert::AreEqual(3U, f.FigureCount);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawLines_UsesOneOpenFigurePerLine)
+    {
+        Fixture f;
+
+        Vector2 points[] = { Vector2{ 1, 2 }, Vector2{ 3, 4 }, Vector2{ 5, 6 }, Vector2{ 7, 8 } };
+        Color color = OpaqueColor1;
+
+        f.ExpectPathGeometries(1);
+        f.ExpectDrawGeometry(3);
+
+        ThrowIfFailed(f.DS->DrawLines(4, points, 1, &color, 3));
+
+        Assert::AreEqual(2U, f.FigureCount);
+        Assert::IsTrue(std::all_of(f.FigureBegins.begin(), f.FigureBegins.end(), [] (auto b) { return b == D2D1_FIGURE_BEGIN_HOLLOW; }));
+        Assert::IsTrue(std::all_of(f.FigureEnds.begin(), f.FigureEnds.end(), [] (auto e) { return e == D2D1_FIGURE_END_OPEN; }));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_WithTranslucentColor_DrawEachPrimitive)
+    {
+        Fixture f;
+
+        Rect rects[] = { Rect{ 1, 2, 3, 4 }, Rect{ 5, 6, 7, 8 }, Rect{ 9, 10, 11, 12 } };
+        Color color = TranslucentColor;
+
+        int index = 0;
+
+        f.CanvasDevice->CreatePathGeometryMethod.SetExpectedCalls(0);
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(3,
+            [&] (D2D1_RECT_F const* rect, ID2D1Brush*)
+            {
+                Assert::AreEqual(ToD2DRect(rects[index]), *rect);
+                ++index;
+            });
+
+        ThrowIfFailed(f.DS->FillRectangles(3, rects, 1, &color));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_WithBlendOtherThanSourceOver_DrawEachPrimitive)
+    {
+        D2D1_PRIMITIVE_BLEND blends[] = { D2D1_PRIMITIVE_BLEND_COPY, D2D1_PRIMITIVE_BLEND_MIN, D2D1_PRIMITIVE_BLEND_ADD, D2D1_PRIMITIVE_BLEND_MAX };
+
+        for (auto blend : blends)
+        {
+            Fixture f;
+
+            Rect rects[] = { Rect{ 1, 2, 3, 4 }, Rect{ 5, 6, 7, 8 }, Rect{ 9, 10, 11, 12 } };
+            Color color = OpaqueColor1;
+
+            int index = 0;
+
+            f.DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([=] { return blend; });
+
+            f.CanvasDevice->CreatePathGeometryMethod.SetExpectedCalls(0);
+            f.DeviceContext->FillRectangleMethod.SetExpectedCalls(3,
+                [&] (D2D1_RECT_F const* rect, ID2D1Brush*)
+                {
+                    Assert::AreEqual(ToD2DRect(rects[index]), *rect);
+                    ++index;
+                });
+
+            ThrowIfFailed(f.DS->FillRectangles(3, rects, 1, &color));
+        }
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchedPrimitives_RunsOfTheSameColorShareAGeometry)
+    {
+        Fixture f;
+
+        Vector2 centers[] = { Vector2{ 1, 2 }, Vector2{ 3, 4 }, Vector2{ 5, 6 }, Vector2{ 7, 8 } };
+        float radius = 5;
+        Color colors[] = { OpaqueColor1, OpaqueColor1, OpaqueColor2, OpaqueColor1 };
+
+        // The first two circles share a geometry; the others are drawn individually.
+        f.ExpectPathGeometries(1);
+        f.ExpectFillGeometry();
+
+        int index = 2;
+
+        f.DeviceContext->FillEllipseMethod.SetExpectedCalls(2,
+            [&] (D2D1_ELLIPSE const* ellipse, ID2D1Brush*)
+            {
+                Assert::AreEqual(ToD2DPoint(centers[index]), ellipse->point);
+                ++index;
+            });
+
+        ThrowIfFailed(f.DS->FillCircles(4, centers, 1, &radius, 4, colors));
+
+        Assert::AreEqual(2U, f.FigureCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawLines_ManyLinesAreDrawnWithOneDrawGeometryCall)
+    {
+        Fixture f;
+
+        // Timings for large counts are in PerformanceTests.
+        const uint32_t lineCount = 3;
+
+        std::vector<Vector2> points(lineCount * 2);
+        for (auto i = 0U; i < points.size(); ++i)
+        {
+            points[i] = Vector2{ static_cast<float>(i), static_cast<float>(i % 100) };
+        }
+
+        Color color = OpaqueColor1;
+
+        f.ExpectPathGeometries(1, false);
+        f.ExpectDrawGeometry(1);
+
+        ThrowIfFailed(f.DS->DrawLines(static_cast<uint32_t>(points.size()), points.data(), 1, &color, 1));
+
+        Assert::AreEqual(lineCount, f.FigureCount);
+    }
+};
+
+Color const CanvasDrawingSession_BatchedPrimitivesTests::OpaqueColor1{ 255, 1, 2, 3 };
+Color const CanvasDrawingSession_BatchedPrimitivesTests::OpaqueColor2{ 255, 4, 5, 6 };
+Color const CanvasDrawingSession_BatchedPrimitivesTests::TranslucentColor{ 128, 1, 2, 3 };
+
+TEST_CLASS(CanvasDrawingSession_ColorFillTests)
+{
+    static Color const OpaqueColor1;
+    static Color const OpaqueColor2;
+    static Color const TranslucentColor;
+
+    class StubD2DFactoryWithCreateShapes : public StubD2DFactoryWithCreateStrokeStyle
+    {
+    public:
+        CALL_COUNTER_WITH_MOCK(CreateGeometryGroupMethod, HRESULT(D2D1_FILL_MODE, ID2D1Geometry**, UINT32, ID2D1GeometryGroup**));
+        CALL_COUNTER_WITH_MOCK(CreateTransformedGeometryMethod, HRESULT(ID2D1Geometry*, D2D1_MATRIX_3X2_F const*, ID2D1TransformedGeometry**));
+
+        StubD2DFactoryWithCreateShapes()
+        {
+            CreateGeometryGroupMethod.AllowAnyCall(
+                [] (D2D1_FILL_MODE, ID2D1Geometry**, UINT32, ID2D1GeometryGroup** value)
+                {
+                    return Make<MockD2DGeometryGroup>().CopyTo(value);
+                });
+
+            CreateTransformedGeometryMethod.AllowAnyCall(
+                [] (ID2D1Geometry*, D2D1_MATRIX_3X2_F const*, ID2D1TransformedGeometry** value)
+                {
+                    return Make<MockD2DTransformedGeometry>().CopyTo(value);
+                });
+        }
+
+        STDMETHOD(CreateRectangleGeometry)(D2D1_RECT_F const*, ID2D1RectangleGeometry** value) override
+        {
+            return Make<MockD2DRectangleGeometry>().CopyTo(value);
+        }
+
+        STDMETHOD(CreateRoundedRectangleGeometry)(D2D1_ROUNDED_RECT const*, ID2D1RoundedRectangleGeometry** value) override
+        {
+            return Make<MockD2DRoundedRectangleGeometry>().CopyTo(value);
+        }
+
+        STDMETHOD(CreateEllipseGeometry)(D2D1_ELLIPSE const*, ID2D1EllipseGeometry** value) override
+        {
+            return Make<MockD2DEllipseGeometry>().CopyTo(value);
+        }
+
+        STDMETHOD(CreateGeometryGroup)(D2D1_FILL_MODE fillMode, ID2D1Geometry** geometries, UINT32 geometriesCount, ID2D1GeometryGroup** value) override
+        {
+            return CreateGeometryGroupMethod.WasCalled(fillMode, geometries, geometriesCount, value);
+        }
+
+        STDMETHOD(CreateTransformedGeometry)(ID2D1Geometry* sourceGeometry, D2D1_MATRIX_3X2_F const* transform, ID2D1TransformedGeometry** value) override
+        {
+            return CreateTransformedGeometryMethod.WasCalled(sourceGeometry, transform, value);
+        }
+    };
+
+    struct Fixture : public CanvasDrawingSessionFixture
+    {
+        ComPtr<StubD2DFactoryWithCreateShapes> Factory;
+        std::vector<D2D1_COLOR_F> BrushColors;
+        D2D1_COLOR_F CurrentColor;
+
+        Fixture()
+            : Factory(Make<StubD2DFactoryWithCreateShapes>())
+            , CurrentColor{}
+        {
+            DeviceContext->m_factory = Factory;
+
+            DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_SOURCE_OVER; });
+
+            DeviceContext->CreateSolidColorBrushMethod.AllowAnyCall(
+                [=] (D2D1_COLOR_F const* color, D2D1_BRUSH_PROPERTIES const*, ID2D1SolidColorBrush** value)
+                {
+                    CurrentColor = *color;
+                    BrushColors.push_back(*color);
+
+                    auto brush = Make<MockD2DSolidColorBrush>();
+                    brush->SetColorMethod.AllowAnyCall(
+                        [=] (D2D1_COLOR_F const* color)
+                        {
+                            CurrentColor = *color;
+                            BrushColors.push_back(*color);
+                        });
+
+                    return brush.CopyTo(value);
+                });
+        }
+
+        void EnableCoalescing()
+        {
+            ThrowIfFailed(DS->put_CoalesceColorFills(true));
+        }
+
+        CanvasColorFillStatistics GetStatistics()
+        {
+            CanvasColorFillStatistics statistics;
+            ThrowIfFailed(DS->get_ColorFillStatistics(&statistics));
+            return statistics;
+        }
+
+        ComPtr<CanvasGeometry> MakeRectangleGeometry(D2D1_RECT_F const& rect)
+        {
+            CanvasDevice->CreateRectangleGeometryMethod.SetExpectedCalls(1,
+                [=] (D2D1_RECT_F const&)
+                {
+                    auto geometry = Make<MockD2DRectangleGeometry>();
+
+                    geometry->GetRectMethod.AllowAnyCall([=] (D2D1_RECT_F* value) { *value = rect; });
+
+                    geometry->GetFactoryMethod.AllowAnyCall(
+                        [=] (ID2D1Factory** value)
+                        {
+                            Factory.CopyTo(value);
+                        });
+
+                    return geometry;
+                });
+
+            return CanvasGeometry::CreateNew(CanvasDevice.Get(), FromD2DRect(rect));
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_GetColorBrush_SkipsSetColorWhenTheColorIsUnchanged)
+    {
+        Fixture f;
+
+        f.DeviceContext->FillRectangleMethod.AllowAnyCall();
+
+        Color colors[] = { OpaqueColor1, OpaqueColor1, OpaqueColor2, OpaqueColor2, OpaqueColor2, OpaqueColor1 };
+
+        for (auto& color : colors)
+        {
+            ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, color));
+        }
+
+        // One CreateSolidColorBrush, then SetColor for each change of color.
+        Assert::AreEqual<size_t>(3, f.BrushColors.size());
+        Assert::AreEqual(ToD2DColor(OpaqueColor1), f.BrushColors[0]);
+        Assert::AreEqual(ToD2DColor(OpaqueColor2), f.BrushColors[1]);
+        Assert::AreEqual(ToD2DColor(OpaqueColor1), f.BrushColors[2]);
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(3U, statistics.SetColorCallsAvoided);
+        Assert::AreEqual(0U, statistics.CoalescedFillCount);
+        Assert::AreEqual(0U, statistics.FillCallsAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_DefaultsToFalse)
+    {
+        Fixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_CoalesceColorFills(nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_ColorFillStatistics(nullptr));
+
+        boolean value = true;
+        ThrowIfFailed(f.DS->get_CoalesceColorFills(&value));
+        Assert::IsFalse(!!value);
+
+        ThrowIfFailed(f.DS->put_CoalesceColorFills(true));
+        ThrowIfFailed(f.DS->get_CoalesceColorFills(&value));
+        Assert::IsTrue(!!value);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_WhenEnabled_SameColorFillsAreDrawnAsOneGeometryGroup)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        const uint32_t fillCount = 1000;
+
+        for (auto i = 0U; i < fillCount; i++)
+        {
+            auto x = static_cast<float>(i);
+
+            switch (i % 4)
+            {
+            case 0: ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ x, 0, 10, 10 }, OpaqueColor1)); break;
+            case 1: ThrowIfFailed(f.DS->FillEllipseWithColor(Vector2{ x, 0 }, 5, 6, OpaqueColor1)); break;
+            case 2: ThrowIfFailed(f.DS->FillCircleWithColor(Vector2{ x, 0 }, 5, OpaqueColor1)); break;
+            case 3: ThrowIfFailed(f.DS->FillRoundedRectangleWithColor(Rect{ x, 0, 10, 10 }, 2, 3, OpaqueColor1)); break;
+            }
+        }
+
+        ComPtr<ID2D1GeometryGroup> geometryGroup;
+
+        f.Factory->CreateGeometryGroupMethod.SetExpectedCalls(1,
+            [&] (D2D1_FILL_MODE fillMode, ID2D1Geometry** geometries, UINT32 geometriesCount, ID2D1GeometryGroup** value)
+            {
+                Assert::AreEqual(D2D1_FILL_MODE_WINDING, fillMode);
+                Assert::AreEqual(fillCount, geometriesCount);
+
+                for (auto i = 0U; i < geometriesCount; i++)
+                {
+                    Assert::IsNotNull(geometries[i]);
+                }
+
+                geometryGroup = Make<MockD2DGeometryGroup>();
+                return geometryGroup.CopyTo(value);
+            });
+
+        f.DeviceContext->FillGeometryMethod.SetExpectedCalls(1,
+            [&] (ID2D1Geometry* geometry, ID2D1Brush* brush, ID2D1Brush* opacityBrush)
+            {
+                Assert::IsTrue(IsSameInstance(geometryGroup.Get(), geometry));
+                Assert::IsNotNull(brush);
+                Assert::IsNull(opacityBrush);
+                Assert::AreEqual(ToD2DColor(OpaqueColor1), f.CurrentColor);
+            });
+
+        ThrowIfFailed(f.DS->Close());
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(fillCount, statistics.CoalescedFillCount);
+        Assert::AreEqual(fillCount - 1, statistics.FillCallsAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_ChangingColorFlushesPendingFills)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        std::vector<D2D1_COLOR_F> drawnColors;
+        std::vector<UINT32> groupSizes;
+
+        f.Factory->CreateGeometryGroupMethod.AllowAnyCall(
+            [&] (D2D1_FILL_MODE, ID2D1Geometry**, UINT32 geometriesCount, ID2D1GeometryGroup** value)
+            {
+                groupSizes.push_back(geometriesCount);
+                return Make<MockD2DGeometryGroup>().CopyTo(value);
+            });
+
+        f.DeviceContext->FillGeometryMethod.AllowAnyCall(
+            [&] (ID2D1Geometry*, ID2D1Brush*, ID2D1Brush*)
+            {
+                drawnColors.push_back(f.CurrentColor);
+            });
+
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, OpaqueColor1));
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 5, 6, 7, 8 }, OpaqueColor1));
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, OpaqueColor2));
+
+        Assert::AreEqual<size_t>(1, drawnColors.size());
+
+        ThrowIfFailed(f.DS->Close());
+
+        // A single pending fill is drawn without a geometry group.
+        Assert::AreEqual<size_t>(1, groupSizes.size());
+        Assert::AreEqual(2U, groupSizes[0]);
+
+        Assert::AreEqual<size_t>(2, drawnColors.size());
+        Assert::AreEqual(ToD2DColor(OpaqueColor1), drawnColors[0]);
+        Assert::AreEqual(ToD2DColor(OpaqueColor2), drawnColors[1]);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_OtherDrawingFlushesPendingFills)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        int sequence = 0;
+
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, OpaqueColor1));
+
+        f.DeviceContext->FillGeometryMethod.SetExpectedCalls(1,
+            [&] (ID2D1Geometry*, ID2D1Brush*, ID2D1Brush*)
+            {
+                Assert::AreEqual(0, sequence++);
+                Assert::AreEqual(ToD2DColor(OpaqueColor1), f.CurrentColor);
+            });
+
+        f.DeviceContext->DrawLineMethod.SetExpectedCalls(1,
+            [&] (D2D1_POINT_2F, D2D1_POINT_2F, ID2D1Brush*, float, ID2D1StrokeStyle*)
+            {
+                Assert::AreEqual(1, sequence++);
+                Assert::AreEqual(ToD2DColor(OpaqueColor2), f.CurrentColor);
+            });
+
+        ThrowIfFailed(f.DS->DrawLineWithColor(Vector2{ 1, 2 }, Vector2{ 3, 4 }, OpaqueColor2));
+
+        Assert::AreEqual(2, sequence);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_TranslucentAndNegativeSizedFillsAreDrawnDirectly)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(2);
+        f.DeviceContext->FillEllipseMethod.SetExpectedCalls(1);
+        f.Factory->CreateGeometryGroupMethod.SetExpectedCalls(0);
+
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, TranslucentColor));
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, -3, 4 }, OpaqueColor1));
+        ThrowIfFailed(f.DS->FillEllipseWithColor(Vector2{ 1, 2 }, -3, 4, OpaqueColor1));
+
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual(0U, f.GetStatistics().CoalescedFillCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_WithNonSourceOverBlend_FillsAreDrawnDirectly)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        f.DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_COPY; });
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, OpaqueColor1));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_SimpleShapeGeometriesAreCoalesced)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        auto geometry = f.MakeRectangleGeometry(D2D1_RECT_F{ 1, 2, 3, 4 });
+        auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
+
+        f.Factory->CreateTransformedGeometryMethod.SetExpectedCalls(1,
+            [&] (ID2D1Geometry* sourceGeometry, D2D1_MATRIX_3X2_F const* transform, ID2D1TransformedGeometry** value)
+            {
+                Assert::IsTrue(IsSameInstance(d2dGeometry.Get(), sourceGeometry));
+                Assert::AreEqual(D2D1_MATRIX_3X2_F{ 1, 0, 0, 1, 5, 6 }, *transform);
+                return Make<MockD2DTransformedGeometry>().CopyTo(value);
+            });
+
+        f.Factory->CreateGeometryGroupMethod.SetExpectedCalls(1,
+            [&] (D2D1_FILL_MODE, ID2D1Geometry** geometries, UINT32 geometriesCount, ID2D1GeometryGroup** value)
+            {
+                Assert::AreEqual(2U, geometriesCount);
+                Assert::IsTrue(IsSameInstance(d2dGeometry.Get(), geometries[0]));
+                return Make<MockD2DGeometryGroup>().CopyTo(value);
+            });
+
+        f.DeviceContext->FillGeometryMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->FillGeometryWithColor(geometry.Get(), Vector2{ 0, 0 }, OpaqueColor1));
+        ThrowIfFailed(f.DS->FillGeometryWithColor(geometry.Get(), Vector2{ 5, 6 }, OpaqueColor1));
+
+        ThrowIfFailed(f.DS->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceColorFills_OtherGeometriesAreDrawnDirectly)
+    {
+        Fixture f;
+        f.EnableCoalescing();
+
+        auto geometry = f.MakeRectangleGeometry(D2D1_RECT_F{ 3, 2, 1, 4 });
+        auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometry);
+
+        f.DeviceContext->FillGeometryMethod.SetExpectedCalls(1,
+            [&] (ID2D1Geometry* geometry, ID2D1Brush*, ID2D1Brush*)
+            {
+                Assert::IsTrue(IsSameInstance(d2dGeometry.Get(), geometry));
+            });
+
+        ThrowIfFailed(f.DS->FillGeometryWithColor(geometry.Get(), Vector2{ 0, 0 }, OpaqueColor1));
+
+        Assert::AreEqual(0U, f.GetStatistics().CoalescedFillCount);
+    }
+};
+
+Color const CanvasDrawingSession_ColorFillTests::OpaqueColor1{ 255, 1, 2, 3 };
+Color const CanvasDrawingSession_ColorFillTests::OpaqueColor2{ 255, 4, 5, 6 };
+Color const CanvasDrawingSession_ColorFillTests::TranslucentColor{ 128, 1, 2, 3 };
+
+TEST_CLASS(CanvasDrawingSession_StatisticsTests)
+{
+    struct Fixture : public CanvasDrawingSessionFixture
+    {
+        Fixture()
+        {
+            DeviceContext->CreateSolidColorBrushMethod.AllowAnyCall(
+                [] (D2D1_COLOR_F const*, D2D1_BRUSH_PROPERTIES const*, ID2D1SolidColorBrush** value)
+                {
+                    return Make<MockD2DSolidColorBrush>().CopyTo(value);
+                });
+        }
+
+        void EnableStatistics()
+        {
+            ThrowIfFailed(DS->put_CollectStatistics(true));
+        }
+
+        CanvasDrawingSessionStatistics GetStatistics()
+        {
+            CanvasDrawingSessionStatistics statistics;
+            ThrowIfFailed(DS->get_Statistics(&statistics));
+            return statistics;
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_CollectStatistics_DefaultsToFalse)
+    {
+        Fixture f;
+
+        boolean value = true;
+        ThrowIfFailed(f.DS->get_CollectStatistics(&value));
+        Assert::IsFalse(!!value);
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_CollectStatistics(nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_Statistics(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_WhenNotCollecting_NothingIsRecorded)
+    {
+        Fixture f;
+
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(1);
+        f.DeviceContext->FlushMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, Color{ 255, 1, 2, 3 }));
+        ThrowIfFailed(f.DS->Flush());
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(0U, statistics.GeometryCount);
+        Assert::AreEqual(0LL, statistics.GeometryTime.Duration);
+        Assert::AreEqual(0U, statistics.FlushCount);
+        Assert::AreEqual(0LL, statistics.FlushTime.Duration);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_GeometryCallsAreCountedOnce)
+    {
+        Fixture f;
+        f.EnableStatistics();
+
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(3);
+        f.DeviceContext->DrawLineMethod.SetExpectedCalls(1);
+
+        for (int i = 0; i < 3; i++)
+        {
+            ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, Color{ 255, 1, 2, 3 }));
+        }
+
+        ThrowIfFailed(f.DS->DrawLineWithBrush(Vector2{ 1, 2 }, Vector2{ 3, 4 }, f.Brush.Get()));
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(4U, statistics.GeometryCount);
+        Assert::IsTrue(statistics.GeometryTime.Duration >= 0);
+        Assert::AreEqual(0U, statistics.DrawTextCount);
+        Assert::AreEqual(0U, statistics.DrawImageCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_DrawTextIsCounted)
+    {
+        Fixture f;
+        f.EnableStatistics();
+
+        f.DeviceContext->DrawTextLayoutMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->DrawTextLayoutWithBrush(f.TextLayout.Get(), Vector2{ 1, 2 }, f.Brush.Get()));
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(1U, statistics.DrawTextCount);
+        Assert::AreEqual(0U, statistics.GeometryCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_FlushIsCounted)
+    {
+        Fixture f;
+        f.EnableStatistics();
+
+        f.DeviceContext->FlushMethod.SetExpectedCalls(2);
+
+        ThrowIfFailed(f.DS->Flush());
+        ThrowIfFailed(f.DS->Flush());
+
+        Assert::AreEqual(2U, f.GetStatistics().FlushCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_LayerPushAndPopAreCounted)
+    {
+        Fixture f;
+        f.EnableStatistics();
+
+        f.DeviceContext->GetAntialiasModeMethod.AllowAnyCall();
+        f.DeviceContext->PushLayerMethod.SetExpectedCalls(1);
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacity(1.0f, &activeLayer));
+
+        f.DeviceContext->PopLayerMethod.SetExpectedCalls(1);
+        ThrowIfFailed(As<IClosable>(activeLayer)->Close());
+
+        Assert::AreEqual(2U, f.GetStatistics().LayerCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_CollectionCanBeTurnedOff)
+    {
+        Fixture f;
+        f.EnableStatistics();
+
+        f.DeviceContext->FlushMethod.SetExpectedCalls(2);
+
+        ThrowIfFailed(f.DS->Flush());
+        ThrowIfFailed(f.DS->put_CollectStatistics(false));
+        ThrowIfFailed(f.DS->Flush());
+
+        Assert::AreEqual(1U, f.GetStatistics().FlushCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_Statistics_CanBeReadAfterClose)
+    {
+        Fixture f;
+        f.EnableStatistics();
+
+        f.DeviceContext->FlushMethod.SetExpectedCalls(1);
+        ThrowIfFailed(f.DS->Flush());
+
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual(1U, f.GetStatistics().FlushCount);
+    }
+};
+
+TEST_CLASS(CanvasDrawingSession_StateChangeTests)
+{
+    struct Fixture : public CanvasDrawingSessionFixture
+    {
+        CanvasStateChangeStatistics GetStatistics()
+        {
+            CanvasStateChangeStatistics statistics;
+            ThrowIfFailed(DS->get_StateChangeStatistics(&statistics));
+            return statistics;
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_StateChangeStatistics_NullArg)
+    {
+        Fixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_StateChangeStatistics(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_SettingStateToItsCurrentValue_DoesNotCallDeviceContext)
+    {
+        Fixture f;
+
+        f.DeviceContext->SetAntialiasModeMethod.SetExpectedCalls(1);
+        f.DeviceContext->SetPrimitiveBlendMethod.SetExpectedCalls(1);
+        f.DeviceContext->SetTextAntialiasModeMethod.SetExpectedCalls(1);
+
+        for (int i = 0; i < 3; i++)
+        {
+            ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+            ThrowIfFailed(f.DS->put_Blend(CanvasBlend_Copy));
+            ThrowIfFailed(f.DS->put_TextAntialiasing(CanvasTextAntialiasing_Aliased));
+        }
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(2U, statistics.AntialiasingChangesAvoided);
+        Assert::AreEqual(2U, statistics.BlendChangesAvoided);
+        Assert::AreEqual(2U, statistics.TextAntialiasingChangesAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_SettingStateToADifferentValue_CallsDeviceContext)
+    {
+        Fixture f;
+
+        f.DeviceContext->SetAntialiasModeMethod.SetExpectedCalls(3);
+
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Antialiased));
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+
+        Assert::AreEqual(0U, f.GetStatistics().AntialiasingChangesAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_SettingStateToTheValueThatWasRead_DoesNotCallDeviceContext)
+    {
+        Fixture f;
+
+        f.DeviceContext->GetPrimitiveBlendMethod.SetExpectedCalls(1, [] { return D2D1_PRIMITIVE_BLEND_ADD; });
+        f.DeviceContext->SetPrimitiveBlendMethod.SetExpectedCalls(0);
+
+        CanvasBlend blend;
+        ThrowIfFailed(f.DS->get_Blend(&blend));
+        ThrowIfFailed(f.DS->put_Blend(blend));
+
+        Assert::AreEqual(1U, f.GetStatistics().BlendChangesAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_SettingTransformToItsCurrentValue_DoesNotCallDeviceContext)
+    {
+        Fixture f;
+
+        Matrix3x2 matrix{ 1, 2, 3, 4, 5, 6 };
+
+        f.DeviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+        f.DeviceContext->SetTransformMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->put_Transform(matrix));
+        ThrowIfFailed(f.DS->put_Transform(matrix));
+
+        Assert::AreEqual(1U, f.GetStatistics().TransformChangesAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_SettingUnitsToTheValueThatWasRead_DoesNotCallDeviceContext)
+    {
+        Fixture f;
+
+        f.DeviceContext->GetUnitModeMethod.SetExpectedCalls(1, [] { return D2D1_UNIT_MODE_PIXELS; });
+        f.DeviceContext->SetUnitModeMethod.SetExpectedCalls(0);
+
+        CanvasUnits units;
+        ThrowIfFailed(f.DS->get_Units(&units));
+        ThrowIfFailed(f.DS->put_Units(units));
+
+        Assert::AreEqual(1U, f.GetStatistics().UnitsChangesAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_AfterNativeResourceIsRetrieved_StateChangesAreNotElided)
+    {
+        Fixture f;
+
+        f.DeviceContext->SetAntialiasModeMethod.SetExpectedCalls(1);
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+
+        ComPtr<ID2D1DeviceContext1> deviceContext;
+        ThrowIfFailed(f.DS->GetNativeResource(nullptr, 0, IID_PPV_ARGS(&deviceContext)));
+
+        // The caller could have changed the state behind our back.
+        f.DeviceContext->SetAntialiasModeMethod.SetExpectedCalls(2);
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+
+        Assert::AreEqual(0U, f.GetStatistics().AntialiasingChangesAvoided);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WrappedDeviceContext_StateChangesAreNotElided)
+    {
+        auto deviceContext = Make<MockD2DDeviceContext>();
+        auto drawingSession = Make<CanvasDrawingSession>(deviceContext.Get());
+
+        deviceContext->SetPrimitiveBlendMethod.SetExpectedCalls(2);
+
+        ThrowIfFailed(drawingSession->put_Blend(CanvasBlend_Copy));
+        ThrowIfFailed(drawingSession->put_Blend(CanvasBlend_Copy));
+
+        ThrowIfFailed(drawingSession->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_DrawingAtTheOrigin_DoesNotChangeTransform)
+    {
+        Fixture f;
+
+        f.DeviceContext->GetTransformMethod.SetExpectedCalls(0);
+        f.DeviceContext->SetTransformMethod.SetExpectedCalls(0);
+        f.DeviceContext->DrawGeometryMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->DrawGeometryWithBrush(f.Geometry.Get(), Vector2{ 0, 0 }, f.Brush.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_StateChangeStatistics_CanBeReadAfterClose)
+    {
+        Fixture f;
+
+        f.DeviceContext->SetAntialiasModeMethod.SetExpectedCalls(1);
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+        ThrowIfFailed(f.DS->put_Antialiasing(CanvasAntialiasing_Aliased));
+
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual(1U, f.GetStatistics().AntialiasingChangesAvoided);
+    }
+};
+
+TEST_CLASS(CanvasDrawingSession_CullingTests)
+{
+    struct Fixture : public CanvasDrawingSessionFixture
+    {
+        ComPtr<MockD2DBitmap> Target;
+        D2D1_MATRIX_3X2_F Transform;
+        D2D1_UNIT_MODE UnitMode;
+        float Dpi;
+
+        Fixture()
+            : Target(Make<MockD2DBitmap>())
+            , Transform(D2D1::Matrix3x2F::Identity())
+            , UnitMode(D2D1_UNIT_MODE_DIPS)
+            , Dpi(DEFAULT_DPI)
+        {
+            Target->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 100, 100 }; });
+
+            DeviceContext->GetTargetMethod.AllowAnyCall([=] (ID2D1Image** value) { Target.CopyTo(value); });
+            DeviceContext->GetDpiMethod.AllowAnyCall([=] (float* dpiX, float* dpiY) { *dpiX = *dpiY = Dpi; });
+            DeviceContext->GetTransformMethod.AllowAnyCall([=] (D2D1_MATRIX_3X2_F* value) { *value = Transform; });
+            DeviceContext->GetUnitModeMethod.AllowAnyCall([=] { return UnitMode; });
+            DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_SOURCE_OVER; });
+            DeviceContext->GetAntialiasModeMethod.AllowAnyCall();
+
+            DeviceContext->CreateSolidColorBrushMethod.AllowAnyCall(
+                [] (D2D1_COLOR_F const*, D2D1_BRUSH_PROPERTIES const*, ID2D1SolidColorBrush** value)
+                {
+                    return Make<MockD2DSolidColorBrush>().CopyTo(value);
+                });
+        }
+
+        void EnableCulling()
+        {
+            ThrowIfFailed(DS->put_CullInvisibleDraws(true));
+        }
+
+        uint32_t GetCulledDrawCount()
+        {
+            uint32_t count;
+            ThrowIfFailed(DS->get_CulledDrawCount(&count));
+            return count;
+        }
+
+        ComPtr<CanvasBitmap> MakeBitmap()
+        {
+            auto d2dBitmap = Make<StubD2DBitmap>();
+            d2dBitmap->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 10, 10 }; });
+            d2dBitmap->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 10, 10 }; });
+
+            return Make<CanvasBitmap>(CanvasDevice.Get(), d2dBitmap.Get());
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_CullInvisibleDraws_DefaultsToFalse)
+    {
+        Fixture f;
+
+        boolean value = true;
+        ThrowIfFailed(f.DS->get_CullInvisibleDraws(&value));
+        Assert::IsFalse(!!value);
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_CullInvisibleDraws(nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_CulledDrawCount(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsDisabled_DrawsOutsideTheTargetAreNotCulled)
+    {
+        Fixture f;
+
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 500, 500, 10, 10 }, f.Brush.Get()));
+
+        Assert::AreEqual(0U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsEnabled_RectanglesOutsideTheTargetAreCulled)
+    {
+        Fixture f;
+        f.EnableCulling();
+
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(2);
+        f.DeviceContext->DrawRectangleMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 500, 500, 10, 10 }, f.Brush.Get()));
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ -50, 0, 10, 10 }, Color{ 255, 1, 2, 3 }));
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 10, 10, 10, 10 }, f.Brush.Get()));
+
+        // Partially visible.
+        ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 95, 95, 10, 10 }, Color{ 255, 1, 2, 3 }));
+
+        // The stroke reaches into the target.
+        ThrowIfFailed(f.DS->DrawRectangleWithBrushAndStrokeWidth(Rect{ 104, 0, 10, 10 }, f.Brush.Get(), 10));
+        ThrowIfFailed(f.DS->DrawRectangleWithBrushAndStrokeWidth(Rect{ 120, 0, 10, 10 }, f.Brush.Get(), 10));
+
+        Assert::AreEqual(3U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsEnabled_EllipsesOutsideTheTargetAreCulled)
+    {
+        Fixture f;
+        f.EnableCulling();
+
+        f.DeviceContext->FillEllipseMethod.SetExpectedCalls(1);
+        f.DeviceContext->DrawEllipseMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->FillEllipseWithBrush(Vector2{ 150, 50 }, 20, 20, f.Brush.Get()));
+        ThrowIfFailed(f.DS->FillEllipseWithColor(Vector2{ 110, 50 }, 20, 20, Color{ 255, 1, 2, 3 }));
+        ThrowIfFailed(f.DS->DrawEllipseWithBrush(Vector2{ 50, -30 }, 20, 20, f.Brush.Get()));
+        ThrowIfFailed(f.DS->DrawEllipseWithBrush(Vector2{ 50, -20 }, 20, 20, f.Brush.Get()));
+
+        Assert::AreEqual(2U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsEnabled_TransformAndDpiAreTakenIntoAccount)
+    {
+        Fixture f;
+        f.Dpi = DEFAULT_DPI * 2;
+        f.EnableCulling();
+
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(2);
+
+        // At 192 DPI, the 100 pixel target is 50 DIPs wide.
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 60, 0, 10, 10 }, f.Brush.Get()));
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 40, 0, 10, 10 }, f.Brush.Get()));
+
+        // The same rectangle is visible once it is moved back into view.
+        f.Transform = D2D1::Matrix3x2F::Translation(-30, 0);
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 60, 0, 10, 10 }, f.Brush.Get()));
+
+        // In pixel units there is no DPI scaling.
+        f.Transform = D2D1::Matrix3x2F::Identity();
+        f.UnitMode = D2D1_UNIT_MODE_PIXELS;
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 110, 0, 10, 10 }, f.Brush.Get()));
+
+        Assert::AreEqual(2U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsEnabled_LayerClipsAreTakenIntoAccount)
+    {
+        Fixture f;
+        f.EnableCulling();
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1);
+        f.DeviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(1);
+        f.DeviceContext->FillRectangleMethod.SetExpectedCalls(2);
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 0, 0, 20, 20 }, &activeLayer));
+
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 50, 50, 10, 10 }, f.Brush.Get()));
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 5, 5, 10, 10 }, f.Brush.Get()));
+
+        ThrowIfFailed(As<IClosable>(activeLayer)->Close());
+
+        // Once the layer is closed, only the target bounds apply again.
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 50, 50, 10, 10 }, f.Brush.Get()));
+
+        Assert::AreEqual(1U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsEnabled_BitmapsOutsideTheTargetAreCulled)
+    {
+        Fixture f;
+        f.EnableCulling();
+
+        auto bitmap = f.MakeBitmap();
+
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DS->DrawImageAtOffset(bitmap.Get(), Vector2{ 200, 0 }));
+        ThrowIfFailed(f.DS->DrawImageToRect(bitmap.Get(), Rect{ 0, 200, 10, 10 }));
+        ThrowIfFailed(f.DS->DrawImageAtOffset(bitmap.Get(), Vector2{ 95, 95 }));
+
+        Assert::AreEqual(2U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_WhenCullingIsEnabled_CachedGeometryOutsideTheTargetIsCulled)
+    {
+        Fixture f;
+        f.EnableCulling();
+
+        auto d2dGeometry = Make<MockD2DRectangleGeometry>();
+        d2dGeometry->GetBoundsMethod.SetExpectedCalls(1,
+            [] (D2D1_MATRIX_3X2_F const* transform, D2D1_RECT_F* bounds)
+            {
+                Assert::IsNull(transform);
+                *bounds = D2D1_RECT_F{ 0, 0, 10, 10 };
+                return S_OK;
+            });
+
+        auto geometry = Make<CanvasGeometry>(f.CanvasDevice.Get(), d2dGeometry.Get());
+        auto cachedGeometry = CanvasCachedGeometry::CreateNew(f.CanvasDevice.Get(), geometry.Get(), D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+        f.DeviceContext->DrawGeometryRealizationMethod.SetExpectedCalls(1);
+
+        f.Transform = D2D1::Matrix3x2F::Translation(300, 0);
+        ThrowIfFailed(f.DS->DrawCachedGeometryAtOriginWithBrush(cachedGeometry.Get(), f.Brush.Get()));
+        ThrowIfFailed(f.DS->DrawCachedGeometryAtOriginWithBrush(cachedGeometry.Get(), f.Brush.Get()));
+
+        f.Transform = D2D1::Matrix3x2F::Identity();
+        ThrowIfFailed(f.DS->DrawCachedGeometryAtOriginWithBrush(cachedGeometry.Get(), f.Brush.Get()));
+
+        Assert::AreEqual(2U, f.GetCulledDrawCount());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CulledDrawCount_CanBeReadAfterClose)
+    {
+        Fixture f;
+        f.EnableCulling();
+
+        ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 500, 500, 10, 10 }, f.Brush.Get()));
+
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual(1U, f.GetCulledDrawCount());
+    }
+};
+
+TEST_CLASS(CanvasDrawingSession_LayerPoolTests)
+{
+    struct Fixture : public CanvasDrawingSessionFixture
+    {
+        LayerPool* Pool;
+        std::vector<ID2D1Layer*> PushedLayers;
+        std::vector<D2D1_SIZE_F> CreatedLayerSizes;
+
+        Fixture()
+            : Pool(CanvasDevice->GetLayerPool())
+        {
+            Pool->SetMaximumBytes(16 * 1024 * 1024);
+
+            DeviceContext->GetAntialiasModeMethod.AllowAnyCall();
+            DeviceContext->GetTransformMethod.AllowAnyCall([] (D2D1_MATRIX_3X2_F* value) { *value = D2D1::Matrix3x2F::Identity(); });
+            DeviceContext->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 1000, 1000 }; });
+
+            DeviceContext->CreateLayerMethod.AllowAnyCall(
+                [=] (D2D1_SIZE_F const* size, ID2D1Layer** value)
+                {
+                    CreatedLayerSizes.push_back(*size);
+                    return Make<MockD2DLayer>().CopyTo(value);
+                });
+
+            DeviceContext->PushLayerMethod.AllowAnyCall(
+                [=] (D2D1_LAYER_PARAMETERS1 const*, ID2D1Layer* layer)
+                {
+                    PushedLayers.push_back(layer);
+                });
+
+            DeviceContext->PopLayerMethod.AllowAnyCall();
+        }
+
+        ComPtr<ICanvasActiveLayer> CreateLayer(Rect const& clipRectangle)
+        {
+            ComPtr<ICanvasActiveLayer> activeLayer;
+            ThrowIfFailed(DS->CreateLayerWithOpacityAndClipRectangle(0.5f, clipRectangle, &activeLayer));
+            return activeLayer;
+        }
+
+        static void Close(ComPtr<ICanvasActiveLayer> const& activeLayer)
+        {
+            ThrowIfFailed(As<IClosable>(activeLayer)->Close());
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_WhenDisabled_LayersAreNotPooled)
+    {
+        Fixture f;
+        f.Pool->SetMaximumBytes(0);
+
+        f.Close(f.CreateLayer(Rect{ 0, 0, 10, 10 }));
+
+        Assert::AreEqual<size_t>(1, f.PushedLayers.size());
+        Assert::IsNull(f.PushedLayers[0]);
+        Assert::AreEqual<size_t>(0, f.CreatedLayerSizes.size());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_LayersAreReusedOncePopped)
+    {
+        Fixture f;
+
+        for (int i = 0; i < 3; i++)
+        {
+            f.Close(f.CreateLayer(Rect{ 0, 0, 10, 10 }));
+        }
+
+        Assert::AreEqual<size_t>(1, f.CreatedLayerSizes.size());
+        Assert::AreEqual(D2D1_SIZE_F{ 64, 64 }, f.CreatedLayerSizes[0]);
+
+        Assert::AreEqual<size_t>(3, f.PushedLayers.size());
+        Assert::IsNotNull(f.PushedLayers[0]);
+        Assert::IsTrue(f.PushedLayers[0] == f.PushedLayers[1]);
+        Assert::IsTrue(f.PushedLayers[0] == f.PushedLayers[2]);
+
+        auto statistics = f.Pool->GetStatistics();
+        Assert::AreEqual(1U, statistics.CreateCount);
+        Assert::AreEqual(2U, statistics.ReuseCount);
+        Assert::AreEqual(1U, statistics.IdleLayerCount);
+        Assert::AreEqual<uint64_t>(64 * 64 * 4, statistics.SizeInBytes);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_NestedLayersDoNotShare)
+    {
+        Fixture f;
+
+        auto outer = f.CreateLayer(Rect{ 0, 0, 10, 10 });
+        auto inner = f.CreateLayer(Rect{ 0, 0, 10, 10 });
+
+        f.Close(inner);
+        f.Close(outer);
+
+        Assert::AreEqual<size_t>(2, f.CreatedLayerSizes.size());
+        Assert::IsFalse(f.PushedLayers[0] == f.PushedLayers[1]);
+        Assert::AreEqual(2U, f.Pool->GetStatistics().IdleLayerCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_LayersAreBucketedBySize)
+    {
+        Fixture f;
+
+        f.Close(f.CreateLayer(Rect{ 0, 0, 10, 10 }));
+        f.Close(f.CreateLayer(Rect{ 0, 0, 300, 100 }));
+        f.Close(f.CreateLayer(Rect{ 0, 0, 5000, 5000 }));    // clamped to the target size
+
+        Assert::AreEqual<size_t>(3, f.CreatedLayerSizes.size());
+        Assert::AreEqual(D2D1_SIZE_F{ 64, 64 }, f.CreatedLayerSizes[0]);
+        Assert::AreEqual(D2D1_SIZE_F{ 512, 128 }, f.CreatedLayerSizes[1]);
+        Assert::AreEqual(D2D1_SIZE_F{ 1024, 1024 }, f.CreatedLayerSizes[2]);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_IdleLayersAreEvictedToStayWithinBudget)
+    {
+        Fixture f;
+        f.Pool->SetMaximumBytes(64 * 64 * 4);
+
+        auto first = f.CreateLayer(Rect{ 0, 0, 10, 10 });
+        auto second = f.CreateLayer(Rect{ 0, 0, 10, 10 });
+
+        f.Close(second);
+        f.Close(first);
+
+        auto statistics = f.Pool->GetStatistics();
+        Assert::AreEqual(1U, statistics.EvictionCount);
+        Assert::AreEqual(1U, statistics.IdleLayerCount);
+
+        f.Pool->Clear();
+        Assert::AreEqual(0U, f.Pool->GetStatistics().IdleLayerCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_AxisAlignedClipsDoNotUseThePool)
+    {
+        Fixture f;
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1);
+        f.DeviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(1);
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 0, 0, 10, 10 }, &activeLayer));
+        f.Close(activeLayer);
+
+        Assert::AreEqual<size_t>(0, f.CreatedLayerSizes.size());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_WhenCreateLayerFails_NothingIsPushedOrCounted)
+    {
+        Fixture f;
+
+        f.DeviceContext->CreateLayerMethod.SetExpectedCalls(1,
+            [] (D2D1_SIZE_F const*, ID2D1Layer**)
+            {
+                return E_OUTOFMEMORY;
+            });
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        Assert::AreEqual(E_OUTOFMEMORY, f.DS->CreateLayerWithOpacityAndClipRectangle(0.5f, Rect{ 0, 0, 10, 10 }, &activeLayer));
+
+        Assert::AreEqual<size_t>(0, f.PushedLayers.size());
+        Assert::AreEqual(0U, f.Pool->GetStatistics().CreateCount);
+
+        // The failed layer must not be left on the stack for the next one to trip over.
+        f.DeviceContext->CreateLayerMethod.AllowAnyCall(
+            [] (D2D1_SIZE_F const*, ID2D1Layer** value)
+            {
+                return Make<MockD2DLayer>().CopyTo(value);
+            });
+
+        f.Close(f.CreateLayer(Rect{ 0, 0, 10, 10 }));
+
+        Assert::AreEqual<size_t>(1, f.PushedLayers.size());
+        Assert::AreEqual(1U, f.Pool->GetStatistics().CreateCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_LayerPool_LayersWithoutBoundsAreNotPooled)
+    {
+        Fixture f;
+
+        // Command list targets have no size.
+        f.DeviceContext->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 0, 0 }; });
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacity(0.5f, &activeLayer));
+        f.Close(activeLayer);
+
+        Assert::IsNull(f.PushedLayers[0]);
+        Assert::AreEqual<size_t>(0, f.CreatedLayerSizes.size());
+    }
+};
+
 TEST_CLASS(CanvasDrawingSession_Interop)
 {
     TEST_METHOD_EX(CanvasDrawingSession_Wrapper_DoesNotAutomaticallyCallAnyMethods)
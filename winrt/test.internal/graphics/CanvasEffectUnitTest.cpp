@@ -594,7 +594,17 @@ public:
             DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall();
             DeviceContext->SetTextAntialiasModeMethod.AllowAnyCall();
 
-            DeviceContext->SetTargetMethod.SetExpectedCalls(1,
+            // The leased context is reset when the drawing session closes.
+            DeviceContext->SetDpiMethod.AllowAnyCall();
+            DeviceContext->SetUnitModeMethod.AllowAnyCall();
+            DeviceContext->SetTransformMethod.AllowAnyCall();
+            DeviceContext->SetAntialiasModeMethod.AllowAnyCall();
+            DeviceContext->SetPrimitiveBlendMethod.AllowAnyCall();
+            DeviceContext->SetTextRenderingParamsMethod.AllowAnyCall();
+            DeviceContext->GetRenderingControlsMethod.AllowAnyCall();
+            DeviceContext->SetRenderingControlsMethod.AllowAnyCall();
+
+            DeviceContext->SetTargetMethod.AllowAnyCall(
                 [&] (ID2D1Image* newTarget)
                 {
                     CurrentTarget = newTarget;
@@ -620,7 +630,7 @@ public:
                     return d2dCl;
                 });
 
-            CanvasDevice->CreateDeviceContextForDrawingSessionMethod.SetExpectedCalls(1, [=] { return DeviceContext; });            
+            CanvasDevice->GetResourceCreationDeviceContextMethod.SetExpectedCalls(1, [=] { return DeviceContextLease(ComPtr<ID2D1DeviceContext1>(DeviceContext)); });
         }
 
         ComPtr<ICanvasCommandList> CreateCommandList()
@@ -0,0 +1,404 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <random>
+#include <lib/geometry/CanvasGeometryIndex.h>
+#include "mocks/MockD2DPathGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+typedef std::vector<D2D1_POINT_2F> Polygon;
+
+
+static Polygon MakeRectangle(float left, float top, float right, float bottom)
+{
+    return Polygon{ { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+}
+
+
+static std::vector<int32_t> ToVector(ComArray<int32_t> const& array)
+{
+    return std::vector<int32_t>(array.GetData(), array.GetData() + array.GetSize());
+}
+
+
+TEST_CLASS(CanvasGeometryIndexUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasGeometryIndex> Index;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , Index(Make<CanvasGeometryIndex>(D2D1_DEFAULT_FLATTENING_TOLERANCE))
+        {
+        }
+
+        // Makes a geometry whose simplified form is the specified polygons.
+        ComPtr<CanvasGeometry> MakeGeometry(
+            std::vector<Polygon> const& figures,
+            D2D1_FILL_MODE fillMode = D2D1_FILL_MODE_ALTERNATE,
+            D2D1_FIGURE_BEGIN figureBegin = D2D1_FIGURE_BEGIN_FILLED,
+            D2D1_FIGURE_END figureEnd = D2D1_FIGURE_END_CLOSED)
+        {
+            auto d2dGeometry = Make<MockD2DPathGeometry>();
+
+            d2dGeometry->GetBoundsMethod.AllowAnyCall(
+                [=](D2D1_MATRIX_3X2_F const* transform, D2D1_RECT_F* bounds)
+                {
+                    Assert::IsNull(transform);
+
+                    *bounds = D2D1_RECT_F{ INFINITY, INFINITY, -INFINITY, -INFINITY };
+
+                    for (auto& figure : figures)
+                    {
+                        for (auto& point : figure)
+                        {
+                            bounds->left = std::min(bounds->left, point.x);
+                            bounds->top = std::min(bounds->top, point.y);
+                            bounds->right = std::max(bounds->right, point.x);
+                            bounds->bottom = std::max(bounds->bottom, point.y);
+                        }
+                    }
+
+                    return S_OK;
+                });
+
+            d2dGeometry->SimplifyMethod.AllowAnyCall(
+                [=](D2D1_GEOMETRY_SIMPLIFICATION_OPTION option, D2D1_MATRIX_3X2_F const*, float flatteningTolerance, ID2D1SimplifiedGeometrySink* sink)
+                {
+                    Assert::IsTrue(option == D2D1_GEOMETRY_SIMPLIFICATION_OPTION_LINES);
+                    Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, flatteningTolerance);
+
+                    sink->SetFillMode(fillMode);
+
+                    for (auto& figure : figures)
+                    {
+                        sink->BeginFigure(figure[0], figureBegin);
+                        sink->AddLines(figure.data() + 1, static_cast<uint32_t>(figure.size() - 1));
+                        sink->EndFigure(figureEnd);
+                    }
+
+                    return S_OK;
+                });
+
+            return Make<CanvasGeometry>(Device.Get(), d2dGeometry.Get());
+        }
+
+        void Insert(int32_t id, std::vector<Polygon> const& figures)
+        {
+            ThrowIfFailed(Index->Insert(id, MakeGeometry(figures).Get()));
+        }
+
+        std::vector<int32_t> FindAtPoint(float x, float y, float tolerance = 0)
+        {
+            ComArray<int32_t> ids;
+            ThrowIfFailed(Index->FindAtPoint(Vector2{ x, y }, tolerance, ids.GetAddressOfSize(), ids.GetAddressOfData()));
+            return ToVector(ids);
+        }
+
+        std::vector<int32_t> FindInRectangle(float x, float y, float width, float height)
+        {
+            ComArray<int32_t> ids;
+            ThrowIfFailed(Index->FindInRectangle(Rect{ x, y, width, height }, ids.GetAddressOfSize(), ids.GetAddressOfData()));
+            return ToVector(ids);
+        }
+
+        std::vector<int32_t> FindNearest(float x, float y, float maximumDistance, uint32_t maximumCount)
+        {
+            ComArray<int32_t> ids;
+            ThrowIfFailed(Index->FindNearest(Vector2{ x, y }, maximumDistance, maximumCount, ids.GetAddressOfSize(), ids.GetAddressOfData()));
+            return ToVector(ids);
+        }
+
+        uint32_t GetCount()
+        {
+            uint32_t count;
+            ThrowIfFailed(Index->get_Count(&count));
+            return count;
+        }
+    };
+
+public:
+    TEST_METHOD_EX(CanvasGeometryIndex_Factory)
+    {
+        auto factory = Make<CanvasGeometryIndexFactory>();
+
+        ComPtr<IInspectable> inspectable;
+        ThrowIfFailed(factory->ActivateInstance(&inspectable));
+
+        float tolerance;
+        ThrowIfFailed(As<ICanvasGeometryIndex>(inspectable)->get_FlatteningTolerance(&tolerance));
+        Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tolerance);
+
+        ComPtr<ICanvasGeometryIndex> geometryIndex;
+        ThrowIfFailed(factory->Create(2, &geometryIndex));
+        ThrowIfFailed(geometryIndex->get_FlatteningTolerance(&tolerance));
+        Assert::AreEqual(2.0f, tolerance);
+
+        Assert::AreEqual(E_INVALIDARG, factory->Create(0, &geometryIndex));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::ExpectedPositiveNonzero);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_InsertReplaceAndRemove)
+    {
+        Fixture f;
+
+        f.Insert(1, { MakeRectangle(0, 0, 10, 10) });
+        f.Insert(2, { MakeRectangle(20, 0, 30, 10) });
+        Assert::AreEqual(2u, f.GetCount());
+
+        // Inserting an existing id moves it.
+        f.Insert(1, { MakeRectangle(40, 0, 50, 10) });
+        Assert::AreEqual(2u, f.GetCount());
+        Assert::IsTrue(f.FindAtPoint(5, 5).empty());
+        Assert::IsTrue(f.FindAtPoint(45, 5) == std::vector<int32_t>{ 1 });
+
+        boolean removed;
+        ThrowIfFailed(f.Index->Remove(1, &removed));
+        Assert::IsTrue(!!removed);
+        ThrowIfFailed(f.Index->Remove(1, &removed));
+        Assert::IsFalse(!!removed);
+
+        Assert::AreEqual(1u, f.GetCount());
+        Assert::IsTrue(f.FindAtPoint(45, 5).empty());
+        Assert::IsTrue(f.FindAtPoint(25, 5) == std::vector<int32_t>{ 2 });
+
+        ThrowIfFailed(f.Index->Clear());
+        Assert::AreEqual(0u, f.GetCount());
+        Assert::IsTrue(f.FindAtPoint(25, 5).empty());
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindAtPoint_UsesFillAndTolerance)
+    {
+        Fixture f;
+
+        f.Insert(7, { Polygon{ { 0, 0 }, { 10, 0 }, { 0, 10 } } });
+
+        Assert::IsTrue(f.FindAtPoint(2, 2) == std::vector<int32_t>{ 7 });
+
+        // Inside the bounds, but outside the triangle.
+        Assert::IsTrue(f.FindAtPoint(8, 8).empty());
+        Assert::IsTrue(f.FindAtPoint(8, 8, 5) == std::vector<int32_t>{ 7 });
+
+        Assert::IsTrue(f.FindAtPoint(-1, 5).empty());
+        Assert::IsTrue(f.FindAtPoint(-1, 5, 1) == std::vector<int32_t>{ 7 });
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindAtPoint_UsesFillMode)
+    {
+        Fixture f;
+
+        // A square with a square hole, both wound the same way.
+        std::vector<Polygon> figures{ MakeRectangle(0, 0, 10, 10), MakeRectangle(3, 3, 7, 7) };
+
+        ThrowIfFailed(f.Index->Insert(1, f.MakeGeometry(figures, D2D1_FILL_MODE_ALTERNATE).Get()));
+        ThrowIfFailed(f.Index->Insert(2, f.MakeGeometry(figures, D2D1_FILL_MODE_WINDING).Get()));
+
+        Assert::IsTrue(f.FindAtPoint(1, 1) == std::vector<int32_t>{ 1, 2 });
+        Assert::IsTrue(f.FindAtPoint(5, 5) == std::vector<int32_t>{ 2 });
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindAtPoint_HollowFiguresOnlyMatchTheirOutline)
+    {
+        Fixture f;
+
+        ThrowIfFailed(f.Index->Insert(1, f.MakeGeometry({ Polygon{ { 0, 0 }, { 10, 0 }, { 10, 10 } } }, D2D1_FILL_MODE_ALTERNATE, D2D1_FIGURE_BEGIN_HOLLOW, D2D1_FIGURE_END_OPEN).Get()));
+
+        Assert::IsTrue(f.FindAtPoint(8, 2).empty());
+        Assert::IsTrue(f.FindAtPoint(8, 2, 2) == std::vector<int32_t>{ 1 });
+
+        // The figure is open, so there is no line back to the start.
+        Assert::IsTrue(f.FindAtPoint(5, 5, 1).empty());
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindInRectangle)
+    {
+        Fixture f;
+
+        // A row of ten 10x10 squares, 20 apart.
+        for (int i = 0; i < 10; ++i)
+        {
+            f.Insert(i, { MakeRectangle(i * 20.0f, 0, i * 20.0f + 10, 10) });
+        }
+
+        f.Insert(100, { MakeRectangle(-1000, 100, 1000, 1000) });
+
+        Assert::IsTrue(f.FindInRectangle(15, 2, 30, 2) == std::vector<int32_t>{ 1, 2 });
+        Assert::IsTrue(f.FindInRectangle(11, 0, 8, 10).empty());
+
+        // Entirely inside a geometry.
+        Assert::IsTrue(f.FindInRectangle(0, 200, 10, 10) == std::vector<int32_t>{ 100 });
+
+        // Entirely containing a geometry.
+        Assert::IsTrue(f.FindInRectangle(-5, -5, 20, 20) == std::vector<int32_t>{ 0 });
+
+        // Overlapping the bounds of a triangle, but not the triangle itself.
+        f.Insert(200, { Polygon{ { 0, 300 }, { 10, 300 }, { 0, 310 } } });
+        Assert::IsTrue(f.FindInRectangle(8, 308, 5, 5).empty());
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindNearest)
+    {
+        Fixture f;
+
+        f.Insert(0, { MakeRectangle(0, 0, 10, 10) });
+        f.Insert(1, { MakeRectangle(20, 0, 30, 10) });
+        f.Insert(2, { MakeRectangle(40, 0, 50, 10) });
+
+        // 1 and 2 are both 5 away, and 0 is 25 away.
+        Assert::IsTrue(f.FindNearest(35, 5, INFINITY, 10) == std::vector<int32_t>{ 1, 2, 0 });
+        Assert::IsTrue(f.FindNearest(35, 5, INFINITY, 2) == std::vector<int32_t>{ 1, 2 });
+        Assert::IsTrue(f.FindNearest(35, 5, 10, 10) == std::vector<int32_t>{ 1, 2 });
+        Assert::IsTrue(f.FindNearest(35, 5, 4, 10).empty());
+        Assert::IsTrue(f.FindNearest(35, 5, INFINITY, 0).empty());
+
+        // Geometries containing the point are at distance zero.
+        Assert::IsTrue(f.FindNearest(9, 5, INFINITY, 1) == std::vector<int32_t>{ 0 });
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindAtPoints_ReturnsOffsetsIntoIds)
+    {
+        Fixture f;
+
+        f.Insert(1, { MakeRectangle(0, 0, 10, 10) });
+        f.Insert(2, { MakeRectangle(5, 5, 15, 15) });
+
+        Vector2 points[] = { { 1, 1 }, { 100, 100 }, { 7, 7 } };
+
+        ComArray<uint32_t> offsets;
+        ComArray<int32_t> ids;
+        ThrowIfFailed(f.Index->FindAtPoints(_countof(points), points, 0, offsets.GetAddressOfSize(), offsets.GetAddressOfData(), ids.GetAddressOfSize(), ids.GetAddressOfData()));
+
+        Assert::AreEqual(4u, offsets.GetSize());
+        Assert::AreEqual(0u, offsets[0]);
+        Assert::AreEqual(1u, offsets[1]);
+        Assert::AreEqual(1u, offsets[2]);
+        Assert::AreEqual(3u, offsets[3]);
+
+        Assert::IsTrue(ToVector(ids) == std::vector<int32_t>{ 1, 1, 2 });
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_EmptyGeometriesAreNeverFound)
+    {
+        Fixture f;
+
+        f.Insert(1, {});
+
+        Assert::AreEqual(1u, f.GetCount());
+        Assert::IsTrue(f.FindNearest(0, 0, INFINITY, 10).empty());
+        Assert::IsTrue(f.FindInRectangle(-1000, -1000, 2000, 2000).empty());
+
+        boolean removed;
+        ThrowIfFailed(f.Index->Remove(1, &removed));
+        Assert::IsTrue(!!removed);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_InvalidArguments)
+    {
+        Fixture f;
+
+        ComArray<int32_t> ids;
+
+        Assert::AreEqual(E_INVALIDARG, f.Index->Insert(1, nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, f.Index->FindAtPoint(Vector2{}, -1, ids.GetAddressOfSize(), ids.GetAddressOfData()));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::GeometryIndexInvalidDistance);
+
+        Assert::AreEqual(E_INVALIDARG, f.Index->FindNearest(Vector2{}, NAN, 1, ids.GetAddressOfSize(), ids.GetAddressOfData()));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::GeometryIndexInvalidDistance);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Closed)
+    {
+        Fixture f;
+
+        f.Insert(1, { MakeRectangle(0, 0, 10, 10) });
+
+        ThrowIfFailed(f.Index->Close());
+
+        uint32_t count;
+        boolean removed;
+        ComArray<int32_t> ids;
+
+        Assert::AreEqual(RO_E_CLOSED, f.Index->get_Count(&count));
+        Assert::AreEqual(RO_E_CLOSED, f.Index->Insert(1, f.MakeGeometry({ MakeRectangle(0, 0, 10, 10) }).Get()));
+        Assert::AreEqual(RO_E_CLOSED, f.Index->Remove(1, &removed));
+        Assert::AreEqual(RO_E_CLOSED, f.Index->FindAtPoint(Vector2{}, 0, ids.GetAddressOfSize(), ids.GetAddressOfData()));
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_ManyGeometries_MatchBruteForce)
+    {
+        Fixture f;
+
+        std::minstd_rand random(1234);
+        std::uniform_real_distribution<float> position(0, 1000);
+        std::uniform_real_distribution<float> size(1, 30);
+
+        // Random rectangles, so the expected results are easy to compute.
+        std::map<int32_t, D2D1_RECT_F> rectangles;
+
+        for (int32_t id = 0; id < 2000; ++id)
+        {
+            auto left = position(random);
+            auto top = position(random);
+            auto rect = D2D1_RECT_F{ left, top, left + size(random), top + size(random) };
+
+            f.Insert(id, { MakeRectangle(rect.left, rect.top, rect.right, rect.bottom) });
+            rectangles[id] = rect;
+        }
+
+        // Remove every third one, to exercise removal from all over the tree.
+        for (int32_t id = 0; id < 2000; id += 3)
+        {
+            boolean removed;
+            ThrowIfFailed(f.Index->Remove(id, &removed));
+            rectangles.erase(id);
+        }
+
+        Assert::AreEqual(static_cast<uint32_t>(rectangles.size()), f.GetCount());
+
+        // An unbalanced tree would be hundreds of levels deep.
+        Assert::IsTrue(f.Index->GetTreeHeight() < 24);
+
+        std::vector<Vector2> points;
+
+        for (int i = 0; i < 500; ++i)
+        {
+            points.push_back(Vector2{ position(random), position(random) });
+        }
+
+        ComArray<uint32_t> offsets;
+        ComArray<int32_t> allIds;
+        ThrowIfFailed(f.Index->FindAtPoints(static_cast<uint32_t>(points.size()), points.data(), 0, offsets.GetAddressOfSize(), offsets.GetAddressOfData(), allIds.GetAddressOfSize(), allIds.GetAddressOfData()));
+
+        for (uint32_t i = 0; i < points.size(); ++i)
+        {
+            auto& point = points[i];
+
+            std::vector<int32_t> expectedAtPoint;
+            std::vector<int32_t> expectedInRectangle;
+
+            for (auto& rectangle : rectangles)
+            {
+                auto& r = rectangle.second;
+
+                if (point.X > r.left && point.X < r.right && point.Y > r.top && point.Y < r.bottom)
+                    expectedAtPoint.push_back(rectangle.first);
+
+                if (point.X - 20 <= r.right && point.X + 20 >= r.left && point.Y - 20 <= r.bottom && point.Y + 20 >= r.top)
+                    expectedInRectangle.push_back(rectangle.first);
+            }
+
+            Assert::IsTrue(expectedAtPoint == f.FindAtPoint(point.X, point.Y));
+            Assert::IsTrue(expectedInRectangle == f.FindInRectangle(point.X - 20, point.Y - 20, 40, 40));
+
+            std::vector<int32_t> idsFromBatch(allIds.GetData() + offsets[i], allIds.GetData() + offsets[i + 1]);
+            Assert::IsTrue(expectedAtPoint == idsFromBatch);
+        }
+    }
+};
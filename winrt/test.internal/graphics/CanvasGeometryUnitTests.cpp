@@ -1211,6 +1211,104 @@ public:
         f.ValidateTessellatedTriangles(triangles);
     }
 
+    TEST_METHOD_EX(CanvasGeometry_TessellateWithEngine_Direct2D)
+    {
+        TessellateFixture f;
+        ComArray<CanvasTriangleVertices> triangles;
+
+        const float expectedTolerance = 23;
+
+        f.ExpectOneTessellateCall(sc_someD2DTransform, expectedTolerance);
+
+        ThrowIfFailed(f.RectangleGeometry->TessellateWithEngine(sc_someTransform, expectedTolerance, CanvasTessellationEngine::Direct2D, triangles.GetAddressOfSize(), triangles.GetAddressOfData()));
+
+        f.ValidateTessellatedTriangles(triangles);
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateWithEngine_Cpu_TessellatesStreamedPath)
+    {
+        Fixture f;
+
+        auto mockD2DPathGeometry = Make<MockD2DPathGeometry>();
+        auto canvasGeometry = Make<CanvasGeometry>(f.Device.Get(), mockD2DPathGeometry.Get());
+
+        mockD2DPathGeometry->StreamMethod.SetExpectedCalls(1,
+            [&](ID2D1GeometrySink* internalSink)
+            {
+                D2D1_POINT_2F points[] = { { 10, 0 }, { 10, 10 }, { 0, 10 } };
+
+                internalSink->BeginFigure(D2D1_POINT_2F{ 0, 0 }, D2D1_FIGURE_BEGIN_FILLED);
+                internalSink->AddLines(points, _countof(points));
+                internalSink->EndFigure(D2D1_FIGURE_END_CLOSED);
+                return S_OK;
+            });
+
+        ComArray<CanvasTriangleVertices> triangles;
+        ThrowIfFailed(canvasGeometry->TessellateWithEngine(Matrix3x2{ 2, 0, 0, 2, 0, 0 }, D2D1_DEFAULT_FLATTENING_TOLERANCE, CanvasTessellationEngine::Cpu, triangles.GetAddressOfSize(), triangles.GetAddressOfData()));
+
+        Assert::AreEqual(2u, triangles.GetSize());
+        Assert::AreEqual(Vector2{ 20, 0 }, triangles[0].Vertex2);
+        Assert::AreEqual(Vector2{ 20, 20 }, triangles[1].Vertex2);
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateToIndexedMesh_Direct2D_PassesTrianglesToMesh)
+    {
+        TessellateFixture f;
+
+        const float expectedTolerance = 23;
+
+        f.ExpectOneTessellateCall(sc_someD2DTransform, expectedTolerance);
+
+        ComPtr<ICanvasIndexedMesh> mesh;
+        ThrowIfFailed(f.RectangleGeometry->TessellateToIndexedMesh(sc_someTransform, expectedTolerance, CanvasTessellationEngine::Direct2D, CanvasIndexedMeshOptions::None, &mesh));
+
+        ComArray<Vector2> vertices;
+        ComArray<uint32_t> indices;
+        ThrowIfFailed(mesh->GetVertices(vertices.GetAddressOfSize(), vertices.GetAddressOfData()));
+        ThrowIfFailed(mesh->GetIndices(indices.GetAddressOfSize(), indices.GetAddressOfData()));
+
+        Assert::AreEqual(9u, vertices.GetSize());
+        Assert::AreEqual(9u, indices.GetSize());
+
+        for (uint32_t i = 0; i < indices.GetSize(); ++i)
+        {
+            Assert::AreEqual(i, indices[i]);
+        }
+
+        Assert::AreEqual(Vector2{ 1, 2 }, vertices[0]);
+        Assert::AreEqual(Vector2{ 17, 18 }, vertices[8]);
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateToIndexedMesh_Cpu_SharesVertices)
+    {
+        Fixture f;
+
+        auto mockD2DPathGeometry = Make<MockD2DPathGeometry>();
+        auto canvasGeometry = Make<CanvasGeometry>(f.Device.Get(), mockD2DPathGeometry.Get());
+
+        mockD2DPathGeometry->StreamMethod.SetExpectedCalls(1,
+            [&](ID2D1GeometrySink* internalSink)
+            {
+                D2D1_POINT_2F points[] = { { 10, 0 }, { 10, 10 }, { 0, 10 } };
+
+                internalSink->BeginFigure(D2D1_POINT_2F{ 0, 0 }, D2D1_FIGURE_BEGIN_FILLED);
+                internalSink->AddLines(points, _countof(points));
+                internalSink->EndFigure(D2D1_FIGURE_END_CLOSED);
+                return S_OK;
+            });
+
+        ComPtr<ICanvasIndexedMesh> mesh;
+        ThrowIfFailed(canvasGeometry->TessellateToIndexedMesh(Matrix3x2{ 1, 0, 0, 1, 0, 0 }, D2D1_DEFAULT_FLATTENING_TOLERANCE, CanvasTessellationEngine::Cpu, CanvasIndexedMeshOptions::None, &mesh));
+
+        // Two triangles, but only the four corners of the square.
+        uint32_t vertexCount, indexCount;
+        ThrowIfFailed(mesh->get_VertexCount(&vertexCount));
+        ThrowIfFailed(mesh->get_IndexCount(&indexCount));
+
+        Assert::AreEqual(4u, vertexCount);
+        Assert::AreEqual(6u, indexCount);
+    }
+
     TEST_METHOD_EX(CanvasGeometry_Tessellate_NullArgs)
     {
         GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
@@ -1221,6 +1319,14 @@ public:
 
         Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithTransformAndFlatteningTolerance(Matrix3x2{}, 0, nullptr, t.GetAddressOfData()));
         Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithTransformAndFlatteningTolerance(Matrix3x2{}, 0, t.GetAddressOfSize(), nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithEngine(Matrix3x2{}, 0, CanvasTessellationEngine::Cpu, nullptr, t.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithEngine(Matrix3x2{}, 0, CanvasTessellationEngine::Cpu, t.GetAddressOfSize(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithEngine(Matrix3x2{}, 0, static_cast<CanvasTessellationEngine>(2), t.GetAddressOfSize(), t.GetAddressOfData()));
+
+        ComPtr<ICanvasIndexedMesh> mesh;
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateToIndexedMesh(Matrix3x2{}, 0, CanvasTessellationEngine::Cpu, CanvasIndexedMeshOptions::None, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateToIndexedMesh(Matrix3x2{}, 0, static_cast<CanvasTessellationEngine>(2), CanvasIndexedMeshOptions::None, &mesh));
     }
 
     TEST_METHOD_EX(CanvasGeometry_Closure)
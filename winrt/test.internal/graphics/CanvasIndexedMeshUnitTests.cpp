@@ -0,0 +1,222 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/geometry/CanvasIndexedMesh.h>
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+// Two triangles that make up a 10x10 square.
+static std::vector<CanvasTriangleVertices> const sc_square =
+{
+    { Vector2{ 0, 0 },  Vector2{ 10, 0 },  Vector2{ 0, 10 } },
+    { Vector2{ 10, 0 }, Vector2{ 10, 10 }, Vector2{ 0, 10 } },
+};
+
+
+static ComPtr<CanvasIndexedMesh> MakeMesh(std::vector<CanvasTriangleVertices> const& triangles, CanvasIndexedMeshOptions options = CanvasIndexedMeshOptions::None)
+{
+    IndexedMeshBuilder builder;
+    builder.AddTriangles(triangles.data(), static_cast<uint32_t>(triangles.size()));
+    return builder.CreateMesh(options);
+}
+
+
+// A grid of width x height squares, each made of two triangles.
+static std::vector<CanvasTriangleVertices> MakeGrid(uint32_t width, uint32_t height)
+{
+    std::vector<CanvasTriangleVertices> triangles;
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            auto left = static_cast<float>(x);
+            auto top = static_cast<float>(y);
+
+            triangles.push_back({ Vector2{ left, top },     Vector2{ left + 1, top },     Vector2{ left, top + 1 } });
+            triangles.push_back({ Vector2{ left + 1, top }, Vector2{ left + 1, top + 1 }, Vector2{ left, top + 1 } });
+        }
+    }
+
+    return triangles;
+}
+
+
+TEST_CLASS(CanvasIndexedMeshUnitTests)
+{
+public:
+    TEST_METHOD_EX(CanvasIndexedMesh_SharedVertices_AreMerged)
+    {
+        auto mesh = MakeMesh(sc_square);
+
+        ComArray<Vector2> vertices;
+        ComArray<uint32_t> indices;
+        ThrowIfFailed(mesh->GetVertices(vertices.GetAddressOfSize(), vertices.GetAddressOfData()));
+        ThrowIfFailed(mesh->GetIndices(indices.GetAddressOfSize(), indices.GetAddressOfData()));
+
+        Assert::AreEqual(4u, vertices.GetSize());
+        Assert::AreEqual(6u, indices.GetSize());
+
+        uint32_t expectedIndices[] = { 0, 1, 2, 1, 3, 2 };
+
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            Assert::AreEqual(expectedIndices[i], indices[i]);
+        }
+
+        // Indexing the vertices gives back the original triangles.
+        for (uint32_t i = 0; i < 6; i += 3)
+        {
+            auto& triangle = sc_square[i / 3];
+
+            Assert::AreEqual(triangle.Vertex1, vertices[indices[i]]);
+            Assert::AreEqual(triangle.Vertex2, vertices[indices[i + 1]]);
+            Assert::AreEqual(triangle.Vertex3, vertices[indices[i + 2]]);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_PositiveAndNegativeZero_AreTheSameVertex)
+    {
+        auto mesh = MakeMesh(
+            {
+                { Vector2{ 0, 0 },   Vector2{ 1, 0 }, Vector2{ 0, 1 } },
+                { Vector2{ -0.0f, -0.0f }, Vector2{ 0, 1 }, Vector2{ -1, 0 } },
+            });
+
+        uint32_t vertexCount;
+        ThrowIfFailed(mesh->get_VertexCount(&vertexCount));
+        Assert::AreEqual(4u, vertexCount);
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_IndexFormat_DependsOnVertexCountAndOptions)
+    {
+        CanvasIndexFormat format;
+
+        ThrowIfFailed(MakeMesh(sc_square)->get_IndexFormat(&format));
+        Assert::AreEqual(CanvasIndexFormat::UInt16, format);
+
+        ThrowIfFailed(MakeMesh(sc_square, CanvasIndexedMeshOptions::Force32BitIndices)->get_IndexFormat(&format));
+        Assert::AreEqual(CanvasIndexFormat::UInt32, format);
+
+        // 256x256 squares have 257x257 vertices, which is too many for 16 bit indices.
+        ThrowIfFailed(MakeMesh(MakeGrid(255, 255))->get_IndexFormat(&format));
+        Assert::AreEqual(CanvasIndexFormat::UInt16, format);
+
+        ThrowIfFailed(MakeMesh(MakeGrid(256, 256))->get_IndexFormat(&format));
+        Assert::AreEqual(CanvasIndexFormat::UInt32, format);
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_CopyIndexBytesTo_UsesIndexFormat)
+    {
+        for (auto options : { CanvasIndexedMeshOptions::None, CanvasIndexedMeshOptions::Force32BitIndices })
+        {
+            auto mesh = MakeMesh(sc_square, options);
+
+            uint32_t indexSize = (options == CanvasIndexedMeshOptions::None) ? 2 : 4;
+
+            std::vector<uint8_t> bytes(6 * indexSize);
+            ThrowIfFailed(mesh->CopyIndexBytesTo(static_cast<uint32_t>(bytes.size()), bytes.data()));
+
+            // Indices are little endian; the fourth index is 1.
+            Assert::AreEqual<uint8_t>(1, bytes[3 * indexSize]);
+            Assert::AreEqual<uint8_t>(0, bytes[3 * indexSize + 1]);
+
+            Assert::AreEqual(E_INVALIDARG, mesh->CopyIndexBytesTo(static_cast<uint32_t>(bytes.size() - 1), bytes.data()));
+            ValidateStoredErrorState(E_INVALIDARG, Strings::IndexedMeshBufferTooSmall);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_CopyVerticesTo)
+    {
+        auto mesh = MakeMesh(sc_square);
+
+        Vector2 vertices[4];
+        ThrowIfFailed(mesh->CopyVerticesTo(_countof(vertices), vertices));
+
+        Assert::AreEqual(Vector2{ 10, 10 }, vertices[3]);
+
+        Assert::AreEqual(E_INVALIDARG, mesh->CopyVerticesTo(3, vertices));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::IndexedMeshBufferTooSmall);
+
+        Assert::AreEqual(E_INVALIDARG, mesh->CopyVerticesTo(4, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_EdgeFlags_MarkOutlineVertices)
+    {
+        // In a 2x2 grid, only the center vertex is not on the outline.
+        auto mesh = MakeMesh(MakeGrid(2, 2), CanvasIndexedMeshOptions::IncludeEdgeFlags);
+
+        boolean hasEdgeFlags;
+        ThrowIfFailed(mesh->get_HasEdgeFlags(&hasEdgeFlags));
+        Assert::IsTrue(!!hasEdgeFlags);
+
+        ComArray<Vector2> vertices;
+        ComArray<uint8_t> flags;
+        ThrowIfFailed(mesh->GetVertices(vertices.GetAddressOfSize(), vertices.GetAddressOfData()));
+        ThrowIfFailed(mesh->GetEdgeFlags(flags.GetAddressOfSize(), flags.GetAddressOfData()));
+
+        Assert::AreEqual(9u, flags.GetSize());
+
+        for (uint32_t i = 0; i < flags.GetSize(); ++i)
+        {
+            bool isCenter = (vertices[i] == Vector2{ 1, 1 });
+
+            Assert::AreEqual<uint8_t>(isCenter ? 0 : 1, flags[i]);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_GetEdgeFlags_FailsWhenNotRequested)
+    {
+        auto mesh = MakeMesh(sc_square);
+
+        boolean hasEdgeFlags;
+        ThrowIfFailed(mesh->get_HasEdgeFlags(&hasEdgeFlags));
+        Assert::IsFalse(!!hasEdgeFlags);
+
+        ComArray<uint8_t> flags;
+        Assert::AreEqual(E_INVALIDARG, mesh->GetEdgeFlags(flags.GetAddressOfSize(), flags.GetAddressOfData()));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::IndexedMeshHasNoEdgeFlags);
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_EmptyMesh)
+    {
+        auto mesh = MakeMesh({});
+
+        ComArray<Vector2> vertices;
+        ComArray<uint32_t> indices;
+        ThrowIfFailed(mesh->GetVertices(vertices.GetAddressOfSize(), vertices.GetAddressOfData()));
+        ThrowIfFailed(mesh->GetIndices(indices.GetAddressOfSize(), indices.GetAddressOfData()));
+
+        Assert::AreEqual(0u, vertices.GetSize());
+        Assert::AreEqual(0u, indices.GetSize());
+    }
+
+    TEST_METHOD_EX(CanvasIndexedMesh_Grid_IsMuchSmallerThanTriangleList)
+    {
+        // Shared vertices save memory even on a small grid.  Timings for
+        // detailed tessellations are in PerformanceTests.
+        uint32_t const size = 8;
+
+        auto triangles = MakeGrid(size, size);
+        auto mesh = MakeMesh(triangles);
+
+        uint32_t vertexCount, indexCount;
+        CanvasIndexFormat format;
+        ThrowIfFailed(mesh->get_VertexCount(&vertexCount));
+        ThrowIfFailed(mesh->get_IndexCount(&indexCount));
+        ThrowIfFailed(mesh->get_IndexFormat(&format));
+
+        Assert::AreEqual((size + 1) * (size + 1), vertexCount);
+        Assert::AreEqual(size * size * 6, indexCount);
+        Assert::AreEqual(CanvasIndexFormat::UInt16, format);
+
+        auto triangleListBytes = triangles.size() * sizeof(CanvasTriangleVertices);
+        auto meshBytes = vertexCount * sizeof(Vector2) + indexCount * sizeof(uint16_t);
+
+        Assert::IsTrue(meshBytes * 2 < triangleListBytes);
+    }
+};
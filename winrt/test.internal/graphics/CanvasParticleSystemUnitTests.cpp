@@ -0,0 +1,378 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include <WindowsNumerics.h>
+
+#include <lib/drawing/CanvasParticleSystem.h>
+#include <lib/drawing/CanvasSpriteBatch.h>
+#include "../mocks/MockD2DSpriteBatch.h"
+
+using namespace Windows::Foundation::Numerics;
+
+
+static ComPtr<ICanvasParticleSystem> MakeParticleSystem(uint32_t capacity)
+{
+    ComPtr<ICanvasParticleSystemFactory> factory;
+    ThrowIfFailed(MakeAndInitialize<CanvasParticleSystemFactory>(&factory));
+
+    ComPtr<ICanvasParticleSystem> particleSystem;
+    ThrowIfFailed(factory->Create(capacity, &particleSystem));
+    return particleSystem;
+}
+
+
+static CanvasParticleEmitterDescription MakeEmitter()
+{
+    CanvasParticleEmitterDescription emitter{};
+
+    emitter.Position = Vector2{ 10, 20 };
+    emitter.Velocity = Vector2{ 1, 2 };
+    emitter.Lifetime = 2;
+    emitter.StartSize = 1;
+    emitter.EndSize = 3;
+    emitter.StartColor = Vector4{ 0, 0, 0, 1 };
+    emitter.EndColor = Vector4{ 1, 1, 1, 0 };
+
+    return emitter;
+}
+
+
+TEST_CLASS(CanvasParticleSystemUnitTests)
+{
+public:
+
+    struct Fixture
+    {
+        ComPtr<MockD2DDeviceContext> DeviceContext;
+        ComPtr<StubD2DBitmap> D2DBitmap;
+        ComPtr<CanvasBitmap> Bitmap;
+        ComPtr<CanvasSpriteBatch> SpriteBatch;
+
+        std::vector<D2D1_COLOR_F> Colors;
+        std::vector<D2D1_MATRIX_3X2_F> Transforms;
+
+        Fixture()
+            : DeviceContext(Make<MockD2DDeviceContext>())
+            , D2DBitmap(Make<StubD2DBitmap>(D2D1_BITMAP_OPTIONS_NONE, DEFAULT_DPI))
+            , Bitmap(Make<CanvasBitmap>(Make<MockCanvasDevice>().Get(), D2DBitmap.Get()))
+        {
+            D2DBitmap->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 100.0f, 50.0f }; });
+            D2DBitmap->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 100U, 50U }; });
+
+            DeviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+            DeviceContext->GetAntialiasModeMethod.AllowAnyCall([] { return D2D1_ANTIALIAS_MODE_ALIASED; });
+
+            auto d3dDevice = Make<MockD3D11Device>();
+            d3dDevice->GetAdapterMethod.AllowAnyCall(
+                [] (IDXGIAdapter** adapter)
+                {
+                    auto dxgiAdapter = Make<StubDxgiAdapter>();
+                    dxgiAdapter->GetDescMethod.AllowAnyCall([] (DXGI_ADAPTER_DESC* d) { *d = DXGI_ADAPTER_DESC{}; return S_OK; });
+                    return dxgiAdapter.CopyTo(adapter);
+                });
+            d3dDevice->GetFeatureLevelMethod.AllowAnyCall([] { return D3D_FEATURE_LEVEL_11_1; });
+
+            auto d2dDevice = Make<MockD2DDevice>(d3dDevice.Get());
+            DeviceContext->GetDeviceMethod.AllowAnyCall([=] (ID2D1Device** d) { return d2dDevice.CopyTo(d); });
+
+            SpriteBatch = Make<CanvasSpriteBatch>(
+                DeviceContext,
+                CanvasSpriteSortMode::None,
+                D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+                D2D1_SPRITE_OPTIONS_NONE);
+        }
+
+        uint32_t SpriteCount()
+        {
+            CanvasSpriteBatchStatistics statistics;
+            ThrowIfFailed(SpriteBatch->get_Statistics(&statistics));
+            return statistics.SpriteCount;
+        }
+
+        // Closes the sprite batch, capturing the sprites that it passes to D2D.
+        void CloseSpriteBatch()
+        {
+            auto d2dSpriteBatch = Make<MockD2DSpriteBatch>();
+
+            DeviceContext->CreateSpriteBatchMethod.AllowAnyCall(
+                [=] (ID2D1SpriteBatch** value)
+                {
+                    return d2dSpriteBatch.CopyTo(value);
+                });
+
+            d2dSpriteBatch->AddSpritesMethod.AllowAnyCall(
+                [=] (uint32_t count, const D2D1_RECT_F*, const D2D1_RECT_U*, const D2D1_COLOR_F* colors, const D2D1_MATRIX_3X2_F* transforms, uint32_t, uint32_t, uint32_t colorStride, uint32_t transformStride)
+                {
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        Colors.push_back(*reinterpret_cast<D2D1_COLOR_F const*>(reinterpret_cast<uint8_t const*>(colors) + colorStride * i));
+                        Transforms.push_back(*reinterpret_cast<D2D1_MATRIX_3X2_F const*>(reinterpret_cast<uint8_t const*>(transforms) + transformStride * i));
+                    }
+                    return S_OK;
+                });
+
+            DeviceContext->DrawSpriteBatchMethod.AllowAnyCall();
+
+            ThrowIfFailed(SpriteBatch->Close());
+        }
+
+        Fixture(Fixture const&) = delete;
+        Fixture& operator=(Fixture const&) = delete;
+    };
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Create_FailsWithInvalidParameters)
+    {
+        ComPtr<ICanvasParticleSystemFactory> factory;
+        ThrowIfFailed(MakeAndInitialize<CanvasParticleSystemFactory>(&factory));
+
+        ComPtr<ICanvasParticleSystem> particleSystem;
+
+        Assert::AreEqual(E_INVALIDARG, factory->Create(1, nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, factory->Create(0, &particleSystem));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::ParticleSystemInvalidCapacity);
+
+        // Capacities that would wrap around when padded to a group of four.
+        for (auto capacity : { UINT32_MAX - 2, UINT32_MAX - 1, UINT32_MAX })
+        {
+            Assert::AreEqual(E_INVALIDARG, factory->Create(capacity, &particleSystem));
+            ValidateStoredErrorState(E_INVALIDARG, Strings::ParticleSystemInvalidCapacity);
+        }
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Create_HasCapacityAndNoParticles)
+    {
+        auto particleSystem = MakeParticleSystem(123);
+
+        uint32_t capacity = 0;
+        ThrowIfFailed(particleSystem->get_Capacity(&capacity));
+        Assert::AreEqual(123U, capacity);
+
+        uint32_t count = 1;
+        ThrowIfFailed(particleSystem->get_ParticleCount(&count));
+        Assert::AreEqual(0U, count);
+
+        Vector2 gravity{ 1, 1 };
+        ThrowIfFailed(particleSystem->get_Gravity(&gravity));
+        Assert::AreEqual(0.0f, gravity.X);
+        Assert::AreEqual(0.0f, gravity.Y);
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Properties_FailWhenPassedNull)
+    {
+        auto particleSystem = MakeParticleSystem(1);
+
+        Assert::AreEqual(E_INVALIDARG, particleSystem->get_Capacity(nullptr));
+        Assert::AreEqual(E_INVALIDARG, particleSystem->get_ParticleCount(nullptr));
+        Assert::AreEqual(E_INVALIDARG, particleSystem->get_Gravity(nullptr));
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_MethodsFail_AfterClosed)
+    {
+        Fixture f;
+        auto particleSystem = MakeParticleSystem(1);
+
+        ThrowIfFailed(As<IClosable>(particleSystem)->Close());
+
+        uint32_t value;
+        Vector2 gravity;
+
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->get_Capacity(&value));
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->get_ParticleCount(&value));
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->get_Gravity(&gravity));
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->put_Gravity(Vector2{}));
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->Emit(MakeEmitter(), 1));
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->Update(1));
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->Clear());
+        Assert::AreEqual(RO_E_CLOSED, particleSystem->Draw(f.SpriteBatch.Get(), f.Bitmap.Get()));
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Emit_FailsWhenLifetimeIsNotPositive)
+    {
+        auto particleSystem = MakeParticleSystem(1);
+        auto emitter = MakeEmitter();
+
+        for (auto lifetime : { 0.0f, -1.0f, std::numeric_limits<float>::quiet_NaN() })
+        {
+            emitter.Lifetime = lifetime;
+
+            Assert::AreEqual(E_INVALIDARG, particleSystem->Emit(emitter, 1));
+            ValidateStoredErrorState(E_INVALIDARG, Strings::ParticleEmitterInvalidLifetime);
+        }
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Emit_StopsAtCapacity)
+    {
+        auto particleSystem = MakeParticleSystem(10);
+
+        ThrowIfFailed(particleSystem->Emit(MakeEmitter(), 7));
+        ThrowIfFailed(particleSystem->Emit(MakeEmitter(), 7));
+
+        uint32_t count = 0;
+        ThrowIfFailed(particleSystem->get_ParticleCount(&count));
+        Assert::AreEqual(10U, count);
+
+        ThrowIfFailed(particleSystem->Clear());
+
+        ThrowIfFailed(particleSystem->get_ParticleCount(&count));
+        Assert::AreEqual(0U, count);
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Update_FailsWhenElapsedTimeIsNegative)
+    {
+        auto particleSystem = MakeParticleSystem(1);
+
+        Assert::AreEqual(E_INVALIDARG, particleSystem->Update(-1));
+        Assert::AreEqual(E_INVALIDARG, particleSystem->Update(std::numeric_limits<float>::quiet_NaN()));
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Update_RemovesExpiredParticles)
+    {
+        auto particleSystem = MakeParticleSystem(10);
+
+        auto shortLived = MakeEmitter();
+        shortLived.Lifetime = 1;
+
+        ThrowIfFailed(particleSystem->Emit(shortLived, 3));
+        ThrowIfFailed(particleSystem->Emit(MakeEmitter(), 2));
+        ThrowIfFailed(particleSystem->Emit(shortLived, 3));
+
+        ThrowIfFailed(particleSystem->Update(1));
+
+        uint32_t count = 0;
+        ThrowIfFailed(particleSystem->get_ParticleCount(&count));
+        Assert::AreEqual(2U, count);
+
+        ThrowIfFailed(particleSystem->Update(1));
+
+        ThrowIfFailed(particleSystem->get_ParticleCount(&count));
+        Assert::AreEqual(0U, count);
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Draw_FailsWhenPassedNull)
+    {
+        Fixture f;
+        auto particleSystem = MakeParticleSystem(1);
+
+        Assert::AreEqual(E_INVALIDARG, particleSystem->Draw(nullptr, f.Bitmap.Get()));
+        Assert::AreEqual(E_INVALIDARG, particleSystem->Draw(f.SpriteBatch.Get(), nullptr));
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Draw_WithNoParticles_AddsNoSprites)
+    {
+        Fixture f;
+        auto particleSystem = MakeParticleSystem(1);
+
+        ThrowIfFailed(particleSystem->Draw(f.SpriteBatch.Get(), f.Bitmap.Get()));
+
+        Assert::AreEqual(0U, f.SpriteCount());
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Draw_AddsIntegratedAndInterpolatedSprites)
+    {
+        Fixture f;
+        auto particleSystem = MakeParticleSystem(5);
+
+        ThrowIfFailed(particleSystem->put_Gravity(Vector2{ 0, 4 }));
+        ThrowIfFailed(particleSystem->Emit(MakeEmitter(), 5));
+        ThrowIfFailed(particleSystem->Update(1));
+
+        ThrowIfFailed(particleSystem->Draw(f.SpriteBatch.Get(), f.Bitmap.Get()));
+
+        f.CloseSpriteBatch();
+
+        // Velocity becomes (1, 6), so position becomes (11, 26).  Halfway
+        // through its lifetime, the size is 2, so the 100x50 bitmap is
+        // scaled by 2 and centered on the position.
+        D2D1_MATRIX_3X2_F expectedTransform{ 2, 0, 0, 2, 11 - 100, 26 - 50 };
+        D2D1_COLOR_F expectedColor{ 0.5f, 0.5f, 0.5f, 0.5f };
+
+        Assert::AreEqual<size_t>(5, f.Transforms.size());
+
+        for (size_t i = 0; i < f.Transforms.size(); ++i)
+        {
+            Assert::AreEqual(expectedTransform, f.Transforms[i]);
+            Assert::AreEqual(expectedColor, f.Colors[i]);
+        }
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_Emit_IsDeterministicWithVariance)
+    {
+        auto emitter = MakeEmitter();
+        emitter.PositionVariance = Vector2{ 5, 5 };
+        emitter.VelocityVariance = Vector2{ 5, 5 };
+        emitter.LifetimeVariance = 0.5f;
+
+        std::vector<D2D1_MATRIX_3X2_F> results[2];
+
+        for (auto& result : results)
+        {
+            Fixture f;
+            auto particleSystem = MakeParticleSystem(100);
+
+            ThrowIfFailed(particleSystem->Emit(emitter, 100));
+            ThrowIfFailed(particleSystem->Update(0.1f));
+            ThrowIfFailed(particleSystem->Draw(f.SpriteBatch.Get(), f.Bitmap.Get()));
+
+            f.CloseSpriteBatch();
+            result = f.Transforms;
+        }
+
+        Assert::AreEqual<size_t>(100, results[0].size());
+        Assert::IsTrue(results[0] == results[1]);
+        Assert::IsFalse(results[0].front() == results[0].back());
+    }
+
+
+    TEST_METHOD_EX(CanvasParticleSystem_SimulateAndDraw_AcrossSeveralThreads)
+    {
+        // Enough groups of four for more than two chunks of work, with a
+        // partial group at the end.
+        const uint32_t particleCount = 2048 * 4 * 2 + 3;
+
+        Fixture f;
+        auto particleSystem = MakeParticleSystem(particleCount);
+
+        ThrowIfFailed(particleSystem->put_Gravity(Vector2{ 0, 4 }));
+        ThrowIfFailed(particleSystem->Emit(MakeEmitter(), particleCount));
+        ThrowIfFailed(particleSystem->Update(1));
+
+        ThrowIfFailed(particleSystem->Draw(f.SpriteBatch.Get(), f.Bitmap.Get()));
+
+        Assert::AreEqual(particleCount, f.SpriteCount());
+
+        f.CloseSpriteBatch();
+
+        Assert::AreEqual<size_t>(particleCount, f.Transforms.size());
+
+        // Every particle started identical, so however the work was split
+        // across threads they must all have ended up in the same place.
+        D2D1_MATRIX_3X2_F expectedTransform{ 2, 0, 0, 2, 11 - 100, 26 - 50 };
+        D2D1_COLOR_F expectedColor{ 0.5f, 0.5f, 0.5f, 0.5f };
+
+        for (size_t i = 0; i < f.Transforms.size(); ++i)
+        {
+            Assert::AreEqual(expectedTransform, f.Transforms[i]);
+            Assert::AreEqual(expectedColor, f.Colors[i]);
+        }
+    }
+};
+
+#endif
@@ -70,10 +70,18 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
         ExpectHResultException(RO_E_CLOSED, [&]{ pathBuilderInternal->GetDevice(); });
     }
 
-    TEST_METHOD_EX(CanvasPathBuilder_CreationOpensGeometrySink)
+    TEST_METHOD_EX(CanvasPathBuilder_GeometrySinkIsOpenedWhenPathIsCreated)
     {
         SetupFixture f;
 
+        f.Device->CreatePathGeometryMethod.SetExpectedCalls(0);
+
+        auto canvasPathBuilder = Make<CanvasPathBuilder>(f.Device.Get());
+
+        ThrowIfFailed(canvasPathBuilder->BeginFigure(Vector2{}));
+        ThrowIfFailed(canvasPathBuilder->AddLine(Vector2{ 1, 2 }));
+        ThrowIfFailed(canvasPathBuilder->EndFigure(CanvasFigureLoop::Open));
+
         f.Device->CreatePathGeometryMethod.SetExpectedCalls(1,
             []
             {
@@ -83,13 +91,19 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                     [](ID2D1GeometrySink** out)
                     {
                         auto geometrySink = Make<MockD2DGeometrySink>();
+
+                        geometrySink->BeginFigureMethod.SetExpectedCalls(1);
+                        geometrySink->AddLinesMethod.SetExpectedCalls(1);
+                        geometrySink->EndFigureMethod.SetExpectedCalls(1);
+                        geometrySink->CloseMethod.SetExpectedCalls(1);
+
                         return geometrySink.CopyTo(out);
                     });
 
                 return pathGeometry;
             });
 
-        auto canvasPathBuilder = Make<CanvasPathBuilder>(f.Device.Get());
+        CanvasGeometry::CreateNew(canvasPathBuilder.Get());
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_CanOnlyCreateOneGeometry)
@@ -146,6 +160,12 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
             GeometrySink->BeginFigureMethod.AllowAnyCall();
         }
 
+        // Commands are recorded until the path is needed, so tests send
+        // them on to the D2D sink explicitly.
+        void SendRecordedCommands()
+        {
+            As<ICanvasPathBuilderInternal>(PathBuilder)->GetGeometrySink();
+        }
     };
 
     TEST_METHOD_EX(CanvasPathBuilder_BeginFigure)
@@ -159,6 +179,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_FIGURE_BEGIN_FILLED, figureBegin);
             });
         ThrowIfFailed(f.PathBuilder->BeginFigure(Vector2{ 1, 2 }));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_BeginFigureWithFigureFill)
@@ -172,6 +193,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_FIGURE_BEGIN_HOLLOW, figureBegin);
             });
         ThrowIfFailed(f.PathBuilder->BeginFigureWithFigureFill(Vector2{ 1, 2 }, CanvasFigureFill::DoesNotAffectFills));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_BeginFigureAtCoords)
@@ -185,6 +207,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_FIGURE_BEGIN_FILLED, figureBegin);
             });
         ThrowIfFailed(f.PathBuilder->BeginFigureAtCoords(1, 2));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_BeginFigureAtCoordsWithFigureFill)
@@ -198,6 +221,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_FIGURE_BEGIN_HOLLOW, figureBegin);
             });
         ThrowIfFailed(f.PathBuilder->BeginFigureAtCoordsWithFigureFill(1, 2, CanvasFigureFill::DoesNotAffectFills));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddArcToPoint)
@@ -216,6 +240,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_ARC_SIZE_LARGE, arc->arcSize);
             });
         ThrowIfFailed(f.PathBuilder->AddArcToPoint(Vector2{ 1, 2 }, 3.0f, 4.0f, 0.0f, CanvasSweepDirection::Clockwise, CanvasArcSize::Large));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddArcToPoint_ExpectsRadians)
@@ -237,6 +262,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                     Assert::AreEqual(angle, radians, 0.0001f);
                 });
             ThrowIfFailed(f.PathBuilder->AddArcToPoint(Vector2{}, 0, 0, angle, CanvasSweepDirection::Clockwise, CanvasArcSize::Large));
+            f.SendRecordedCommands();
         }
     }
 
@@ -294,10 +320,11 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
 
         for (auto& testPass : testPasses)
         {
-            f.GeometrySink->AddLineMethod.SetExpectedCalls(1, [&](D2D1_POINT_2F point)
+            f.GeometrySink->AddLinesMethod.SetExpectedCalls(1, [&](D2D1_POINT_2F const* points, uint32_t count)
             {
-                Assert::AreEqual(testPass.ExpectedStart.x, point.x, epsilon);
-                Assert::AreEqual(testPass.ExpectedStart.y, point.y, epsilon);
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(testPass.ExpectedStart.x, points[0].x, epsilon);
+                Assert::AreEqual(testPass.ExpectedStart.y, points[0].y, epsilon);
             });
 
             int whichArcIsThis = 0;
@@ -317,6 +344,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
             });
 
             ThrowIfFailed(f.PathBuilder->AddArcAroundEllipse(Vector2{ cX, cY }, rX, rY, testPass.StartAngle, testPass.SweepAngle));
+            f.SendRecordedCommands();
         }
     }
 
@@ -344,14 +372,16 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
 
         f.PathBuilder->BeginFigure(Vector2{});
 
-        f.GeometrySink->AddBezierMethod.SetExpectedCalls(1,
-            [](const D2D1_BEZIER_SEGMENT* segment)
+        f.GeometrySink->AddBeziersMethod.SetExpectedCalls(1,
+            [](const D2D1_BEZIER_SEGMENT* segments, uint32_t count)
             {
-                Assert::AreEqual(D2D1::Point2F(1, 2), segment->point1);
-                Assert::AreEqual(D2D1::Point2F(3, 4), segment->point2);
-                Assert::AreEqual(D2D1::Point2F(5, 6), segment->point3);
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1::Point2F(1, 2), segments->point1);
+                Assert::AreEqual(D2D1::Point2F(3, 4), segments->point2);
+                Assert::AreEqual(D2D1::Point2F(5, 6), segments->point3);
             });
         ThrowIfFailed(f.PathBuilder->AddCubicBezier(Vector2{ 1, 2 }, Vector2{ 3, 4 }, Vector2{ 5, 6 }));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddCubicBezier_InvalidState)
@@ -369,12 +399,14 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
 
         f.PathBuilder->BeginFigure(Vector2{});
 
-        f.GeometrySink->AddLineMethod.SetExpectedCalls(1,
-            [](D2D1_POINT_2F point)
+        f.GeometrySink->AddLinesMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F const* points, uint32_t count)
             {
-                Assert::AreEqual(D2D1::Point2F(1, 2), point);
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1::Point2F(1, 2), points[0]);
             });
         ThrowIfFailed(f.PathBuilder->AddLine(Vector2{ 1, 2 }));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddLine_InvalidState)
@@ -392,12 +424,14 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
 
         f.PathBuilder->BeginFigure(Vector2{});
 
-        f.GeometrySink->AddLineMethod.SetExpectedCalls(1,
-            [](D2D1_POINT_2F point)
+        f.GeometrySink->AddLinesMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F const* points, uint32_t count)
             {
-                Assert::AreEqual(D2D1::Point2F(1, 2), point);
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1::Point2F(1, 2), points[0]);
             });
         ThrowIfFailed(f.PathBuilder->AddLineWithCoords(1, 2));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddLineWithCoords_InvalidState)
@@ -415,13 +449,15 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
 
         f.PathBuilder->BeginFigure(Vector2{});
 
-        f.GeometrySink->AddQuadraticBezierMethod.SetExpectedCalls(1,
-            [](const D2D1_QUADRATIC_BEZIER_SEGMENT* segment)
+        f.GeometrySink->AddQuadraticBeziersMethod.SetExpectedCalls(1,
+            [](const D2D1_QUADRATIC_BEZIER_SEGMENT* segments, uint32_t count)
             {
-                Assert::AreEqual(D2D1::Point2F(1, 2), segment->point1);
-                Assert::AreEqual(D2D1::Point2F(3, 4), segment->point2);
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1::Point2F(1, 2), segments->point1);
+                Assert::AreEqual(D2D1::Point2F(3, 4), segments->point2);
             });
         ThrowIfFailed(f.PathBuilder->AddQuadraticBezier(Vector2{ 1, 2 }, Vector2{ 3, 4 }));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddQuadraticBezier_InvalidState)
@@ -443,6 +479,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_PATH_SEGMENT_FORCE_ROUND_LINE_JOIN, pathSegment);
             });
         ThrowIfFailed(f.PathBuilder->SetSegmentOptions(CanvasFigureSegmentOptions::ForceRoundLineJoin));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_SetFilledRegionDetermination)
@@ -455,6 +492,7 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
                 Assert::AreEqual(D2D1_FILL_MODE_WINDING, fillMode);
             });
         ThrowIfFailed(f.PathBuilder->SetFilledRegionDetermination(CanvasFilledRegionDetermination::Winding));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_SetFilledRegionDetermination_InvalidAfterBeginFigure)
@@ -499,6 +537,33 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
             });
         ThrowIfFailed(f.PathBuilder->BeginFigure(Vector2{}));
         ThrowIfFailed(f.PathBuilder->EndFigure(CanvasFigureLoop::Closed));
+        f.SendRecordedCommands();
+    }
+
+    TEST_METHOD_EX(CanvasPathBuilder_InvalidEnums_ReturnInvalidArg)
+    {
+        SinkAccessFixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->SetFilledRegionDetermination(static_cast<CanvasFilledRegionDetermination>(2)));
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->SetSegmentOptions(static_cast<CanvasFigureSegmentOptions>(4)));
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->BeginFigureWithFigureFill(Vector2{}, static_cast<CanvasFigureFill>(2)));
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->BeginFigureAtCoordsWithFigureFill(0, 0, static_cast<CanvasFigureFill>(256)));
+
+        ThrowIfFailed(f.PathBuilder->BeginFigure(Vector2{}));
+
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->AddArcToPoint(Vector2{ 1, 1 }, 1, 1, 0, static_cast<CanvasSweepDirection>(2), CanvasArcSize::Small));
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->AddArcToPoint(Vector2{ 1, 1 }, 1, 1, 0, CanvasSweepDirection::Clockwise, static_cast<CanvasArcSize>(256)));
+        Assert::AreEqual(E_INVALIDARG, f.PathBuilder->EndFigure(static_cast<CanvasFigureLoop>(2)));
+
+        // None of the invalid calls were recorded.
+        f.GeometrySink->AddArcMethod.SetExpectedCalls(0);
+        f.GeometrySink->SetFillModeMethod.SetExpectedCalls(0);
+        f.GeometrySink->SetSegmentFlagsMethod.SetExpectedCalls(0);
+        f.GeometrySink->BeginFigureMethod.SetExpectedCalls(1);
+        f.GeometrySink->EndFigureMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.PathBuilder->EndFigure(CanvasFigureLoop::Closed));
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_DoubleClose_NothingBadHappens)
@@ -578,16 +643,27 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
         auto mockD2DPathGeometry = Make<MockD2DPathGeometry>();
         auto pathGeometry = Make<CanvasGeometry>(f.Device.Get(), mockD2DPathGeometry.Get());
 
-        auto canvasPathBuilder = Make<CanvasPathBuilder>(f.Device.Get());
-
         mockD2DPathGeometry->StreamMethod.SetExpectedCalls(1,
-            [f](ID2D1GeometrySink* geometrySink)
+            [](ID2D1GeometrySink* geometrySink)
             {
-                Assert::AreEqual(static_cast<ID2D1GeometrySink*>(f.GeometrySink.Get()), geometrySink);
+                geometrySink->BeginFigure(D2D1::Point2F(1, 2), D2D1_FIGURE_BEGIN_FILLED);
+                geometrySink->AddLine(D2D1::Point2F(3, 4));
+                geometrySink->EndFigure(D2D1_FIGURE_END_CLOSED);
                 return S_OK;
             });
 
-        Assert::AreEqual(S_OK, canvasPathBuilder->AddGeometry(pathGeometry.Get()));
+        Assert::AreEqual(S_OK, f.PathBuilder->AddGeometry(pathGeometry.Get()));
+
+        // The streamed path is recorded along with everything else.
+        f.GeometrySink->AddLinesMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F const* points, uint32_t count)
+            {
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1::Point2F(3, 4), points[0]);
+            });
+        f.GeometrySink->EndFigureMethod.SetExpectedCalls(1);
+
+        f.SendRecordedCommands();
     }
 
     TEST_METHOD_EX(CanvasPathBuilder_AddGeometryWithNonPath_CausesSimplify)
@@ -597,19 +673,95 @@ TEST_CLASS(CanvasPathBuilderUnitTests)
         auto mockD2DRectangleGeometry = Make<MockD2DRectangleGeometry>();
         auto rectangleGeometry = Make<CanvasGeometry>(f.Device.Get(), mockD2DRectangleGeometry.Get());
 
-        auto canvasPathBuilder = Make<CanvasPathBuilder>(f.Device.Get());
-
         mockD2DRectangleGeometry->SimplifyMethod.SetExpectedCalls(1,
-            [f](D2D1_GEOMETRY_SIMPLIFICATION_OPTION simplification, CONST D2D1_MATRIX_3X2_F* transform, FLOAT tol, ID2D1SimplifiedGeometrySink* geometrySink)
+            [](D2D1_GEOMETRY_SIMPLIFICATION_OPTION simplification, CONST D2D1_MATRIX_3X2_F* transform, FLOAT tol, ID2D1SimplifiedGeometrySink* geometrySink)
             {
                 Assert::AreEqual(D2D1_GEOMETRY_SIMPLIFICATION_OPTION_CUBICS_AND_LINES, simplification);
                 Assert::IsNull(transform);
                 Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tol);
-                Assert::AreEqual(static_cast<ID2D1SimplifiedGeometrySink*>(f.GeometrySink.Get()), geometrySink);
+                Assert::IsNotNull(geometrySink);
                 return S_OK;
             });
 
-        Assert::AreEqual(S_OK, canvasPathBuilder->AddGeometry(rectangleGeometry.Get()));
+        Assert::AreEqual(S_OK, f.PathBuilder->AddGeometry(rectangleGeometry.Get()));
     }
 
+    TEST_METHOD_EX(CanvasPathBuilder_RecordedRunsAreSentInSingleCalls)
+    {
+        SinkAccessFixture f;
+
+        f.GeometrySink->AddLinesMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F const* points, uint32_t count)
+            {
+                Assert::AreEqual(3u, count);
+
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    Assert::AreEqual(D2D1::Point2F(static_cast<float>(i), 1), points[i]);
+                }
+            });
+
+        f.GeometrySink->AddBeziersMethod.SetExpectedCalls(1,
+            [](D2D1_BEZIER_SEGMENT const*, uint32_t count)
+            {
+                Assert::AreEqual(2u, count);
+            });
+
+        f.GeometrySink->EndFigureMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.PathBuilder->BeginFigure(Vector2{}));
+
+        for (int i = 0; i < 3; i++)
+        {
+            ThrowIfFailed(f.PathBuilder->AddLine(Vector2{ static_cast<float>(i), 1 }));
+        }
+
+        ThrowIfFailed(f.PathBuilder->AddCubicBezier(Vector2{}, Vector2{}, Vector2{}));
+        ThrowIfFailed(f.PathBuilder->AddCubicBezier(Vector2{}, Vector2{}, Vector2{}));
+        ThrowIfFailed(f.PathBuilder->EndFigure(CanvasFigureLoop::Closed));
+
+        // Nothing reaches D2D until the path is needed.
+        Assert::AreEqual(0, f.GeometrySink->AddLinesMethod.GetCurrentCallCount());
+
+        f.GeometrySink->CloseMethod.SetExpectedCalls(1);
+
+        CanvasGeometry::CreateNew(f.PathBuilder.Get());
+    }
+
+    TEST_METHOD_EX(CanvasPathBuilder_LongRecordedRuns_AreSentOncePerFigure)
+    {
+        const uint32_t figureCount = 3;
+        const uint32_t segmentsPerFigure = 1000;
+
+        SinkAccessFixture f;
+
+        uint32_t figure = 0;
+
+        f.GeometrySink->EndFigureMethod.SetExpectedCalls(figureCount, [&](D2D1_FIGURE_END) { ++figure; });
+        f.GeometrySink->CloseMethod.SetExpectedCalls(1);
+        f.GeometrySink->AddLinesMethod.SetExpectedCalls(figureCount,
+            [&](D2D1_POINT_2F const* points, uint32_t count)
+            {
+                Assert::AreEqual(segmentsPerFigure, count);
+
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    Assert::AreEqual(D2D1::Point2F(static_cast<float>(i), static_cast<float>(figure)), points[i]);
+                }
+            });
+
+        for (uint32_t j = 0; j < figureCount; j++)
+        {
+            ThrowIfFailed(f.PathBuilder->BeginFigure(Vector2{ 0, static_cast<float>(j) }));
+
+            for (uint32_t i = 0; i < segmentsPerFigure; i++)
+            {
+                ThrowIfFailed(f.PathBuilder->AddLine(Vector2{ static_cast<float>(i), static_cast<float>(j) }));
+            }
+
+            ThrowIfFailed(f.PathBuilder->EndFigure(CanvasFigureLoop::Closed));
+        }
+
+        CanvasGeometry::CreateNew(f.PathBuilder.Get());
+    }
 };
@@ -0,0 +1,279 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <random>
+#include <lib/geometry/CanvasPathSampler.h>
+#include "mocks/MockD2DPathGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+typedef std::vector<D2D1_POINT_2F> Polyline;
+
+static const float Epsilon = 0.0001f;
+
+
+static void AssertVectorsEqual(Vector2 const& expected, Vector2 const& actual, float tolerance = Epsilon)
+{
+    Assert::AreEqual(expected.X, actual.X, tolerance);
+    Assert::AreEqual(expected.Y, actual.Y, tolerance);
+}
+
+
+TEST_CLASS(CanvasPathSamplerUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasPathSamplerFactory> Factory;
+        float ExpectedFlatteningTolerance;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , Factory(Make<CanvasPathSamplerFactory>())
+            , ExpectedFlatteningTolerance(D2D1_DEFAULT_FLATTENING_TOLERANCE)
+        {
+        }
+
+        // Makes a geometry whose simplified form is the specified polylines.
+        ComPtr<CanvasGeometry> MakeGeometry(
+            std::vector<Polyline> const& figures,
+            D2D1_FIGURE_END figureEnd = D2D1_FIGURE_END_OPEN)
+        {
+            auto d2dGeometry = Make<MockD2DPathGeometry>();
+
+            d2dGeometry->SimplifyMethod.AllowAnyCall(
+                [=](D2D1_GEOMETRY_SIMPLIFICATION_OPTION option, D2D1_MATRIX_3X2_F const* transform, float flatteningTolerance, ID2D1SimplifiedGeometrySink* sink)
+                {
+                    Assert::IsTrue(option == D2D1_GEOMETRY_SIMPLIFICATION_OPTION_LINES);
+                    Assert::IsNull(transform);
+                    Assert::AreEqual(ExpectedFlatteningTolerance, flatteningTolerance);
+
+                    for (auto& figure : figures)
+                    {
+                        sink->BeginFigure(figure[0], D2D1_FIGURE_BEGIN_HOLLOW);
+                        sink->AddLines(figure.data() + 1, static_cast<uint32_t>(figure.size() - 1));
+                        sink->EndFigure(figureEnd);
+                    }
+
+                    return S_OK;
+                });
+
+            return Make<CanvasGeometry>(Device.Get(), d2dGeometry.Get());
+        }
+
+        ComPtr<ICanvasPathSampler> Create(
+            std::vector<Polyline> const& figures,
+            D2D1_FIGURE_END figureEnd = D2D1_FIGURE_END_OPEN)
+        {
+            ComPtr<ICanvasPathSampler> sampler;
+            ThrowIfFailed(Factory->Create(MakeGeometry(figures, figureEnd).Get(), &sampler));
+            return sampler;
+        }
+    };
+
+    static float GetTotalLength(ComPtr<ICanvasPathSampler> const& sampler)
+    {
+        float length;
+        ThrowIfFailed(sampler->get_TotalLength(&length));
+        return length;
+    }
+
+    static Vector2 ComputePointOnPath(ComPtr<ICanvasPathSampler> const& sampler, float distance, Vector2* tangent = nullptr)
+    {
+        Vector2 point;
+        Vector2 unusedTangent;
+        ThrowIfFailed(sampler->ComputePointOnPathWithTangent(distance, tangent ? tangent : &unusedTangent, &point));
+        return point;
+    }
+
+public:
+    TEST_METHOD_EX(CanvasPathSampler_Factory)
+    {
+        Fixture f;
+
+        std::vector<Polyline> figures{ Polyline{ { 0, 0 }, { 10, 0 } } };
+
+        ComPtr<ICanvasPathSampler> sampler;
+        ThrowIfFailed(f.Factory->Create(f.MakeGeometry(figures).Get(), &sampler));
+
+        float tolerance;
+        ThrowIfFailed(sampler->get_FlatteningTolerance(&tolerance));
+        Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tolerance);
+
+        f.ExpectedFlatteningTolerance = 2;
+        ThrowIfFailed(f.Factory->CreateWithFlatteningTolerance(f.MakeGeometry(figures).Get(), 2, &sampler));
+        ThrowIfFailed(sampler->get_FlatteningTolerance(&tolerance));
+        Assert::AreEqual(2.0f, tolerance);
+
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CreateWithFlatteningTolerance(f.MakeGeometry(figures).Get(), 0, &sampler));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::ExpectedPositiveNonzero);
+
+        Assert::AreEqual(E_INVALIDARG, f.Factory->Create(nullptr, &sampler));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->Create(f.MakeGeometry(figures).Get(), nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasPathSampler_TotalLength)
+    {
+        Fixture f;
+
+        Assert::AreEqual(11.0f, GetTotalLength(f.Create({ Polyline{ { 0, 0 }, { 3, 4 }, { 3, 10 } } })), Epsilon);
+
+        // Closed figures include their closing line.
+        Assert::AreEqual(40.0f, GetTotalLength(f.Create({ Polyline{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } } }, D2D1_FIGURE_END_CLOSED)), Epsilon);
+
+        // Figures follow each other, without counting the gap between them.
+        Assert::AreEqual(15.0f, GetTotalLength(f.Create({ Polyline{ { 0, 0 }, { 10, 0 } }, Polyline{ { 100, 100 }, { 100, 105 } } })), Epsilon);
+    }
+
+    TEST_METHOD_EX(CanvasPathSampler_ComputePointOnPath)
+    {
+        Fixture f;
+
+        auto sampler = f.Create({ Polyline{ { 0, 0 }, { 10, 0 } }, Polyline{ { 100, 100 }, { 100, 100 }, { 100, 110 } } });
+
+        Vector2 tangent;
+
+        AssertVectorsEqual(Vector2{ 4, 0 }, ComputePointOnPath(sampler, 4, &tangent));
+        AssertVectorsEqual(Vector2{ 1, 0 }, tangent);
+
+        // The repeated point in the second figure adds no length.
+        AssertVectorsEqual(Vector2{ 100, 103 }, ComputePointOnPath(sampler, 13, &tangent));
+        AssertVectorsEqual(Vector2{ 0, 1 }, tangent);
+
+        // Distances outside the path are clamped to its ends.
+        AssertVectorsEqual(Vector2{ 0, 0 }, ComputePointOnPath(sampler, -5));
+        AssertVectorsEqual(Vector2{ 0, 0 }, ComputePointOnPath(sampler, NAN));
+        AssertVectorsEqual(Vector2{ 100, 110 }, ComputePointOnPath(sampler, 1000, &tangent));
+        AssertVectorsEqual(Vector2{ 0, 1 }, tangent);
+
+        Vector2 point;
+        ThrowIfFailed(sampler->ComputePointOnPath(5, &point));
+        AssertVectorsEqual(Vector2{ 5, 0 }, point);
+
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointOnPath(5, nullptr));
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointOnPathWithTangent(5, nullptr, &point));
+    }
+
+    TEST_METHOD_EX(CanvasPathSampler_EmptyPath)
+    {
+        Fixture f;
+
+        auto sampler = f.Create({});
+
+        Assert::AreEqual(0.0f, GetTotalLength(sampler));
+
+        Vector2 tangent;
+        AssertVectorsEqual(Vector2{ 0, 0 }, ComputePointOnPath(sampler, 1, &tangent));
+        AssertVectorsEqual(Vector2{ 0, 0 }, tangent);
+
+        // A single point has no length, but still has a position.
+        sampler = f.Create({ Polyline{ { 3, 4 } } });
+
+        Assert::AreEqual(0.0f, GetTotalLength(sampler));
+        AssertVectorsEqual(Vector2{ 3, 4 }, ComputePointOnPath(sampler, 1, &tangent));
+        AssertVectorsEqual(Vector2{ 0, 0 }, tangent);
+    }
+
+    TEST_METHOD_EX(CanvasPathSampler_ComputePointsOnPath_MatchesSingleQueries)
+    {
+        Fixture f;
+
+        // A zigzag with many segments of different lengths.
+        Polyline zigzag;
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> step(0.1f, 10);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            zigzag.push_back(D2D1_POINT_2F{ i * 5.0f, (i % 2) ? step(random) : -step(random) });
+        }
+
+        auto sampler = f.Create({ zigzag });
+        auto totalLength = GetTotalLength(sampler);
+
+        // An odd count, so the tail after the last group of four is used.
+        std::vector<float> distances(10003);
+        std::uniform_real_distribution<float> distance(-10, totalLength + 10);
+
+        for (auto& d : distances)
+        {
+            d = distance(random);
+        }
+
+        // Sorted distances take the fast path through the segment search.
+        auto sortedDistances = distances;
+        std::sort(sortedDistances.begin(), sortedDistances.end());
+
+        for (auto& input : { distances, sortedDistances })
+        {
+            auto count = static_cast<uint32_t>(input.size());
+
+            std::vector<Vector2> points(count);
+            std::vector<Vector2> tangents(count);
+
+            ThrowIfFailed(sampler->ComputePointsOnPath(count, const_cast<float*>(input.data()), count, points.data(), count, tangents.data()));
+
+            // Groups of four are interpolated with SIMD, which may round
+            // differently from the single queries far from the origin.
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Vector2 expectedTangent;
+                AssertVectorsEqual(ComputePointOnPath(sampler, input[i], &expectedTangent), points[i], 0.001f);
+                AssertVectorsEqual(expectedTangent, tangents[i]);
+            }
+
+            // Tangents are optional.
+            std::vector<Vector2> pointsOnly(count);
+            ThrowIfFailed(sampler->ComputePointsOnPath(count, const_cast<float*>(input.data()), count, pointsOnly.data(), 0, nullptr));
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                AssertVectorsEqual(points[i], pointsOnly[i]);
+            }
+        }
+    }
+
+    TEST_METHOD_EX(CanvasPathSampler_ComputePointsOnPath_ValidatesArrays)
+    {
+        Fixture f;
+
+        auto sampler = f.Create({ Polyline{ { 0, 0 }, { 10, 0 } } });
+
+        float distances[3]{ 1, 2, 3 };
+        Vector2 points[3];
+        Vector2 tangents[3];
+
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointsOnPath(3, distances, 2, points, 0, nullptr));
+        ValidateStoredErrorState(E_INVALIDARG, L"The array points was expected to be of size 3; actual array was of size 2.");
+
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointsOnPath(3, distances, 3, points, 2, tangents));
+        ValidateStoredErrorState(E_INVALIDARG, L"The array tangents was expected to be of size 3; actual array was of size 2.");
+
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointsOnPath(3, nullptr, 3, points, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointsOnPath(3, distances, 3, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, sampler->ComputePointsOnPath(3, distances, 3, points, 3, nullptr));
+
+        ThrowIfFailed(sampler->ComputePointsOnPath(0, nullptr, 0, nullptr, 0, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasPathSampler_Closed)
+    {
+        Fixture f;
+
+        auto sampler = f.Create({ Polyline{ { 0, 0 }, { 10, 0 } } });
+
+        ThrowIfFailed(As<IClosable>(sampler)->Close());
+
+        float value;
+        Vector2 point;
+        float distance = 1;
+
+        Assert::AreEqual(RO_E_CLOSED, sampler->get_TotalLength(&value));
+        Assert::AreEqual(RO_E_CLOSED, sampler->get_FlatteningTolerance(&value));
+        Assert::AreEqual(RO_E_CLOSED, sampler->ComputePointOnPath(1, &point));
+        Assert::AreEqual(RO_E_CLOSED, sampler->ComputePointsOnPath(1, &distance, 1, &point, 0, nullptr));
+    }
+};
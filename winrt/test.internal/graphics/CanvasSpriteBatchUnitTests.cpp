@@ -1298,6 +1298,305 @@ public:
     }
 
 
+    //
+    // DrawMany
+    //
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyMethodsFailWhenPassedNullParameters)
+    {
+        DrawFixture f;
+
+        auto bitmap = f.Bitmap.Get();
+        Vector2 offset{};
+        Rect rect{};
+        Matrix3x2 transform{};
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(nullptr, 1, &offset, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyToRects(nullptr, 1, &rect, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyWithTransforms(nullptr, 1, &transform, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(nullptr, 1, &offset, 1, &rect, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetToRects(nullptr, 1, &rect, 1, &rect, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetWithTransforms(nullptr, 1, &transform, 1, &rect, 0, nullptr, 0, nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(bitmap, 1, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyToRects(bitmap, 1, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyWithTransforms(bitmap, 1, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(bitmap, 1, &offset, 1, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(bitmap, 1, &offset, 1, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(bitmap, 1, &offset, 0, nullptr, 1, nullptr));
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyMethodsFail_AfterClosed)
+    {
+        DrawFixture f;
+
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+
+        auto bitmap = f.Bitmap.Get();
+        Vector2 offset{};
+        Rect rect{};
+        Matrix3x2 transform{};
+
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyAtOffsets(bitmap, 1, &offset, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyToRects(bitmap, 1, &rect, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyWithTransforms(bitmap, 1, &transform, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(bitmap, 1, &offset, 1, &rect, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyFromSpriteSheetToRects(bitmap, 1, &rect, 1, &rect, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyFromSpriteSheetWithTransforms(bitmap, 1, &transform, 1, &rect, 0, nullptr, 0, nullptr));
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawMany_FailsWhenArraysAreTheWrongLength)
+    {
+        DrawFixture f;
+
+        auto bitmap = f.Bitmap.Get();
+        Vector2 offsets[3]{};
+        Rect rects[3]{};
+        Vector4 tints[3]{};
+        CanvasSpriteFlip flips[3]{};
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(bitmap, 3, offsets, 2, tints, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(bitmap, 3, offsets, 0, nullptr, 2, flips));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(bitmap, 3, offsets, 0, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(bitmap, 3, offsets, 2, rects, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(bitmap, 2, offsets, 3, rects, 0, nullptr, 0, nullptr));
+
+        // Nothing was added, so closing the batch doesn't draw anything
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawMany_FailsWhenPassedInvalidFlip_AndDoesNotAddAnySprites)
+    {
+        DrawFixture f;
+
+        Vector2 offsets[3]{};
+        CanvasSpriteFlip flips[3]{ CanvasSpriteFlip::None, CanvasSpriteFlip::Both, static_cast<CanvasSpriteFlip>(4) };
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(f.Bitmap.Get(), 3, offsets, 0, nullptr, 3, flips));
+        ValidateStoredErrorState(E_INVALIDARG, L"Invalid CanvasSpriteFlip value specified for sprite 2.");
+
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawMany_WithNoSprites_DoesNothing)
+    {
+        DrawFixture f;
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyAtOffsets(f.Bitmap.Get(), 0, nullptr, 0, nullptr, 0, nullptr));
+        ThrowIfFailed(f.SpriteBatch->DrawManyFromSpriteSheetToRects(f.Bitmap.Get(), 0, nullptr, 0, nullptr, 0, nullptr, 0, nullptr));
+
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyAtOffsets_MatchesDrawAtOffsetWithTint)
+    {
+        DrawFixture f;
+
+        std::vector<Vector2> offsets(std::begin(gOffsets), std::end(gOffsets));
+        std::vector<Vector4> tints(std::begin(gTints), std::end(gTints));
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyAtOffsets(
+            f.Bitmap.Get(),
+            static_cast<uint32_t>(offsets.size()), offsets.data(),
+            static_cast<uint32_t>(tints.size()), tints.data(),
+            0, nullptr));
+
+        for (size_t i = 0; i < offsets.size(); ++i)
+        {
+            f.ExpectSprite(
+                f.FullBitmapDestRect(offsets[i]),
+                f.FullBitmapSourceRect(),
+                *ReinterpretAs<D2D1_COLOR_F*>(&tints[i]));
+        }
+
+        f.Validate();
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyToRects_WithSharedTintAndPerSpriteFlips)
+    {
+        DrawFixture f;
+
+        auto flipCases = GenerateFlipTestCases(f.FullBitmapSourceRect());
+        auto tint = gAnyTint;
+
+        std::vector<Rect> rects;
+        std::vector<CanvasSpriteFlip> flips;
+
+        for (auto& t : flipCases)
+        {
+            rects.push_back(gAnyRect);
+            flips.push_back(t.first);
+
+            f.ExpectSprite(ToD2DRect(gAnyRect), t.second, *ReinterpretAs<D2D1_COLOR_F*>(&tint));
+        }
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyToRects(
+            f.Bitmap.Get(),
+            static_cast<uint32_t>(rects.size()), rects.data(),
+            1, &tint,
+            static_cast<uint32_t>(flips.size()), flips.data()));
+
+        f.Validate();
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyWithTransforms)
+    {
+        DrawFixture f;
+
+        std::vector<Matrix3x2> transforms(std::begin(gMatrices), std::end(gMatrices));
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyWithTransforms(
+            f.Bitmap.Get(),
+            static_cast<uint32_t>(transforms.size()), transforms.data(),
+            0, nullptr,
+            0, nullptr));
+
+        for (auto& transform : transforms)
+        {
+            f.ExpectSprite(
+                f.FullBitmapDestRect(float2::zero()),
+                f.FullBitmapSourceRect(),
+                D2D1_COLOR_F{ 1.0f, 1.0f, 1.0f, 1.0f },
+                *ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform));
+        }
+
+        f.Validate();
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyFromSpriteSheetAtOffsets_WithSharedSourceRect)
+    {
+        DrawFixture f;
+
+        auto width = 30.0f;
+        auto height = 40.0f;
+        Rect sourceRect{ 10.0f, 20.0f, width, height };
+
+        std::vector<Vector2> offsets(std::begin(gOffsets), std::end(gOffsets));
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyFromSpriteSheetAtOffsets(
+            f.Bitmap.Get(),
+            static_cast<uint32_t>(offsets.size()), offsets.data(),
+            1, &sourceRect,
+            0, nullptr,
+            0, nullptr));
+
+        for (auto& offset : offsets)
+        {
+            f.ExpectSprite(
+                D2D1_RECT_F{ offset.X, offset.Y, offset.X + width, offset.Y + height },
+                D2D1_RECT_U{ 20, 40, static_cast<uint32_t>(20 + width * 2), static_cast<uint32_t>(40 + height * 2) });
+        }
+
+        f.Validate();
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyFromSpriteSheetToRects_WithPerSpriteSourceRects)
+    {
+        DrawFixture f;
+
+        std::vector<Rect> destRects(std::begin(gRects), std::end(gRects));
+        std::vector<Rect> sourceRects;
+
+        for (auto i = 0U; i < destRects.size(); ++i)
+        {
+            auto offset = static_cast<float>(i * 10);
+            sourceRects.push_back(Rect{ offset, offset, 30.0f, 40.0f });
+
+            auto pixelOffset = static_cast<uint32_t>(offset * 2);
+            f.ExpectSprite(
+                ToD2DRect(destRects[i]),
+                D2D1_RECT_U{ pixelOffset, pixelOffset, pixelOffset + 60, pixelOffset + 80 });
+        }
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyFromSpriteSheetToRects(
+            f.Bitmap.Get(),
+            static_cast<uint32_t>(destRects.size()), destRects.data(),
+            static_cast<uint32_t>(sourceRects.size()), sourceRects.data(),
+            0, nullptr,
+            0, nullptr));
+
+        f.Validate();
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyFromSpriteSheetWithTransforms_WithFlip)
+    {
+        DrawFixture f;
+
+        auto width = 30.0f;
+        auto height = 40.0f;
+        Rect sourceRect{ 10.0f, 20.0f, width, height };
+        D2D1_RECT_U s{ 20, 40, static_cast<uint32_t>(20 + width * 2), static_cast<uint32_t>(40 + height * 2) };
+
+        auto flip = CanvasSpriteFlip::Horizontal;
+        auto transform = gMatrices[1];
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyFromSpriteSheetWithTransforms(
+            f.Bitmap.Get(),
+            1, &transform,
+            1, &sourceRect,
+            0, nullptr,
+            1, &flip));
+
+        f.ExpectSprite(
+            D2D1_RECT_F{ 0, 0, width, height },
+            D2D1_RECT_U{ s.right, s.top, s.left, s.bottom },
+            D2D1_COLOR_F{ 1.0f, 1.0f, 1.0f, 1.0f },
+            *ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform));
+
+        f.Validate();
+    }
+
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawMany_LargeBatchesAreDrawnWithSingleDrawSpriteBatchCall)
+    {
+        DrawFixture f;
+
+        // One more than a batch may hold when the quirk is required, which
+        // this device does not need.  Timings for large counts are in
+        // PerformanceTests.
+        const uint32_t spriteCount = 257;
+
+        std::vector<Vector2> offsets(spriteCount);
+        for (auto i = 0U; i < spriteCount; ++i)
+        {
+            offsets[i] = Vector2{ static_cast<float>(i), static_cast<float>(i) };
+        }
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyAtOffsets(f.Bitmap.Get(), spriteCount, offsets.data(), 0, nullptr, 0, nullptr));
+
+        auto d2dSpriteBatch = f.ExpectCreateSpriteBatch();
+        d2dSpriteBatch->AddSpritesMethod.SetExpectedCalls(1,
+            [&] (uint32_t count, D2D1_RECT_F const* dstRects, D2D1_RECT_U const*, D2D1_COLOR_F const*, D2D1_MATRIX_3X2_F const*, uint32_t dstStride, uint32_t, uint32_t, uint32_t)
+            {
+                Assert::AreEqual(spriteCount, count);
+
+                auto last = reinterpret_cast<D2D1_RECT_F const*>(reinterpret_cast<uint8_t const*>(dstRects) + dstStride * (count - 1));
+                Assert::AreEqual(f.FullBitmapDestRect(float2(static_cast<float>(spriteCount - 1))), *last);
+                return S_OK;
+            });
+
+        f.DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(1,
+            [&] (auto, auto startIndex, auto count, auto bitmap, auto, auto)
+            {
+                Assert::AreEqual(0U, startIndex);
+                Assert::AreEqual(spriteCount, count);
+                Assert::IsTrue(IsSameInstance(f.D2DBitmap.Get(), bitmap));
+            });
+
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+    }
+
+
     //
     // Multiple bitmaps and sorting
     //
@@ -1522,6 +1821,117 @@ public:
         f.Validate();
     }
 
+    TEST_METHOD_EX(CanvasSpriteBatch_RecentlyDrawnBitmaps_AreOnlyQueriedOnce)
+    {
+        MultipleBitmapFixture f;
+
+        for (auto& bitmap : f.Bitmaps)
+        {
+            bitmap.first->GetSizeMethod.SetExpectedCalls(1, [] { return D2D1_SIZE_F{ 100, 100 }; });
+            bitmap.first->GetPixelSizeMethod.SetExpectedCalls(1, [] { return D2D1_SIZE_U{ 100, 100 }; });
+        }
+
+        for (int i = 0; i < 8; ++i)
+        {
+            f.AddAndExpect(f.Bitmaps[i % 4], static_cast<float>(i));
+        }
+
+        f.ExpectBatches(
+        {
+            { f.Bitmaps[0], 0, 1 },
+            { f.Bitmaps[1], 1, 1 },
+            { f.Bitmaps[2], 2, 1 },
+            { f.Bitmaps[3], 3, 1 },
+            { f.Bitmaps[0], 4, 1 },
+            { f.Bitmaps[1], 5, 1 },
+            { f.Bitmaps[2], 6, 1 },
+            { f.Bitmaps[3], 7, 1 }
+        });
+
+        f.Validate();
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_WhenManyBitmapsAreDrawn_TheOldestIsQueriedAgain)
+    {
+        MultipleBitmapFixture f;
+
+        auto d2dBitmap = Make<StubD2DBitmap>();
+        d2dBitmap->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 100, 100 }; });
+        d2dBitmap->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 100, 100 }; });
+        auto fifthBitmap = std::make_pair(d2dBitmap, Make<CanvasBitmap>(Make<MockCanvasDevice>().Get(), d2dBitmap.Get()));
+
+        f.Bitmaps[0].first->GetSizeMethod.SetExpectedCalls(2, [] { return D2D1_SIZE_F{ 100, 100 }; });
+        f.Bitmaps[1].first->GetSizeMethod.SetExpectedCalls(1, [] { return D2D1_SIZE_F{ 100, 100 }; });
+
+        f.AddAndExpect(f.Bitmaps[0], 0);
+        f.AddAndExpect(f.Bitmaps[1], 1);
+        f.AddAndExpect(f.Bitmaps[2], 2);
+        f.AddAndExpect(f.Bitmaps[3], 3);
+        f.AddAndExpect(fifthBitmap, 4);
+        f.AddAndExpect(f.Bitmaps[1], 5);
+        f.AddAndExpect(f.Bitmaps[0], 6);
+
+        f.ExpectBatches(
+        {
+            { f.Bitmaps[0], 0, 1 },
+            { f.Bitmaps[1], 1, 1 },
+            { f.Bitmaps[2], 2, 1 },
+            { f.Bitmaps[3], 3, 1 },
+            { fifthBitmap,  4, 1 },
+            { f.Bitmaps[1], 5, 1 },
+            { f.Bitmaps[0], 6, 1 }
+        });
+
+        f.Validate();
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawingACachedBitmap_FailsAfterTheBitmapIsClosed)
+    {
+        DrawFixture f;
+
+        Vector2 offset{ 1, 2 };
+
+        ThrowIfFailed(f.SpriteBatch->DrawAtOffset(f.Bitmap.Get(), offset));
+        f.ExpectSprite(f.FullBitmapDestRect(offset), f.FullBitmapSourceRect());
+
+        ThrowIfFailed(f.Bitmap->Close());
+
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawAtOffset(f.Bitmap.Get(), offset));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawAtOffset(f.Bitmap.Get(), offset));
+
+        f.Validate();
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_ManyDrawsFromTheSameSpriteSheet_OnlyQueryTheBitmapOnce)
+    {
+        DrawFixture f;
+
+        f.D2DBitmap->GetSizeMethod.SetExpectedCalls(1, [&] { return f.BitmapSize; });
+        f.D2DBitmap->GetPixelSizeMethod.SetExpectedCalls(1, [&] { return f.BitmapSizeInPixels; });
+
+        // Timings for large counts are in PerformanceTests.
+        const uint32_t drawCount = 10;
+
+        for (auto i = 0U; i < drawCount; ++i)
+        {
+            auto offset = float2(static_cast<float>(i));
+            ThrowIfFailed(f.SpriteBatch->DrawAtOffset(f.Bitmap.Get(), offset));
+            ThrowIfFailed(f.SpriteBatch->DrawFromSpriteSheetAtOffset(f.Bitmap.Get(), offset, gAnyRect));
+        }
+
+        auto d2dSpriteBatch = f.ExpectCreateSpriteBatch();
+
+        f.DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(1,
+            [&] (auto, auto startIndex, auto count, auto bitmap, auto, auto)
+            {
+                Assert::AreEqual(0U, startIndex);
+                Assert::AreEqual(drawCount * 2, count);
+                Assert::IsTrue(IsSameInstance(f.D2DBitmap.Get(), bitmap));
+            });
+
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+    }
+
     TEST_METHOD_EX(CanvasSpriteBatch_When_AntialiasingIsEnabled_ItMustBeDisabledAroundCallsToDrawSpriteBatch)
     {
         MultipleBitmapFixture f;
@@ -1566,6 +1976,59 @@ public:
         f.Validate();
     }
 
+    TEST_METHOD_EX(CanvasSpriteBatch_WhenCreatedBySession_StateTheSessionKnowsIsNotReadAgain)
+    {
+        auto deviceContext = Make<MockD2DDeviceContext>();
+        SetReportedVendorIdAndFeatureLevel(deviceContext.Get(), 0, D3D_FEATURE_LEVEL_11_1);
+
+        deviceContext->SetTextAntialiasModeMethod.AllowAnyCall();
+
+        auto drawingSession = CanvasDrawingSession::CreateNew(deviceContext.Get(), std::make_shared<StubCanvasDrawingSessionAdapter>());
+
+        // Read once by get_Units, and once when the sprite batch is created.
+        deviceContext->GetUnitModeMethod.SetExpectedCalls(2, [] { return D2D1_UNIT_MODE_DIPS; });
+
+        CanvasUnits units;
+        ThrowIfFailed(drawingSession->get_Units(&units));
+
+        // Set once by put_Antialiasing, then around DrawSpriteBatch.
+        int callCount = 0;
+        deviceContext->SetAntialiasModeMethod.SetExpectedCalls(3,
+            [callCount] (D2D1_ANTIALIAS_MODE mode) mutable
+            {
+                if (callCount == 1)
+                    Assert::AreEqual(D2D1_ANTIALIAS_MODE_ALIASED, mode);
+                else
+                    Assert::AreEqual(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE, mode);
+
+                ++callCount;
+            });
+
+        ThrowIfFailed(drawingSession->put_Antialiasing(CanvasAntialiasing_Antialiased));
+
+        ComPtr<ICanvasSpriteBatch> spriteBatch;
+        ThrowIfFailed(drawingSession->CreateSpriteBatch(&spriteBatch));
+
+        auto d2dBitmap = Make<StubD2DBitmap>();
+        d2dBitmap->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 100, 100 }; });
+        d2dBitmap->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 100, 100 }; });
+        auto bitmap = Make<CanvasBitmap>(Make<MockCanvasDevice>().Get(), d2dBitmap.Get());
+
+        ThrowIfFailed(spriteBatch->DrawAtOffset(bitmap.Get(), float2::zero()));
+
+        auto d2dSpriteBatch = Make<MockD2DSpriteBatch>();
+        d2dSpriteBatch->AddSpritesMethod.AllowAnyCall();
+        deviceContext->CreateSpriteBatchMethod.SetExpectedCalls(1, [=] (ID2D1SpriteBatch** value) { return d2dSpriteBatch.CopyTo(value); });
+
+        // The session already knows both values, so neither is read back.
+        deviceContext->GetAntialiasModeMethod.SetExpectedCalls(0);
+        deviceContext->SetUnitModeMethod.SetExpectedCalls(0);
+        deviceContext->DrawSpriteBatchMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(As<IClosable>(spriteBatch)->Close());
+        ThrowIfFailed(drawingSession->Close());
+    }
+
     TEST_METHOD_EX(CanvasSpriteBatch_WhenQuirkRequired_SpriteBatchesAreNotLargerThan256)
     {
         struct TestCase
@@ -1612,6 +2075,297 @@ public:
             f.Validate();
         }
     }
+
+    //
+    // Statistics
+    //
+
+    TEST_METHOD_EX(CanvasSpriteBatch_get_Statistics_FailsWhenPassedNull)
+    {
+        DrawFixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->get_Statistics(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_get_Statistics_BeforeClose_ReportsSpritesAddedSoFar)
+    {
+        DrawFixture f;
+
+        for (auto offset : gOffsets)
+        {
+            ThrowIfFailed(f.SpriteBatch->DrawAtOffset(f.Bitmap.Get(), offset));
+            f.ExpectSprite(f.FullBitmapDestRect(offset), f.FullBitmapSourceRect());
+        }
+
+        CanvasSpriteBatchStatistics statistics;
+        ThrowIfFailed(f.SpriteBatch->get_Statistics(&statistics));
+
+        Assert::AreEqual<uint32_t>(_countof(gOffsets), statistics.SpriteCount);
+        Assert::IsTrue(statistics.PeakSpriteCapacity >= statistics.SpriteCount);
+        Assert::AreEqual(0U, statistics.DrawCallCount);
+        Assert::AreEqual<int64_t>(0, statistics.SortTime.Duration);
+        Assert::AreEqual<int64_t>(0, statistics.AddSpritesTime.Duration);
+        Assert::IsFalse(!!statistics.SpriteBatchQuirkRequired);
+
+        f.Validate();
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_get_Statistics_AfterClose_ReportsBatches)
+    {
+        MultipleBitmapFixture f;
+
+        for (int i = 0; i < 10; ++i)
+            f.AddAndExpect(f.Bitmaps[i % 2], (float)i);
+
+        f.DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(10);
+
+        f.Validate();
+
+        CanvasSpriteBatchStatistics statistics;
+        ThrowIfFailed(f.SpriteBatch->get_Statistics(&statistics));
+
+        Assert::AreEqual(10U, statistics.SpriteCount);
+        Assert::AreEqual(10U, statistics.DrawCallCount);
+        Assert::IsTrue(statistics.PeakSpriteCapacity >= 10U);
+        Assert::AreEqual<int64_t>(0, statistics.SortTime.Duration);
+        Assert::IsTrue(statistics.AddSpritesTime.Duration >= 0);
+        Assert::IsFalse(!!statistics.SpriteBatchQuirkRequired);
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_get_Statistics_AfterClose_WhenSorted_ReportsBatchesAfterSorting)
+    {
+        MultipleBitmapFixture f(CanvasSpriteSortMode::Bitmap);
+
+        for (int i = 0; i < 10; ++i)
+            f.Add(f.Bitmaps[i % 2], (float)i);
+
+        f.D2DSpriteBatch->AddSpritesMethod.AllowAnyCall();
+        f.DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(2);
+
+        f.Validate();
+
+        CanvasSpriteBatchStatistics statistics;
+        ThrowIfFailed(f.SpriteBatch->get_Statistics(&statistics));
+
+        Assert::AreEqual(10U, statistics.SpriteCount);
+        Assert::AreEqual(2U, statistics.DrawCallCount);
+        Assert::IsTrue(statistics.SortTime.Duration >= 0);
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatch_get_Statistics_AfterClose_ReportsWhenQuirkWasRequired)
+    {
+        MultipleBitmapFixture f(CanvasSpriteSortMode::None, QUALCOMM_VENDOR_ID, D3D_FEATURE_LEVEL_9_3);
+
+        for (int i = 0; i < 1000; ++i)
+            f.AddAndExpect(f.Bitmaps[0], (float)i);
+
+        f.DeviceContext->FlushMethod.SetExpectedCalls(4);
+        f.DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(4);
+
+        f.Validate();
+
+        CanvasSpriteBatchStatistics statistics;
+        ThrowIfFailed(f.SpriteBatch->get_Statistics(&statistics));
+
+        Assert::AreEqual(1000U, statistics.SpriteCount);
+        Assert::AreEqual(4U, statistics.DrawCallCount);
+        Assert::IsTrue(!!statistics.SpriteBatchQuirkRequired);
+    }
+
+    //
+    // CanvasDrawingSession.CoalesceBitmapDraws
+    //
+
+    struct CoalesceFixture : public Fixture
+    {
+        ComPtr<ICanvasImage> Image;
+        bool Flushed;
+
+        CoalesceFixture(ComPtr<MockD2DDeviceContext> deviceContext = Make<MockD2DDeviceContext>())
+            : Fixture(deviceContext)
+            , Image(As<ICanvasImage>(Bitmap))
+            , Flushed(false)
+        {
+            DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_SOURCE_OVER; });
+
+            ThrowIfFailed(DrawingSession->put_CoalesceBitmapDraws(true));
+        }
+
+        // Must be called after all the sprites have been expected.
+        void ExpectFlush()
+        {
+            auto d2dSpriteBatch = ExpectAndValidateCreateSpriteBatch();
+
+            DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(1,
+                [=] (auto batch, auto startIndex, auto spriteCount, auto bitmap, auto, auto)
+                {
+                    Assert::IsTrue(IsSameInstance(d2dSpriteBatch.Get(), batch));
+                    Assert::AreEqual(0U, startIndex);
+                    Assert::AreEqual(ExpectedSprites.Count(), spriteCount);
+                    Assert::IsTrue(IsSameInstance(D2DBitmap.Get(), bitmap));
+                    Flushed = true;
+                });
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_DefaultsToFalse)
+    {
+        Fixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.DrawingSession->get_CoalesceBitmapDraws(nullptr));
+
+        boolean value = true;
+        ThrowIfFailed(f.DrawingSession->get_CoalesceBitmapDraws(&value));
+        Assert::IsFalse(!!value);
+
+        ThrowIfFailed(f.DrawingSession->put_CoalesceBitmapDraws(true));
+        ThrowIfFailed(f.DrawingSession->get_CoalesceBitmapDraws(&value));
+        Assert::IsTrue(!!value);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_WhenEnabled_BitmapDrawsAreDrawnAsOneSpriteBatch)
+    {
+        CoalesceFixture f;
+
+        for (auto offset : gOffsets)
+        {
+            ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), offset));
+            f.ExpectSprite(f.FullBitmapDestRect(offset), f.FullBitmapSourceRect());
+        }
+
+        ThrowIfFailed(f.DrawingSession->DrawImageToRect(f.Bitmap.Get(), gAnyRect));
+        f.ExpectSprite(ToD2DRect(gAnyRect), f.FullBitmapSourceRect());
+
+        f.ExpectFlush();
+
+        ThrowIfFailed(f.DrawingSession->Close());
+
+        Assert::IsTrue(f.Flushed);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_OpacityAndSourceRectAreApplied)
+    {
+        CoalesceFixture f;
+
+        auto offset = Vector2{ 1, 2 };
+        auto sourceRect = Rect{ 10, 20, 30, 40 };
+
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffsetWithSourceRectAndOpacity(f.Image.Get(), offset, sourceRect, 0.5f));
+
+        // The bitmap is 192 DPI, so the source rect is doubled when converted to pixels.
+        f.ExpectSprite(
+            D2D1_RECT_F{ 1, 2, 31, 42 },
+            D2D1_RECT_U{ 20, 40, 80, 120 },
+            D2D1_COLOR_F{ 1, 1, 1, 0.5f });
+
+        f.ExpectFlush();
+
+        ThrowIfFailed(f.DrawingSession->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_AreFlushedBeforeStateChanges)
+    {
+        CoalesceFixture f;
+
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), Vector2{}));
+        f.ExpectSprite(f.FullBitmapDestRect(float2::zero()), f.FullBitmapSourceRect());
+
+        f.ExpectFlush();
+
+        f.DeviceContext->SetTransformMethod.SetExpectedCalls(1,
+            [&] (D2D1_MATRIX_3X2_F const*)
+            {
+                Assert::IsTrue(f.Flushed);
+            });
+
+        ThrowIfFailed(f.DrawingSession->put_Transform(Matrix3x2{ 1, 0, 0, 1, 0, 0 }));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_AreFlushedBeforeIncompatibleDraws)
+    {
+        CoalesceFixture f;
+
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), Vector2{}));
+        f.ExpectSprite(f.FullBitmapDestRect(float2::zero()), f.FullBitmapSourceRect());
+
+        f.ExpectFlush();
+
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1,
+            [&] (ID2D1Bitmap*, D2D1_RECT_F const*, float, D2D1_INTERPOLATION_MODE, D2D1_RECT_F const*, D2D1_MATRIX_4X4_F const* perspective)
+            {
+                Assert::IsTrue(f.Flushed);
+                Assert::IsNotNull(perspective);
+            });
+
+        Matrix4x4 perspective{};
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffsetWithSourceRectAndOpacityAndInterpolationAndPerspective(
+            f.Bitmap.Get(), Vector2{}, gAnyRect, 1.0f, CanvasImageInterpolation::Linear, perspective));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_NotUsed_WhenBlendIsNotSourceOver)
+    {
+        CoalesceFixture f;
+
+        f.DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall([] { return D2D1_PRIMITIVE_BLEND_COPY; });
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DrawingSession->DrawImageToRect(f.Bitmap.Get(), gAnyRect));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_NotUsed_WhenSourceRectIsNotWholePixels)
+    {
+        CoalesceFixture f;
+
+        // The bitmap is 192 DPI, so 10.25 DIPs is 20.5 pixels.
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1,
+            [] (ID2D1Bitmap*, D2D1_RECT_F const*, float, D2D1_INTERPOLATION_MODE, D2D1_RECT_F const* sourceRect, D2D1_MATRIX_4X4_F const*)
+            {
+                Assert::AreEqual(10.25f, sourceRect->left);
+            });
+
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffsetWithSourceRectAndOpacity(f.Image.Get(), Vector2{}, Rect{ 10.25f, 20, 30, 40 }, 1.0f));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_WhenAntialiased_OnlyPixelAlignedDrawsAreCoalesced)
+    {
+        CoalesceFixture f;
+
+        D2D1_MATRIX_3X2_F transform = D2D1::Matrix3x2F::Identity();
+
+        f.DeviceContext->GetAntialiasModeMethod.AllowAnyCall([] { return D2D1_ANTIALIAS_MODE_PER_PRIMITIVE; });
+        f.DeviceContext->SetAntialiasModeMethod.AllowAnyCall();
+        f.DeviceContext->GetTransformMethod.AllowAnyCall([&] (D2D1_MATRIX_3X2_F* value) { *value = transform; });
+        f.DeviceContext->GetDpiMethod.AllowAnyCall([] (float* dpiX, float* dpiY) { *dpiX = *dpiY = DEFAULT_DPI * 2; });
+
+        // At 192 DPI a quarter of a DIP is half a pixel, so this edge is antialiased.
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(2);
+
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), Vector2{ 0.25f, 0 }));
+
+        // Rotated edges are antialiased too.
+        transform = D2D1::Matrix3x2F::Rotation(45);
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), Vector2{}));
+
+        // A draw that lands on whole pixels looks the same either way.
+        transform = D2D1::Matrix3x2F::Translation(0.5f, 1);
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), Vector2{ 1, 2 }));
+        f.ExpectSprite(f.FullBitmapDestRect(float2{ 1, 2 }), f.FullBitmapSourceRect());
+
+        f.ExpectFlush();
+
+        ThrowIfFailed(f.DrawingSession->Close());
+
+        Assert::IsTrue(f.Flushed);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CoalesceBitmapDraws_NotUsed_WhenSpriteBatchNotSupported)
+    {
+        CoalesceFixture f(Make<MockD2DDeviceContextThatDoesNotSupportSpriteBatch>());
+
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1);
+
+        ThrowIfFailed(f.DrawingSession->DrawImageAtOffset(f.Image.Get(), Vector2{}));
+    }
 };
 
 #endif
@@ -1879,5 +1879,135 @@ namespace canvas
 
             TrimmingDelimiterValidationTest(textFormat);
         }
+
+        struct SharedTextFormatFixture
+        {
+            ComPtr<CanvasTextFormat> Format1;
+            ComPtr<CanvasTextFormat> Format2;
+
+            SharedTextFormatFixture()
+            {
+                CustomFontManagerAdapter::SetInstance(std::make_shared<StubFontManagerAdapter>());
+
+                Format1 = Make<CanvasTextFormat>();
+                Format2 = Make<CanvasTextFormat>();
+            }
+        };
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedTextFormat_IsSharedBetweenIdenticalFormats)
+        {
+            SharedTextFormatFixture f;
+
+            ThrowIfFailed(f.Format1->put_FontSize(30));
+            ThrowIfFailed(f.Format2->put_FontSize(30));
+
+            auto dtf1 = f.Format1->GetSharedTextFormat();
+            auto dtf2 = f.Format2->GetSharedTextFormat();
+
+            Assert::IsTrue(IsSameInstance(dtf1.Get(), dtf2.Get()));
+            Assert::AreEqual(30.0f, dtf1->GetFontSize());
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedTextFormat_ChangingAPropertyOnlyAffectsThatFormat)
+        {
+            SharedTextFormatFixture f;
+
+            auto dtf1 = f.Format1->GetSharedTextFormat();
+            Assert::IsTrue(IsSameInstance(dtf1.Get(), f.Format2->GetSharedTextFormat().Get()));
+
+            ThrowIfFailed(f.Format2->put_FontSize(40));
+            ThrowIfFailed(f.Format2->put_WordWrapping(CanvasWordWrapping::NoWrap));
+
+            auto dtf2 = f.Format2->GetSharedTextFormat();
+
+            Assert::IsFalse(IsSameInstance(dtf1.Get(), dtf2.Get()));
+            Assert::AreEqual(40.0f, dtf2->GetFontSize());
+            Assert::AreEqual(DWRITE_WORD_WRAPPING_NO_WRAP, dtf2->GetWordWrapping());
+
+            Assert::IsTrue(IsSameInstance(dtf1.Get(), f.Format1->GetSharedTextFormat().Get()));
+            Assert::AreEqual(20.0f, dtf1->GetFontSize());
+            Assert::AreEqual(DWRITE_WORD_WRAPPING_WRAP, dtf1->GetWordWrapping());
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedTextFormatWithWordWrapping_IsSharedBetweenIdenticalFormats)
+        {
+            SharedTextFormatFixture f;
+
+            auto noWrap1 = f.Format1->GetSharedTextFormatWithWordWrapping(CanvasWordWrapping::NoWrap);
+            auto noWrap2 = f.Format2->GetSharedTextFormatWithWordWrapping(CanvasWordWrapping::NoWrap);
+
+            Assert::IsTrue(IsSameInstance(noWrap1.Get(), noWrap2.Get()));
+            Assert::AreEqual(DWRITE_WORD_WRAPPING_NO_WRAP, noWrap1->GetWordWrapping());
+
+            // The format's own word wrapping is unaffected
+            CanvasWordWrapping wordWrapping;
+            ThrowIfFailed(f.Format1->get_WordWrapping(&wordWrapping));
+            Assert::AreEqual(CanvasWordWrapping::Wrap, wordWrapping);
+
+            // Asking for the format's own word wrapping gives the same object
+            // as GetSharedTextFormat
+            Assert::IsTrue(IsSameInstance(
+                f.Format1->GetSharedTextFormat().Get(),
+                f.Format1->GetSharedTextFormatWithWordWrapping(CanvasWordWrapping::Wrap).Get()));
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedTextFormat_NativeResourceIsNotShared)
+        {
+            SharedTextFormatFixture f;
+
+            auto sharedFormat = f.Format2->GetSharedTextFormat();
+            Assert::IsTrue(IsSameInstance(sharedFormat.Get(), f.Format1->GetSharedTextFormat().Get()));
+
+            auto nativeFormat = GetWrappedResource<IDWriteTextFormat1>(f.Format1);
+
+            Assert::IsFalse(IsSameInstance(sharedFormat.Get(), nativeFormat.Get()));
+
+            // From now on the format uses its own resource, so changes made
+            // through interop are seen by drawing...
+            Assert::IsTrue(IsSameInstance(nativeFormat.Get(), f.Format1->GetSharedTextFormat().Get()));
+
+            // ...but not by the other format.
+            ThrowIfFailed(nativeFormat->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP));
+            Assert::AreEqual(DWRITE_WORD_WRAPPING_WRAP, f.Format2->GetSharedTextFormat()->GetWordWrapping());
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedTextFormat_FormatsWithTrimmingSignsAreNotShared)
+        {
+            SharedTextFormatFixture f;
+
+            ThrowIfFailed(f.Format1->put_TrimmingSign(CanvasTrimmingSign::Ellipsis));
+            ThrowIfFailed(f.Format2->put_TrimmingSign(CanvasTrimmingSign::Ellipsis));
+
+            Assert::IsFalse(IsSameInstance(
+                f.Format1->GetSharedTextFormat().Get(),
+                f.Format2->GetSharedTextFormat().Get()));
+
+            CanvasTrimmingSign sign;
+            ThrowIfFailed(f.Format1->get_TrimmingSign(&sign));
+            Assert::AreEqual(CanvasTrimmingSign::Ellipsis, sign);
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_Version_IsSharedByUnmodifiedFormats)
+        {
+            SharedTextFormatFixture f;
+
+            Assert::AreEqual(f.Format1->GetVersion(), f.Format2->GetVersion());
+
+            ThrowIfFailed(f.Format2->put_FontSize(40));
+            Assert::AreNotEqual(f.Format1->GetVersion(), f.Format2->GetVersion());
+
+            // Handing out the native resource means it might be modified behind
+            // our back, so the format can't be cached from then on, even after
+            // its properties are changed.
+            auto unmodifiedVersion = f.Format1->GetVersion();
+            GetWrappedResource<IDWriteTextFormat1>(f.Format1);
+            Assert::AreEqual(UncacheableTextFormatVersion, f.Format1->GetVersion());
+
+            ThrowIfFailed(f.Format1->put_FontSize(40));
+            Assert::AreEqual(UncacheableTextFormatVersion, f.Format1->GetVersion());
+
+            Assert::AreEqual(unmodifiedVersion, Make<CanvasTextFormat>()->GetVersion());
+            Assert::AreNotEqual(UncacheableTextFormatVersion, unmodifiedVersion);
+        }
     };
 }
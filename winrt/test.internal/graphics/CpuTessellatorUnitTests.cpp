@@ -0,0 +1,239 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/geometry/CpuTessellator.h>
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+static ComPtr<CpuTessellator> MakeTessellator(D2D1_MATRIX_3X2_F const& transform = D2D1::Matrix3x2F::Identity(), float tolerance = D2D1_DEFAULT_FLATTENING_TOLERANCE)
+{
+    auto tessellator = Make<CpuTessellator>(transform, tolerance);
+    CheckMakeResult(tessellator);
+    return tessellator;
+}
+
+
+static void AddPolygon(CpuTessellator* tessellator, std::vector<D2D1_POINT_2F> const& points, D2D1_FIGURE_BEGIN figureBegin = D2D1_FIGURE_BEGIN_FILLED)
+{
+    tessellator->BeginFigure(points[0], figureBegin);
+    tessellator->AddLines(points.data() + 1, static_cast<uint32_t>(points.size() - 1));
+    tessellator->EndFigure(D2D1_FIGURE_END_CLOSED);
+}
+
+
+// Positive for triangles that are clockwise when y points down.
+static float SignedArea(CanvasTriangleVertices const& t)
+{
+    return ((t.Vertex2.X - t.Vertex1.X) * (t.Vertex3.Y - t.Vertex1.Y) -
+            (t.Vertex3.X - t.Vertex1.X) * (t.Vertex2.Y - t.Vertex1.Y)) / 2;
+}
+
+
+static float TotalArea(std::vector<CanvasTriangleVertices> const& triangles)
+{
+    float area = 0;
+
+    for (auto& triangle : triangles)
+    {
+        Assert::IsTrue(SignedArea(triangle) > 0);
+        area += SignedArea(triangle);
+    }
+
+    return area;
+}
+
+
+static void AssertTrianglesEqual(std::vector<CanvasTriangleVertices> const& expected, std::vector<CanvasTriangleVertices> const& actual)
+{
+    Assert::AreEqual(expected.size(), actual.size());
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        Assert::AreEqual(expected[i].Vertex1, actual[i].Vertex1);
+        Assert::AreEqual(expected[i].Vertex2, actual[i].Vertex2);
+        Assert::AreEqual(expected[i].Vertex3, actual[i].Vertex3);
+    }
+}
+
+
+TEST_CLASS(CpuTessellatorUnitTests)
+{
+public:
+    TEST_METHOD_EX(CpuTessellator_Square_MatchesGoldenMesh)
+    {
+        auto tessellator = MakeTessellator();
+
+        AddPolygon(tessellator.Get(), { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
+        ThrowIfFailed(tessellator->Close());
+
+        AssertTrianglesEqual(
+            {
+                { Vector2{ 0, 0 },  Vector2{ 10, 0 },  Vector2{ 0, 10 } },
+                { Vector2{ 10, 0 }, Vector2{ 10, 10 }, Vector2{ 0, 10 } },
+            },
+            tessellator->Tessellate());
+    }
+
+    TEST_METHOD_EX(CpuTessellator_Triangle_MatchesGoldenMesh)
+    {
+        auto tessellator = MakeTessellator();
+
+        AddPolygon(tessellator.Get(), { { 0, 0 }, { 10, 10 }, { 0, 10 } });
+
+        AssertTrianglesEqual(
+            {
+                { Vector2{ 0, 0 }, Vector2{ 10, 10 }, Vector2{ 0, 10 } },
+            },
+            tessellator->Tessellate());
+    }
+
+    TEST_METHOD_EX(CpuTessellator_Transform_IsApplied)
+    {
+        auto tessellator = MakeTessellator(D2D1::Matrix3x2F::Scale(2, 3) * D2D1::Matrix3x2F::Translation(5, 0));
+
+        AddPolygon(tessellator.Get(), { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
+
+        AssertTrianglesEqual(
+            {
+                { Vector2{ 5, 0 },  Vector2{ 25, 0 },  Vector2{ 5, 30 } },
+                { Vector2{ 25, 0 }, Vector2{ 25, 30 }, Vector2{ 5, 30 } },
+            },
+            tessellator->Tessellate());
+    }
+
+    TEST_METHOD_EX(CpuTessellator_OverlappingFigures_RespectFillMode)
+    {
+        for (auto fillMode : { D2D1_FILL_MODE_ALTERNATE, D2D1_FILL_MODE_WINDING })
+        {
+            auto tessellator = MakeTessellator();
+
+            tessellator->SetFillMode(fillMode);
+            AddPolygon(tessellator.Get(), { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
+            AddPolygon(tessellator.Get(), { { 5, 0 }, { 15, 0 }, { 15, 10 }, { 5, 10 } });
+
+            auto expectedArea = (fillMode == D2D1_FILL_MODE_ALTERNATE) ? 100.0f : 150.0f;
+
+            Assert::AreEqual(expectedArea, TotalArea(tessellator->Tessellate()));
+        }
+    }
+
+    TEST_METHOD_EX(CpuTessellator_SelfIntersectingFigure_IsSplitAtCrossing)
+    {
+        auto tessellator = MakeTessellator();
+
+        // A bow tie, whose edges cross at (5, 5).
+        AddPolygon(tessellator.Get(), { { 0, 0 }, { 10, 10 }, { 10, 0 }, { 0, 10 } });
+
+        auto triangles = tessellator->Tessellate();
+
+        Assert::AreEqual(50.0f, TotalArea(triangles), 0.001f);
+
+        for (auto& triangle : triangles)
+        {
+            for (auto& vertex : { triangle.Vertex1, triangle.Vertex2, triangle.Vertex3 })
+            {
+                // Nothing may be filled between the two halves of the bow tie.
+                auto distanceFromCenter = fabsf(vertex.X - 5);
+                Assert::IsTrue(distanceFromCenter >= fabsf(vertex.Y - 5) - 0.001f);
+            }
+        }
+    }
+
+    TEST_METHOD_EX(CpuTessellator_HollowFigures_AreIgnored)
+    {
+        auto tessellator = MakeTessellator();
+
+        AddPolygon(tessellator.Get(), { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } }, D2D1_FIGURE_BEGIN_HOLLOW);
+
+        Assert::AreEqual<size_t>(0, tessellator->Tessellate().size());
+    }
+
+    TEST_METHOD_EX(CpuTessellator_Arcs_AreFlattenedWithinTolerance)
+    {
+        float const radius = 100;
+        float const tolerance = 0.25f;
+
+        auto tessellator = MakeTessellator(D2D1::Matrix3x2F::Identity(), tolerance);
+
+        D2D1_ARC_SEGMENT halfCircles[] =
+        {
+            { D2D1_POINT_2F{ radius, 0 },  D2D1_SIZE_F{ radius, radius }, 0, D2D1_SWEEP_DIRECTION_CLOCKWISE, D2D1_ARC_SIZE_SMALL },
+            { D2D1_POINT_2F{ -radius, 0 }, D2D1_SIZE_F{ radius, radius }, 0, D2D1_SWEEP_DIRECTION_CLOCKWISE, D2D1_ARC_SIZE_SMALL },
+        };
+
+        CpuTessellator::Figure figure{ D2D1_POINT_2F{ -radius, 0 } };
+
+        for (auto& arc : halfCircles)
+        {
+            figure.Segments.push_back(CpuTessellator::Segment{ CpuTessellator::SegmentType::Arc, { arc.point }, arc });
+        }
+
+        auto points = tessellator->FlattenFigure(figure);
+
+        Assert::IsTrue(points.size() > 8);
+
+        for (size_t i = 1; i < points.size(); ++i)
+        {
+            auto& a = points[i - 1];
+            auto& b = points[i];
+
+            // Every vertex is on the circle, and the middle of every chord is
+            // no further inside it than the tolerance.
+            Assert::AreEqual(radius, sqrtf(b.x * b.x + b.y * b.y), 0.01f);
+
+            auto midX = (a.x + b.x) / 2;
+            auto midY = (a.y + b.y) / 2;
+            Assert::IsTrue(radius - sqrtf(midX * midX + midY * midY) <= tolerance + 0.01f);
+        }
+
+        // The first half circle is clockwise from the left, so goes over the top.
+        Assert::IsTrue(points[points.size() / 4].y < 0);
+    }
+
+    TEST_METHOD_EX(CpuTessellator_Curves_UseMoreSegmentsForSmallerTolerances)
+    {
+        CpuTessellator::Figure figure{ D2D1_POINT_2F{ 0, 0 } };
+        figure.Segments.push_back(CpuTessellator::Segment{ CpuTessellator::SegmentType::CubicBezier, { { 0, 100 }, { 100, 100 }, { 100, 0 } } });
+        figure.Segments.push_back(CpuTessellator::Segment{ CpuTessellator::SegmentType::QuadraticBezier, { { 50, -100 }, { 0, 0 } } });
+
+        auto coarse = MakeTessellator(D2D1::Matrix3x2F::Identity(), 10)->FlattenFigure(figure);
+        auto fine = MakeTessellator(D2D1::Matrix3x2F::Identity(), 0.1f)->FlattenFigure(figure);
+
+        Assert::IsTrue(fine.size() > coarse.size());
+
+        // The end points of both curves are always included exactly.
+        Assert::IsTrue(std::find(fine.begin(), fine.end(), D2D1_POINT_2F{ 100, 0 }) != fine.end());
+        Assert::AreEqual(D2D1_POINT_2F{ 0, 0 }, fine.back());
+    }
+
+    TEST_METHOD_EX(CpuTessellator_ManyFigures_ProduceSameResultAsSingleFigures)
+    {
+        // There is no timing harness here, so this checks that a geometry large
+        // enough to be split across threads gives a complete, ordered result.
+        auto tessellator = MakeTessellator();
+
+        uint32_t const count = 1000;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto x = static_cast<float>(i % 40) * 20;
+            auto y = static_cast<float>(i / 40) * 20;
+
+            AddPolygon(tessellator.Get(), { { x, y }, { x + 10, y }, { x + 10, y + 10 }, { x, y + 10 } });
+        }
+
+        auto triangles = tessellator->Tessellate();
+
+        Assert::AreEqual<size_t>(count * 2, triangles.size());
+        Assert::AreEqual(count * 100.0f, TotalArea(triangles));
+
+        for (size_t i = 1; i < triangles.size(); ++i)
+        {
+            Assert::IsTrue(triangles[i - 1].Vertex1.Y <= triangles[i].Vertex1.Y);
+        }
+    }
+};
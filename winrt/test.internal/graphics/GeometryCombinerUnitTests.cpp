@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "mocks/MockD2DGeometryGroup.h"
+#include "mocks/MockD2DGeometrySink.h"
+#include "mocks/MockD2DPathGeometry.h"
+#include "mocks/MockD2DRectangleGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+TEST_CLASS(GeometryCombinerUnitTests)
+{
+    struct CombineCall
+    {
+        ID2D1Geometry* Geometry;
+        ID2D1Geometry* Input;
+        D2D1_COMBINE_MODE CombineMode;
+    };
+
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasGeometryFactory> Factory;
+        std::vector<ComPtr<MockD2DPathGeometry>> CreatedPaths;
+        std::vector<CombineCall> CombineCalls;
+        float ExpectedFlatteningTolerance;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , Factory(Make<CanvasGeometryFactory>())
+            , ExpectedFlatteningTolerance(D2D1_DEFAULT_FLATTENING_TOLERANCE)
+        {
+            Device->CreatePathGeometryMethod.AllowAnyCall(
+                [this]
+                {
+                    auto path = Make<MockD2DPathGeometry>();
+
+                    path->OpenMethod.AllowAnyCall(
+                        [](ID2D1GeometrySink** out)
+                        {
+                            auto sink = Make<MockD2DGeometrySink>();
+                            sink->CloseMethod.AllowAnyCall();
+                            return sink.CopyTo(out);
+                        });
+
+                    AllowCombine(path.Get(), path->CombineWithGeometryMethod);
+
+                    CreatedPaths.push_back(path);
+
+                    return path;
+                });
+        }
+
+        template<typename METHOD>
+        void AllowCombine(ID2D1Geometry* geometry, METHOD& combineMethod)
+        {
+            combineMethod.AllowAnyCall(
+                [=](ID2D1Geometry* input, D2D1_COMBINE_MODE combineMode, D2D1_MATRIX_3X2_F const* transform, float flatteningTolerance, ID2D1SimplifiedGeometrySink*)
+                {
+                    Assert::IsNull(transform);
+                    Assert::AreEqual(ExpectedFlatteningTolerance, flatteningTolerance);
+
+                    CombineCalls.push_back(CombineCall{ geometry, input, combineMode });
+
+                    return S_OK;
+                });
+        }
+
+        ComPtr<MockD2DRectangleGeometry> MakeRectangle(D2D1_RECT_F const& bounds)
+        {
+            auto rectangle = Make<MockD2DRectangleGeometry>();
+
+            rectangle->GetBoundsMethod.AllowAnyCall(
+                [=](D2D1_MATRIX_3X2_F const* transform, D2D1_RECT_F* result)
+                {
+                    Assert::IsNull(transform);
+                    *result = bounds;
+                    return S_OK;
+                });
+
+            AllowCombine(rectangle.Get(), rectangle->CombineWithGeometryMethod);
+
+            return rectangle;
+        }
+
+        ComPtr<MockD2DPathGeometry> MakePath(D2D1_RECT_F const& bounds)
+        {
+            auto path = Make<MockD2DPathGeometry>();
+
+            path->GetBoundsMethod.AllowAnyCall(
+                [=](D2D1_MATRIX_3X2_F const*, D2D1_RECT_F* result)
+                {
+                    *result = bounds;
+                    return S_OK;
+                });
+
+            AllowCombine(path.Get(), path->CombineWithGeometryMethod);
+
+            return path;
+        }
+
+        ComPtr<ICanvasGeometry> CombineMany(std::vector<ComPtr<ID2D1Geometry>> const& d2dGeometries, CanvasGeometryCombine combine)
+        {
+            std::vector<ComPtr<ICanvasGeometry>> geometries;
+            std::vector<ICanvasGeometry*> rawGeometries;
+
+            for (auto& d2dGeometry : d2dGeometries)
+            {
+                geometries.push_back(Make<CanvasGeometry>(Device.Get(), d2dGeometry.Get()));
+                rawGeometries.push_back(geometries.back().Get());
+            }
+
+            ComPtr<ICanvasGeometry> result;
+
+            ThrowIfFailed(Factory->CombineManyWithFlatteningTolerance(
+                Device.Get(),
+                static_cast<uint32_t>(rawGeometries.size()),
+                rawGeometries.data(),
+                combine,
+                ExpectedFlatteningTolerance,
+                &result));
+
+            return result;
+        }
+
+        void AssertCombined(size_t index, ID2D1Geometry* geometry, ID2D1Geometry* input, D2D1_COMBINE_MODE combineMode)
+        {
+            Assert::IsTrue(index < CombineCalls.size());
+            Assert::AreEqual(geometry, CombineCalls[index].Geometry);
+            Assert::AreEqual(input, CombineCalls[index].Input);
+            Assert::AreEqual(combineMode, CombineCalls[index].CombineMode);
+        }
+
+        ComPtr<MockD2DGeometryGroup> ExpectGroup(ID2D1Geometry* first, ID2D1Geometry* second)
+        {
+            auto group = Make<MockD2DGeometryGroup>();
+
+            group->SimplifyMethod.AllowAnyCall();
+
+            Device->CreateGeometryGroupMethod.SetExpectedCalls(1,
+                [=](D2D1_FILL_MODE fillMode, ID2D1Geometry** geometries, uint32_t geometryCount)
+                {
+                    Assert::AreEqual(D2D1_FILL_MODE_ALTERNATE, fillMode);
+                    Assert::AreEqual(2u, geometryCount);
+                    Assert::AreEqual(first, geometries[0]);
+                    Assert::AreEqual(second, geometries[1]);
+
+                    return group;
+                });
+
+            return group;
+        }
+    };
+
+public:
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_CombinesInBalancedTree)
+    {
+        Fixture f;
+        f.ExpectedFlatteningTolerance = 0.5f;
+
+        auto bounds = D2D1::RectF(0, 0, 10, 10);
+        ComPtr<ID2D1Geometry> rectangles[] = { f.MakeRectangle(bounds), f.MakeRectangle(bounds), f.MakeRectangle(bounds), f.MakeRectangle(bounds) };
+
+        auto result = f.CombineMany({ std::begin(rectangles), std::end(rectangles) }, CanvasGeometryCombine::Union);
+
+        Assert::AreEqual(3u, static_cast<uint32_t>(f.CombineCalls.size()));
+        Assert::AreEqual(3u, static_cast<uint32_t>(f.CreatedPaths.size()));
+
+        f.AssertCombined(0, rectangles[0].Get(), rectangles[1].Get(), D2D1_COMBINE_MODE_UNION);
+        f.AssertCombined(1, rectangles[2].Get(), rectangles[3].Get(), D2D1_COMBINE_MODE_UNION);
+        f.AssertCombined(2, f.CreatedPaths[0].Get(), f.CreatedPaths[1].Get(), D2D1_COMBINE_MODE_UNION);
+
+        Assert::AreEqual<ID2D1Geometry*>(f.CreatedPaths[2].Get(), GetWrappedResource<ID2D1Geometry>(result).Get());
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_OddGeometryMovesUpUnchanged)
+    {
+        Fixture f;
+
+        auto bounds = D2D1::RectF(0, 0, 10, 10);
+        ComPtr<ID2D1Geometry> rectangles[] = { f.MakeRectangle(bounds), f.MakeRectangle(bounds), f.MakeRectangle(bounds) };
+
+        f.CombineMany({ std::begin(rectangles), std::end(rectangles) }, CanvasGeometryCombine::Xor);
+
+        Assert::AreEqual(2u, static_cast<uint32_t>(f.CombineCalls.size()));
+
+        f.AssertCombined(0, rectangles[0].Get(), rectangles[1].Get(), D2D1_COMBINE_MODE_XOR);
+        f.AssertCombined(1, f.CreatedPaths[0].Get(), rectangles[2].Get(), D2D1_COMBINE_MODE_XOR);
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_DisjointShapesAreGroupedRatherThanCombined)
+    {
+        Fixture f;
+
+        auto first = f.MakeRectangle(D2D1::RectF(0, 0, 10, 10));
+        auto second = f.MakeRectangle(D2D1::RectF(20, 0, 30, 10));
+
+        auto group = f.ExpectGroup(first.Get(), second.Get());
+
+        auto result = f.CombineMany({ first, second }, CanvasGeometryCombine::Union);
+
+        Assert::AreEqual(0u, static_cast<uint32_t>(f.CombineCalls.size()));
+        Assert::AreEqual(1, group->SimplifyMethod.GetCurrentCallCount());
+
+        // The group is written into a new path.
+        Assert::AreEqual<ID2D1Geometry*>(f.CreatedPaths[0].Get(), GetWrappedResource<ID2D1Geometry>(result).Get());
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_DisjointPathsAreStillCombined)
+    {
+        Fixture f;
+
+        // A path may depend on its fill mode, so it cannot be grouped.
+        auto first = f.MakePath(D2D1::RectF(0, 0, 10, 10));
+        auto second = f.MakePath(D2D1::RectF(20, 0, 30, 10));
+
+        f.CombineMany({ first, second }, CanvasGeometryCombine::Union);
+
+        Assert::AreEqual(1u, static_cast<uint32_t>(f.CombineCalls.size()));
+        f.AssertCombined(0, first.Get(), second.Get(), D2D1_COMBINE_MODE_UNION);
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_IntersectWithNoCommonBoundsIsEmpty)
+    {
+        Fixture f;
+
+        auto result = f.CombineMany(
+            {
+                f.MakeRectangle(D2D1::RectF(0, 0, 10, 10)),
+                f.MakeRectangle(D2D1::RectF(5, 5, 15, 15)),
+                f.MakeRectangle(D2D1::RectF(12, 0, 20, 10)),
+            },
+            CanvasGeometryCombine::Intersect);
+
+        Assert::AreEqual(0u, static_cast<uint32_t>(f.CombineCalls.size()));
+        Assert::AreEqual(1u, static_cast<uint32_t>(f.CreatedPaths.size()));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_ExcludeOnlyRemovesOverlappingGeometries)
+    {
+        Fixture f;
+
+        auto first = f.MakeRectangle(D2D1::RectF(0, 0, 10, 10));
+        auto overlapping1 = f.MakeRectangle(D2D1::RectF(5, 5, 15, 15));
+        auto outside = f.MakeRectangle(D2D1::RectF(20, 20, 30, 30));
+        auto overlapping2 = f.MakeRectangle(D2D1::RectF(0, 0, 2, 2));
+
+        // The overlapping geometries are unioned first.  They do not overlap
+        // each other, so are grouped.
+        auto group = f.ExpectGroup(overlapping1.Get(), overlapping2.Get());
+
+        auto result = f.CombineMany({ first, overlapping1, outside, overlapping2 }, CanvasGeometryCombine::Exclude);
+
+        Assert::AreEqual(1u, static_cast<uint32_t>(f.CombineCalls.size()));
+        f.AssertCombined(0, first.Get(), group.Get(), D2D1_COMBINE_MODE_EXCLUDE);
+
+        Assert::AreEqual<ID2D1Geometry*>(f.CreatedPaths[0].Get(), GetWrappedResource<ID2D1Geometry>(result).Get());
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_NoGeometriesGivesEmptyPath)
+    {
+        Fixture f;
+
+        auto result = f.CombineMany({}, CanvasGeometryCombine::Union);
+
+        Assert::AreEqual(1u, static_cast<uint32_t>(f.CreatedPaths.size()));
+        Assert::AreEqual<ID2D1Geometry*>(f.CreatedPaths[0].Get(), GetWrappedResource<ID2D1Geometry>(result).Get());
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_CombineMany_InvalidArgs)
+    {
+        Fixture f;
+
+        auto geometry = Make<CanvasGeometry>(f.Device.Get(), f.MakeRectangle(D2D1::RectF()).Get());
+        ICanvasGeometry* geometries[] = { geometry.Get(), nullptr };
+
+        ComPtr<ICanvasGeometry> result;
+
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CombineMany(nullptr, 1, geometries, CanvasGeometryCombine::Union, &result));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CombineMany(f.Device.Get(), 1, geometries, CanvasGeometryCombine::Union, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CombineMany(f.Device.Get(), 1, nullptr, CanvasGeometryCombine::Union, &result));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->CombineMany(f.Device.Get(), 2, geometries, CanvasGeometryCombine::Union, &result));
+    }
+};
@@ -0,0 +1,300 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/geometry/CanvasCachedGeometry.h>
+#include <lib/geometry/GeometryRealizationCache.h>
+#include "mocks/MockD2DGeometryRealization.h"
+#include "mocks/MockD2DPathGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+TEST_CLASS(GeometryRealizationCacheUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        GeometryRealizationCache* Cache;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , Cache(Device->GetGeometryRealizationCache())
+        {
+            Cache->SetMaximumBytes(1024 * 1024);
+        }
+
+        // Makes a new geometry whose path is a square of the specified size.
+        // Geometries made with the same size have the same content.
+        ComPtr<CanvasGeometry> MakeSquare(float size)
+        {
+            auto d2dGeometry = Make<MockD2DPathGeometry>();
+
+            d2dGeometry->StreamMethod.AllowAnyCall(
+                [=](ID2D1GeometrySink* sink)
+                {
+                    D2D1_POINT_2F points[] = { { size, 0 }, { size, size }, { 0, size } };
+
+                    sink->SetFillMode(D2D1_FILL_MODE_ALTERNATE);
+                    sink->BeginFigure(D2D1_POINT_2F{ 0, 0 }, D2D1_FIGURE_BEGIN_FILLED);
+                    sink->AddLines(points, _countof(points));
+                    sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+                    return S_OK;
+                });
+
+            d2dGeometry->TessellateMethod.AllowAnyCall(
+                [=](D2D1_MATRIX_3X2_F const*, float, ID2D1TessellationSink* sink)
+                {
+                    D2D1_TRIANGLE triangle{ { 0, 0 }, { size, 0 }, { 0, size } };
+                    sink->AddTriangles(&triangle, 1);
+                    return S_OK;
+                });
+
+            return Make<CanvasGeometry>(Device.Get(), d2dGeometry.Get());
+        }
+
+        CanvasGeometryRealizationCacheStatistics GetStatistics()
+        {
+            return Cache->GetStatistics();
+        }
+    };
+
+    TEST_METHOD_EX(GeometryRealizationCache_IsDisabledByDefault)
+    {
+        GeometryRealizationCache cache;
+
+        Assert::AreEqual<uint64_t>(0, cache.GetMaximumBytes());
+        Assert::IsFalse(cache.IsEnabled());
+
+        auto realization = cache.GetOrCreateFill(nullptr, 0.25f,
+            [](float) -> ComPtr<ID2D1GeometryRealization>
+            {
+                Assert::Fail(L"Nothing should be created while the cache is disabled");
+                return nullptr;
+            });
+
+        Assert::IsNull(realization.Get());
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_ToleranceBuckets)
+    {
+        int32_t a, b, c;
+
+        // Tolerances within a quarter of an octave share a bucket.
+        Assert::IsTrue(GeometryRealizationCache::TryGetToleranceBucket(0.25f, &a));
+        Assert::IsTrue(GeometryRealizationCache::TryGetToleranceBucket(0.26f, &b));
+        Assert::IsTrue(GeometryRealizationCache::TryGetToleranceBucket(0.3f, &c));
+
+        Assert::AreEqual(a, b);
+        Assert::AreEqual(a + 1, c);
+
+        // The bucket tolerance is never coarser than the one asked for.
+        for (float tolerance = 0.001f; tolerance < 100; tolerance *= 1.1f)
+        {
+            int32_t bucket;
+            Assert::IsTrue(GeometryRealizationCache::TryGetToleranceBucket(tolerance, &bucket));
+
+            auto bucketTolerance = GeometryRealizationCache::GetBucketTolerance(bucket);
+            Assert::IsTrue(bucketTolerance <= tolerance);
+            Assert::IsTrue(bucketTolerance > tolerance * 0.8f);
+        }
+
+        for (float tolerance : { 0.0f, -1.0f, NAN, INFINITY })
+        {
+            Assert::IsFalse(GeometryRealizationCache::TryGetToleranceBucket(tolerance, &a));
+        }
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_GetMaximumScale)
+    {
+        Assert::AreEqual(1.0f, GeometryRealizationCache::GetMaximumScale(D2D1::Matrix3x2F::Identity()), 0.0001f);
+        Assert::AreEqual(3.0f, GeometryRealizationCache::GetMaximumScale(D2D1::Matrix3x2F::Scale(2, -3)), 0.0001f);
+        Assert::AreEqual(2.0f, GeometryRealizationCache::GetMaximumScale(D2D1::Matrix3x2F::Rotation(45) * D2D1::Matrix3x2F::Scale(2, 2) * D2D1::Matrix3x2F::Translation(100, 100)), 0.0001f);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_HashStrokeStyle_DependsOnProperties)
+    {
+        auto strokeStyle1 = Make<CanvasStrokeStyle>();
+        auto strokeStyle2 = Make<CanvasStrokeStyle>();
+
+        Assert::AreEqual<uint64_t>(0, GeometryRealizationCache::HashStrokeStyle(nullptr));
+        Assert::AreEqual(GeometryRealizationCache::HashStrokeStyle(strokeStyle1.Get()), GeometryRealizationCache::HashStrokeStyle(strokeStyle2.Get()));
+
+        ThrowIfFailed(strokeStyle2->put_LineJoin(CanvasLineJoin::Round));
+        Assert::AreNotEqual(GeometryRealizationCache::HashStrokeStyle(strokeStyle1.Get()), GeometryRealizationCache::HashStrokeStyle(strokeStyle2.Get()));
+
+        float dashes[] = { 1, 2 };
+        ThrowIfFailed(strokeStyle1->put_LineJoin(CanvasLineJoin::Round));
+        ThrowIfFailed(strokeStyle1->put_CustomDashStyle(_countof(dashes), dashes));
+        Assert::AreNotEqual(GeometryRealizationCache::HashStrokeStyle(strokeStyle1.Get()), GeometryRealizationCache::HashStrokeStyle(strokeStyle2.Get()));
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_CachedFill_IsSharedByGeometriesWithTheSameContent)
+    {
+        Fixture f;
+
+        auto realization = Make<MockD2DGeometryRealization>();
+
+        f.Device->CreateFilledGeometryRealizationMethod.SetExpectedCalls(1,
+            [&](ID2D1Geometry*, float flatteningTolerance)
+            {
+                // Created with the finest tolerance in the bucket.
+                Assert::AreEqual(0.25f, flatteningTolerance);
+                return realization;
+            });
+
+        auto cached1 = CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 0.25f);
+        auto cached2 = CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 0.26f);
+
+        Assert::IsTrue(IsSameInstance(realization.Get(), GetWrappedResource<ID2D1GeometryRealization>(cached1).Get()));
+        Assert::IsTrue(IsSameInstance(realization.Get(), GetWrappedResource<ID2D1GeometryRealization>(cached2).Get()));
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(1u, statistics.HitCount);
+        Assert::AreEqual(1u, statistics.MissCount);
+        Assert::AreEqual(1u, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_DifferentContentOrParameters_AreCachedSeparately)
+    {
+        Fixture f;
+
+        f.Device->CreateFilledGeometryRealizationMethod.SetExpectedCalls(3,
+            [](ID2D1Geometry*, float) { return Make<MockD2DGeometryRealization>(); });
+
+        f.Device->CreateStrokedGeometryRealizationMethod.SetExpectedCalls(2,
+            [](ID2D1Geometry*, float, ID2D1StrokeStyle*, float) { return Make<MockD2DGeometryRealization>(); });
+
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 0.25f);
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(20).Get(), 0.25f);     // different content
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 1.0f);      // different zoom
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 1, nullptr, 0.25f);
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 2, nullptr, 0.25f);
+
+        // And these are all hits.
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(20).Get(), 0.25f);
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 2, nullptr, 0.25f);
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(2u, statistics.HitCount);
+        Assert::AreEqual(5u, statistics.MissCount);
+        Assert::AreEqual(5u, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_InvalidTolerance_IsNotCached)
+    {
+        Fixture f;
+
+        f.Device->CreateFilledGeometryRealizationMethod.SetExpectedCalls(2,
+            [](ID2D1Geometry*, float flatteningTolerance)
+            {
+                Assert::AreEqual(0.0f, flatteningTolerance);
+                return Make<MockD2DGeometryRealization>();
+            });
+
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 0);
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(10).Get(), 0);
+
+        Assert::AreEqual(0u, f.GetStatistics().EntryCount);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_LeastRecentlyUsed_IsEvictedToStayWithinBudget)
+    {
+        Fixture f;
+
+        f.Device->CreateFilledGeometryRealizationMethod.AllowAnyCall(
+            [](ID2D1Geometry*, float) { return Make<MockD2DGeometryRealization>(); });
+
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(1).Get(), 0.25f);
+        auto oneEntrySize = f.GetStatistics().SizeInBytes;
+
+        f.Cache->SetMaximumBytes(oneEntrySize * 2);
+
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(2).Get(), 0.25f);
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(1).Get(), 0.25f);     // hit; 1 is now most recent
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(3).Get(), 0.25f);     // evicts 2
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(2u, statistics.EntryCount);
+        Assert::AreEqual(1u, statistics.EvictionCount);
+        Assert::IsTrue(statistics.SizeInBytes <= oneEntrySize * 2);
+
+        CanvasCachedGeometry::CreateNew(f.Device.Get(), f.MakeSquare(1).Get(), 0.25f);
+        Assert::AreEqual(2u, f.GetStatistics().HitCount);
+
+        f.Cache->Clear();
+        Assert::AreEqual(0u, f.GetStatistics().EntryCount);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_Tessellation_IsReusedAcrossSimilarTransforms)
+    {
+        Fixture f;
+
+        auto geometry = f.MakeSquare(10);
+
+        ComArray<CanvasTriangleVertices> triangles1, triangles2;
+
+        ThrowIfFailed(geometry->TessellateWithEngine(Matrix3x2{ 2, 0, 0, 2, 100, 0 }, 0.25f, CanvasTessellationEngine::Direct2D, triangles1.GetAddressOfSize(), triangles1.GetAddressOfData()));
+        ThrowIfFailed(geometry->TessellateWithEngine(Matrix3x2{ 1.75f, 0, 0, -1.75f, 0, 0 }, 0.25f, CanvasTessellationEngine::Direct2D, triangles2.GetAddressOfSize(), triangles2.GetAddressOfData()));
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(1u, statistics.HitCount);
+        Assert::AreEqual(1u, statistics.MissCount);
+
+        // The cached triangles are transformed by each caller's transform.
+        Assert::AreEqual(1u, triangles1.GetSize());
+        Assert::AreEqual(Vector2{ 100, 0 }, triangles1[0].Vertex1);
+        Assert::AreEqual(Vector2{ 120, 0 }, triangles1[0].Vertex2);
+        Assert::AreEqual(Vector2{ 100, 20 }, triangles1[0].Vertex3);
+
+        // The second transform mirrors the geometry, so the winding is
+        // reversed to keep the triangle clockwise.
+        Assert::AreEqual(1u, triangles2.GetSize());
+        Assert::AreEqual(Vector2{ 0, 0 }, triangles2[0].Vertex1);
+        Assert::AreEqual(Vector2{ 0, -17.5f }, triangles2[0].Vertex2);
+        Assert::AreEqual(Vector2{ 17.5f, 0 }, triangles2[0].Vertex3);
+
+        // A much larger zoom needs a finer tessellation.
+        ComArray<CanvasTriangleVertices> triangles3;
+        ThrowIfFailed(geometry->TessellateWithEngine(Matrix3x2{ 8, 0, 0, 8, 0, 0 }, 0.25f, CanvasTessellationEngine::Direct2D, triangles3.GetAddressOfSize(), triangles3.GetAddressOfData()));
+
+        Assert::AreEqual(2u, f.GetStatistics().MissCount);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_Tessellation_IsCachedPerEngine)
+    {
+        Fixture f;
+
+        auto geometry = f.MakeSquare(10);
+
+        for (auto engine : { CanvasTessellationEngine::Direct2D, CanvasTessellationEngine::Cpu, CanvasTessellationEngine::Cpu })
+        {
+            ComArray<CanvasTriangleVertices> triangles;
+            ThrowIfFailed(geometry->TessellateWithEngine(Matrix3x2{ 1, 0, 0, 1, 0, 0 }, 0.25f, engine, triangles.GetAddressOfSize(), triangles.GetAddressOfData()));
+        }
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(1u, statistics.HitCount);
+        Assert::AreEqual(2u, statistics.MissCount);
+    }
+
+    TEST_METHOD_EX(GeometryRealizationCache_Tessellation_InvalidEngineIsRejectedBeforeLookup)
+    {
+        Fixture f;
+
+        auto geometry = f.MakeSquare(10);
+
+        ComArray<CanvasTriangleVertices> triangles;
+        ThrowIfFailed(geometry->TessellateWithEngine(Matrix3x2{ 1, 0, 0, 1, 0, 0 }, 0.25f, CanvasTessellationEngine::Direct2D, triangles.GetAddressOfSize(), triangles.GetAddressOfData()));
+
+        // This must not be served by the Direct2D entry that is now cached.
+        ComArray<CanvasTriangleVertices> invalidTriangles;
+        Assert::AreEqual(E_INVALIDARG, geometry->TessellateWithEngine(Matrix3x2{ 1, 0, 0, 1, 0, 0 }, 0.25f, static_cast<CanvasTessellationEngine>(2), invalidTriangles.GetAddressOfSize(), invalidTriangles.GetAddressOfData()));
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(0u, statistics.HitCount);
+        Assert::AreEqual(1u, statistics.MissCount);
+    }
+};
@@ -0,0 +1,386 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/geometry/PathData.h>
+#include "mocks/MockD2DGeometrySink.h"
+#include "mocks/MockD2DPathGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+static ComPtr<PathDataWriter> MakeWriter(float quantizationStep = 0)
+{
+    auto writer = Make<PathDataWriter>(quantizationStep);
+    CheckMakeResult(writer);
+    return writer;
+}
+
+
+// Sends one of every kind of command, with several consecutive lines.
+static void WriteEveryCommand(ID2D1GeometrySink* sink)
+{
+    D2D1_POINT_2F lines[] = { { 3, 4 }, { 5, 6 } };
+    D2D1_BEZIER_SEGMENT bezier{ { 7, 8 }, { 9, 10 }, { 11, 12 } };
+    D2D1_QUADRATIC_BEZIER_SEGMENT quadraticBezier{ { 13, 14 }, { 15, 16 } };
+    D2D1_ARC_SEGMENT arc{ { 17, 18 }, { 19, 20 }, 45, D2D1_SWEEP_DIRECTION_CLOCKWISE, D2D1_ARC_SIZE_LARGE };
+
+    sink->SetFillMode(D2D1_FILL_MODE_WINDING);
+    sink->SetSegmentFlags(D2D1_PATH_SEGMENT_FORCE_UNSTROKED);
+    sink->BeginFigure(D2D1_POINT_2F{ 1, 2 }, D2D1_FIGURE_BEGIN_HOLLOW);
+    sink->AddLines(lines, 2);
+    sink->AddLine(D2D1_POINT_2F{ -1, -2 });
+    sink->AddBezier(&bezier);
+    sink->AddQuadraticBezier(&quadraticBezier);
+    sink->AddArc(&arc);
+    sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+}
+
+
+static std::vector<uint8_t> Encode(float quantizationStep, std::function<void(ID2D1GeometrySink*)> const& write)
+{
+    auto writer = MakeWriter(quantizationStep);
+    write(writer.Get());
+    ThrowIfFailed(writer->Close());
+    return writer->GetData();
+}
+
+
+TEST_CLASS(PathDataUnitTests)
+{
+public:
+    TEST_METHOD_EX(PathData_RoundTrip_IsExact)
+    {
+        for (auto quantizationStep : { 0.0f, 1.0f })
+        {
+            auto data = Encode(quantizationStep, WriteEveryCommand);
+
+            // Reading the data back into a writer must reproduce it exactly.
+            auto rewritten = Encode(quantizationStep, [&](ID2D1GeometrySink* sink) { ReadPathData(data.data(), data.size(), sink); });
+
+            Assert::IsTrue(data == rewritten);
+        }
+    }
+
+    TEST_METHOD_EX(PathData_Read_PassesEachCommandToSink)
+    {
+        auto data = Encode(0, WriteEveryCommand);
+
+        auto sink = Make<MockD2DGeometrySink>();
+
+        sink->SetFillModeMethod.SetExpectedCalls(1, [](D2D1_FILL_MODE fillMode) { Assert::AreEqual(D2D1_FILL_MODE_WINDING, fillMode); });
+        sink->SetSegmentFlagsMethod.SetExpectedCalls(1, [](D2D1_PATH_SEGMENT flags) { Assert::AreEqual(D2D1_PATH_SEGMENT_FORCE_UNSTROKED, flags); });
+
+        sink->BeginFigureMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F point, D2D1_FIGURE_BEGIN figureBegin)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 1, 2 }, point);
+                Assert::AreEqual(D2D1_FIGURE_BEGIN_HOLLOW, figureBegin);
+            });
+
+        // The separate AddLines and AddLine calls arrive as a single run.
+        sink->AddLinesMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F const* points, uint32_t count)
+            {
+                Assert::AreEqual(3u, count);
+                Assert::AreEqual(D2D1_POINT_2F{ 3, 4 }, points[0]);
+                Assert::AreEqual(D2D1_POINT_2F{ 5, 6 }, points[1]);
+                Assert::AreEqual(D2D1_POINT_2F{ -1, -2 }, points[2]);
+            });
+
+        sink->AddBeziersMethod.SetExpectedCalls(1,
+            [](D2D1_BEZIER_SEGMENT const* beziers, uint32_t count)
+            {
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1_POINT_2F{ 7, 8 }, beziers[0].point1);
+                Assert::AreEqual(D2D1_POINT_2F{ 11, 12 }, beziers[0].point3);
+            });
+
+        sink->AddQuadraticBeziersMethod.SetExpectedCalls(1,
+            [](D2D1_QUADRATIC_BEZIER_SEGMENT const* beziers, uint32_t count)
+            {
+                Assert::AreEqual(1u, count);
+                Assert::AreEqual(D2D1_POINT_2F{ 13, 14 }, beziers[0].point1);
+                Assert::AreEqual(D2D1_POINT_2F{ 15, 16 }, beziers[0].point2);
+            });
+
+        sink->AddArcMethod.SetExpectedCalls(1,
+            [](D2D1_ARC_SEGMENT const* arc)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 17, 18 }, arc->point);
+                Assert::AreEqual(19.0f, arc->size.width);
+                Assert::AreEqual(20.0f, arc->size.height);
+                Assert::AreEqual(45.0f, arc->rotationAngle);
+                Assert::AreEqual(D2D1_SWEEP_DIRECTION_CLOCKWISE, arc->sweepDirection);
+                Assert::AreEqual(D2D1_ARC_SIZE_LARGE, arc->arcSize);
+            });
+
+        sink->EndFigureMethod.SetExpectedCalls(1, [](D2D1_FIGURE_END figureEnd) { Assert::AreEqual(D2D1_FIGURE_END_CLOSED, figureEnd); });
+
+        ReadPathData(data.data(), data.size(), sink.Get());
+    }
+
+    TEST_METHOD_EX(PathData_Quantized_RoundsToStepAndIsSmaller)
+    {
+        std::vector<D2D1_POINT_2F> points;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            points.push_back(D2D1_POINT_2F{ 1000 + i * 0.3f, 2000 - i * 0.2f });
+        }
+
+        auto write = [&](ID2D1GeometrySink* sink)
+        {
+            sink->BeginFigure(D2D1_POINT_2F{ 0.1f, -0.1f }, D2D1_FIGURE_BEGIN_FILLED);
+            sink->AddLines(points.data(), static_cast<uint32_t>(points.size()));
+            sink->EndFigure(D2D1_FIGURE_END_OPEN);
+        };
+
+        auto floatData = Encode(0, write);
+        auto quantizedData = Encode(0.25f, write);
+
+        // Small deltas take one or two bytes per coordinate instead of four.
+        Assert::IsTrue(quantizedData.size() * 2 < floatData.size());
+
+        auto sink = Make<MockD2DGeometrySink>();
+
+        sink->BeginFigureMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F point, D2D1_FIGURE_BEGIN)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 0, 0 }, point);
+            });
+
+        sink->AddLinesMethod.SetExpectedCalls(1,
+            [&](D2D1_POINT_2F const* readPoints, uint32_t count)
+            {
+                Assert::AreEqual(static_cast<uint32_t>(points.size()), count);
+
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    Assert::AreEqual(std::round(points[i].x * 4) / 4, readPoints[i].x);
+                    Assert::AreEqual(std::round(points[i].y * 4) / 4, readPoints[i].y);
+                }
+            });
+
+        sink->EndFigureMethod.SetExpectedCalls(1);
+
+        ReadPathData(quantizedData.data(), quantizedData.size(), sink.Get());
+    }
+
+    TEST_METHOD_EX(PathData_Quantized_RejectsPointsThatCannotBeQuantized)
+    {
+        for (auto value : { NAN, INFINITY, 1e30f })
+        {
+            auto writer = MakeWriter(1e-10f);
+
+            writer->BeginFigure(D2D1_POINT_2F{ 0, value }, D2D1_FIGURE_BEGIN_FILLED);
+
+            // The error is available straight away, not just from Close.
+            Assert::AreEqual(E_INVALIDARG, writer->GetResult());
+
+            writer->EndFigure(D2D1_FIGURE_END_OPEN);
+
+            Assert::AreEqual(E_INVALIDARG, writer->Close());
+            ValidateStoredErrorState(E_INVALIDARG, Strings::PathDataCannotQuantize);
+        }
+    }
+
+    TEST_METHOD_EX(PathData_Read_RejectsInvalidData)
+    {
+        auto valid = Encode(0, WriteEveryCommand);
+        auto sink = Make<MockD2DGeometrySink>();
+
+        sink->SetFillModeMethod.AllowAnyCall();
+        sink->SetSegmentFlagsMethod.AllowAnyCall();
+        sink->BeginFigureMethod.AllowAnyCall();
+        sink->AddLinesMethod.AllowAnyCall();
+        sink->AddBeziersMethod.AllowAnyCall();
+        sink->AddQuadraticBeziersMethod.AllowAnyCall();
+        sink->AddArcMethod.AllowAnyCall();
+        sink->EndFigureMethod.AllowAnyCall();
+
+        auto expectInvalid = [&](std::vector<uint8_t> const& data)
+        {
+            ExpectHResultException(E_INVALIDARG, [&] { ReadPathData(data.data(), data.size(), sink.Get()); });
+            ValidateStoredErrorState(E_INVALIDARG, Strings::InvalidPathData);
+        };
+
+        // Truncated anywhere, including part way through the header.
+        for (size_t size : { size_t(0), sizeof(PathDataHeader) - 1, valid.size() - 1 })
+        {
+            expectInvalid(std::vector<uint8_t>(valid.begin(), valid.begin() + size));
+        }
+
+        auto badMagic = valid;
+        badMagic[0]++;
+        expectInvalid(badMagic);
+
+        auto badVersion = valid;
+        badVersion[offsetof(PathDataHeader, Version)]++;
+        expectInvalid(badVersion);
+
+        auto unknownCommand = valid;
+        unknownCommand.push_back(0xFF);
+        expectInvalid(unknownCommand);
+
+        auto badEnum = valid;
+        badEnum.push_back(static_cast<uint8_t>(PathDataCommand::EndFigure));
+        badEnum.push_back(2);
+        expectInvalid(badEnum);
+
+        // A count larger than the remaining data could hold is rejected
+        // before anything is allocated.
+        auto hugeCount = valid;
+        hugeCount.push_back(static_cast<uint8_t>(PathDataCommand::Lines));
+        hugeCount.insert(hugeCount.end(), { 0xFF, 0xFF, 0xFF, 0xFF, 0x0F });
+        expectInvalid(hugeCount);
+    }
+
+    TEST_METHOD_EX(PathData_CanvasGeometry_RoundTrip)
+    {
+        auto device = Make<StubCanvasDevice>();
+
+        auto d2dGeometry = Make<MockD2DPathGeometry>();
+
+        d2dGeometry->StreamMethod.SetExpectedCalls(1,
+            [](ID2D1GeometrySink* sink)
+            {
+                WriteEveryCommand(sink);
+                return S_OK;
+            });
+
+        auto canvasGeometry = Make<CanvasGeometry>(device.Get(), d2dGeometry.Get());
+
+        ComArray<uint8_t> bytes;
+        ThrowIfFailed(canvasGeometry->GetPathBytes(bytes.GetAddressOfSize(), bytes.GetAddressOfData()));
+
+        Assert::IsTrue(std::vector<uint8_t>(bytes.GetData(), bytes.GetData() + bytes.GetSize()) == Encode(0, WriteEveryCommand));
+
+        // Loading the bytes sends them straight into the new path's sink.
+        auto loadedWriter = MakeWriter();
+
+        device->CreatePathGeometryMethod.SetExpectedCalls(1,
+            [&]
+            {
+                auto pathGeometry = Make<MockD2DPathGeometry>();
+
+                pathGeometry->OpenMethod.SetExpectedCalls(1,
+                    [&](ID2D1GeometrySink** sink)
+                    {
+                        return loadedWriter.CopyTo(sink);
+                    });
+
+                return pathGeometry;
+            });
+
+        auto factory = Make<CanvasGeometryFactory>();
+
+        ComPtr<ICanvasGeometry> loadedGeometry;
+        ThrowIfFailed(factory->CreatePathFromBytes(device.Get(), bytes.GetSize(), bytes.GetData(), &loadedGeometry));
+
+        Assert::IsTrue(loadedWriter->GetData() == Encode(0, WriteEveryCommand));
+
+        ComArray<uint8_t> unusedBytes;
+        Assert::AreEqual(E_INVALIDARG, canvasGeometry->GetPathBytesWithQuantizationStep(-1, unusedBytes.GetAddressOfSize(), unusedBytes.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->CreatePathFromBytes(device.Get(), 0, nullptr, &loadedGeometry));
+    }
+
+    TEST_METHOD_EX(PathData_Read_AlignedFloatPointsArePassedInPlace)
+    {
+        D2D1_POINT_2F lines[] = { { 3, 4 }, { 5, 6 } };
+
+        auto data = Encode(0, [&](ID2D1GeometrySink* sink)
+        {
+            // An odd number of bytes before the run, which the count is
+            // padded to make up for.
+            sink->SetFillMode(D2D1_FILL_MODE_WINDING);
+            sink->BeginFigure(D2D1_POINT_2F{ 1, 2 }, D2D1_FIGURE_BEGIN_FILLED);
+            sink->AddLines(lines, 2);
+            sink->EndFigure(D2D1_FIGURE_END_OPEN);
+        });
+
+        // Copied one byte along, so that the points are no longer aligned.
+        std::vector<uint8_t> unalignedBuffer(data.size() + 1);
+        memcpy(unalignedBuffer.data() + 1, data.data(), data.size());
+
+        for (auto bytes : { data.data(), unalignedBuffer.data() + 1 })
+        {
+            auto sink = Make<MockD2DGeometrySink>();
+
+            sink->SetFillModeMethod.SetExpectedCalls(1);
+            sink->BeginFigureMethod.SetExpectedCalls(1);
+            sink->EndFigureMethod.SetExpectedCalls(1);
+
+            sink->AddLinesMethod.SetExpectedCalls(1,
+                [&](D2D1_POINT_2F const* points, uint32_t count)
+                {
+                    auto pointBytes = reinterpret_cast<uint8_t const*>(points);
+                    bool isInPlace = (pointBytes >= bytes && pointBytes < bytes + data.size());
+
+                    Assert::AreEqual(bytes == data.data(), isInPlace);
+                    Assert::AreEqual(0u, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(points) % alignof(D2D1_POINT_2F)));
+
+                    Assert::AreEqual(2u, count);
+                    Assert::AreEqual(lines[0], points[0]);
+                    Assert::AreEqual(lines[1], points[1]);
+                });
+
+            ReadPathData(bytes, data.size(), sink.Get());
+        }
+    }
+
+    TEST_METHOD_EX(PathData_Read_LongLineRunsAreSentInSingleCalls)
+    {
+        const uint32_t figureCount = 3;
+        const uint32_t segmentsPerFigure = 1000;
+
+        // Every coordinate is a multiple of 1/16, so both encodings are exact.
+        auto getPoint = [](uint32_t figure, uint32_t i)
+        {
+            return D2D1_POINT_2F{ i * 0.5f, figure + (i % 7) * 0.125f };
+        };
+
+        auto write = [&](ID2D1GeometrySink* sink)
+        {
+            std::vector<D2D1_POINT_2F> points(segmentsPerFigure);
+
+            for (uint32_t figure = 0; figure < figureCount; ++figure)
+            {
+                sink->BeginFigure(D2D1_POINT_2F{ 0, static_cast<float>(figure) }, D2D1_FIGURE_BEGIN_FILLED);
+
+                for (uint32_t i = 0; i < segmentsPerFigure; ++i)
+                {
+                    points[i] = getPoint(figure, i);
+                }
+
+                sink->AddLines(points.data(), segmentsPerFigure);
+                sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+            }
+        };
+
+        for (auto quantizationStep : { 0.0f, 1.0f / 16 })
+        {
+            auto data = Encode(quantizationStep, write);
+
+            uint32_t figure = 0;
+
+            auto sink = Make<MockD2DGeometrySink>();
+            sink->BeginFigureMethod.SetExpectedCalls(figureCount);
+            sink->EndFigureMethod.SetExpectedCalls(figureCount, [&](D2D1_FIGURE_END) { ++figure; });
+            sink->AddLinesMethod.SetExpectedCalls(figureCount,
+                [&](D2D1_POINT_2F const* points, uint32_t count)
+                {
+                    Assert::AreEqual(segmentsPerFigure, count);
+
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        Assert::AreEqual(getPoint(figure, i), points[i]);
+                    }
+                });
+
+            ReadPathData(data.data(), data.size(), sink.Get());
+        }
+    }
+};
@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <random>
+#include <lib/geometry/PolylineDecimation.h>
+#include "mocks/MockD2DGeometrySink.h"
+#include "mocks/MockD2DPathGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+typedef std::vector<D2D1_POINT_2F> Polyline;
+
+
+static Polyline Decimate(Polyline points, bool isClosed, float tolerance)
+{
+    auto keptCount = DecimatePolyline(points.data(), static_cast<uint32_t>(points.size()), isClosed, tolerance);
+
+    points.resize(keptCount);
+    return points;
+}
+
+
+static void AssertPolylinesEqual(Polyline const& expected, Polyline const& actual)
+{
+    Assert::AreEqual(expected.size(), actual.size());
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        Assert::AreEqual(expected[i].x, actual[i].x);
+        Assert::AreEqual(expected[i].y, actual[i].y);
+    }
+}
+
+
+TEST_CLASS(PolylineDecimationUnitTests)
+{
+public:
+    TEST_METHOD_EX(PolylineDecimation_CollinearPointsAreRemoved)
+    {
+        auto result = Decimate({ { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 } }, false, 0);
+
+        AssertPolylinesEqual({ { 0, 0 }, { 4, 0 } }, result);
+    }
+
+    TEST_METHOD_EX(PolylineDecimation_PointsWithinToleranceAreRemoved)
+    {
+        Polyline points{ { 0, 0 }, { 1, 0.4f }, { 2, 0 }, { 3, 5 }, { 4, 0 } };
+
+        AssertPolylinesEqual(points, Decimate(points, false, 0.3f));
+        AssertPolylinesEqual({ { 0, 0 }, { 2, 0 }, { 3, 5 }, { 4, 0 } }, Decimate(points, false, 0.5f));
+        AssertPolylinesEqual({ { 0, 0 }, { 4, 0 } }, Decimate(points, false, 10));
+    }
+
+    TEST_METHOD_EX(PolylineDecimation_ClosedPolylineKeepsCorners)
+    {
+        Polyline square{ { 0, 0 }, { 5, 0 }, { 10, 0 }, { 10, 5 }, { 10, 10 }, { 5, 10 }, { 0, 10 }, { 0, 5 } };
+
+        AssertPolylinesEqual({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } }, Decimate(square, true, 0.1f));
+
+        // When open, the last point is kept even though it is on a straight line.
+        AssertPolylinesEqual({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 0, 5 } }, Decimate(square, false, 0.1f));
+    }
+
+    TEST_METHOD_EX(PolylineDecimation_ShortPolylinesAreUnchanged)
+    {
+        AssertPolylinesEqual({}, Decimate({}, false, 1));
+        AssertPolylinesEqual({ { 1, 2 } }, Decimate({ { 1, 2 } }, true, 1));
+        AssertPolylinesEqual({ { 1, 2 }, { 1, 2 } }, Decimate({ { 1, 2 }, { 1, 2 } }, false, 1));
+    }
+
+    TEST_METHOD_EX(PolylineDecimation_EachFigureIsDecimatedSeparately)
+    {
+        Polylines polylines;
+
+        polylines.Points = { { 0, 0 }, { 1, 0 }, { 2, 0 },
+                             { 7, 7 },
+                             { 0, 0 }, { 5, 0 }, { 10, 0 }, { 10, 10 } };
+
+        polylines.Figures = { { 0, 3, true, false },
+                              { 3, 4, true, false },
+                              { 4, 8, true, true } };
+
+        DecimatePolylines(&polylines, 0.1f);
+
+        Assert::AreEqual(0u, polylines.Figures[0].Begin);
+        Assert::AreEqual(2u, polylines.Figures[0].End);
+        Assert::AreEqual(3u, polylines.Figures[1].Begin);
+        Assert::AreEqual(4u, polylines.Figures[1].End);
+        Assert::AreEqual(4u, polylines.Figures[2].Begin);
+        Assert::AreEqual(7u, polylines.Figures[2].End);
+
+        AssertPolylinesEqual({ { 0, 0 }, { 10, 0 }, { 10, 10 } }, Polyline(polylines.Points.begin() + 4, polylines.Points.begin() + 7));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_Decimate_SendsReducedFiguresToNewPath)
+    {
+        auto device = Make<StubCanvasDevice>();
+        auto d2dGeometry = Make<MockD2DPathGeometry>();
+
+        d2dGeometry->SimplifyMethod.SetExpectedCalls(1,
+            [](D2D1_GEOMETRY_SIMPLIFICATION_OPTION option, D2D1_MATRIX_3X2_F const* transform, float flatteningTolerance, ID2D1SimplifiedGeometrySink* sink)
+            {
+                Assert::IsTrue(option == D2D1_GEOMETRY_SIMPLIFICATION_OPTION_LINES);
+                Assert::IsNull(transform);
+                Assert::AreEqual(0.1f, flatteningTolerance);
+
+                D2D1_POINT_2F points[] = { { 1, 0 }, { 2, 0 }, { 2, 1 }, { 2, 2 } };
+
+                sink->SetFillMode(D2D1_FILL_MODE_WINDING);
+                sink->BeginFigure(D2D1_POINT_2F{ 0, 0 }, D2D1_FIGURE_BEGIN_FILLED);
+                sink->AddLines(points, _countof(points));
+                sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+
+                return S_OK;
+            });
+
+        auto resultSink = Make<MockD2DGeometrySink>();
+
+        device->CreatePathGeometryMethod.SetExpectedCalls(1,
+            [&]
+            {
+                auto pathGeometry = Make<MockD2DPathGeometry>();
+
+                pathGeometry->OpenMethod.SetExpectedCalls(1,
+                    [&](ID2D1GeometrySink** out)
+                    {
+                        return resultSink.CopyTo(out);
+                    });
+
+                return pathGeometry;
+            });
+
+        resultSink->SetFillModeMethod.SetExpectedCalls(1, [](D2D1_FILL_MODE fillMode) { Assert::AreEqual(D2D1_FILL_MODE_WINDING, fillMode); });
+        resultSink->BeginFigureMethod.SetExpectedCalls(1, [](D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin)
+        {
+            Assert::AreEqual(D2D1_POINT_2F{ 0, 0 }, startPoint);
+            Assert::AreEqual(D2D1_FIGURE_BEGIN_FILLED, figureBegin);
+        });
+        resultSink->AddLinesMethod.SetExpectedCalls(1, [](D2D1_POINT_2F const* points, uint32_t count)
+        {
+            Assert::AreEqual(2u, count);
+            Assert::AreEqual(D2D1_POINT_2F{ 2, 0 }, points[0]);
+            Assert::AreEqual(D2D1_POINT_2F{ 2, 2 }, points[1]);
+        });
+        resultSink->EndFigureMethod.SetExpectedCalls(1, [](D2D1_FIGURE_END figureEnd) { Assert::AreEqual(D2D1_FIGURE_END_CLOSED, figureEnd); });
+        resultSink->CloseMethod.SetExpectedCalls(1);
+
+        auto geometry = Make<CanvasGeometry>(device.Get(), d2dGeometry.Get());
+
+        ComPtr<ICanvasGeometry> result;
+        ThrowIfFailed(geometry->Decimate(0.1f, &result));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_Decimate_InvalidArgs)
+    {
+        auto device = Make<StubCanvasDevice>();
+        auto geometry = Make<CanvasGeometry>(device.Get(), Make<MockD2DPathGeometry>().Get());
+        auto factory = Make<CanvasGeometryFactory>();
+
+        ComPtr<ICanvasGeometry> result;
+        Assert::AreEqual(E_INVALIDARG, geometry->Decimate(0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, geometry->Decimate(-1, &result));
+        Assert::AreEqual(E_INVALIDARG, geometry->Decimate(NAN, &result));
+
+        Vector2 points[] = { { 0, 0 }, { 1, 1 } };
+        uint32_t count;
+        Vector2* values;
+        Assert::AreEqual(E_INVALIDARG, factory->DecimatePoints(1, nullptr, 1, false, &count, &values));
+        Assert::AreEqual(E_INVALIDARG, factory->DecimatePoints(2, points, -1, false, &count, &values));
+        Assert::AreEqual(E_INVALIDARG, factory->DecimatePoints(2, points, 1, false, nullptr, &values));
+        Assert::AreEqual(E_INVALIDARG, factory->DecimatePoints(2, points, 1, false, &count, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_DecimatePoints)
+    {
+        auto factory = Make<CanvasGeometryFactory>();
+
+        Vector2 points[] = { { 0, 0 }, { 5, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } };
+
+        ComArray<Vector2> result;
+        ThrowIfFailed(factory->DecimatePoints(_countof(points), points, 0.5f, true, result.GetAddressOfSize(), result.GetAddressOfData()));
+
+        Assert::AreEqual(4u, result.GetSize());
+        Assert::AreEqual(Vector2{ 0, 0 }, result[0]);
+        Assert::AreEqual(Vector2{ 10, 0 }, result[1]);
+        Assert::AreEqual(Vector2{ 10, 10 }, result[2]);
+        Assert::AreEqual(Vector2{ 0, 10 }, result[3]);
+    }
+
+    TEST_METHOD_EX(PolylineDecimation_LargePathsGiveTheSameResultAsEachFigureAlone)
+    {
+        // Enough points in total for the figures to be spread across threads.
+        const uint32_t figureCount = 4;
+        const uint32_t pointsPerFigure = 20000;
+        const float tolerance = 0.5f;
+
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> noise(-0.2f, 0.2f);
+
+        Polylines polylines;
+
+        for (uint32_t figure = 0; figure < figureCount; ++figure)
+        {
+            auto begin = static_cast<uint32_t>(polylines.Points.size());
+
+            for (uint32_t i = 0; i < pointsPerFigure; ++i)
+            {
+                float angle = DirectX::XM_2PI * i / pointsPerFigure;
+                float radius = 100.0f + figure * 10 + 5 * sinf(angle * 20);
+
+                polylines.Points.push_back(D2D1_POINT_2F{ radius * cosf(angle) + noise(random), radius * sinf(angle) + noise(random) });
+            }
+
+            polylines.Figures.push_back(PolylineFigure{ begin, begin + pointsPerFigure, true, true });
+        }
+
+        auto original = polylines;
+
+        DecimatePolylines(&polylines, tolerance);
+
+        for (uint32_t figure = 0; figure < figureCount; ++figure)
+        {
+            auto& originalFigure = original.Figures[figure];
+            auto& decimatedFigure = polylines.Figures[figure];
+
+            Polyline originalPoints(original.Points.begin() + originalFigure.Begin, original.Points.begin() + originalFigure.End);
+            Polyline decimatedPoints(polylines.Points.begin() + decimatedFigure.Begin, polylines.Points.begin() + decimatedFigure.End);
+
+            Assert::AreEqual(originalFigure.Begin, decimatedFigure.Begin);
+            Assert::IsTrue(decimatedPoints.size() < originalPoints.size() / 10);
+
+            AssertPolylinesEqual(Decimate(originalPoints, true, tolerance), decimatedPoints);
+        }
+    }
+};
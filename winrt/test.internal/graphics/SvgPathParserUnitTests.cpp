@@ -0,0 +1,298 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/geometry/PathData.h>
+#include <lib/geometry/SvgPathParser.h>
+#include "mocks/MockD2DGeometrySink.h"
+#include "mocks/MockD2DPathGeometry.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+
+static void Parse(std::wstring const& pathData, ID2D1GeometrySink* sink)
+{
+    ParseSvgPathData(pathData.c_str(), pathData.size(), sink);
+}
+
+
+// Encodes what the parser sends to its sink, so that two strings can be
+// checked for producing exactly the same path.
+static std::vector<uint8_t> ParseToPathData(std::wstring const& pathData)
+{
+    auto writer = Make<PathDataWriter>(0.0f);
+    CheckMakeResult(writer);
+
+    Parse(pathData, writer.Get());
+
+    ThrowIfFailed(writer->Close());
+    return writer->GetData();
+}
+
+
+static void AssertSamePath(std::wstring const& expected, std::wstring const& actual)
+{
+    Assert::IsTrue(ParseToPathData(expected) == ParseToPathData(actual), actual.c_str());
+}
+
+
+TEST_CLASS(SvgPathParserUnitTests)
+{
+public:
+    TEST_METHOD_EX(SvgPathParser_AbsoluteCommands_ArePassedToSink)
+    {
+        auto sink = Make<MockD2DGeometrySink>();
+
+        sink->BeginFigureMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F point, D2D1_FIGURE_BEGIN figureBegin)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 1, 2 }, point);
+                Assert::AreEqual(D2D1_FIGURE_BEGIN_FILLED, figureBegin);
+            });
+
+        // L, H and V are batched into one call.
+        sink->AddLinesMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F const* points, uint32_t count)
+            {
+                Assert::AreEqual(3u, count);
+                Assert::AreEqual(D2D1_POINT_2F{ 3, 4 }, points[0]);
+                Assert::AreEqual(D2D1_POINT_2F{ 5, 4 }, points[1]);
+                Assert::AreEqual(D2D1_POINT_2F{ 5, 6 }, points[2]);
+            });
+
+        sink->AddBezierMethod.SetExpectedCalls(1,
+            [](D2D1_BEZIER_SEGMENT const* bezier)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 7, 8 }, bezier->point1);
+                Assert::AreEqual(D2D1_POINT_2F{ 9, 10 }, bezier->point2);
+                Assert::AreEqual(D2D1_POINT_2F{ 11, 12 }, bezier->point3);
+            });
+
+        sink->AddQuadraticBezierMethod.SetExpectedCalls(1,
+            [](D2D1_QUADRATIC_BEZIER_SEGMENT const* bezier)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 13, 14 }, bezier->point1);
+                Assert::AreEqual(D2D1_POINT_2F{ 15, 16 }, bezier->point2);
+            });
+
+        sink->AddArcMethod.SetExpectedCalls(1,
+            [](D2D1_ARC_SEGMENT const* arc)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 19, 20 }, arc->point);
+                Assert::AreEqual(17.0f, arc->size.width);
+                Assert::AreEqual(18.0f, arc->size.height);
+                Assert::AreEqual(45.0f, arc->rotationAngle);
+                Assert::AreEqual(D2D1_ARC_SIZE_LARGE, arc->arcSize);
+                Assert::AreEqual(D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE, arc->sweepDirection);
+            });
+
+        sink->EndFigureMethod.SetExpectedCalls(1, [](D2D1_FIGURE_END figureEnd) { Assert::AreEqual(D2D1_FIGURE_END_CLOSED, figureEnd); });
+
+        Parse(L"M1 2 L3 4 H5 V6 C7 8 9 10 11 12 Q13 14 15 16 A17 18 45 1 0 19 20 Z", sink.Get());
+    }
+
+    TEST_METHOD_EX(SvgPathParser_RelativeCommands_AreRelativeToCurrentPoint)
+    {
+        AssertSamePath(
+            L"M10 20 L13 24 H15 V26 C17 28 19 30 21 32 Q23 34 25 36 A5 6 30 0 1 27 38 Z M40 50 L41 51",
+            L"m10 20 l3 4 h2 v2 c2 2 4 4 6 6 q2 2 4 4 a5 6 30 0 1 2 2 z m30 30 l1 1");
+
+        // After a closepath, relative coordinates continue from the start of
+        // the figure, and a new figure begins there.
+        AssertSamePath(
+            L"M10 10 L20 10 L20 20 Z M10 10 L15 15",
+            L"M10 10 l10 0 l0 10 z l5 5");
+    }
+
+    TEST_METHOD_EX(SvgPathParser_CompactSyntax)
+    {
+        // Extra coordinate pairs after a moveto are lines, and any command's
+        // arguments can repeat without repeating the command.
+        AssertSamePath(L"M1 2 L3 4 L5 6 C1 1 2 2 3 3 C4 4 5 5 6 6", L"M1 2 3 4 5 6 C1 1 2 2 3 3 4 4 5 5 6 6");
+        AssertSamePath(L"m1 2 l3 4 l5 6", L"m1 2 3 4 5 6");
+
+        // Signs and decimal points separate numbers, and commas and any
+        // whitespace are allowed between them.
+        AssertSamePath(L"M1 -2 L0.5 0.5 L-0.25 30", L"M1-2L.5.5-.25,3e1");
+        AssertSamePath(L"M1 2 L3 4", L"\t\r\n M 1 , 2\nL3,\t4 ");
+
+        // Arc flags do not need separators.
+        AssertSamePath(L"M0 0 A1 1 0 1 1 10 10", L"M0 0A1 1 0 1110 10");
+    }
+
+    TEST_METHOD_EX(SvgPathParser_Numbers)
+    {
+        AssertSamePath(L"M100 -0.001 L0.5 1000", L"M1e2-1E-3L5e-1+1e+3");
+        AssertSamePath(L"M1 0.1 L123456.5 0", L"M1. .1L123456.5000000000000000000001 0");
+        AssertSamePath(L"M0 0 L3.4e38 0", L"M0 0 L340000000000000000000000000000000000000 0");
+    }
+
+    TEST_METHOD_EX(SvgPathParser_SmoothCurves_ReflectPreviousControlPoint)
+    {
+        AssertSamePath(L"M0 0 C1 1 2 1 3 0 C4 -1 5 -1 6 0", L"M0 0 C1 1 2 1 3 0 S5 -1 6 0");
+        AssertSamePath(L"M0 0 Q1 1 2 0 Q3 -1 4 0 Q5 1 6 0", L"M0 0 Q1 1 2 0 T4 0 T6 0");
+
+        // Without a matching previous curve, the control point is the
+        // current point.
+        AssertSamePath(L"M0 0 L1 1 C1 1 2 2 3 3", L"M0 0 L1 1 S2 2 3 3");
+        AssertSamePath(L"M0 0 Q1 1 2 0 C2 0 4 0 5 0", L"M0 0 Q1 1 2 0 S4 0 5 0");
+        AssertSamePath(L"M0 0 C1 1 2 1 3 0 Q3 0 4 0", L"M0 0 C1 1 2 1 3 0 T4 0");
+    }
+
+    TEST_METHOD_EX(SvgPathParser_Arcs_FollowSvgRules)
+    {
+        // Zero radii make a line, and an arc to the current point is omitted.
+        AssertSamePath(L"M0 0 L10 10", L"M0 0 A0 5 0 0 0 10 10");
+        AssertSamePath(L"M0 0 L10 10", L"M0 0 L10 10 A5 5 0 0 0 10 10");
+
+        // Negative radii are treated as positive.
+        AssertSamePath(L"M0 0 A5 6 0 0 0 10 10", L"M0 0 A-5 -6 0 0 0 10 10");
+    }
+
+    TEST_METHOD_EX(SvgPathParser_MovetoWithoutSegments_ProducesNothing)
+    {
+        AssertSamePath(L"", L"   ");
+        AssertSamePath(L"", L"M1 2");
+        AssertSamePath(L"", L"M1 2 Z");
+        AssertSamePath(L"M5 6 L7 8", L"M1 2 M5 6 L7 8");
+    }
+
+    TEST_METHOD_EX(SvgPathParser_InvalidData_ReportsPosition)
+    {
+        auto sink = Make<MockD2DGeometrySink>();
+
+        sink->BeginFigureMethod.AllowAnyCall();
+        sink->AddLinesMethod.AllowAnyCall();
+        sink->AddArcMethod.AllowAnyCall();
+        sink->EndFigureMethod.AllowAnyCall();
+
+        std::pair<wchar_t const*, int> invalidPaths[] =
+        {
+            { L"L1 2",                  0 },    // Must start with a moveto
+            { L"M1",                    2 },    // Missing coordinate
+            { L"M1 2 X3 4",             5 },    // Unknown command
+            { L"M1 2 L3 4,",           10 },    // Trailing comma
+            { L"M1 2,L3 4",             5 },    // Comma before a command
+            { L"M1 2 L,3 4",            6 },    // Comma after a command
+            { L"M1 2 L3 .",             9 },    // Decimal point without digits
+            { L"M1 2 A1 1 0 2 0 3 3",  13 },    // Flag that is not 0 or 1
+            { L"M1 2 Z 3 4",            7 },    // Closepath takes no arguments
+            { L"M1e39 0",               1 },    // Too large for a float
+        };
+
+        for (auto& invalidPath : invalidPaths)
+        {
+            ExpectHResultException(E_INVALIDARG, [&] { Parse(invalidPath.first, sink.Get()); });
+
+            wchar_t expectedMessage[256];
+            swprintf_s(expectedMessage, Strings::InvalidSvgPathData, invalidPath.second);
+            ValidateStoredErrorState(E_INVALIDARG, expectedMessage);
+        }
+    }
+
+    TEST_METHOD_EX(SvgPathParser_CanvasGeometry_CreatePathFromSvgPathData)
+    {
+        auto device = Make<StubCanvasDevice>();
+        auto factory = Make<CanvasGeometryFactory>();
+
+        for (auto filledRegionDetermination : { CanvasFilledRegionDetermination::Winding, CanvasFilledRegionDetermination::Alternate })
+        {
+            auto sink = Make<MockD2DGeometrySink>();
+
+            device->CreatePathGeometryMethod.SetExpectedCalls(1,
+                [&]
+                {
+                    auto pathGeometry = Make<MockD2DPathGeometry>();
+
+                    pathGeometry->OpenMethod.SetExpectedCalls(1,
+                        [&](ID2D1GeometrySink** value)
+                        {
+                            return sink.CopyTo(value);
+                        });
+
+                    return pathGeometry;
+                });
+
+            sink->SetFillModeMethod.SetExpectedCalls(1,
+                [&](D2D1_FILL_MODE fillMode)
+                {
+                    Assert::AreEqual(static_cast<D2D1_FILL_MODE>(filledRegionDetermination), fillMode);
+                });
+
+            sink->BeginFigureMethod.SetExpectedCalls(1);
+            sink->AddLinesMethod.SetExpectedCalls(1);
+            sink->EndFigureMethod.SetExpectedCalls(1);
+            sink->CloseMethod.SetExpectedCalls(1, [] { return S_OK; });
+
+            ComPtr<ICanvasGeometry> geometry;
+            WinString pathData(L"M0 0 h10 v10 z");
+
+            // The default follows SVG, which fills using the nonzero rule.
+            if (filledRegionDetermination == CanvasFilledRegionDetermination::Winding)
+                ThrowIfFailed(factory->CreatePathFromSvgPathData(device.Get(), pathData, &geometry));
+            else
+                ThrowIfFailed(factory->CreatePathFromSvgPathDataWithFilledRegionDetermination(device.Get(), pathData, filledRegionDetermination, &geometry));
+
+            Assert::IsNotNull(geometry.Get());
+        }
+
+        ComPtr<ICanvasGeometry> geometry;
+        Assert::AreEqual(E_INVALIDARG, factory->CreatePathFromSvgPathData(nullptr, WinString(L"M0 0"), &geometry));
+        Assert::AreEqual(E_INVALIDARG, factory->CreatePathFromSvgPathData(device.Get(), WinString(L"M0 0"), nullptr));
+    }
+
+    TEST_METHOD_EX(SvgPathParser_LineRuns_AreSentInOneCallUntilAnotherSegmentType)
+    {
+        std::vector<uint32_t> lineRuns;
+        int bezierIndex = -1;
+
+        auto sink = Make<MockD2DGeometrySink>();
+        sink->BeginFigureMethod.SetExpectedCalls(2);
+        sink->EndFigureMethod.SetExpectedCalls(2);
+        sink->AddLinesMethod.AllowAnyCall([&](D2D1_POINT_2F const*, uint32_t count) { lineRuns.push_back(count); });
+        sink->AddBezierMethod.SetExpectedCalls(1, [&](D2D1_BEZIER_SEGMENT const*) { bezierIndex = static_cast<int>(lineRuns.size()); });
+
+        // Lines written with different commands still share a run, which
+        // ends at the curve and at the end of each figure.
+        Parse(L"M0 0 L1 0 h1 v1 l1 1 C5 5 6 6 7 7 L8 8 9 9 z M0 0 1 1 2 2", sink.Get());
+
+        Assert::AreEqual<size_t>(3, lineRuns.size());
+        Assert::AreEqual(4u, lineRuns[0]);
+        Assert::AreEqual(2u, lineRuns[1]);
+        Assert::AreEqual(2u, lineRuns[2]);
+        Assert::AreEqual(1, bezierIndex);
+    }
+
+    TEST_METHOD_EX(SvgPathParser_LongLineRuns_ArriveInOrder)
+    {
+        const uint32_t lineCount = 150;
+
+        std::wstring pathData = L"M0 0";
+
+        for (uint32_t i = 1; i <= lineCount; ++i)
+        {
+            pathData += L" " + std::to_wstring(i) + L" " + std::to_wstring(i % 3);
+        }
+
+        std::vector<D2D1_POINT_2F> lines;
+
+        auto sink = Make<MockD2DGeometrySink>();
+        sink->BeginFigureMethod.SetExpectedCalls(1);
+        sink->EndFigureMethod.SetExpectedCalls(1);
+        sink->AddLinesMethod.AllowAnyCall([&](D2D1_POINT_2F const* points, uint32_t count) { lines.insert(lines.end(), points, points + count); });
+
+        Parse(pathData, sink.Get());
+
+        // Lines are buffered in fixed size batches, so a run this long takes several calls.
+        Assert::IsTrue(sink->AddLinesMethod.GetCurrentCallCount() > 1);
+
+        Assert::AreEqual<size_t>(lineCount, lines.size());
+
+        for (uint32_t i = 1; i <= lineCount; ++i)
+        {
+            Assert::AreEqual(D2D1_POINT_2F{ static_cast<float>(i), static_cast<float>(i % 3) }, lines[i - 1]);
+        }
+    }
+};
@@ -67,6 +67,10 @@ namespace canvas
         CALL_COUNTER_WITH_MOCK(LeaseHistogramEffectMethod, ComPtr<ID2D1Effect>(ID2D1DeviceContext*));
         CALL_COUNTER_WITH_MOCK(ReleaseHistogramEffectMethod, void(ComPtr<ID2D1Effect>));
 
+        CALL_COUNTER_WITH_MOCK(GetTextLayoutCacheMethod, Text::TextLayoutCache*());
+        CALL_COUNTER_WITH_MOCK(GetLayerPoolMethod, LayerPool*());
+        CALL_COUNTER_WITH_MOCK(GetGeometryRealizationCacheMethod, Geometry::GeometryRealizationCache*());
+
         CALL_COUNTER_WITH_MOCK(IsBufferPrecisionSupportedMethod, HRESULT(CanvasBufferPrecision, boolean*));
 
         CALL_COUNTER_WITH_MOCK(RaiseDeviceLostMethod, HRESULT());
@@ -136,6 +140,72 @@ namespace canvas
             return E_NOTIMPL;
         }
 
+        IFACEMETHODIMP get_TextLayoutCacheMaximumEntries(UINT32* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_TextLayoutCacheMaximumEntries");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP put_TextLayoutCacheMaximumEntries(UINT32 value) override
+        {
+            Assert::Fail(L"Unexpected call to put_TextLayoutCacheMaximumEntries");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP get_TextLayoutCacheMaximumBytes(UINT64* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_TextLayoutCacheMaximumBytes");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP put_TextLayoutCacheMaximumBytes(UINT64 value) override
+        {
+            Assert::Fail(L"Unexpected call to put_TextLayoutCacheMaximumBytes");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP get_TextLayoutCacheStatistics(CanvasTextLayoutCacheStatistics* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_TextLayoutCacheStatistics");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP get_LayerPoolMaximumBytes(UINT64* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_LayerPoolMaximumBytes");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP put_LayerPoolMaximumBytes(UINT64 value) override
+        {
+            Assert::Fail(L"Unexpected call to put_LayerPoolMaximumBytes");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP get_LayerPoolStatistics(CanvasLayerPoolStatistics* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_LayerPoolStatistics");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP get_GeometryRealizationCacheMaximumBytes(UINT64* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_GeometryRealizationCacheMaximumBytes");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP put_GeometryRealizationCacheMaximumBytes(UINT64 value) override
+        {
+            Assert::Fail(L"Unexpected call to put_GeometryRealizationCacheMaximumBytes");
+            return E_NOTIMPL;
+        }
+
+        IFACEMETHODIMP get_GeometryRealizationCacheStatistics(CanvasGeometryRealizationCacheStatistics* value) override
+        {
+            Assert::Fail(L"Unexpected call to get_GeometryRealizationCacheStatistics");
+            return E_NOTIMPL;
+        }
+
         IFACEMETHODIMP add_DeviceLost(
             DeviceLostHandlerType* value,
             EventRegistrationToken* token)
@@ -442,6 +512,21 @@ namespace canvas
             return ReleaseHistogramEffectMethod.WasCalled(effect);
         }
 
+        virtual Text::TextLayoutCache* GetTextLayoutCache() override
+        {
+            return GetTextLayoutCacheMethod.WasCalled();
+        }
+
+        virtual LayerPool* GetLayerPool() override
+        {
+            return GetLayerPoolMethod.WasCalled();
+        }
+
+        virtual Geometry::GeometryRealizationCache* GetGeometryRealizationCache() override
+        {
+            return GetGeometryRealizationCacheMethod.WasCalled();
+        }
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         virtual ComPtr<ID2D1GradientMesh> CreateGradientMesh(
             D2D1_GRADIENT_MESH_PATCH const* patches,
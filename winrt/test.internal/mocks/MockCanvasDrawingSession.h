@@ -214,6 +214,25 @@ namespace canvas
         DONT_EXPECT(DrawGlyphRun, Vector2, ICanvasFontFace*, float, uint32_t, CanvasGlyph*, boolean, uint32_t, ICanvasBrush*);
         DONT_EXPECT(DrawGlyphRunWithMeasuringMode, Vector2, ICanvasFontFace*, float, uint32_t, CanvasGlyph*, boolean, uint32_t, ICanvasBrush*, CanvasTextMeasuringMode);
         DONT_EXPECT(DrawGlyphRunWithMeasuringModeAndDescription, Vector2, ICanvasFontFace*, float, uint32_t, CanvasGlyph*, boolean, uint32_t, ICanvasBrush*, CanvasTextMeasuringMode, HSTRING, HSTRING, uint32_t, int*, uint32_t);
+
+        DONT_EXPECT(FillRectangles          , uint32_t, Rect*, uint32_t, Color*);
+        DONT_EXPECT(DrawRectangles          , uint32_t, Rect*, uint32_t, Color*, float);
+        DONT_EXPECT(FillRoundedRectangles   , uint32_t, Rect*, float, float, uint32_t, Color*);
+        DONT_EXPECT(FillEllipses            , uint32_t, Vector2*, uint32_t, Vector2*, uint32_t, Color*);
+        DONT_EXPECT(FillCircles             , uint32_t, Vector2*, uint32_t, float*, uint32_t, Color*);
+        DONT_EXPECT(DrawLines               , uint32_t, Vector2*, uint32_t, Color*, float);
+        DONT_EXPECT(DrawPoints              , uint32_t, Vector2*, uint32_t, Color*, float);
+
+        DONT_EXPECT(get_CoalesceColorFills  , boolean*);
+        DONT_EXPECT(put_CoalesceColorFills  , boolean);
+        DONT_EXPECT(get_ColorFillStatistics , CanvasColorFillStatistics*);
+        DONT_EXPECT(get_CollectStatistics   , boolean*);
+        DONT_EXPECT(put_CollectStatistics   , boolean);
+        DONT_EXPECT(get_Statistics          , CanvasDrawingSessionStatistics*);
+        DONT_EXPECT(get_StateChangeStatistics, CanvasStateChangeStatistics*);
+        DONT_EXPECT(get_CullInvisibleDraws  , boolean*);
+        DONT_EXPECT(put_CullInvisibleDraws  , boolean);
+        DONT_EXPECT(get_CulledDrawCount     , uint32_t*);
     
         DONT_EXPECT(get_Antialiasing            , CanvasAntialiasing*);
         DONT_EXPECT(put_Antialiasing            , CanvasAntialiasing);
@@ -247,6 +266,8 @@ namespace canvas
         DONT_EXPECT(CreateSpriteBatchWithSortMode                           , CanvasSpriteSortMode, ICanvasSpriteBatch**);
         DONT_EXPECT(CreateSpriteBatchWithSortModeAndInterpolation           , CanvasSpriteSortMode, CanvasImageInterpolation, ICanvasSpriteBatch**);
         DONT_EXPECT(CreateSpriteBatchWithSortModeAndInterpolationAndOptions , CanvasSpriteSortMode, CanvasImageInterpolation, CanvasSpriteOptions, ICanvasSpriteBatch**);
+        DONT_EXPECT(get_CoalesceBitmapDraws                                 , boolean*);
+        DONT_EXPECT(put_CoalesceBitmapDraws                                 , boolean);
 #endif
         
         // ICanvasResourceWrapperNative
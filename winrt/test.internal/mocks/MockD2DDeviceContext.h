@@ -40,6 +40,7 @@ namespace canvas
         MOCK_METHOD1(SetUnitMode                      , void(D2D1_UNIT_MODE));
         MOCK_METHOD2(SetDpi                           , void(float dpiX, float dpiY));
         MOCK_METHOD2_CONST(GetDpi                     , void(float* dpiX, float* dpiY));
+        MOCK_METHOD0_CONST(GetSize                    , D2D1_SIZE_F());
         MOCK_METHOD5(DrawLine                         , void(D2D1_POINT_2F,D2D1_POINT_2F,ID2D1Brush*,float,ID2D1StrokeStyle*));
         MOCK_METHOD4(DrawRectangle                    , void(D2D1_RECT_F const*,ID2D1Brush*,float,ID2D1StrokeStyle*));
         MOCK_METHOD2(FillRectangle                    , void(D2D1_RECT_F const*,ID2D1Brush*));
@@ -66,6 +67,7 @@ namespace canvas
         MOCK_METHOD4(DrawGeometry                     , void(ID2D1Geometry*, ID2D1Brush*,float,ID2D1StrokeStyle*));
         MOCK_METHOD3(FillGeometry                     , void(ID2D1Geometry*,ID2D1Brush*,ID2D1Brush*));
         MOCK_METHOD4(DrawTextLayout                   , void(D2D1_POINT_2F, IDWriteTextLayout*, ID2D1Brush*, D2D1_DRAW_TEXT_OPTIONS));
+        MOCK_METHOD2(CreateLayer                      , HRESULT(D2D1_SIZE_F const*, ID2D1Layer**));
         MOCK_METHOD2(PushLayer                        , void(const D2D1_LAYER_PARAMETERS1*, ID2D1Layer*));
         MOCK_METHOD0(PopLayer                         , void());
         MOCK_METHOD2(PushAxisAlignedClip              , void(D2D1_RECT_F const*, D2D1_ANTIALIAS_MODE));
@@ -175,12 +177,6 @@ namespace canvas
             return E_NOTIMPL;
         }
 
-        IFACEMETHODIMP CreateLayer(const D2D1_SIZE_F *,ID2D1Layer **) override
-        {
-            Assert::Fail(L"Unexpected call to CreateLayer");
-            return E_NOTIMPL;
-        }
-
         IFACEMETHODIMP CreateMesh(ID2D1Mesh **) override
         {
             Assert::Fail(L"Unexpected call to CreateMesh");
@@ -230,12 +226,6 @@ namespace canvas
             return D2D1::PixelFormat();
         }
 
-        IFACEMETHODIMP_(D2D1_SIZE_F) GetSize() const override
-        {
-            Assert::Fail(L"Unexpected call to GetSize");
-            return D2D1_SIZE_F{ 0.0f, 0.0f };
-        }
-
         IFACEMETHODIMP_(D2D1_SIZE_U) GetPixelSize() const override
         {
             Assert::Fail(L"Unexpected call to GetPixelSize");
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace canvas
+{
+    class MockD2DLayer : public RuntimeClass<
+        RuntimeClassFlags<ClassicCom>,
+        ChainInterfaces<ID2D1Layer, ID2D1Resource>>
+    {
+    public:
+
+        CALL_COUNTER_WITH_MOCK(GetFactoryMethod, void(ID2D1Factory**));
+        CALL_COUNTER_WITH_MOCK(GetSizeMethod, D2D1_SIZE_F());
+
+        //
+        // ID2D1Layer
+        //
+
+        STDMETHOD_(D2D1_SIZE_F, GetSize)() const override
+        {
+            return GetSizeMethod.WasCalled();
+        }
+
+        //
+        // ID2D1Resource
+        //
+
+        STDMETHOD_(void, GetFactory)(
+            ID2D1Factory** factory) const override
+        {
+            GetFactoryMethod.WasCalled(factory);
+        }
+    };
+}
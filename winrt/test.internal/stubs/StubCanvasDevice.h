@@ -20,6 +20,9 @@ namespace canvas
         ComPtr<MockD3D11Device> m_d3dDevice;
         ComPtr<MockEventSource<DeviceLostHandlerType>> m_deviceLostEventSource;
         DeviceContextPool m_deviceContextPool;
+        Text::TextLayoutCache m_textLayoutCache;
+        LayerPool m_layerPool;
+        Geometry::GeometryRealizationCache m_geometryRealizationCache;
         
     public:
         StubCanvasDevice(ComPtr<ID2D1Device1> device = Make<StubD2DDevice>(), ComPtr<MockD3D11Device> d3dDevice = nullptr)
@@ -88,6 +91,24 @@ namespace canvas
                     return m_deviceLostEventSource->InvokeAll(this, nullptr);
                 });
 
+            GetTextLayoutCacheMethod.AllowAnyCall(
+                [=]
+                {
+                    return &m_textLayoutCache;
+                });
+
+            GetLayerPoolMethod.AllowAnyCall(
+                [=]
+                {
+                    return &m_layerPool;
+                });
+
+            GetGeometryRealizationCacheMethod.AllowAnyCall(
+                [=]
+                {
+                    return &m_geometryRealizationCache;
+                });
+
             IsDeviceLostMethod.AllowAnyCall(
                 [=](int, boolean* out)
                 {
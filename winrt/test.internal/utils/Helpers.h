@@ -1083,6 +1083,13 @@ namespace Microsoft
                 END_ENUM(CanvasFigureFill);
             }
 
+            ENUM_TO_STRING(CanvasIndexFormat)
+            {
+                ENUM_VALUE(CanvasIndexFormat::UInt16);
+                ENUM_VALUE(CanvasIndexFormat::UInt32);
+                END_ENUM(CanvasIndexFormat);
+            }
+
             ENUM_TO_STRING(CanvasSweepDirection)
             {
                 ENUM_VALUE(CanvasSweepDirection::CounterClockwise);
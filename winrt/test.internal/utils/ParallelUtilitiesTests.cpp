@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/utils/ParallelUtilities.h>
+
+
+TEST_CLASS(ParallelUtilitiesTests)
+{
+    // Records the chunks without visiting their elements, and checks that
+    // together they cover [0, count) exactly once.
+    static void ValidateChunks(uint32_t count, uint32_t minChunkSize)
+    {
+        std::mutex mutex;
+        std::vector<std::pair<uint32_t, uint32_t>> chunks;
+
+        ParallelFor(count, minChunkSize,
+            [&](uint32_t begin, uint32_t end)
+            {
+                Lock lock(mutex);
+                chunks.emplace_back(begin, end);
+            });
+
+        std::sort(chunks.begin(), chunks.end());
+
+        uint32_t expectedBegin = 0;
+
+        for (auto& chunk : chunks)
+        {
+            Assert::AreEqual(expectedBegin, chunk.first);
+            Assert::IsTrue(chunk.first < chunk.second);
+
+            expectedBegin = chunk.second;
+        }
+
+        Assert::AreEqual(count, expectedBegin);
+    }
+
+    TEST_METHOD_EX(ParallelFor_EmptyRange_DoesNotCallFunction)
+    {
+        ParallelFor(0, 1, [](uint32_t, uint32_t) { Assert::Fail(); });
+    }
+
+    TEST_METHOD_EX(ParallelFor_ChunksCoverTheRange)
+    {
+        ValidateChunks(1, 1);
+        ValidateChunks(1000, 1);
+        ValidateChunks(1000, 7);
+        ValidateChunks(1000, 0);
+    }
+
+    TEST_METHOD_EX(ParallelFor_ChunksCoverTheRange_WithCountsNearUintMax)
+    {
+        ValidateChunks(UINT32_MAX, 0x80000000);
+        ValidateChunks(UINT32_MAX, UINT32_MAX);
+        ValidateChunks(UINT32_MAX - 1, UINT32_MAX / 3);
+    }
+
+    TEST_METHOD_EX(ParallelFor_ExceptionsAreRethrownOnTheCallingThread)
+    {
+        ExpectHResultException(E_FAIL,
+            []
+            {
+                ParallelFor(1000, 1, [](uint32_t, uint32_t) { ThrowHR(E_FAIL); });
+            });
+    }
+};